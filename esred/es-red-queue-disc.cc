@@ -23,10 +23,12 @@
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
+#include "ns3/pointer.h"
 #include "ns3/simulator.h"
 #include "ns3/abort.h"
 #include "ns3/drop-tail-queue.h"
 #include "es-red-queue-disc.h"
+#include <cmath>
 
 using namespace std;
 
@@ -59,12 +61,41 @@ ESRedQueueDisc::GetTypeId (void)
                 MakeQueueSizeChecker ())
       .AddAttribute ("StabilizedRedMode", "Simple  or Full", IntegerValue (1),
                       MakeIntegerAccessor (&ESRedQueueDisc::stabilizedRedMode),
-                      MakeIntegerChecker<int32_t> ());
+                      MakeIntegerChecker<int32_t> ())
+      .AddAttribute ("ZombieListSize",
+                     "The number of recently seen flows kept in the zombie list",
+                     UintegerValue (MAX_ZOMBIE_LIST_SIZE),
+                     MakeUintegerAccessor (&ESRedQueueDisc::m_zombieListSize),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("ShardGroup",
+                     "The group of shards whose hit frequencies are merged (for a child of MqQueueDisc)",
+                     PointerValue (),
+                     MakePointerAccessor (&ESRedQueueDisc::m_shardGroup),
+                     MakePointerChecker<SredShardGroup> ())
+      .AddAttribute ("OverwriteDecay",
+                     "How the overwrite probability of a zombie decays: with the absolute "
+                     "time it was written (original ESRED), or with its age",
+                     EnumValue (TIMESTAMP),
+                     MakeEnumAccessor (&ESRedQueueDisc::m_overwriteDecay),
+                     MakeEnumChecker (TIMESTAMP, "Timestamp",
+                                      AGE, "Age"))
+      .AddAttribute ("HalfLife",
+                     "Time after which the protection of a zombie against overwrites is halved (Age mode)",
+                     TimeValue (Seconds (1)),
+                     MakeTimeAccessor (&ESRedQueueDisc::m_halfLife),
+                     MakeTimeChecker (Time (0)))
+      .AddAttribute ("TickResolution",
+                     "The resolution of the timestamps of the zombies",
+                     TimeValue (MicroSeconds (100)),
+                     MakeTimeAccessor (&ESRedQueueDisc::m_tickResolution),
+                     MakeTimeChecker (NanoSeconds (1)));
   return tid;
 }
 
 ESRedQueueDisc::ESRedQueueDisc ()
-    : QueueDisc (QueueDiscSizePolicy::SINGLE_INTERNAL_QUEUE)
+    : QueueDisc (QueueDiscSizePolicy::SINGLE_INTERNAL_QUEUE),
+      m_shard (0),
+      m_inShardGroup (false)
 {
   NS_LOG_FUNCTION (this);
   m_uv = CreateObject<UniformRandomVariable> ();
@@ -80,6 +111,12 @@ ESRedQueueDisc::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_uv = 0;
+  if (m_inShardGroup)
+    {
+      m_shardGroup->RemoveShard (m_shard);
+      m_inShardGroup = false;
+    }
+  m_shardGroup = 0;
   QueueDisc::DoDispose ();
 }
 
@@ -91,6 +128,19 @@ ESRedQueueDisc::AssignStreams (int64_t stream)
   return 1;
 }
 
+double
+ESRedQueueDisc::GetHitFrequency (void) const
+{
+  return p_hitFreq;
+}
+
+void
+ESRedQueueDisc::SetHitFrequency (double hitFrequency)
+{
+  NS_LOG_FUNCTION (this << hitFrequency);
+  p_hitFreq = hitFrequency;
+}
+
 void
 ESRedQueueDisc::InitializeParams (void)
 {
@@ -98,15 +148,47 @@ ESRedQueueDisc::InitializeParams (void)
   NS_LOG_INFO ("Initializing ES RED params.");
   zombies = vector<EZombie> ();
   p_hitFreq = 0;
-  alpha = p_overwrite / MAX_ZOMBIE_LIST_SIZE;
+  alpha = p_overwrite / m_zombieListSize;
+  m_halfLifeTicks = m_halfLife.GetDouble () / m_tickResolution.GetDouble ();
+
+  if (m_shardGroup && !m_inShardGroup)
+    {
+      m_shard = m_shardGroup->AddShard (MakeCallback (&ESRedQueueDisc::GetHitFrequency, this),
+                                        MakeCallback (&ESRedQueueDisc::SetHitFrequency, this));
+      m_inShardGroup = true;
+    }
+}
+
+uint32_t
+ESRedQueueDisc::GetTicks (void) const
+{
+  return static_cast<uint32_t> (Simulator::Now ().GetTimeStep () / m_tickResolution.GetTimeStep ());
+}
+
+double
+ESRedQueueDisc::CalculateProbabilityOverwrite (const EZombie &zombie) const
+{
+  if (m_overwriteDecay == TIMESTAMP)
+    {
+      return p_overwrite / (1 + zombie.time * m_tickResolution.GetSeconds ());
+    }
+
+  if (m_halfLifeTicks <= 0)
+    {
+      return p_overwrite;
+    }
+  // unsigned arithmetic handles the wrap around of the tick counter
+  uint32_t age = GetTicks () - zombie.time;
+  return p_overwrite * (1 - std::exp2 (-static_cast<double> (age) / m_halfLifeTicks));
 }
 
 // calculate p_sred
 double
 ESRedQueueDisc::calculateProbabilityStabilizedRed()
 {
+    // the queue size and the capacity are both expressed in packets or in bytes
     uint32_t bufferCapacity = GetInternalQueue (0)->GetMaxSize ().GetValue ();
-    uint32_t q = GetInternalQueue (0)->GetNBytes ();
+    uint32_t q = GetInternalQueue (0)->GetCurrentSize ().GetValue ();
 
     double bufferCapacity_3 = (double) bufferCapacity / 3.0;
     double bufferCapacity_6 = (double) bufferCapacity / 6.0;
@@ -189,30 +271,23 @@ ESRedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       }
   }
 
-  int32_t flowID = flowHash;
-
-  uint32_t nQueued = GetInternalQueue (0)->GetCurrentSize ().GetValue ();
-  uint32_t capacity = GetInternalQueue (0)->GetMaxSize ().GetValue ();
-
-  if (flowID == -1)
-    {
-      DropBeforeEnqueue (item, "InvalidFlowID");
-    }
+  // the zombie list stores and compares the full 32-bit flow hash
+  uint32_t flowID = flowHash;
 
   int32_t curZombieSize = zombies.size ();
   // cout<<"curZombieSize: "<<curZombieSize<<endl;
   // cout<<"nQueued: "<<nQueued<<" , Capacity "<<capacity<< ", Percent : "<< nQueued*100.0/capacity<<endl;
 
-  if (curZombieSize < MAX_ZOMBIE_LIST_SIZE) // still has space in zombie list
+  if (static_cast<uint32_t> (curZombieSize) < m_zombieListSize) // still has space in zombie list
     {
       EZombie zombie;
       zombie.flowID = flowID;
       zombie.count = 0;
-      zombie.time = Simulator::Now ();
+      zombie.time = GetTicks ();
       zombies.push_back (zombie);
 
       // if adding packet size doesn't exceed capacity of queue, then enqueue
-        if (nQueued + item->GetSize () <= capacity)
+        if (GetInternalQueue (0)->GetCurrentSize () + item <= GetInternalQueue (0)->GetMaxSize ())
         {
             NS_LOG_DEBUG ("Enqueueing " << item->GetPacket ()->GetUid () << " to queue " << (uint32_t) flowID);
             return GetInternalQueue (0)->Enqueue (item);
@@ -235,18 +310,18 @@ ESRedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
         {
           hit = 1;
           zombies[index].count++;
-          zombies[index].time = Simulator::Now ();
+          zombies[index].time = GetTicks ();
         }
       else // not HIT
         {
           // get a random value and compare with p_overwrite
           double rand = m_uv->GetValue ();
-          double p_overwrite_e = p_overwrite/(1+zombies[index].time.GetSeconds());
+          double p_overwrite_e = CalculateProbabilityOverwrite (zombies[index]);
           if (rand < p_overwrite_e)
             {
               zombies[index].flowID = flowID;
               zombies[index].count = 0;
-              zombies[index].time = Simulator::Now ();
+              zombies[index].time = GetTicks ();
             }
         }
 
@@ -278,7 +353,7 @@ ESRedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       }
     else
       {
-        if(nQueued < capacity)
+        if (GetInternalQueue (0)->GetCurrentSize () + item <= GetInternalQueue (0)->GetMaxSize ())
         {
             return GetInternalQueue (0)->Enqueue (item);
         }
@@ -123,6 +123,7 @@ int main (int argc, char *argv[])
 {
   uint32_t    nLeaf = 30;
   uint32_t    maxPackets = 100;
+  bool        bql = true;
   bool        modeBytes  = true; // byte mode
 
   // queue disc limit * pktSize ~ 0.5 Mytes
@@ -130,6 +131,7 @@ int main (int argc, char *argv[])
   uint32_t    pktSize = 512;
 
   std::string appDataRate = "650Mbps";
+  uint32_t    appBatchSize = 1;
   uint16_t port = 5001;
   std::string bottleNeckLinkBw = "45Mbps";
   std::string bottleNeckLinkDelay = "1ms";
@@ -142,15 +144,18 @@ int main (int argc, char *argv[])
   CommandLine cmd (__FILE__);
   cmd.AddValue ("nLeaf",     "Number of left and right side leaf nodes", nLeaf);
   cmd.AddValue ("maxPackets","Max Packets allowed in the device queue", maxPackets);
+  cmd.AddValue ("bql", "Enable byte queue limits on the bottleneck devices", bql);
   cmd.AddValue ("queueDiscLimitPackets","Max Packets allowed in the queue disc", queueDiscLimitPackets);
   cmd.AddValue ("appPktSize", "Set OnOff App Packet Size", pktSize);
   cmd.AddValue ("appDataRate", "Set OnOff App DataRate", appDataRate);
+  cmd.AddValue ("appBatchSize", "Set OnOff App BatchSize (packets sent per event)", appBatchSize);
   cmd.AddValue ("modeBytes", "Set Queue disc mode to Packets (false) or bytes (true)", modeBytes);
 
   cmd.Parse (argc,argv);
 
   Config::SetDefault ("ns3::OnOffApplication::PacketSize", UintegerValue (pktSize));
   Config::SetDefault ("ns3::OnOffApplication::DataRate", StringValue (appDataRate));
+  Config::SetDefault ("ns3::OnOffApplication::BatchSize", UintegerValue (appBatchSize));
 
   Config::SetDefault ("ns3::DropTailQueue<Packet>::MaxSize",
                       StringValue (std::to_string (maxPackets) + "p"));
@@ -200,6 +205,11 @@ int main (int argc, char *argv[])
   TrafficControlHelper tchBottleneck;
   QueueDiscContainer queueDiscs;
   tchBottleneck.SetRootQueueDisc ("ns3::StabilizedRedQueueDisc");
+  if (bql)
+    {
+      // keep the backlog in the queue disc rather than in the device queue
+      tchBottleneck.SetQueueLimits ("ns3::DynamicQueueLimits");
+    }
   tchBottleneck.Install (d.GetLeft ()->GetDevice (0));
   queueDiscs = tchBottleneck.Install (d.GetRight ()->GetDevice (0));
 
@@ -0,0 +1,56 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "trace-replay-helper.h"
+#include "ns3/abort.h"
+#include "ns3/string.h"
+#include "ns3/trace-replay-application.h"
+
+namespace ns3 {
+
+TraceReplayHelper::TraceReplayHelper (std::string traceFile)
+{
+  m_factory.SetTypeId ("ns3::TraceReplayApplication");
+  m_factory.Set ("TraceFile", StringValue (traceFile));
+}
+
+void
+TraceReplayHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+TraceReplayHelper::Install (Ptr<Node> node, NodeContainer sources, NodeContainer destinations,
+                            const std::vector<Address> &addresses) const
+{
+  NS_ABORT_MSG_UNLESS (destinations.GetN () == addresses.size (),
+                       "One address is needed for each destination");
+  Ptr<TraceReplayApplication> app = m_factory.Create<TraceReplayApplication> ();
+  for (uint32_t i = 0; i < sources.GetN (); i++)
+    {
+      app->AddSource (sources.Get (i));
+    }
+  for (uint32_t i = 0; i < destinations.GetN (); i++)
+    {
+      app->AddDestination (destinations.Get (i), addresses[i]);
+    }
+  node->AddApplication (app);
+
+  return ApplicationContainer (app);
+}
+
+} // namespace ns3
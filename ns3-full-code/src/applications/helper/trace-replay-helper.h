@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRACE_REPLAY_HELPER_H
+#define TRACE_REPLAY_HELPER_H
+
+#include <string>
+#include <vector>
+#include "ns3/object-factory.h"
+#include "ns3/address.h"
+#include "ns3/attribute.h"
+#include "ns3/node-container.h"
+#include "ns3/application-container.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tracereplay
+ * \brief A helper to make it easier to instantiate an
+ * ns3::TraceReplayApplication replaying a trace between sets of nodes.
+ */
+class TraceReplayHelper
+{
+public:
+  /**
+   * Create a TraceReplayHelper to make it easier to work with
+   * TraceReplayApplications
+   *
+   * \param traceFile the name of the flow trace file
+   */
+  TraceReplayHelper (std::string traceFile);
+
+  /**
+   * Helper function used to set the underlying application attributes,
+   * _not_ the socket attributes.
+   *
+   * \param name the name of the application attribute to set
+   * \param value the value of the application attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Install an ns3::TraceReplayApplication on the node, configured with all
+   * the attributes set with SetAttribute, which replays the trace from the
+   * sources to the destinations.
+   *
+   * \param node the node on which the application will be installed
+   * \param sources the sources of the flows
+   * \param destinations the destinations of the flows
+   * \param addresses the IPv4 or IPv6 address of each destination
+   * \returns Container of Ptr to the application installed.
+   */
+  ApplicationContainer Install (Ptr<Node> node, NodeContainer sources,
+                                NodeContainer destinations,
+                                const std::vector<Address> &addresses) const;
+
+private:
+  ObjectFactory m_factory; //!< Object factory.
+};
+
+} // namespace ns3
+
+#endif /* TRACE_REPLAY_HELPER_H */
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "flow-trace-file.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/fatal-error.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowTraceFile");
+
+namespace {
+
+/// The magic string of the trace files
+const char g_magic[8] = {'N', 'S', '3', 'F', 'L', 'O', 'W', 'S'};
+/// The version of the format
+const uint32_t g_version = 1;
+
+/**
+ * \param p the bytes
+ * \param n the number of bytes
+ * \return the little-endian integer stored in the bytes
+ */
+uint64_t
+ReadLe (const uint8_t *p, uint32_t n)
+{
+  uint64_t v = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      v |= static_cast<uint64_t> (p[i]) << (8 * i);
+    }
+  return v;
+}
+
+/**
+ * \param os the stream
+ * \param v the integer
+ * \param n the number of bytes to write
+ */
+void
+WriteLe (std::ostream &os, uint64_t v, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      os.put (static_cast<char> ((v >> (8 * i)) & 0xff));
+    }
+}
+
+} // unnamed namespace
+
+FlowTraceFile::FlowTraceFile ()
+  : m_data (0),
+    m_size (0),
+    m_nRecords (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FlowTraceFile::~FlowTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+FlowTraceFile::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+
+  int fd = open (filename.c_str (), O_RDONLY);
+  NS_ABORT_MSG_IF (fd < 0, "Cannot open the flow trace file " << filename);
+  struct stat st;
+  if (fstat (fd, &st) < 0 || static_cast<uint64_t> (st.st_size) < HEADER_SIZE)
+    {
+      close (fd);
+      NS_FATAL_ERROR ("The flow trace file " << filename << " has no header");
+    }
+  m_size = st.st_size;
+  void *data = mmap (0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping outlives the descriptor
+  close (fd);
+  NS_ABORT_MSG_IF (data == MAP_FAILED, "Cannot map the flow trace file " << filename);
+  // the records are read in order
+  madvise (data, m_size, MADV_SEQUENTIAL);
+  m_data = static_cast<const uint8_t *> (data);
+
+  NS_ABORT_MSG_UNLESS (std::memcmp (m_data, g_magic, sizeof (g_magic)) == 0,
+                       filename << " is not a flow trace file");
+  NS_ABORT_MSG_UNLESS (ReadLe (m_data + 8, 4) == g_version,
+                       "Unsupported version of the flow trace file " << filename);
+  NS_ABORT_MSG_UNLESS (ReadLe (m_data + 12, 4) == RECORD_SIZE,
+                       "Unsupported record size in the flow trace file " << filename);
+  m_nRecords = (m_size - HEADER_SIZE) / RECORD_SIZE;
+  NS_LOG_INFO (filename << ": " << m_nRecords << " flows");
+}
+
+void
+FlowTraceFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data != 0)
+    {
+      munmap (const_cast<uint8_t *> (m_data), m_size);
+    }
+  m_data = 0;
+  m_size = 0;
+  m_nRecords = 0;
+}
+
+bool
+FlowTraceFile::IsOpen (void) const
+{
+  return m_data != 0;
+}
+
+uint64_t
+FlowTraceFile::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+FlowTraceFile::Record
+FlowTraceFile::GetRecord (uint64_t index) const
+{
+  NS_ASSERT_MSG (index < m_nRecords, "No record " << index);
+  const uint8_t *p = m_data + HEADER_SIZE + index * RECORD_SIZE;
+  Record record;
+  record.start = NanoSeconds (ReadLe (p, 8));
+  record.size = ReadLe (p + 8, 8);
+  record.gap = NanoSeconds (ReadLe (p + 16, 8));
+  record.source = ReadLe (p + 24, 2);
+  record.destination = ReadLe (p + 26, 2);
+  record.protocol = p[28];
+  return record;
+}
+
+void
+FlowTraceFile::WriteHeader (std::ostream &os)
+{
+  os.write (g_magic, sizeof (g_magic));
+  WriteLe (os, g_version, 4);
+  WriteLe (os, RECORD_SIZE, 4);
+}
+
+void
+FlowTraceFile::WriteRecord (std::ostream &os, const Record &record)
+{
+  WriteLe (os, record.start.GetNanoSeconds (), 8);
+  WriteLe (os, record.size, 8);
+  WriteLe (os, record.gap.GetNanoSeconds (), 8);
+  WriteLe (os, record.source, 2);
+  WriteLe (os, record.destination, 2);
+  WriteLe (os, record.protocol, 1);
+  WriteLe (os, 0, 3);
+}
+
+} // namespace ns3
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_TRACE_FILE_H
+#define FLOW_TRACE_FILE_H
+
+#include <string>
+#include <ostream>
+#include <stdint.h>
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief A read-only, memory-mapped file of flow arrivals
+ *
+ * The file describes the flows to replay, sorted by start time. All the
+ * fields are little-endian. The file starts with a 16-byte header:
+ *
+ * \li the magic string "NS3FLOWS" (8 bytes),
+ * \li the version of the format, 1 (4 bytes),
+ * \li the size of a record, 32 (4 bytes),
+ *
+ * followed by the 32-byte records:
+ *
+ * \li the start time of the flow, in nanoseconds since the start of the trace (8 bytes),
+ * \li the size of the flow, in bytes (8 bytes),
+ * \li the gap between the packets of the flow, in nanoseconds (8 bytes),
+ * \li the index of the source (2 bytes),
+ * \li the index of the destination (2 bytes),
+ * \li the protocol, 6 (TCP) or 17 (UDP) (1 byte),
+ * \li 3 reserved bytes.
+ *
+ * The file is mapped in memory rather than read, so that a trace of
+ * millions of flows is paged in as it is replayed and does not need to fit
+ * in memory. The records are written with WriteHeader and WriteRecord.
+ */
+class FlowTraceFile
+{
+public:
+  /**
+   * \brief A flow of the trace
+   */
+  struct Record
+  {
+    Time start;             //!< start time, relative to the start of the trace
+    uint64_t size;          //!< size, in bytes
+    Time gap;               //!< gap between the packets (UDP)
+    uint16_t source;        //!< index of the source
+    uint16_t destination;   //!< index of the destination
+    uint8_t protocol;       //!< protocol number, 6 (TCP) or 17 (UDP)
+  };
+
+  static const uint32_t HEADER_SIZE = 16;   //!< size of the header, in bytes
+  static const uint32_t RECORD_SIZE = 32;   //!< size of a record, in bytes
+
+  FlowTraceFile ();
+  ~FlowTraceFile ();
+
+  // Delete copy constructor and assignment operator to avoid misuse
+  FlowTraceFile (const FlowTraceFile &) = delete;
+  FlowTraceFile & operator = (const FlowTraceFile &) = delete;
+
+  /**
+   * \brief Map a trace file in memory
+   *
+   * Aborts the simulation if the file cannot be mapped or is not a valid
+   * trace file.
+   *
+   * \param filename the name of the file
+   */
+  void Open (std::string filename);
+
+  /**
+   * \brief Unmap the file, if any
+   */
+  void Close (void);
+
+  /**
+   * \return true if a file is mapped
+   */
+  bool IsOpen (void) const;
+
+  /**
+   * \return the number of records of the file
+   */
+  uint64_t GetNRecords (void) const;
+
+  /**
+   * \param index the index of the record
+   * \return the record
+   */
+  Record GetRecord (uint64_t index) const;
+
+  /**
+   * \brief Write the header of a trace file
+   * \param os the stream, opened in binary mode
+   */
+  static void WriteHeader (std::ostream &os);
+
+  /**
+   * \brief Write a record of a trace file
+   * \param os the stream, opened in binary mode
+   * \param record the record
+   */
+  static void WriteRecord (std::ostream &os, const Record &record);
+
+private:
+  const uint8_t *m_data;    //!< the mapped file
+  uint64_t m_size;          //!< the size of the mapped file, in bytes
+  uint64_t m_nRecords;      //!< the number of records
+};
+
+} // namespace ns3
+
+#endif /* FLOW_TRACE_FILE_H */
@@ -99,6 +99,14 @@ OnOffApplication::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&OnOffApplication::m_enableSeqTsSizeHeader),
                    MakeBooleanChecker ())
+    .AddAttribute ("BatchSize",
+                   "The maximum number of packets sent back to back per send event. "
+                   "If greater than one, the packets are copied from a template and "
+                   "the application waits for room in the socket instead of retrying "
+                   "on a timer when the socket cannot accept a packet.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&OnOffApplication::m_batchSize),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&OnOffApplication::m_txTrace),
                      "ns3::Packet::TracedCallback")
@@ -119,7 +127,8 @@ OnOffApplication::OnOffApplication ()
     m_residualBits (0),
     m_lastStartTime (Seconds (0)),
     m_totBytes (0),
-    m_unsentPacket (0)
+    m_unsentPacket (0),
+    m_blocked (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -160,6 +169,7 @@ OnOffApplication::DoDispose (void)
   CancelEvents ();
   m_socket = 0;
   m_unsentPacket = 0;
+  m_template = 0;
   // chain up
   Application::DoDispose ();
 }
@@ -207,9 +217,18 @@ void OnOffApplication::StartApplication () // Called at time specified by Start
       m_socket->SetConnectCallback (
         MakeCallback (&OnOffApplication::ConnectionSucceeded, this),
         MakeCallback (&OnOffApplication::ConnectionFailed, this));
+      m_socket->SetSendCallback (MakeCallback (&OnOffApplication::SendAvailable, this));
     }
   m_cbrRateFailSafe = m_cbrRate;
 
+  m_template = 0;
+  if (m_batchSize > 1)
+    {
+      uint32_t headerSize = m_enableSeqTsSizeHeader ? SeqTsSizeHeader ().GetSerializedSize () : 0;
+      NS_ABORT_IF (m_pktSize < headerSize);
+      m_template = Create<Packet> (m_pktSize - headerSize);
+    }
+
   // Insure no pending event
   CancelEvents ();
   // If we are not yet connected, there is nothing to do here
@@ -237,7 +256,10 @@ void OnOffApplication::CancelEvents ()
 {
   NS_LOG_FUNCTION (this);
 
-  if (m_sendEvent.IsRunning () && m_cbrRateFailSafe == m_cbrRate )
+  // A batch sends packets ahead of time, so the last packet sent may be
+  // due after now
+  if (m_sendEvent.IsRunning () && m_cbrRateFailSafe == m_cbrRate
+      && Simulator::Now () > m_lastStartTime)
     { // Cancel the pending send packet event
       // Calculate residual bits since last packet sent
       Time delta (Simulator::Now () - m_lastStartTime);
@@ -254,6 +276,7 @@ void OnOffApplication::CancelEvents ()
       NS_LOG_DEBUG ("Discarding cached packet upon CancelEvents ()");
     }
   m_unsentPacket = 0;
+  m_blocked = false;
 }
 
 // Event handlers
@@ -287,7 +310,9 @@ void OnOffApplication::ScheduleNextTx ()
                               static_cast<double>(m_cbrRate.GetBitRate ()))); // Time till next packet
       NS_LOG_LOGIC ("nextTime = " << nextTime.As (Time::S));
       m_sendEvent = Simulator::Schedule (nextTime,
-                                         &OnOffApplication::SendPacket, this);
+                                         m_batchSize > 1 ? &OnOffApplication::SendBatch
+                                                         : &OnOffApplication::SendPacket,
+                                         this);
     }
   else
     { // All done, cancel any pending events
@@ -314,18 +339,13 @@ void OnOffApplication::ScheduleStopEvent ()
 }
 
 
-void OnOffApplication::SendPacket ()
+Ptr<Packet>
+OnOffApplication::CreatePacket ()
 {
   NS_LOG_FUNCTION (this);
 
-  NS_ASSERT (m_sendEvent.IsExpired ());
-
   Ptr<Packet> packet;
-  if (m_unsentPacket)
-    {
-      packet = m_unsentPacket;
-    }
-  else if (m_enableSeqTsSizeHeader)
+  if (m_enableSeqTsSizeHeader)
     {
       Address from, to;
       m_socket->GetSockName (from);
@@ -334,44 +354,63 @@ void OnOffApplication::SendPacket ()
       header.SetSeq (m_seq++);
       header.SetSize (m_pktSize);
       NS_ABORT_IF (m_pktSize < header.GetSerializedSize ());
-      packet = Create<Packet> (m_pktSize - header.GetSerializedSize ());
+      packet = m_template ? m_template->Copy ()
+                          : Create<Packet> (m_pktSize - header.GetSerializedSize ());
       // Trace before adding header, for consistency with PacketSink
       m_txTraceWithSeqTsSize (packet, from, to, header);
       packet->AddHeader (header);
     }
   else
     {
-      packet = Create<Packet> (m_pktSize);
+      packet = m_template ? m_template->Copy () : Create<Packet> (m_pktSize);
+    }
+  return packet;
+}
+
+void
+OnOffApplication::NotifyTx (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+
+  m_txTrace (packet);
+  m_totBytes += m_pktSize;
+  Address localAddress;
+  m_socket->GetSockName (localAddress);
+  if (InetSocketAddress::IsMatchingType (m_peer))
+    {
+      NS_LOG_INFO ("At time " << Simulator::Now ().As (Time::S)
+                   << " on-off application sent "
+                   <<  packet->GetSize () << " bytes to "
+                   << InetSocketAddress::ConvertFrom(m_peer).GetIpv4 ()
+                   << " port " << InetSocketAddress::ConvertFrom (m_peer).GetPort ()
+                   << " total Tx " << m_totBytes << " bytes");
+      m_txTraceWithAddresses (packet, localAddress, InetSocketAddress::ConvertFrom (m_peer));
+    }
+  else if (Inet6SocketAddress::IsMatchingType (m_peer))
+    {
+      NS_LOG_INFO ("At time " << Simulator::Now ().As (Time::S)
+                   << " on-off application sent "
+                   <<  packet->GetSize () << " bytes to "
+                   << Inet6SocketAddress::ConvertFrom(m_peer).GetIpv6 ()
+                   << " port " << Inet6SocketAddress::ConvertFrom (m_peer).GetPort ()
+                   << " total Tx " << m_totBytes << " bytes");
+      m_txTraceWithAddresses (packet, localAddress, Inet6SocketAddress::ConvertFrom(m_peer));
     }
+}
+
+void OnOffApplication::SendPacket ()
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ASSERT (m_sendEvent.IsExpired ());
+
+  Ptr<Packet> packet = m_unsentPacket ? m_unsentPacket : CreatePacket ();
 
   int actual = m_socket->Send (packet);
   if ((unsigned) actual == m_pktSize)
     {
-      m_txTrace (packet);
-      m_totBytes += m_pktSize;
       m_unsentPacket = 0;
-      Address localAddress;
-      m_socket->GetSockName (localAddress);
-      if (InetSocketAddress::IsMatchingType (m_peer))
-        {
-          NS_LOG_INFO ("At time " << Simulator::Now ().As (Time::S)
-                       << " on-off application sent "
-                       <<  packet->GetSize () << " bytes to "
-                       << InetSocketAddress::ConvertFrom(m_peer).GetIpv4 ()
-                       << " port " << InetSocketAddress::ConvertFrom (m_peer).GetPort ()
-                       << " total Tx " << m_totBytes << " bytes");
-          m_txTraceWithAddresses (packet, localAddress, InetSocketAddress::ConvertFrom (m_peer));
-        }
-      else if (Inet6SocketAddress::IsMatchingType (m_peer))
-        {
-          NS_LOG_INFO ("At time " << Simulator::Now ().As (Time::S)
-                       << " on-off application sent "
-                       <<  packet->GetSize () << " bytes to "
-                       << Inet6SocketAddress::ConvertFrom(m_peer).GetIpv6 ()
-                       << " port " << Inet6SocketAddress::ConvertFrom (m_peer).GetPort ()
-                       << " total Tx " << m_totBytes << " bytes");
-          m_txTraceWithAddresses (packet, localAddress, Inet6SocketAddress::ConvertFrom(m_peer));
-        }
+      NotifyTx (packet);
     }
   else
     {
@@ -383,6 +422,67 @@ void OnOffApplication::SendPacket ()
   ScheduleNextTx ();
 }
 
+void OnOffApplication::SendBatch ()
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ASSERT (m_sendEvent.IsExpired ());
+
+  Time interval = m_cbrRate.CalculateBytesTxTime (m_pktSize);
+  // The packets due after the end of the On period are not sent
+  Time onLeft = Simulator::GetDelayLeft (m_startStopEvent);
+  // Offset of the nominal send time of the next packet
+  Time next = Seconds (0);
+  uint32_t sent = 0;
+  while (sent < m_batchSize && next < onLeft)
+    {
+      if (m_socket->GetTxAvailable () < m_pktSize)
+        {
+          NS_LOG_DEBUG ("No room in the socket for " << m_pktSize << " bytes; waiting");
+          m_blocked = true;
+          break;
+        }
+      Ptr<Packet> packet = CreatePacket ();
+      int actual = m_socket->Send (packet);
+      if ((unsigned) actual == m_pktSize)
+        {
+          NotifyTx (packet);
+        }
+      else
+        {
+          NS_LOG_DEBUG ("Unable to send packet; actual " << actual << " size " << m_pktSize << "; skipping it");
+        }
+      next += interval;
+      sent++;
+      if (m_maxBytes > 0 && m_totBytes >= m_maxBytes)
+        {
+          // All done, cancel any pending events
+          StopApplication ();
+          return;
+        }
+    }
+  NS_LOG_LOGIC ("sent " << sent << " packets");
+
+  m_residualBits = 0;
+  m_lastStartTime = Simulator::Now () + (sent > 0 ? next - interval : Seconds (0));
+  if (!m_blocked)
+    {
+      m_sendEvent = Simulator::Schedule (next, &OnOffApplication::SendBatch, this);
+    }
+}
+
+void OnOffApplication::SendAvailable (Ptr<Socket> socket, uint32_t available)
+{
+  NS_LOG_FUNCTION (this << socket << available);
+
+  // m_blocked is reset when the On period ends
+  if (m_blocked && available >= m_pktSize)
+    {
+      m_blocked = false;
+      SendBatch ();
+    }
+}
+
 
 void OnOffApplication::ConnectionSucceeded (Ptr<Socket> socket)
 {
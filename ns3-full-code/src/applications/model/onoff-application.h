@@ -91,6 +91,20 @@ class Socket;
  * (enable its "EnableSeqTsSizeHeader" attribute), or users may extract
  * the header via trace sources.  Note that the continuity of the sequence
  * number may be disrupted across On/Off cycles.
+ *
+ * If the attribute "BatchSize" is greater than one, each send event sends
+ * a batch of up to BatchSize packets back to back, those which the cbr
+ * schedule spreads over the next BatchSize intervals (and within the
+ * current On period), and schedules the next event at the nominal time of
+ * the packet which follows, so that the average rate is unchanged while
+ * the number of events is divided by BatchSize. The packets are copies of
+ * a template packet, whose zero-filled payload they share (the copies, as
+ * any copy, keep the uid of the template). Rather than caching a packet
+ * which the socket cannot accept and retrying at the next interval, the
+ * application checks the room in the transmit buffer of the socket
+ * (Socket::GetTxAvailable) and, once it is full, sends nothing until the
+ * socket notifies that room is available again; the schedule then restarts
+ * from that time, as the packets which could not be sent are not queued.
 */
 class OnOffApplication : public Application 
 {
@@ -156,6 +170,29 @@ private:
    * \brief Send a packet
    */
   void SendPacket ();
+  /**
+   * \brief Send a batch of packets (BatchSize greater than one)
+   */
+  void SendBatch ();
+  /**
+   * \brief Resume sending batches once the socket has room again
+   * \param socket the socket
+   * \param available the room in the transmit buffer of the socket
+   */
+  void SendAvailable (Ptr<Socket> socket, uint32_t available);
+  /**
+   * \brief Create the next packet to send
+   *
+   * If the SeqTsSizeHeader is enabled, the header is added and traced.
+   *
+   * \return the packet
+   */
+  Ptr<Packet> CreatePacket ();
+  /**
+   * \brief Account for and trace a packet sent
+   * \param packet the packet
+   */
+  void NotifyTx (Ptr<Packet> packet);
 
   Ptr<Socket>     m_socket;       //!< Associated socket
   Address         m_peer;         //!< Peer address
@@ -176,6 +213,9 @@ private:
   uint32_t        m_seq {0};      //!< Sequence
   Ptr<Packet>     m_unsentPacket; //!< Unsent packet cached for future attempt
   bool            m_enableSeqTsSizeHeader {false}; //!< Enable or disable the use of SeqTsSizeHeader
+  uint32_t        m_batchSize;    //!< Maximum number of packets sent per send event
+  Ptr<Packet>     m_template;     //!< Template of the packets sent in batches
+  bool            m_blocked;      //!< True if waiting for room in the socket to send a batch
 
 
   /// Traced Callback: transmitted packets.
@@ -0,0 +1,535 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "trace-replay-application.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/trace-source-accessor.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TraceReplayApplication");
+
+NS_OBJECT_ENSURE_REGISTERED (TraceReplayApplication);
+
+TypeId
+TraceReplayApplication::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TraceReplayApplication")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TraceReplayApplication> ()
+    .AddAttribute ("TraceFile",
+                   "The name of the flow trace file (see FlowTraceFile)",
+                   StringValue (""),
+                   MakeStringAccessor (&TraceReplayApplication::m_traceFile),
+                   MakeStringChecker ())
+    .AddAttribute ("Port",
+                   "The port which the destinations listen on",
+                   UintegerValue (9),
+                   MakeUintegerAccessor (&TraceReplayApplication::m_port),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("PacketSize",
+                   "The size of the packets of the UDP flows",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&TraceReplayApplication::m_packetSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxActiveFlows",
+                   "The maximum number of flows whose source is sending; the flows "
+                   "which start beyond it are skipped (0 for no limit)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TraceReplayApplication::m_maxActiveFlows),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("FlowStarted", "A flow started",
+                     MakeTraceSourceAccessor (&TraceReplayApplication::m_flowStartedTrace),
+                     "ns3::TraceReplayApplication::FlowStartedCallback")
+    .AddTraceSource ("FlowCompleted", "A TCP flow was received by its destination",
+                     MakeTraceSourceAccessor (&TraceReplayApplication::m_flowCompletedTrace),
+                     "ns3::TraceReplayApplication::FlowCompletedCallback")
+  ;
+  return tid;
+}
+
+TraceReplayApplication::TraceReplayApplication ()
+  : m_next (0),
+    m_started (0),
+    m_completed (0),
+    m_skipped (0),
+    m_totalRx (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TraceReplayApplication::~TraceReplayApplication ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TraceReplayApplication::AddSource (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  m_sources.push_back (node);
+  // the IPv4 and IPv6 idle sockets of the source
+  m_udpSockets.emplace_back ();
+  m_udpSockets.emplace_back ();
+}
+
+void
+TraceReplayApplication::AddDestination (Ptr<Node> node, Address address)
+{
+  NS_LOG_FUNCTION (this << node << address);
+  NS_ABORT_MSG_UNLESS (Ipv4Address::IsMatchingType (address) || Ipv6Address::IsMatchingType (address),
+                       "The address of a destination must be an IPv4 or IPv6 address");
+  m_destinations.push_back (node);
+  m_destinationAddresses.push_back (address);
+}
+
+uint64_t
+TraceReplayApplication::GetStartedFlows (void) const
+{
+  return m_started;
+}
+
+uint64_t
+TraceReplayApplication::GetCompletedFlows (void) const
+{
+  return m_completed;
+}
+
+uint64_t
+TraceReplayApplication::GetSkippedFlows (void) const
+{
+  return m_skipped;
+}
+
+uint32_t
+TraceReplayApplication::GetActiveFlows (void) const
+{
+  return m_flows.size () - m_freeSlots.size ();
+}
+
+uint64_t
+TraceReplayApplication::GetTotalRx (void) const
+{
+  return m_totalRx;
+}
+
+void
+TraceReplayApplication::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_trace.Close ();
+  m_sources.clear ();
+  m_udpSockets.clear ();
+  m_destinations.clear ();
+  m_destinationAddresses.clear ();
+  m_listeners.clear ();
+  m_flows.clear ();
+  m_freeSlots.clear ();
+  m_rxFlows.clear ();
+  // chain up
+  Application::DoDispose ();
+}
+
+void
+TraceReplayApplication::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_sources.empty () || m_destinations.empty (),
+                   "TraceReplayApplication needs at least a source and a destination");
+
+  for (uint32_t i = 0; i < m_destinations.size (); i++)
+    {
+      bool ipv4 = Ipv4Address::IsMatchingType (m_destinationAddresses[i]);
+      Address local = ipv4 ? Address (InetSocketAddress (Ipv4Address::GetAny (), m_port))
+                           : Address (Inet6SocketAddress (Ipv6Address::GetAny (), m_port));
+
+      Ptr<Socket> listener = Socket::CreateSocket (m_destinations[i], TcpSocketFactory::GetTypeId ());
+      NS_ABORT_MSG_IF (listener->Bind (local) == -1, "Failed to bind the socket of a destination");
+      listener->Listen ();
+      listener->ShutdownSend ();
+      listener->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                                   MakeCallback (&TraceReplayApplication::HandleAccept, this));
+      // the accepted sockets inherit the close callbacks
+      listener->SetCloseCallbacks (MakeCallback (&TraceReplayApplication::HandlePeerClose, this),
+                                   MakeCallback (&TraceReplayApplication::HandlePeerClose, this));
+      m_listeners.push_back (listener);
+
+      Ptr<Socket> udp = Socket::CreateSocket (m_destinations[i], UdpSocketFactory::GetTypeId ());
+      NS_ABORT_MSG_IF (udp->Bind (local) == -1, "Failed to bind the socket of a destination");
+      udp->ShutdownSend ();
+      udp->SetRecvCallback (MakeCallback (&TraceReplayApplication::HandleUdpRead, this));
+      m_listeners.push_back (udp);
+    }
+
+  m_trace.Open (m_traceFile);
+  m_next = 0;
+  m_traceStart = Simulator::Now ();
+  ScheduleNextFlow ();
+}
+
+void
+TraceReplayApplication::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nextEvent.Cancel ();
+  for (uint32_t slot = 0; slot < m_flows.size (); slot++)
+    {
+      if (m_flows[slot].socket)
+        {
+          m_flows[slot].sendEvent.Cancel ();
+          m_flows[slot].socket->Close ();
+          EndFlow (slot);
+        }
+    }
+  for (auto &it : m_rxFlows)
+    {
+      it.first->Close ();
+    }
+  m_rxFlows.clear ();
+  for (auto &listener : m_listeners)
+    {
+      listener->Close ();
+    }
+  m_listeners.clear ();
+  for (auto &sockets : m_udpSockets)
+    {
+      for (auto &socket : sockets)
+        {
+          socket->Close ();
+        }
+      sockets.clear ();
+    }
+  m_trace.Close ();
+}
+
+void
+TraceReplayApplication::ScheduleNextFlow (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_next < m_trace.GetNRecords ())
+    {
+      Time start = m_traceStart + m_trace.GetRecord (m_next).start;
+      m_nextEvent = Simulator::Schedule (Max (start - Simulator::Now (), Seconds (0)),
+                                         &TraceReplayApplication::StartFlows, this);
+    }
+}
+
+void
+TraceReplayApplication::StartFlows (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now () - m_traceStart;
+  while (m_next < m_trace.GetNRecords ())
+    {
+      FlowTraceFile::Record record = m_trace.GetRecord (m_next);
+      if (record.start > now)
+        {
+          break;
+        }
+      Ptr<Node> source = m_sources[record.source % m_sources.size ()];
+      Simulator::ScheduleWithContext (source->GetId (), Seconds (0),
+                                      &TraceReplayApplication::StartFlow, this, m_next, record);
+      m_next++;
+    }
+  ScheduleNextFlow ();
+}
+
+void
+TraceReplayApplication::StartFlow (uint64_t index, FlowTraceFile::Record record)
+{
+  NS_LOG_FUNCTION (this << index);
+
+  if (!m_trace.IsOpen ())
+    {
+      // the application stopped
+      return;
+    }
+  NS_ABORT_MSG_UNLESS (record.protocol == 6 || record.protocol == 17,
+                       "Unknown protocol " << +record.protocol << " of flow " << index);
+  if (m_maxActiveFlows > 0 && GetActiveFlows () >= m_maxActiveFlows)
+    {
+      NS_LOG_LOGIC ("Skipping flow " << index << ": " << GetActiveFlows () << " active flows");
+      m_skipped++;
+      return;
+    }
+
+  uint32_t slot;
+  if (m_freeSlots.empty ())
+    {
+      slot = m_flows.size ();
+      m_flows.emplace_back ();
+    }
+  else
+    {
+      slot = m_freeSlots.back ();
+      m_freeSlots.pop_back ();
+    }
+  Flow &flow = m_flows[slot];
+  flow.source = record.source % m_sources.size ();
+  flow.index = index;
+  flow.header = SeqTsSizeHeader ();
+  flow.size = record.size;
+  flow.sent = 0;
+  flow.gap = record.gap;
+  flow.tcp = (record.protocol == 6);
+
+  const Address &destination = m_destinationAddresses[record.destination % m_destinations.size ()];
+  bool ipv4 = Ipv4Address::IsMatchingType (destination);
+  flow.ipv4 = ipv4;
+  Address peer = ipv4 ? Address (InetSocketAddress (Ipv4Address::ConvertFrom (destination), m_port))
+                      : Address (Inet6SocketAddress (Ipv6Address::ConvertFrom (destination), m_port));
+
+  m_started++;
+  m_flowStartedTrace (index, flow.size);
+
+  if (flow.tcp)
+    {
+      flow.size = std::max<uint64_t> (flow.size, flow.header.GetSerializedSize ());
+      flow.header.SetSeq (index);
+      flow.header.SetSize (flow.size);
+      flow.socket = Socket::CreateSocket (m_sources[flow.source], TcpSocketFactory::GetTypeId ());
+      NS_ABORT_MSG_IF ((ipv4 ? flow.socket->Bind () : flow.socket->Bind6 ()) == -1,
+                       "Failed to bind the socket of flow " << index);
+      flow.socket->SetConnectCallback (
+        MakeCallback (&TraceReplayApplication::ConnectionSucceeded, this).Bind (slot),
+        MakeCallback (&TraceReplayApplication::ConnectionFailed, this).Bind (slot));
+      flow.socket->SetSendCallback (MakeCallback (&TraceReplayApplication::SendData, this).Bind (slot));
+      flow.socket->Connect (peer);
+      flow.socket->ShutdownRecv ();
+      return;
+    }
+
+  // recycle an idle UDP socket of the source
+  std::vector<Ptr<Socket> > &idle = m_udpSockets[2 * flow.source + (ipv4 ? 0 : 1)];
+  if (idle.empty ())
+    {
+      flow.socket = Socket::CreateSocket (m_sources[flow.source], UdpSocketFactory::GetTypeId ());
+      NS_ABORT_MSG_IF ((ipv4 ? flow.socket->Bind () : flow.socket->Bind6 ()) == -1,
+                       "Failed to bind the socket of flow " << index);
+      flow.socket->ShutdownRecv ();
+    }
+  else
+    {
+      flow.socket = idle.back ();
+      idle.pop_back ();
+    }
+  flow.socket->Connect (peer);
+  SendDatagram (slot);
+}
+
+void
+TraceReplayApplication::EndFlow (uint32_t slot)
+{
+  NS_LOG_FUNCTION (this << slot);
+  Flow &flow = m_flows[slot];
+  if (flow.tcp)
+    {
+      // the socket lives until the connection is closed; it must not call
+      // back into a slot which may be reused
+      flow.socket->SetConnectCallback (MakeNullCallback<void, Ptr<Socket> > (),
+                                       MakeNullCallback<void, Ptr<Socket> > ());
+      flow.socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+    }
+  else if (!m_udpSockets.empty ())
+    {
+      m_udpSockets[2 * flow.source + (flow.ipv4 ? 0 : 1)].push_back (flow.socket);
+    }
+  flow.socket = 0;
+  m_freeSlots.push_back (slot);
+}
+
+void
+TraceReplayApplication::ConnectionSucceeded (uint32_t slot, Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << slot << socket);
+  // the socket calls the send callback once connected
+}
+
+void
+TraceReplayApplication::ConnectionFailed (uint32_t slot, Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << slot << socket);
+  NS_LOG_WARN ("Flow " << m_flows[slot].index << " failed to connect");
+  socket->Close ();
+  EndFlow (slot);
+}
+
+void
+TraceReplayApplication::SendData (uint32_t slot, Ptr<Socket> socket, uint32_t available)
+{
+  NS_LOG_FUNCTION (this << slot << socket << available);
+  Flow &flow = m_flows[slot];
+  NS_ASSERT (flow.socket == socket);
+
+  while (flow.sent < flow.size && available > 0)
+    {
+      Ptr<Packet> packet;
+      if (flow.sent == 0)
+        {
+          uint32_t headerSize = flow.header.GetSerializedSize ();
+          if (available < headerSize)
+            {
+              break;
+            }
+          packet = Create<Packet> (std::min<uint64_t> (flow.size, available) - headerSize);
+          packet->AddHeader (flow.header);
+        }
+      else
+        {
+          packet = Create<Packet> (std::min<uint64_t> (flow.size - flow.sent, available));
+        }
+      int actual = socket->Send (packet);
+      if (actual <= 0)
+        {
+          break;
+        }
+      flow.sent += actual;
+      available = socket->GetTxAvailable ();
+    }
+
+  if (flow.sent == flow.size)
+    {
+      NS_LOG_LOGIC ("Flow " << flow.index << " handed to the socket");
+      socket->Close ();
+      EndFlow (slot);
+    }
+}
+
+void
+TraceReplayApplication::SendDatagram (uint32_t slot)
+{
+  NS_LOG_FUNCTION (this << slot);
+  Flow &flow = m_flows[slot];
+
+  do
+    {
+      uint32_t size = std::min<uint64_t> (flow.size - flow.sent, m_packetSize);
+      if (flow.socket->Send (Create<Packet> (size)) < 0)
+        {
+          NS_LOG_LOGIC ("Flow " << flow.index << ": unable to send " << size << " bytes");
+        }
+      flow.sent += size;
+    }
+  while (flow.sent < flow.size && flow.gap.IsZero ());
+
+  if (flow.sent < flow.size)
+    {
+      flow.sendEvent = Simulator::Schedule (flow.gap, &TraceReplayApplication::SendDatagram, this, slot);
+    }
+  else
+    {
+      EndFlow (slot);
+    }
+}
+
+void
+TraceReplayApplication::HandleAccept (Ptr<Socket> socket, const Address &from)
+{
+  NS_LOG_FUNCTION (this << socket << from);
+  socket->SetRecvCallback (MakeCallback (&TraceReplayApplication::HandleRead, this));
+  RxFlow &rx = m_rxFlows[socket];
+  rx.buffer = Create<Packet> ();
+  rx.size = 0;
+  rx.received = 0;
+}
+
+void
+TraceReplayApplication::HandleRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  auto it = m_rxFlows.find (socket);
+  if (it == m_rxFlows.end ())
+    {
+      return;
+    }
+  RxFlow &rx = it->second;
+
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      if (packet->GetSize () == 0)
+        {
+          break;
+        }
+      m_totalRx += packet->GetSize ();
+      rx.received += packet->GetSize ();
+      if (rx.size == 0)
+        {
+          rx.buffer->AddAtEnd (packet);
+          SeqTsSizeHeader header;
+          if (rx.buffer->GetSize () >= header.GetSerializedSize ())
+            {
+              rx.buffer->PeekHeader (header);
+              rx.index = header.GetSeq ();
+              rx.size = header.GetSize ();
+              rx.start = header.GetTs ();
+              rx.buffer = 0;
+            }
+        }
+    }
+
+  if (rx.size > 0 && rx.received >= rx.size)
+    {
+      NS_LOG_LOGIC ("Flow " << rx.index << " of " << rx.size << " bytes completed");
+      m_completed++;
+      m_flowCompletedTrace (rx.index, rx.size, Simulator::Now () - rx.start);
+      m_rxFlows.erase (it);
+      socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      socket->Close ();
+    }
+}
+
+void
+TraceReplayApplication::HandleUdpRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_totalRx += packet->GetSize ();
+    }
+}
+
+void
+TraceReplayApplication::HandlePeerClose (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  auto it = m_rxFlows.find (socket);
+  if (it != m_rxFlows.end ())
+    {
+      // the source closed the connection before the end of the flow
+      NS_LOG_LOGIC ("Flow closed after " << it->second.received << " bytes");
+      m_rxFlows.erase (it);
+      socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      socket->Close ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,277 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRACE_REPLAY_APPLICATION_H
+#define TRACE_REPLAY_APPLICATION_H
+
+#include <map>
+#include <vector>
+#include "ns3/application.h"
+#include "ns3/address.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/traced-callback.h"
+#include "ns3/seq-ts-size-header.h"
+#include "flow-trace-file.h"
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup applications
+ * \defgroup tracereplay TraceReplayApplication
+ *
+ * This traffic generator replays the flows of a FlowTraceFile.
+ */
+/**
+ * \ingroup tracereplay
+ *
+ * \brief Replay the TCP and UDP flows of a trace between sets of nodes
+ *
+ * The application starts, at the time given by the trace (relative to the
+ * start of the application), each flow of the trace, from the source whose
+ * index is the index of the source of the flow modulo the number of
+ * sources (added with AddSource) to the destination whose index is the
+ * index of the destination of the flow modulo the number of destinations
+ * (added with AddDestination), so that a trace can be replayed on any
+ * number of nodes, e.g., on the leaf nodes of a dumbbell. The node which
+ * the application is installed on does not take part in the flows.
+ *
+ * A TCP flow opens a connection to the destination and sends the size of
+ * the flow, then closes the connection. The stream starts with a
+ * SeqTsSizeHeader carrying the index of the flow, its start time and its
+ * size (flows shorter than the header are extended to its size), so that
+ * the application, which listens on the Port of each destination, can tell
+ * when the flow is complete, and then closes the connection and fires the
+ * FlowCompleted trace with the flow completion time. A UDP flow sends the
+ * size of the flow in packets of PacketSize bytes spaced by the gap of the
+ * flow; the application counts the bytes received.
+ *
+ * The trace is mapped in memory and read as the flows start, with a single
+ * pending event for the next flow, and the state of a flow is released
+ * (its slot is reused) as soon as the source has handed all its bytes to
+ * the socket; the UDP sockets of the sources are reused by the following
+ * flows. The memory used by the application is thus bounded by the number
+ * of concurrent flows, which MaxActiveFlows can limit, rather than the
+ * number of flows of the trace. The TCP sockets, which ns-3 cannot
+ * reconnect, are released by the TCP stack once closed (after TIME_WAIT,
+ * see the MaxSegLifetime attribute of TcpSocketBase).
+ */
+class TraceReplayApplication : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TraceReplayApplication ();
+  virtual ~TraceReplayApplication ();
+
+  /**
+   * \brief Add a source of the flows
+   * \param node the node
+   */
+  void AddSource (Ptr<Node> node);
+
+  /**
+   * \brief Add a destination of the flows
+   * \param node the node
+   * \param address the IPv4 or IPv6 address of the node which the sources send to
+   */
+  void AddDestination (Ptr<Node> node, Address address);
+
+  /**
+   * \return the number of flows started
+   */
+  uint64_t GetStartedFlows (void) const;
+
+  /**
+   * \return the number of TCP flows completed (received by the destination)
+   */
+  uint64_t GetCompletedFlows (void) const;
+
+  /**
+   * \return the number of flows not started because of MaxActiveFlows
+   */
+  uint64_t GetSkippedFlows (void) const;
+
+  /**
+   * \return the number of flows whose source is sending
+   */
+  uint32_t GetActiveFlows (void) const;
+
+  /**
+   * \return the number of bytes received by the destinations
+   */
+  uint64_t GetTotalRx (void) const;
+
+  /**
+   * TracedCallback signature for the start of a flow
+   *
+   * \param [in] index the index of the flow in the trace (modulo 2^32)
+   * \param [in] size the size of the flow
+   */
+  typedef void (* FlowStartedCallback)(uint32_t index, uint64_t size);
+
+  /**
+   * TracedCallback signature for the completion of a TCP flow
+   *
+   * \param [in] index the index of the flow in the trace (modulo 2^32)
+   * \param [in] size the size of the flow
+   * \param [in] fct the flow completion time
+   */
+  typedef void (* FlowCompletedCallback)(uint32_t index, uint64_t size, Time fct);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  // inherited from Application base class.
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \brief The state of a flow whose source is sending
+   */
+  struct Flow
+  {
+    Ptr<Socket> socket;     //!< the socket
+    uint32_t source;        //!< the index of the source
+    uint32_t index;         //!< the index of the flow in the trace
+    SeqTsSizeHeader header; //!< the header of the stream (TCP), stamped at the start
+    uint64_t size;          //!< the size
+    uint64_t sent;          //!< the bytes handed to the socket
+    Time gap;               //!< the gap between the packets (UDP)
+    bool tcp;               //!< true for a TCP flow
+    bool ipv4;              //!< true for a flow to an IPv4 address
+    EventId sendEvent;      //!< the next packet (UDP)
+  };
+
+  /**
+   * \brief The state of a TCP flow received by a destination
+   */
+  struct RxFlow
+  {
+    Ptr<Packet> buffer;     //!< the bytes received before the header is complete
+    uint32_t index;         //!< the index of the flow
+    uint64_t size;          //!< the size of the flow (0 until the header is received)
+    uint64_t received;      //!< the bytes received
+    Time start;             //!< the start time of the flow
+  };
+
+  /**
+   * \brief Schedule the start of the next flows of the trace
+   */
+  void ScheduleNextFlow (void);
+  /**
+   * \brief Start the flows of the trace which are due
+   */
+  void StartFlows (void);
+  /**
+   * \brief Start a flow, in the context of its source
+   * \param index the index of the flow
+   * \param record the flow
+   */
+  void StartFlow (uint64_t index, FlowTraceFile::Record record);
+  /**
+   * \brief Release the state of a flow whose source is done
+   * \param slot the slot of the flow
+   */
+  void EndFlow (uint32_t slot);
+  /**
+   * \brief Handle the establishment of the connection of a TCP flow
+   * \param slot the slot of the flow
+   * \param socket the socket
+   */
+  void ConnectionSucceeded (uint32_t slot, Ptr<Socket> socket);
+  /**
+   * \brief Handle the failure of the connection of a TCP flow
+   * \param slot the slot of the flow
+   * \param socket the socket
+   */
+  void ConnectionFailed (uint32_t slot, Ptr<Socket> socket);
+  /**
+   * \brief Hand the bytes of a TCP flow to its socket
+   * \param slot the slot of the flow
+   * \param socket the socket
+   * \param available the room in the transmit buffer of the socket
+   */
+  void SendData (uint32_t slot, Ptr<Socket> socket, uint32_t available);
+  /**
+   * \brief Send the next packet of a UDP flow
+   * \param slot the slot of the flow
+   */
+  void SendDatagram (uint32_t slot);
+  /**
+   * \brief Handle a connection accepted by a destination
+   * \param socket the socket
+   * \param from the address of the source
+   */
+  void HandleAccept (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief Handle the data of a TCP flow received by a destination
+   * \param socket the socket
+   */
+  void HandleRead (Ptr<Socket> socket);
+  /**
+   * \brief Handle the packets of the UDP flows received by a destination
+   * \param socket the socket
+   */
+  void HandleUdpRead (Ptr<Socket> socket);
+  /**
+   * \brief Handle the close of a connection by a source
+   * \param socket the socket
+   */
+  void HandlePeerClose (Ptr<Socket> socket);
+
+  std::string m_traceFile;          //!< the name of the trace file
+  uint16_t m_port;                  //!< the port of the destinations
+  uint32_t m_packetSize;            //!< the size of the UDP packets
+  uint32_t m_maxActiveFlows;        //!< the maximum number of flows sending (0 for no limit)
+
+  FlowTraceFile m_trace;            //!< the trace
+  uint64_t m_next;                  //!< the index of the next flow of the trace
+  Time m_traceStart;                //!< the start time of the trace
+  EventId m_nextEvent;              //!< the start of the next flows
+
+  std::vector<Ptr<Node> > m_sources;                    //!< the sources
+  std::vector<std::vector<Ptr<Socket> > > m_udpSockets; //!< the idle IPv4 and IPv6 UDP sockets of each source
+  std::vector<Ptr<Node> > m_destinations;               //!< the destinations
+  std::vector<Address> m_destinationAddresses;          //!< the addresses of the destinations
+  std::vector<Ptr<Socket> > m_listeners;                //!< the sockets of the destinations
+
+  std::vector<Flow> m_flows;                            //!< the flows, by slot
+  std::vector<uint32_t> m_freeSlots;                    //!< the free slots of m_flows
+  std::map<Ptr<Socket>, RxFlow> m_rxFlows;              //!< the TCP flows being received
+
+  uint64_t m_started;               //!< the number of flows started
+  uint64_t m_completed;             //!< the number of TCP flows completed
+  uint64_t m_skipped;               //!< the number of flows skipped
+  uint64_t m_totalRx;               //!< the bytes received
+
+  /// Traced Callback: the start of a flow (index, size)
+  TracedCallback<uint32_t, uint64_t> m_flowStartedTrace;
+  /// Traced Callback: the completion of a TCP flow (index, size, completion time)
+  TracedCallback<uint32_t, uint64_t, Time> m_flowCompletedTrace;
+};
+
+} // namespace ns3
+
+#endif /* TRACE_REPLAY_APPLICATION_H */
@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <set>
+#include "ns3/test.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/application-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/onoff-application.h"
+#include "ns3/on-off-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/packet-sink-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Check that sending batches of packets over UDP does not change the
+ * number of packets sent in each On period, and that the packets of a batch
+ * are sent at the same time.
+ */
+class OnOffBatchTestCase : public TestCase
+{
+public:
+  OnOffBatchTestCase ();
+  virtual ~OnOffBatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Run an OnOffApplication over UDP
+   * \param batchSize the BatchSize attribute of the application
+   */
+  void RunUdp (uint32_t batchSize);
+  /**
+   * Record a packet sent
+   * \param p the packet
+   */
+  void SendTx (Ptr<const Packet> p);
+  uint64_t m_sent {0};              //!< number of bytes sent
+  std::set<int64_t> m_sendTimes;    //!< the times at which packets are sent
+};
+
+OnOffBatchTestCase::OnOffBatchTestCase ()
+  : TestCase ("Check that batches do not change the packets sent over UDP")
+{
+}
+
+OnOffBatchTestCase::~OnOffBatchTestCase ()
+{
+}
+
+void
+OnOffBatchTestCase::SendTx (Ptr<const Packet> p)
+{
+  m_sent += p->GetSize ();
+  m_sendTimes.insert (Simulator::Now ().GetTimeStep ());
+}
+
+void
+OnOffBatchTestCase::RunUdp (uint32_t batchSize)
+{
+  m_sent = 0;
+  m_sendTimes.clear ();
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  simpleHelper.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices = simpleHelper.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer i = ipv4.Assign (devices);
+
+  uint16_t port = 9;
+  OnOffHelper sourceHelper ("ns3::UdpSocketFactory", InetSocketAddress (i.GetAddress (1), port));
+  sourceHelper.SetConstantRate (DataRate ("10Mbps"), 500);
+  sourceHelper.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.3]"));
+  sourceHelper.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.2]"));
+  sourceHelper.SetAttribute ("BatchSize", UintegerValue (batchSize));
+  ApplicationContainer sourceApp = sourceHelper.Install (nodes.Get (0));
+  sourceApp.Start (Seconds (0.0));
+  sourceApp.Stop (Seconds (2.0));
+  sourceApp.Get (0)->TraceConnectWithoutContext ("Tx", MakeCallback (&OnOffBatchTestCase::SendTx, this));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+OnOffBatchTestCase::DoRun (void)
+{
+  RunUdp (1);
+  uint64_t sent = m_sent;
+  NS_TEST_ASSERT_MSG_GT (sent, 0, "No packet sent");
+  NS_TEST_ASSERT_MSG_EQ (m_sendTimes.size (), sent / 500, "The packets should be sent one at a time");
+
+  RunUdp (16);
+  NS_TEST_ASSERT_MSG_EQ (m_sent, sent, "Batches should not change the number of bytes sent");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_sendTimes.size (), sent / 500 / 16 + 4,
+                               "The packets of a batch should be sent at the same time");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Check that, over TCP, an application sending batches at a rate above the
+ * rate of the link waits for room in the socket rather than overrunning it,
+ * and resumes sending, so that the link is kept busy.
+ */
+class OnOffBatchTcpTestCase : public TestCase
+{
+public:
+  OnOffBatchTcpTestCase ();
+  virtual ~OnOffBatchTcpTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a packet sent
+   * \param p the packet
+   */
+  void SendTx (Ptr<const Packet> p);
+  uint64_t m_sent {0};      //!< number of bytes sent
+};
+
+OnOffBatchTcpTestCase::OnOffBatchTcpTestCase ()
+  : TestCase ("Check that batches wait for room in a TCP socket")
+{
+}
+
+OnOffBatchTcpTestCase::~OnOffBatchTcpTestCase ()
+{
+}
+
+void
+OnOffBatchTcpTestCase::SendTx (Ptr<const Packet> p)
+{
+  m_sent += p->GetSize ();
+}
+
+void
+OnOffBatchTcpTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetDeviceAttribute ("DataRate", StringValue ("1Mbps"));
+  simpleHelper.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  NetDeviceContainer devices = simpleHelper.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer i = ipv4.Assign (devices);
+
+  uint16_t port = 9;
+  OnOffHelper sourceHelper ("ns3::TcpSocketFactory", InetSocketAddress (i.GetAddress (1), port));
+  sourceHelper.SetConstantRate (DataRate ("10Mbps"), 500);
+  sourceHelper.SetAttribute ("BatchSize", UintegerValue (16));
+  ApplicationContainer sourceApp = sourceHelper.Install (nodes.Get (0));
+  sourceApp.Start (Seconds (0.0));
+  sourceApp.Stop (Seconds (10.0));
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory",
+                               InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApp = sinkHelper.Install (nodes.Get (1));
+  sinkApp.Start (Seconds (0.0));
+  sinkApp.Stop (Seconds (10.0));
+
+  sourceApp.Get (0)->TraceConnectWithoutContext ("Tx", MakeCallback (&OnOffBatchTcpTestCase::SendTx, this));
+  Ptr<PacketSink> sink = DynamicCast<PacketSink> (sinkApp.Get (0));
+
+  Simulator::Stop (Seconds (9.0));
+  Simulator::Run ();
+  uint64_t received = sink->GetTotalRx ();
+  Simulator::Destroy ();
+
+  // The application is On for 1 s out of 2, at ten times the rate of the
+  // link; the transmit buffer of the socket (128 KB) keeps the link busy
+  // during the Off periods
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_sent, received, "The sink received more than sent");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_sent, received + 131072,
+                               "The application sent more than the socket could hold");
+  NS_TEST_ASSERT_MSG_GT (received, 1000 * 1000 / 8 * 9 * 8 / 10,
+                         "The application should resume sending when the socket has room");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief OnOffApplication TestSuite
+ */
+class OnOffApplicationTestSuite : public TestSuite
+{
+public:
+  OnOffApplicationTestSuite ();
+};
+
+OnOffApplicationTestSuite::OnOffApplicationTestSuite ()
+  : TestSuite ("onoff-application", UNIT)
+{
+  AddTestCase (new OnOffBatchTestCase (), TestCase::QUICK);
+  AddTestCase (new OnOffBatchTcpTestCase (), TestCase::QUICK);
+}
+
+static OnOffApplicationTestSuite g_onOffApplicationTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,270 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <fstream>
+#include <set>
+#include "ns3/test.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/application-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/seq-ts-size-header.h"
+#include "ns3/flow-trace-file.h"
+#include "ns3/trace-replay-application.h"
+#include "ns3/trace-replay-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Check that a FlowTraceFile reads back the records written.
+ */
+class FlowTraceFileTestCase : public TestCase
+{
+public:
+  FlowTraceFileTestCase ();
+  virtual ~FlowTraceFileTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FlowTraceFileTestCase::FlowTraceFileTestCase ()
+  : TestCase ("Check that a flow trace file reads back the records written")
+{
+}
+
+FlowTraceFileTestCase::~FlowTraceFileTestCase ()
+{
+}
+
+void
+FlowTraceFileTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("flows.bin");
+  std::ofstream os (filename, std::ios::binary);
+  FlowTraceFile::WriteHeader (os);
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      FlowTraceFile::Record record;
+      record.start = NanoSeconds (1000000007ULL * i);
+      record.size = 0x100000000ULL + i;
+      record.gap = MicroSeconds (i);
+      record.source = i;
+      record.destination = 65535 - i;
+      record.protocol = (i % 2) ? 17 : 6;
+      FlowTraceFile::WriteRecord (os, record);
+    }
+  os.close ();
+
+  FlowTraceFile trace;
+  NS_TEST_ASSERT_MSG_EQ (trace.IsOpen (), false, "No file should be mapped");
+  trace.Open (filename);
+  NS_TEST_ASSERT_MSG_EQ (trace.IsOpen (), true, "The file should be mapped");
+  NS_TEST_ASSERT_MSG_EQ (trace.GetNRecords (), 100, "Wrong number of records");
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      FlowTraceFile::Record record = trace.GetRecord (i);
+      NS_TEST_ASSERT_MSG_EQ (record.start, NanoSeconds (1000000007ULL * i), "Wrong start time");
+      NS_TEST_ASSERT_MSG_EQ (record.size, 0x100000000ULL + i, "Wrong size");
+      NS_TEST_ASSERT_MSG_EQ (record.gap, MicroSeconds (i), "Wrong gap");
+      NS_TEST_ASSERT_MSG_EQ (record.source, i, "Wrong source");
+      NS_TEST_ASSERT_MSG_EQ (record.destination, 65535 - i, "Wrong destination");
+      uint32_t protocol = (i % 2) ? 17 : 6;
+      NS_TEST_ASSERT_MSG_EQ (+record.protocol, protocol, "Wrong protocol");
+    }
+  trace.Close ();
+  NS_TEST_ASSERT_MSG_EQ (trace.IsOpen (), false, "The file should be unmapped");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Check that a TraceReplayApplication replays the TCP and UDP flows of a
+ * trace between two sources and two destinations, that every TCP flow is
+ * received whole, and that MaxActiveFlows skips the flows beyond it.
+ */
+class TraceReplayTestCase : public TestCase
+{
+public:
+  TraceReplayTestCase ();
+  virtual ~TraceReplayTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Replay the trace
+   * \param maxActiveFlows the MaxActiveFlows attribute of the application
+   * \return the application, once the simulation has run
+   */
+  Ptr<TraceReplayApplication> Replay (uint32_t maxActiveFlows);
+  /**
+   * Record a completed flow
+   * \param index the index of the flow
+   * \param size the size of the flow
+   * \param fct the flow completion time
+   */
+  void FlowCompleted (uint32_t index, uint64_t size, Time fct);
+
+  std::string m_filename;           //!< the trace file
+  uint64_t m_tcpBytes {0};          //!< the bytes of the TCP flows of the trace
+  uint64_t m_udpBytes {0};          //!< the bytes of the UDP flows of the trace
+  uint32_t m_tcpFlows {0};          //!< the TCP flows of the trace
+  uint64_t m_completedBytes {0};    //!< the bytes of the completed flows
+  std::set<uint32_t> m_completed;   //!< the indexes of the completed flows
+  bool m_fctPositive {true};        //!< whether all the completion times are positive
+};
+
+TraceReplayTestCase::TraceReplayTestCase ()
+  : TestCase ("Check that the flows of a trace are replayed")
+{
+}
+
+TraceReplayTestCase::~TraceReplayTestCase ()
+{
+}
+
+void
+TraceReplayTestCase::FlowCompleted (uint32_t index, uint64_t size, Time fct)
+{
+  m_completed.insert (index);
+  m_completedBytes += size;
+  m_fctPositive = m_fctPositive && fct.IsStrictlyPositive ();
+}
+
+Ptr<TraceReplayApplication>
+TraceReplayTestCase::Replay (uint32_t maxActiveFlows)
+{
+  m_completedBytes = 0;
+  m_completed.clear ();
+
+  // two sources and two destinations on a shared channel
+  NodeContainer nodes;
+  nodes.Create (5);
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  simpleHelper.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices = simpleHelper.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer i = ipv4.Assign (devices);
+
+  TraceReplayHelper helper (m_filename);
+  helper.SetAttribute ("MaxActiveFlows", UintegerValue (maxActiveFlows));
+  helper.SetAttribute ("PacketSize", UintegerValue (500));
+  NodeContainer sources (nodes.Get (1), nodes.Get (2));
+  NodeContainer destinations (nodes.Get (3), nodes.Get (4));
+  std::vector<Address> addresses {i.GetAddress (3), i.GetAddress (4)};
+  ApplicationContainer apps = helper.Install (nodes.Get (0), sources, destinations, addresses);
+  apps.Start (Seconds (1.0));
+  apps.Stop (Seconds (20.0));
+  Ptr<TraceReplayApplication> app = DynamicCast<TraceReplayApplication> (apps.Get (0));
+  app->TraceConnectWithoutContext ("FlowCompleted", MakeCallback (&TraceReplayTestCase::FlowCompleted, this));
+
+  Simulator::Stop (Seconds (19.0));
+  Simulator::Run ();
+  return app;
+}
+
+void
+TraceReplayTestCase::DoRun (void)
+{
+  // 40 TCP flows, 10 UDP flows, one every 10 ms, with some flows shorter
+  // than the header of the stream
+  m_filename = CreateTempDirFilename ("replay.bin");
+  std::ofstream os (m_filename, std::ios::binary);
+  FlowTraceFile::WriteHeader (os);
+  uint32_t headerSize = SeqTsSizeHeader ().GetSerializedSize ();
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      FlowTraceFile::Record record;
+      record.start = MilliSeconds (10 * i);
+      record.source = i;
+      record.destination = i / 2;
+      if (i % 5 == 4)
+        {
+          record.protocol = 17;
+          record.size = 5000 + 100 * i;
+          record.gap = (i % 10 == 4) ? Seconds (0) : MilliSeconds (1);
+          m_udpBytes += record.size;
+        }
+      else
+        {
+          record.protocol = 6;
+          record.size = (i % 7 == 0) ? 10 : 20000 * (i % 3 + 1);
+          record.gap = Seconds (0);
+          m_tcpBytes += std::max<uint64_t> (record.size, headerSize);
+          m_tcpFlows++;
+        }
+      FlowTraceFile::WriteRecord (os, record);
+    }
+  os.close ();
+
+  Ptr<TraceReplayApplication> app = Replay (0);
+  NS_TEST_ASSERT_MSG_EQ (app->GetStartedFlows (), 50, "All the flows should start");
+  NS_TEST_ASSERT_MSG_EQ (app->GetSkippedFlows (), 0, "No flow should be skipped");
+  NS_TEST_ASSERT_MSG_EQ (app->GetActiveFlows (), 0, "All the sources should be done");
+  NS_TEST_ASSERT_MSG_EQ (app->GetCompletedFlows (), m_tcpFlows, "All the TCP flows should complete");
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), m_tcpFlows, "A TCP flow completed twice");
+  NS_TEST_ASSERT_MSG_EQ (m_completedBytes, m_tcpBytes, "Wrong sizes of the completed flows");
+  NS_TEST_ASSERT_MSG_EQ (m_fctPositive, true, "The completion times should be positive");
+  NS_TEST_ASSERT_MSG_EQ (app->GetTotalRx (), m_tcpBytes + m_udpBytes,
+                         "The destinations should receive all the bytes of the trace");
+  Simulator::Destroy ();
+
+  // at most one flow sending: the flows arriving while a TCP flow is
+  // sending are skipped
+  app = Replay (1);
+  uint64_t started = app->GetStartedFlows ();
+  NS_TEST_ASSERT_MSG_GT (app->GetSkippedFlows (), 0, "Some flows should be skipped");
+  NS_TEST_ASSERT_MSG_EQ (started + app->GetSkippedFlows (), 50, "Every flow should start or be skipped");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (app->GetCompletedFlows (), started, "More flows completed than started");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief TraceReplayApplication TestSuite
+ */
+class TraceReplayApplicationTestSuite : public TestSuite
+{
+public:
+  TraceReplayApplicationTestSuite ();
+};
+
+TraceReplayApplicationTestSuite::TraceReplayApplicationTestSuite ()
+  : TestSuite ("trace-replay-application", UNIT)
+{
+  AddTestCase (new FlowTraceFileTestCase (), TestCase::QUICK);
+  AddTestCase (new TraceReplayTestCase (), TestCase::QUICK);
+}
+
+static TraceReplayApplicationTestSuite g_traceReplayApplicationTestSuite; //!< Static variable for test initialization
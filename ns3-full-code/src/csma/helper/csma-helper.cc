@@ -323,6 +323,7 @@ CsmaHelper::InstallPriv (Ptr<Node> node, Ptr<CsmaChannel> channel) const
       Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
       ndqi->GetTxQueue (0)->ConnectQueueTraces (queue);
       device->AggregateObject (ndqi);
+      device->SetNetDeviceQueue (ndqi->GetTxQueue (0));
     }
   return device;
 }
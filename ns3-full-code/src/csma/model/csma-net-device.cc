@@ -30,6 +30,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/net-device-queue-interface.h"
 #include "csma-net-device.h"
 #include "csma-channel.h"
 
@@ -218,6 +219,7 @@ CsmaNetDevice::DoDispose ()
   m_channel = 0;
   m_node = 0;
   m_queue = 0;
+  m_txQueue = 0;
   NetDevice::DoDispose ();
 }
 
@@ -456,6 +458,7 @@ CsmaNetDevice::TransmitStart (void)
   if (IsSendEnabled () == false)
     {
       m_phyTxDropTrace (m_currentPkt);
+      NotifyTxComplete ();
       m_currentPkt = 0;
       return;
     }
@@ -510,6 +513,7 @@ CsmaNetDevice::TransmitStart (void)
         {
           NS_LOG_WARN ("Channel TransmitStart returns an error");
           m_phyTxDropTrace (m_currentPkt);
+          NotifyTxComplete ();
           m_currentPkt = 0;
           m_txMachineState = READY;
         } 
@@ -543,6 +547,7 @@ CsmaNetDevice::TransmitAbort (void)
   NS_LOG_LOGIC ("Pkt UID is " << m_currentPkt->GetUid () << ")");
 
   m_phyTxDropTrace (m_currentPkt);
+  NotifyTxComplete ();
   m_currentPkt = 0;
 
   NS_ASSERT_MSG (m_txMachineState == BACKOFF, "Must be in BACKOFF state to abort.  Tx state is: " << m_txMachineState);
@@ -574,6 +579,16 @@ CsmaNetDevice::TransmitAbort (void)
     }
 }
 
+void
+CsmaNetDevice::NotifyTxComplete (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_txQueue)
+    {
+      m_txQueue->NotifyTransmittedBytes (m_currentPkt->GetSize ());
+    }
+}
+
 void
 CsmaNetDevice::TransmitCompleteEvent (void)
 {
@@ -599,6 +614,7 @@ CsmaNetDevice::TransmitCompleteEvent (void)
 
   m_channel->TransmitEnd (); 
   m_phyTxEndTrace (m_currentPkt);
+  NotifyTxComplete ();
   m_currentPkt = 0;
 
   NS_LOG_LOGIC ("Schedule TransmitReadyEvent in " << m_tInterframeGap.As (Time::S));
@@ -676,6 +692,14 @@ CsmaNetDevice::SetQueue (Ptr<Queue<Packet> > q)
   m_queue = q;
 }
 
+void
+CsmaNetDevice::SetNetDeviceQueue (Ptr<NetDeviceQueue> queue)
+{
+  NS_LOG_FUNCTION (this << queue);
+  m_txQueue = queue;
+  m_txQueue->SetDeviceNotifiesTxCompletion (true);
+}
+
 void
 CsmaNetDevice::SetReceiveErrorModel (Ptr<ErrorModel> em)
 {
@@ -39,6 +39,7 @@ namespace ns3 {
 template <typename Item> class Queue;
 class CsmaChannel;
 class ErrorModel;
+class NetDeviceQueue;
 
 /** 
  * \defgroup csma CSMA Network Device
@@ -143,6 +144,20 @@ public:
    */
   Ptr<Queue<Packet> > GetQueue (void) const;
 
+  /**
+   * Set the transmission queue (of the NetDeviceQueueInterface aggregated to
+   * this device) to which the CsmaNetDevice reports the bytes it has
+   * transmitted or dropped.
+   *
+   * The bytes of a packet are reported when its transmission is complete (or
+   * aborted), instead of when the packet is dequeued from the device queue,
+   * so that Byte Queue Limits account for the packet backing off or on the
+   * wire.
+   *
+   * \param queue the device transmission queue
+   */
+  void SetNetDeviceQueue (Ptr<NetDeviceQueue> queue);
+
   /**
    * Attach a receive ErrorModel to the CsmaNetDevice.
    *
@@ -442,6 +457,12 @@ private:
    */
   void TransmitAbort (void);
 
+  /**
+   * Report the bytes of the current packet, which has been transmitted or
+   * dropped, to the device transmission queue (if any)
+   */
+  void NotifyTxComplete (void);
+
   /**
    * Notify any interested parties that the link has come up.
    */
@@ -532,6 +553,11 @@ private:
    */
   Ptr<Queue<Packet> > m_queue;
 
+  /**
+   * The device transmission queue to which the transmitted bytes are reported
+   */
+  Ptr<NetDeviceQueue> m_txQueue;
+
   /**
    * Error model for receive packet events.  When active this model will be
    * used to model transmission errors by marking some of the packets 
@@ -0,0 +1,289 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/simulator.h"
+#include "ns3/csma-net-device.h"
+#include "ns3/csma-channel.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-limits.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \brief Queue limits which record the bytes queued and completed
+ */
+class CsmaRecordingQueueLimits : public QueueLimits
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual void Reset ()
+  {
+  }
+  virtual void Completed (uint32_t count)
+  {
+    m_completed.push_back (std::make_pair (Simulator::Now (), count));
+  }
+  virtual int32_t Available () const
+  {
+    return 0;
+  }
+  virtual void Queued (uint32_t count)
+  {
+    m_queued.push_back (std::make_pair (Simulator::Now (), count));
+  }
+
+  std::vector<std::pair<Time, uint32_t> > m_queued;    //!< the time and size of the bytes queued
+  std::vector<std::pair<Time, uint32_t> > m_completed; //!< the time and size of the bytes completed
+};
+
+TypeId
+CsmaRecordingQueueLimits::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmaRecordingQueueLimits")
+    .SetParent<QueueLimits> ()
+    .SetGroupName ("Csma")
+  ;
+  return tid;
+}
+
+/**
+ * \brief Test the Byte Queue Limits support of CsmaNetDevice
+ *
+ * A device whose transmission queue has queue limits sends packets on a
+ * CsmaChannel shared with a second device.  The bytes of each packet must be
+ * reported as transmitted exactly once, when its transmission completes, when
+ * it is aborted after too many backoffs, when the send side of the device has
+ * been disabled during a backoff and when the channel refuses the packet.
+ */
+class CsmaBqlTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  CsmaBqlTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Create the devices, the channel and the queue limits of the first device
+   */
+  void CreateDevices (void);
+  /**
+   * \brief Send a packet
+   * \param dev the sending device
+   * \param size the size of the packet
+   */
+  void Send (Ptr<CsmaNetDevice> dev, uint32_t size);
+  /**
+   * \brief Check that every packet queued by the first device has been completed
+   * \param n the expected number of packets
+   * \param msg the message printed on failure
+   */
+  void CheckCompleted (uint32_t n, std::string msg);
+
+  /// Send packets on an idle channel
+  void RunTransmitComplete (void);
+  /// Send a packet on a busy channel without any backoff allowed
+  void RunTransmitAbort (void);
+  /// Disable the send side of the device while a packet backs off
+  void RunSendDisabled (void);
+  /// Send a packet from a device detached from the channel
+  void RunChannelError (void);
+
+  Ptr<CsmaNetDevice> m_devA;                //!< the device with queue limits
+  Ptr<CsmaNetDevice> m_devB;                //!< the other device
+  Ptr<CsmaChannel> m_channel;               //!< the channel
+  Ptr<CsmaRecordingQueueLimits> m_limits;   //!< the queue limits of the first device
+  DataRate m_rate;                          //!< the rate of the channel
+};
+
+CsmaBqlTest::CsmaBqlTest ()
+  : TestCase ("Csma Byte Queue Limits"),
+    m_rate ("1Mbps")
+{
+}
+
+void
+CsmaBqlTest::CreateDevices (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  m_devA = CreateObject<CsmaNetDevice> ();
+  m_devB = CreateObject<CsmaNetDevice> ();
+  m_channel = CreateObjectWithAttributes<CsmaChannel> ("DataRate", DataRateValue (m_rate));
+
+  m_devA->Attach (m_channel);
+  m_devA->SetAddress (Mac48Address::Allocate ());
+  Ptr<Queue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  m_devA->SetQueue (queue);
+  m_devB->Attach (m_channel);
+  m_devB->SetAddress (Mac48Address::Allocate ());
+  m_devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  a->AddDevice (m_devA);
+  b->AddDevice (m_devB);
+
+  Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
+  ndqi->GetTxQueue (0)->ConnectQueueTraces (queue);
+  m_devA->AggregateObject (ndqi);
+  m_devA->SetNetDeviceQueue (ndqi->GetTxQueue (0));
+  m_limits = CreateObject<CsmaRecordingQueueLimits> ();
+  ndqi->GetTxQueue (0)->SetQueueLimits (m_limits);
+}
+
+void
+CsmaBqlTest::Send (Ptr<CsmaNetDevice> dev, uint32_t size)
+{
+  dev->Send (Create<Packet> (size), dev->GetBroadcast (), 0x800);
+}
+
+void
+CsmaBqlTest::CheckCompleted (uint32_t n, std::string msg)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_limits->m_queued.size (), n, "Every packet should be queued " << msg);
+  NS_TEST_ASSERT_MSG_EQ (m_limits->m_completed.size (), n, "Every packet should be completed " << msg);
+  for (uint32_t i = 0; i < m_limits->m_completed.size () && i < m_limits->m_queued.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_limits->m_completed[i].second, m_limits->m_queued[i].second,
+                             "Wrong number of bytes completed " << msg);
+    }
+}
+
+void
+CsmaBqlTest::RunTransmitComplete (void)
+{
+  CreateDevices ();
+  uint32_t n = 3;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Simulator::Schedule (Seconds (1), &CsmaBqlTest::Send, this, m_devA, 998);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  CheckCompleted (n, "on an idle channel");
+  if (IsStatusFailure ())
+    {
+      return;
+    }
+  // the size of the packets includes the Ethernet header and trailer
+  Time txTime = m_rate.CalculateBytesTxTime (m_limits->m_queued[0].second);
+  NS_TEST_EXPECT_MSG_EQ (m_limits->m_completed[0].first, Seconds (1) + txTime,
+                         "The bytes should be completed at the end of the transmission");
+  for (uint32_t i = 1; i < n; i++)
+    {
+      NS_TEST_EXPECT_MSG_GT (m_limits->m_completed[i].first, m_limits->m_completed[i - 1].first + txTime,
+                             "The packets are transmitted one at a time");
+    }
+}
+
+void
+CsmaBqlTest::RunTransmitAbort (void)
+{
+  CreateDevices ();
+  m_devA->SetBackoffParams (MicroSeconds (1), 1, 10, 10, 0);
+  Simulator::Schedule (Seconds (1), &CsmaBqlTest::Send, this, m_devB, 998);
+  Simulator::Schedule (Seconds (1) + MicroSeconds (1), &CsmaBqlTest::Send, this, m_devA, 998);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  CheckCompleted (1, "after an aborted transmission");
+  if (IsStatusFailure ())
+    {
+      return;
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_limits->m_completed[0].first, Seconds (1) + MicroSeconds (1),
+                         "The bytes should be completed when the transmission is aborted");
+}
+
+void
+CsmaBqlTest::RunSendDisabled (void)
+{
+  CreateDevices ();
+  Simulator::Schedule (Seconds (1), &CsmaBqlTest::Send, this, m_devB, 998);
+  Simulator::Schedule (Seconds (1) + MicroSeconds (1), &CsmaBqlTest::Send, this, m_devA, 998);
+  Simulator::Schedule (Seconds (1) + MicroSeconds (1), &CsmaNetDevice::SetSendEnable, m_devA, false);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  CheckCompleted (1, "after a drop of the send-disabled device");
+  if (IsStatusFailure ())
+    {
+      return;
+    }
+  NS_TEST_EXPECT_MSG_GT (m_limits->m_completed[0].first, Seconds (1) + MicroSeconds (1),
+                         "The bytes should be completed at the end of the backoff");
+}
+
+void
+CsmaBqlTest::RunChannelError (void)
+{
+  CreateDevices ();
+  m_channel->Detach (m_devA);
+  Simulator::Schedule (Seconds (1), &CsmaBqlTest::Send, this, m_devA, 998);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  CheckCompleted (1, "after the channel refused the packet");
+  if (IsStatusFailure ())
+    {
+      return;
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_limits->m_completed[0].first, Seconds (1),
+                         "The bytes should be completed when the channel refuses the packet");
+}
+
+void
+CsmaBqlTest::DoRun (void)
+{
+  RunTransmitComplete ();
+  RunTransmitAbort ();
+  RunSendDisabled ();
+  RunChannelError ();
+}
+
+/**
+ * \brief TestSuite for Csma module
+ */
+class CsmaTestSuite : public TestSuite
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  CsmaTestSuite ();
+};
+
+CsmaTestSuite::CsmaTestSuite ()
+  : TestSuite ("devices-csma", UNIT)
+{
+  AddTestCase (new CsmaBqlTest, TestCase::QUICK);
+}
+
+static CsmaTestSuite g_csmaTestSuite; //!< The testsuite
@@ -82,6 +82,8 @@ public:
    * its representation of the global topology before recomputing routes.
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
+   * The routing tables of the nodes whose routes did not change are left
+   * untouched.
    *
    */
   static void RecomputeRoutingTables (void);
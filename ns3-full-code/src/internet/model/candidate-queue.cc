@@ -51,7 +51,9 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 {
   typedef CandidateQueue::CandidateList_t List_t;
   typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  // print the vertices in priority order
+  List_t list = q.m_candidates;
+  std::sort (list.begin (), list.end (), &CandidateQueue::IsBefore);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
@@ -66,7 +68,8 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_pushes (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +97,10 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  vNew->m_candidateOrder = m_pushes++;
+  m_candidates.push_back (vNew);
+  vNew->m_candidatePosition = m_candidates.size () - 1;
+  SiftUp (m_candidates.size () - 1);
 }
 
 SPFVertex *
@@ -111,7 +113,13 @@ CandidateQueue::Pop (void)
     }
 
   SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *last = m_candidates.back ();
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      Place (0, last);
+      SiftDown (0);
+    }
   return v;
 }
 
@@ -164,11 +172,89 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  for (uint32_t i = m_candidates.size () / 2; i-- > 0; )
+    {
+      SiftDown (i);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Update (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+  NS_ASSERT (v->m_candidatePosition < m_candidates.size ()
+             && m_candidates[v->m_candidatePosition] == v);
+
+  v->m_candidateOrder = m_pushes++;
+  SiftUp (v->m_candidatePosition);
+}
+
+void
+CandidateQueue::Place (uint32_t pos, SPFVertex *v)
+{
+  m_candidates[pos] = v;
+  v->m_candidatePosition = pos;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t pos)
+{
+  SPFVertex *v = m_candidates[pos];
+  while (pos > 0)
+    {
+      uint32_t parent = (pos - 1) / 2;
+      if (!IsBefore (v, m_candidates[parent]))
+        {
+          break;
+        }
+      Place (pos, m_candidates[parent]);
+      pos = parent;
+    }
+  Place (pos, v);
+}
+
+void
+CandidateQueue::SiftDown (uint32_t pos)
+{
+  SPFVertex *v = m_candidates[pos];
+  uint32_t size = m_candidates.size ();
+  for (;;)
+    {
+      uint32_t child = 2 * pos + 1;
+      if (child >= size)
+        {
+          break;
+        }
+      if (child + 1 < size && IsBefore (m_candidates[child + 1], m_candidates[child]))
+        {
+          child++;
+        }
+      if (!IsBefore (m_candidates[child], v))
+        {
+          break;
+        }
+      Place (pos, m_candidates[child]);
+      pos = child;
+    }
+  Place (pos, v);
+}
+
+bool
+CandidateQueue::IsBefore (const SPFVertex* v1, const SPFVertex* v2)
+{
+  if (CompareSPFVertex (v1, v2))
+    {
+      return true;
+    }
+  if (CompareSPFVertex (v2, v1))
+    {
+      return false;
+    }
+  return v1->m_candidateOrder < v2->m_candidateOrder;
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
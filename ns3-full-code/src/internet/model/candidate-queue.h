@@ -22,7 +22,7 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -47,6 +47,12 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap.  Each vertex records its position in the heap,
+ * so that Update () can move a vertex whose distance decreased in
+ * logarithmic time, and the order in which it was pushed, so that the
+ * vertices at the same distance (and of the same type) are popped in FIFO
+ * order, as they were when the queue was a sorted list.
  */
 class CandidateQueue
 {
@@ -154,6 +160,19 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Restore the priority order after the distance of a vertex of the
+ * queue decreased.
+ *
+ * The vertex is ordered after the vertices at the same distance (and of the
+ * same type), as if it were pushed again.  This is cheaper than Reorder ()
+ * when only one vertex changed.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance decreased.
+ */
+  void Update (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -184,8 +203,38 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+/**
+ * \brief return true if v1 is popped before v2, breaking the ties of
+ * CompareSPFVertex by the order in which the vertices were pushed
+ *
+ * \param v1 first operand
+ * \param v2 second operand
+ * \return True if v1 should be popped before v2; false otherwise
+ */
+  static bool IsBefore (const SPFVertex* v1, const SPFVertex* v2);
+
+/**
+ * \brief Move the vertex at the given position towards the top of the heap
+ * \param pos the position of the vertex
+ */
+  void SiftUp (uint32_t pos);
+
+/**
+ * \brief Move the vertex at the given position towards the bottom of the heap
+ * \param pos the position of the vertex
+ */
+  void SiftDown (uint32_t pos);
+
+/**
+ * \brief Store a vertex at a position of the heap
+ * \param pos the position
+ * \param v the vertex
+ */
+  void Place (uint32_t pos, SPFVertex *v);
+
+  typedef std::vector<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
+  CandidateList_t m_candidates;  //!< SPFVertex candidates, as a binary heap
+  uint64_t m_pushes;             //!< number of vertices pushed (or updated) so far
 
   /**
    * \brief Stream insertion operator.
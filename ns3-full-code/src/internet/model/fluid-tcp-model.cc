@@ -0,0 +1,358 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/queue-disc.h"
+#include "ns3/traffic-control-layer.h"
+#include "fluid-tcp-model.h"
+#include "ipv4-header.h"
+#include "ipv4-l3-protocol.h"
+#include "ipv4-queue-disc-item.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FluidTcpModel");
+
+NS_OBJECT_ENSURE_REGISTERED (FluidTcpModel);
+
+const uint8_t FluidTcpModel::PROT_NUMBER = 253;
+
+TypeId
+FluidTcpModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FluidTcpModel")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<FluidTcpModel> ()
+    .AddAttribute ("Flows",
+                   "The number of flows",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&FluidTcpModel::m_nFlows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("PropagationDelay",
+                   "The round trip propagation delay of the flows",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&FluidTcpModel::m_propagationDelay),
+                   MakeTimeChecker (MicroSeconds (1)))
+    .AddAttribute ("PacketSize",
+                   "The size of the packets, IPv4 header included",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&FluidTcpModel::m_packetSize),
+                   MakeUintegerChecker<uint32_t> (21))
+    .AddAttribute ("TimeStep",
+                   "The integration step of the window equation",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&FluidTcpModel::m_timeStep),
+                   MakeTimeChecker (MicroSeconds (1)))
+    .AddAttribute ("MaxWindow",
+                   "The maximum congestion window, in packets",
+                   DoubleValue (1000),
+                   MakeDoubleAccessor (&FluidTcpModel::m_maxWindow),
+                   MakeDoubleChecker<double> (1))
+    .AddAttribute ("UseEcn",
+                   "True to send ECN capable packets",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FluidTcpModel::m_ecn),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SourceAddress",
+                   "The source address of the first flow; the following flows "
+                   "use the following addresses",
+                   Ipv4AddressValue (Ipv4Address ("100.0.0.0")),
+                   MakeIpv4AddressAccessor (&FluidTcpModel::m_sourceAddress),
+                   MakeIpv4AddressChecker ())
+    .AddAttribute ("StartTime",
+                   "The time at which the flows start",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&FluidTcpModel::m_startTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("StopTime",
+                   "The time at which the flows stop (zero for never)",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&FluidTcpModel::m_stopTime),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Window",
+                     "The congestion window of the flows, in packets",
+                     MakeTraceSourceAccessor (&FluidTcpModel::m_window),
+                     "ns3::TracedValueCallback::Double")
+    .AddTraceSource ("Rtt",
+                     "The round trip time of the flows",
+                     MakeTraceSourceAccessor (&FluidTcpModel::m_rtt),
+                     "ns3::TracedValueCallback::Time")
+    .AddTraceSource ("DropProbability",
+                     "The fraction of the packets dropped or marked during the last step",
+                     MakeTraceSourceAccessor (&FluidTcpModel::m_prob),
+                     "ns3::TracedValueCallback::Double")
+  ;
+  return tid;
+}
+
+FluidTcpModel::FluidTcpModel ()
+  : m_window (1),
+    m_prob (0),
+    m_stepSent (0),
+    m_stepCongested (0),
+    m_txPackets (0),
+    m_dropped (0),
+    m_marked (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_flowRv = CreateObject<UniformRandomVariable> ();
+}
+
+FluidTcpModel::~FluidTcpModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FluidTcpModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Stop ();
+  m_stepEvent.Cancel ();
+  if (m_qDisc)
+    {
+      m_qDisc->TraceDisconnectWithoutContext ("Drop", MakeCallback (&FluidTcpModel::DropTrace, this));
+      m_qDisc->TraceDisconnectWithoutContext ("Mark", MakeCallback (&FluidTcpModel::MarkTrace, this));
+    }
+  m_device = 0;
+  m_tc = 0;
+  m_qDisc = 0;
+  m_flowRv = 0;
+  m_history.clear ();
+  Object::DoDispose ();
+}
+
+void
+FluidTcpModel::Install (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  NS_ABORT_MSG_IF (m_device, "The model is already installed");
+
+  DataRateValue rate;
+  NS_ABORT_MSG_UNLESS (device->GetAttributeFailSafe ("DataRate", rate),
+                       "The device has no DataRate attribute");
+  m_linkRate = rate.Get ();
+
+  m_tc = device->GetNode ()->GetObject<TrafficControlLayer> ();
+  NS_ABORT_MSG_UNLESS (m_tc, "The node has no traffic control layer");
+  m_qDisc = m_tc->GetRootQueueDiscOnDevice (device);
+  NS_ABORT_MSG_UNLESS (m_qDisc, "No queue disc is installed on the device");
+  m_device = device;
+
+  m_qDisc->TraceConnectWithoutContext ("Drop", MakeCallback (&FluidTcpModel::DropTrace, this));
+  m_qDisc->TraceConnectWithoutContext ("Mark", MakeCallback (&FluidTcpModel::MarkTrace, this));
+
+  Simulator::ScheduleWithContext (device->GetNode ()->GetId (), m_startTime,
+                                  &FluidTcpModel::Start, this);
+}
+
+int64_t
+FluidTcpModel::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_flowRv->SetStream (stream);
+  return 1;
+}
+
+double
+FluidTcpModel::GetWindow (void) const
+{
+  return m_window;
+}
+
+Time
+FluidTcpModel::GetRtt (void) const
+{
+  return m_rtt;
+}
+
+double
+FluidTcpModel::GetDropProbability (void) const
+{
+  return m_prob;
+}
+
+uint64_t
+FluidTcpModel::GetTxPackets (void) const
+{
+  return m_txPackets;
+}
+
+uint64_t
+FluidTcpModel::GetDroppedPackets (void) const
+{
+  return m_dropped;
+}
+
+uint64_t
+FluidTcpModel::GetMarkedPackets (void) const
+{
+  return m_marked;
+}
+
+void
+FluidTcpModel::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_rtt = m_propagationDelay;
+  m_history.clear ();
+  m_history.push_back ({Simulator::Now (), m_window, 0});
+  if (!m_stopTime.IsZero ())
+    {
+      Simulator::Schedule (m_stopTime - m_startTime, &FluidTcpModel::Stop, this);
+    }
+  m_stepEvent = Simulator::Schedule (m_timeStep, &FluidTcpModel::Step, this);
+  Send ();
+}
+
+void
+FluidTcpModel::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stepEvent.Cancel ();
+  m_sendEvent.Cancel ();
+}
+
+const FluidTcpModel::State &
+FluidTcpModel::GetPastState (Time time) const
+{
+  NS_ASSERT (!m_history.empty ());
+  auto it = std::lower_bound (m_history.begin (), m_history.end (), time,
+                              [] (const State &state, const Time &t) { return state.time < t; });
+  if (it == m_history.end ())
+    {
+      return m_history.back ();
+    }
+  return *it;
+}
+
+void
+FluidTcpModel::Step (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+
+  if (m_stepSent > 0)
+    {
+      m_prob = std::min (1.0, static_cast<double> (m_stepCongested) / m_stepSent);
+    }
+  double signalRate = m_stepCongested / (m_nFlows * m_timeStep.GetSeconds ());
+  m_stepSent = 0;
+  m_stepCongested = 0;
+
+  double rtt = m_propagationDelay.GetSeconds ()
+    + m_qDisc->GetNBytes () * 8.0 / m_linkRate.GetBitRate ();
+  m_rtt = Seconds (rtt);
+
+  // The losses of the packets sent one round trip time ago halve the window.
+  // W(t - R) p(t - R) / R(t - R) is the rate of the losses per flow, which is
+  // counted rather than computed from the fraction of packets lost, as a step
+  // lasts a few packets.
+  const State &past = GetPastState (now - Seconds (rtt));
+  double window = m_window;
+  window += m_timeStep.GetSeconds () * (1 / rtt - window / 2 * past.signalRate);
+  m_window = std::max (0.0, std::min (window, m_maxWindow));
+
+  m_history.push_back ({now, m_window, signalRate});
+  // Keep the states of the last two round trip times
+  while (m_history.size () > 1 && m_history[1].time < now - Seconds (2 * rtt))
+    {
+      m_history.pop_front ();
+    }
+
+  if (!m_sendEvent.IsRunning ())
+    {
+      Send ();
+    }
+  m_stepEvent = Simulator::Schedule (m_timeStep, &FluidTcpModel::Step, this);
+}
+
+void
+FluidTcpModel::Send (void)
+{
+  double rate = m_nFlows * m_window / m_rtt.Get ().GetSeconds ();
+  if (rate <= 0)
+    {
+      // The next step will resume sending
+      return;
+    }
+
+  uint32_t flow = m_flowRv->GetInteger (0, m_nFlows - 1);
+  Ipv4Header header;
+  Ptr<Packet> packet = Create<Packet> (m_packetSize - header.GetSerializedSize ());
+  header.SetSource (Ipv4Address (m_sourceAddress.Get () + flow));
+  header.SetDestination (Ipv4Address::GetBroadcast ());
+  header.SetProtocol (PROT_NUMBER);
+  header.SetPayloadSize (packet->GetSize ());
+  header.SetTtl (1);
+  header.SetEcn (m_ecn ? Ipv4Header::ECN_ECT0 : Ipv4Header::ECN_NotECT);
+  if (Node::ChecksumEnabled ())
+    {
+      header.EnableChecksum ();
+    }
+
+  m_txPackets++;
+  m_stepSent++;
+  m_tc->Send (m_device, Create<Ipv4QueueDiscItem> (packet, m_device->GetBroadcast (),
+                                                   Ipv4L3Protocol::PROT_NUMBER, header));
+
+  m_sendEvent = Simulator::Schedule (Seconds (1 / rate), &FluidTcpModel::Send, this);
+}
+
+bool
+FluidTcpModel::IsOwnItem (Ptr<const QueueDiscItem> item) const
+{
+  Ptr<const Ipv4QueueDiscItem> ipv4Item = DynamicCast<const Ipv4QueueDiscItem> (item);
+  if (!ipv4Item)
+    {
+      return false;
+    }
+  const Ipv4Header &header = ipv4Item->GetHeader ();
+  return header.GetProtocol () == PROT_NUMBER
+         && header.GetSource ().Get () - m_sourceAddress.Get () < m_nFlows;
+}
+
+void
+FluidTcpModel::DropTrace (Ptr<const QueueDiscItem> item)
+{
+  if (IsOwnItem (item))
+    {
+      m_dropped++;
+      m_stepCongested++;
+    }
+}
+
+void
+FluidTcpModel::MarkTrace (Ptr<const QueueDiscItem> item, const char* reason)
+{
+  if (IsOwnItem (item))
+    {
+      m_marked++;
+      m_stepCongested++;
+    }
+}
+
+} // namespace ns3
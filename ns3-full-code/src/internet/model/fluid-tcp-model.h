@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLUID_TCP_MODEL_H
+#define FLUID_TCP_MODEL_H
+
+#include <deque>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/data-rate.h"
+#include "ns3/traced-value.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+class NetDevice;
+class QueueDisc;
+class QueueDiscItem;
+class TrafficControlLayer;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief A fluid model of a population of long-lived TCP flows
+ *
+ * The model stands in for a number of identical TCP Reno flows sharing a
+ * bottleneck, whose congestion window follows the fluid equation of Misra,
+ * Gong and Towsley (SIGCOMM 2000):
+ *
+ * \f[ \frac{dW}{dt} = \frac{1}{R(t)} - \frac{W(t) W(t - R)}{2 R(t - R)} p(t - R) \f]
+ *
+ * where R(t) is the round trip time (the propagation delay plus the
+ * queueing delay at the bottleneck) and p(t) is the probability that a
+ * packet is dropped or marked at the bottleneck. The equation is integrated
+ * every TimeStep; the rate of drops and marks per flow, which the delayed
+ * term \f$ W(t - R) p(t - R) / R(t - R) \f$ stands for, is counted during
+ * each step and kept for the previous round trip times. Timeouts and slow start are not modeled:
+ * the equation holds as long as the flows have a window of a few packets
+ * (its equilibrium, \f$ W^2 p = 2 \f$, has no solution below
+ * \f$ \sqrt{2} \f$ packets, where actual flows would undergo timeouts).
+ *
+ * The model is installed on the bottleneck device, and the flows send,
+ * at the rate N W(t) / R(t), packets of PacketSize bytes through the
+ * traffic control layer of the device, hence through its root queue disc,
+ * like the packets of the flows simulated packet by packet. The queue disc
+ * (e.g., RED, SRED, ESRED or PIE) handles them as any other packet, and p(t)
+ * is the fraction of the packets of the model which are dropped or marked
+ * by the queue disc, so that the packet flows and the fluid flows are coupled
+ * through the queue of the bottleneck. Each packet belongs to one of the N
+ * flows, drawn at random, whose source address is the SourceAddress plus
+ * the index of the flow, so that the queue discs which classify or count the
+ * flows see N of them. The packets are IPv4 packets of protocol PROT_NUMBER
+ * sent to the broadcast address; they are silently discarded by the node at
+ * the other end of the link.
+ *
+ * The number of events scheduled by the model depends on the rate of the
+ * link, not on the number of flows, which makes it possible to evaluate a
+ * queue disc with as many flows as the bottleneck can carry with such
+ * windows, e.g. hundreds of thousands on a link of some Gbps, without the
+ * cost of their sockets, acknowledgments and applications.
+ */
+class FluidTcpModel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  static const uint8_t PROT_NUMBER; //!< protocol number of the packets of the model (253, for experimentation)
+
+  FluidTcpModel ();
+  virtual ~FluidTcpModel ();
+
+  /**
+   * \brief Install the model on a bottleneck device
+   *
+   * The device must have a DataRate attribute, and the node a traffic
+   * control layer with a root queue disc installed on the device. The model
+   * starts at StartTime.
+   *
+   * \param device the bottleneck device
+   */
+  void Install (Ptr<NetDevice> device);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \return the congestion window of the flows, in packets
+   */
+  double GetWindow (void) const;
+
+  /**
+   * \return the current round trip time of the flows
+   */
+  Time GetRtt (void) const;
+
+  /**
+   * \return the fraction of the packets dropped or marked during the last step
+   */
+  double GetDropProbability (void) const;
+
+  /**
+   * \return the number of packets sent by the model
+   */
+  uint64_t GetTxPackets (void) const;
+
+  /**
+   * \return the number of packets of the model dropped by the queue disc
+   */
+  uint64_t GetDroppedPackets (void) const;
+
+  /**
+   * \return the number of packets of the model marked by the queue disc
+   */
+  uint64_t GetMarkedPackets (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief The state of the model at the end of a step
+   */
+  struct State
+  {
+    Time time;          //!< the end of the step
+    double window;      //!< the congestion window
+    double signalRate;  //!< the drops and marks per flow per second during the step
+  };
+
+  /**
+   * \brief Start sending and integrating the window equation
+   */
+  void Start (void);
+
+  /**
+   * \brief Stop sending
+   */
+  void Stop (void);
+
+  /**
+   * \brief Integrate the window equation over a step
+   */
+  void Step (void);
+
+  /**
+   * \brief Send a packet and schedule the next one
+   */
+  void Send (void);
+
+  /**
+   * \brief Get the state of the model at a previous time
+   * \param time the time
+   * \return the state at the end of the step including the time, or the
+   *         oldest state kept
+   */
+  const State & GetPastState (Time time) const;
+
+  /**
+   * \param item an item of the queue disc
+   * \return true if the item was sent by this model
+   */
+  bool IsOwnItem (Ptr<const QueueDiscItem> item) const;
+
+  /**
+   * \brief Count the drops of the packets of the model
+   * \param item the dropped item
+   */
+  void DropTrace (Ptr<const QueueDiscItem> item);
+
+  /**
+   * \brief Count the marks of the packets of the model
+   * \param item the marked item
+   * \param reason the reason of the mark
+   */
+  void MarkTrace (Ptr<const QueueDiscItem> item, const char* reason);
+
+  uint32_t m_nFlows;              //!< number of flows
+  Time m_propagationDelay;        //!< round trip propagation delay
+  uint32_t m_packetSize;          //!< size of the packets, IPv4 header included
+  Time m_timeStep;                //!< integration step
+  double m_maxWindow;             //!< maximum congestion window, in packets
+  bool m_ecn;                     //!< whether the packets are ECN capable
+  Ipv4Address m_sourceAddress;    //!< source address of the first flow
+  Time m_startTime;               //!< start time of the model
+  Time m_stopTime;                //!< stop time of the model (zero for never)
+
+  Ptr<NetDevice> m_device;                //!< bottleneck device
+  Ptr<TrafficControlLayer> m_tc;          //!< traffic control layer of the node
+  Ptr<QueueDisc> m_qDisc;                 //!< root queue disc of the device
+  DataRate m_linkRate;                    //!< rate of the bottleneck
+  Ptr<UniformRandomVariable> m_flowRv;    //!< picks the flow of each packet
+
+  TracedValue<double> m_window;           //!< congestion window, in packets
+  TracedValue<Time> m_rtt;                //!< round trip time
+  TracedValue<double> m_prob;             //!< drop (or mark) probability
+  std::deque<State> m_history;            //!< states of the last round trip times
+  uint32_t m_stepSent;                    //!< packets sent during the step
+  uint32_t m_stepCongested;               //!< packets dropped or marked during the step
+  uint64_t m_txPackets;                   //!< packets sent
+  uint64_t m_dropped;                     //!< packets dropped
+  uint64_t m_marked;                      //!< packets marked
+  EventId m_stepEvent;                    //!< next integration step
+  EventId m_sendEvent;                    //!< next send
+};
+
+} // namespace ns3
+
+#endif /* FLUID_TCP_MODEL_H */
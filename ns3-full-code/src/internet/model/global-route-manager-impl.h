@@ -26,6 +26,7 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -38,6 +39,7 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * \ingroup globalrouting
@@ -538,6 +540,10 @@ private:
   ListOfSPFVertex_t m_parents; //!< parent list
   ListOfSPFVertex_t m_children; //!< Children list
   bool m_vertexProcessed; //!< Flag to note whether vertex has been processed in stage two of SPF computation
+  uint32_t m_candidatePosition; //!< position of the vertex in the CandidateQueue
+  uint64_t m_candidateOrder; //!< order in which the vertex was pushed in the CandidateQueue
+
+  friend class CandidateQueue;
 
 /**
  * @brief The SPFVertex copy construction is disallowed.  There's no need for
@@ -641,6 +647,25 @@ public:
  */
   GlobalRoutingLSA* GetLSAByLinkData (Ipv4Address addr) const;
 
+/**
+ * @brief Get the number of (router and network) Link State Advertisements.
+ *
+ * @returns the number of Link State Advertisements, external ones excluded.
+ */
+  uint32_t GetNumLSAs () const;
+
+/**
+ * @brief Get the index of a (router or network) Link State Advertisement.
+ *
+ * The LSAs are numbered from 0 to GetNumLSAs () - 1, so that the SPF
+ * calculations can keep their own state for each LSA in a vector rather
+ * than in the (shared) LSAs.
+ *
+ * @param lsa A Link State Advertisement of the database.
+ * @returns the index of the Link State Advertisement.
+ */
+  uint32_t GetLSAIndex (const GlobalRoutingLSA* lsa) const;
+
 /**
  * @brief Set all LSA flags to an initialized state, for SPF computation
  *
@@ -681,6 +706,9 @@ private:
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  std::unordered_map<const GlobalRoutingLSA*, uint32_t> m_lsaIndices; //!< index of each LSA of m_database
+  /// LSA holding a TransitNetwork link record with the given link data
+  std::unordered_map<Ipv4Address, GlobalRoutingLSA*, Ipv4AddressHash> m_linkDataIndex;
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -735,6 +763,17 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the routes of the nodes
+ * whose routes changed.
+ *
+ * This is equivalent to DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+ * and InitializeRoutes (), except that the routing tables of the nodes whose
+ * routes are unchanged (e.g., away from a link which went down) are left
+ * untouched.
+ */
+  virtual void RecomputeRoutingTables ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  * @param lsdb the pre-built LSDB
@@ -767,8 +806,111 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+/**
+ * @brief Create a route calculator sharing the LSDB of another
+ * GlobalRouteManagerImpl, which keeps the ownership of the LSDB.
+ *
+ * Used to compute the routes of several routers in parallel: the LSDB is
+ * only read by the SPF calculations, each calculator keeping its own state.
+ *
+ * @param lsdb the LSDB
+ */
+  GlobalRouteManagerImpl (GlobalRouteManagerLSDB* lsdb);
+
+/**
+ * @brief A route computed by SPF, to be added to the routing table of the
+ * root router.
+ */
+  struct SPFRoute
+  {
+    /// The kind of route
+    enum Type
+    {
+      HOST,          //!< a host route (the mask is ignored)
+      NETWORK,       //!< a network route
+      EXTERNAL       //!< an AS external route
+    };
+    Type type;             //!< the kind of route
+    Ipv4Address dest;      //!< the destination host or network
+    Ipv4Mask mask;         //!< the network mask
+    Ipv4Address nextHop;   //!< the next hop
+    uint32_t outIf;        //!< the outgoing interface
+  };
+
+/**
+ * @brief A router whose routes are computed by SPF, with what the SPF
+ * calculation needs to know about its node.
+ *
+ * The information is gathered before the SPF calculations so that they
+ * do not access the nodes, which allows running them in parallel.
+ */
+  struct SPFRoot
+  {
+    Ipv4Address routerId;                 //!< the router ID
+    Ptr<Ipv4GlobalRouting> routing;       //!< the routing protocol of the node, if found
+    uint32_t nodeId;                      //!< the ID of the node
+    /// the interfaces of the node and their local addresses
+    std::vector<std::pair<int32_t, Ipv4Address> > addresses;
+    std::vector<SPFRoute> routes;         //!< the computed routes
+  };
+
+/**
+ * @brief Work shared by the threads computing the routes in parallel.
+ */
+  struct SPFWork;
+
+/**
+ * @brief Find the routers whose routes are computed by SPF.
+ * @returns the routers
+ */
+  std::vector<SPFRoot> GetSPFRoots (void) const;
+
+/**
+ * @brief Gather the information about a router needed by the SPF calculation.
+ * @param routerId the router ID
+ * @param node the node of the router, if known (otherwise, it is looked up)
+ * @returns the router
+ */
+  SPFRoot GetSPFRoot (Ipv4Address routerId, Ptr<Node> node = 0) const;
+
+/**
+ * @brief Compute the routes of the given routers, possibly in parallel.
+ *
+ * The number of threads is given by the GlobalRoutingSpfThreads global value.
+ *
+ * @param roots the routers
+ */
+  void ComputeRoutes (std::vector<SPFRoot> &roots);
+
+/**
+ * @brief Compute the routes of the routers of a shared work, until none is left.
+ */
+  void ComputeRoutesWorker (void);
+
+/**
+ * @brief Add the computed routes of a router to its routing table.
+ * @param root the router
+ */
+  void InstallRoutes (const SPFRoot &root);
+
+/**
+ * @brief Compute a digest of a list of routes, to detect whether the routes
+ * of a router changed without keeping a copy of them.
+ * @param routes the routes
+ * @returns the digest
+ */
+  static uint64_t GetDigest (const std::vector<SPFRoute> &routes);
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  bool m_ownsLsdb; //!< true if the LSDB is deleted with this object
+  SPFRoot* m_root; //!< the router whose routes are being computed
+  bool m_hasNodes; //!< true if there are nodes in the NodeList
+  std::vector<uint8_t> m_lsaStatus; //!< the SPF status of each LSA, by LSA index
+  std::vector<SPFVertex*> m_lsaCandidate; //!< the candidate vertex of each LSA, by LSA index
+  SPFWork* m_work; //!< the shared work, for a parallel route calculator
+  /// the digest of the routes added to each node (by node ID) by the last calculation
+  std::map<uint32_t, uint64_t> m_installedRoutes;
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -40,29 +40,92 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_connected.clear ();
+  m_wildcards.clear ();
+  m_ports.clear ();
 }
 
 bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv4EndPointDemux::IsConnected (Ipv4EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  return endPoint->m_localAddr != Ipv4Address::GetAny ()
+         && endPoint->m_peerAddr != Ipv4Address::GetAny ()
+         && endPoint->m_peerPort != 0;
+}
+
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  if (IsConnected (endPoint))
+    {
+      FourTuple tuple = {endPoint->m_localAddr.Get (), endPoint->m_peerAddr.Get (),
+                         endPoint->m_localPort, endPoint->m_peerPort};
+      m_connected.emplace (tuple, endPoint);
+    }
+  else
+    {
+      m_wildcards[endPoint->m_localPort].push_back (endPoint);
+    }
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  if (IsConnected (endPoint))
     {
-      if ((*i)->GetLocalPort  () == port) 
+      FourTuple tuple = {endPoint->m_localAddr.Get (), endPoint->m_peerAddr.Get (),
+                         endPoint->m_localPort, endPoint->m_peerPort};
+      auto range = m_connected.equal_range (tuple);
+      for (auto it = range.first; it != range.second; it++)
         {
-          return true;
+          if (it->second == endPoint)
+            {
+              m_connected.erase (it);
+              break;
+            }
+        }
+    }
+  else
+    {
+      auto wildcards = m_wildcards.find (endPoint->m_localPort);
+      wildcards->second.remove (endPoint);
+      if (wildcards->second.empty ())
+        {
+          m_wildcards.erase (wildcards);
         }
     }
-  return false;
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  endPoint->m_demux = this;
+  endPoint->m_position = m_endPoints.insert (m_endPoints.end (), endPoint);
+  m_ports[endPoint->m_localPort]++;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       if ((*i)->GetLocalPort () == port &&
@@ -85,10 +148,7 @@ Ipv4EndPointDemux::Allocate (void)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (Ipv4Address::GetAny (), port));
 }
 
 Ipv4EndPoint *
@@ -101,10 +161,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -124,10 +181,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
       NS_LOG_WARN ("Duplicated endpoint.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -136,7 +190,30 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
+  endPoint->SetPeer (peerAddress, peerPort);
+
+  // the duplicates of a fully specified four-tuple are in the hash table,
+  // the others in the wildcard table
+  EndPoints candidates;
+  if (IsConnected (endPoint))
+    {
+      FourTuple tuple = {localAddress.Get (), peerAddress.Get (), localPort, peerPort};
+      auto range = m_connected.equal_range (tuple);
+      for (auto it = range.first; it != range.second; it++)
+        {
+          candidates.push_back (it->second);
+        }
+    }
+  else
+    {
+      auto wildcards = m_wildcards.find (localPort);
+      if (wildcards != m_wildcards.end ())
+        {
+          candidates = wildcards->second;
+        }
+    }
+  for (EndPointsI i = candidates.begin (); i != candidates.end (); i++) 
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -145,31 +222,31 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
           ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
         {
           NS_LOG_WARN ("Duplicated endpoint.");
+          delete endPoint;
           return 0;
         }
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
-  endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
 
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void 
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (endPoint->m_demux != this)
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
+    }
+  Unindex (endPoint);
+  auto port = m_ports.find (endPoint->m_localPort);
+  if (--port->second == 0)
+    {
+      m_ports.erase (port);
     }
+  m_endPoints.erase (endPoint->m_position);
+  endPoint->m_demux = 0;
+  delete endPoint;
 }
 
 /*
@@ -208,7 +285,59 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+
+  // An exact match on all 4 takes precedence over all the other matches:
+  // look for it in the hash table of the fully specified endpoints first
+  if (daddr != Ipv4Address::GetAny () && saddr != Ipv4Address::GetAny () && sport != 0)
+    {
+      FourTuple tuple = {daddr.Get (), saddr.Get (), dport, sport};
+      auto range = m_connected.equal_range (tuple);
+      for (auto it = range.first; it != range.second; it++)
+        {
+          Ipv4EndPoint* endP = it->second;
+          if (endP->IsRxEnabled ()
+              && (!endP->GetBoundNetDevice () || endP->GetBoundNetDevice () == incomingInterface->GetDevice ()))
+            {
+              NS_LOG_LOGIC ("Found an endpoint for case 4, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
+              retval4.push_back (endP);
+            }
+        }
+      if (!retval4.empty ())
+        {
+          NS_ABORT_MSG_IF (retval4.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
+          return retval4;
+        }
+    }
+
+  // The other matches are among the endpoints of the port which are not
+  // fully specified, and the fully specified endpoints bound to the network
+  // address of the incoming interface, which match subnet-directed
+  // broadcast packets
+  EndPoints candidates;
+  if (saddr != Ipv4Address::GetAny () && sport != 0 && incomingInterface)
+    {
+      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+        {
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+          Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+          if (addrNetpart != daddr && daddr.CombineMask (addr.GetMask ()) == addrNetpart)
+            {
+              FourTuple tuple = {addrNetpart.Get (), saddr.Get (), dport, sport};
+              auto range = m_connected.equal_range (tuple);
+              for (auto it = range.first; it != range.second; it++)
+                {
+                  candidates.push_back (it->second);
+                }
+            }
+        }
+    }
+  auto wildcards = m_wildcards.find (dport);
+  if (wildcards != m_wildcards.end ())
+    {
+      candidates.insert (candidates.end (), wildcards->second.begin (), wildcards->second.end ());
+    }
+
+  for (EndPointsI i = candidates.begin (); i != candidates.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
 
@@ -343,6 +472,17 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport);
 
+  if (daddr != Ipv4Address::GetAny () && saddr != Ipv4Address::GetAny () && sport != 0)
+    {
+      FourTuple tuple = {daddr.Get (), saddr.Get (), dport, sport};
+      auto it = m_connected.find (tuple);
+      if (it != m_connected.end ())
+        {
+          /* this is an exact match. */
+          return it->second;
+        }
+    }
+
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
   uint32_t genericity = 3;
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +41,16 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints whose four-tuple is fully specified (e.g., the endpoints of
+ * the established TCP connections) are also indexed by a hash table, so that
+ * the packets of a connection are demultiplexed without scanning the list,
+ * and the other endpoints (e.g., those of the listening sockets) by local
+ * port in a wildcard table, which Lookup searches when there is no exact
+ * match.  The number of endpoints using each local port is counted, so that
+ * allocating an ephemeral port does not scan the list either.  The
+ * endpoints notify the demux when their local address or their peer
+ * changes.
  */
 
 class Ipv4EndPointDemux {
@@ -166,6 +177,72 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief The four-tuple of an endpoint
+   */
+  struct FourTuple
+  {
+    uint32_t localAddress;  //!< the local address
+    uint32_t peerAddress;   //!< the peer address
+    uint16_t localPort;     //!< the local port
+    uint16_t peerPort;      //!< the peer port
+
+    /**
+     * \param other the four-tuple to compare
+     * \return true if the four-tuples are equal
+     */
+    bool operator == (const FourTuple &other) const
+    {
+      return localAddress == other.localAddress && peerAddress == other.peerAddress
+             && localPort == other.localPort && peerPort == other.peerPort;
+    }
+  };
+
+  /**
+   * \brief Hash function of the four-tuples
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \param tuple the four-tuple
+     * \return the hash of the four-tuple
+     */
+    std::size_t operator () (const FourTuple &tuple) const
+    {
+      uint64_t h = (static_cast<uint64_t> (tuple.localAddress) << 32) | tuple.peerAddress;
+      h ^= ((static_cast<uint64_t> (tuple.localPort) << 16) | tuple.peerPort) * 0x9e3779b97f4a7c15ULL;
+      return std::hash<uint64_t> () (h ^ (h >> 29));
+    }
+  };
+
+  /**
+   * \brief Add an endpoint to the demux
+   * \param endPoint the endpoint
+   * \return the endpoint
+   */
+  Ipv4EndPoint *Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add an endpoint to the hash table if its four-tuple is fully
+   * specified, to the wildcard table otherwise
+   * \param endPoint the endpoint
+   */
+  void Index (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the hash table or the wildcard table
+   * \param endPoint the endpoint
+   */
+  void Unindex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \param endPoint the endpoint
+   * \return true if the four-tuple of the endpoint is fully specified
+   */
+  static bool IsConnected (Ipv4EndPoint *endPoint);
+
 
   /**
    * \brief Allocate an ephemeral port.
@@ -192,6 +269,21 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points whose four-tuple is fully specified.
+   */
+  std::unordered_multimap<FourTuple, Ipv4EndPoint *, FourTupleHash> m_connected;
+
+  /**
+   * \brief The other end points, by local port.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_wildcards;
+
+  /**
+   * \brief The number of end points using each local port.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_ports;
 };
 
 } // namespace ns3
@@ -22,6 +22,7 @@
 #define IPV4_END_POINT_H
 
 #include <stdint.h>
+#include <list>
 #include "ns3/ipv4-address.h"
 #include "ns3/callback.h"
 #include "ns3/net-device.h"
@@ -30,6 +31,8 @@
 
 namespace ns3 {
 
+class Ipv4EndPointDemux;
+
 class Header;
 class Packet;
 
@@ -183,6 +186,8 @@ public:
   bool IsRxEnabled (void);
 
 private:
+  friend class Ipv4EndPointDemux;
+
   /**
    * \brief The local address.
    */
@@ -227,6 +232,17 @@ private:
    * \brief true if the endpoint can receive packets.
    */
   bool m_rxEnabled;
+
+  /**
+   * \brief The demux which allocated the endpoint, notified when the
+   * local address or the peer changes.
+   */
+  Ipv4EndPointDemux *m_demux;
+
+  /**
+   * \brief The position of the endpoint in the list of the demux.
+   */
+  std::list<Ipv4EndPoint *>::iterator m_position;
 };
 
 } // namespace ns3
@@ -59,7 +59,8 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_forwardingTableValid (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +81,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  InvalidateForwardingTable ();
 }
 
 void 
@@ -90,6 +92,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  InvalidateForwardingTable ();
 }
 
 void 
@@ -105,6 +108,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  InvalidateForwardingTable ();
 }
 
 void 
@@ -118,6 +122,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  InvalidateForwardingTable ();
 }
 
 void 
@@ -133,116 +138,174 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  InvalidateForwardingTable ();
 }
 
 
-Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+void
+Ipv4GlobalRouting::InvalidateForwardingTable (void)
 {
-  NS_LOG_FUNCTION (this << dest << oif);
-  NS_LOG_LOGIC ("Looking for route for destination " << dest);
-  Ptr<Ipv4Route> rtentry = 0;
-  // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
+  NS_LOG_FUNCTION (this);
+  m_forwardingTableValid = false;
+  m_hostTable.Clear ();
+  m_networkTable.Clear ();
+  m_ASexternalSets.clear ();
+  m_routeSets.clear ();
+}
 
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+void
+Ipv4GlobalRouting::BuildForwardingTable (void)
+{
+  NS_LOG_FUNCTION (this);
+  InvalidateForwardingTable ();
+
+  // the routes to the same destination are grouped in a route set,
+  // in the order in which they appear in the routing table
+  auto insert = [this] (Ipv4LpmTable &table, Ipv4RoutingTableEntry *route)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest () == dest)
+      Ipv4Address dest = route->IsHost () ? route->GetDest () : route->GetDestNetwork ();
+      uint8_t prefixLength = route->IsHost () ? 32 : route->GetDestNetworkMask ().GetPrefixLength ();
+      uint32_t index;
+      if (!table.Get (dest, prefixLength, index))
         {
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          index = m_routeSets.size ();
+          m_routeSets.push_back (RouteSet ());
+          table.Insert (dest, prefixLength, index);
         }
+      m_routeSets[index].routes.push_back (route);
+      m_routeSets[index].cachedRoutes.push_back (0);
+    };
+
+  for (HostRoutesCI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++)
+    {
+      NS_ASSERT ((*i)->IsHost ());
+      insert (m_hostTable, *i);
+    }
+  for (NetworkRoutesCI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+    {
+      insert (m_networkTable, *j);
+    }
+  // the external routes are matched in routing table order, hence each
+  // one has its own route set
+  for (ASExternalRoutesCI k = m_ASexternalRoutes.begin (); k != m_ASexternalRoutes.end (); k++)
+    {
+      m_ASexternalSets.push_back (m_routeSets.size ());
+      m_routeSets.push_back (RouteSet ());
+      m_routeSets.back ().routes.push_back (*k);
+      m_routeSets.back ().cachedRoutes.push_back (0);
     }
-  if (allRoutes.size () == 0) // if no host route is found
+  m_forwardingTableValid = true;
+  NS_LOG_LOGIC ("Forwarding table built: " << m_routeSets.size () << " route sets, "
+                << m_hostTable.GetNPrefixes () << " hosts, "
+                << m_networkTable.GetNPrefixes () << " networks, "
+                << m_ASexternalSets.size () << " external routes");
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::SelectRoute (RouteSet &routeSet, Ptr<NetDevice> oif, bool ecmp)
+{
+  NS_LOG_FUNCTION (this << oif << ecmp);
+  uint32_t nRoutes = routeSet.routes.size ();
+  if (oif != 0)
     {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      nRoutes = 0;
+      for (const auto route : routeSet.routes)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          if (oif == m_ipv4->GetNetDevice (route->GetInterface ()))
             {
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              nRoutes++;
             }
         }
+      if (nRoutes == 0)
+        {
+          NS_LOG_LOGIC ("Not on requested interface, skipping");
+          return 0;
+        }
     }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
+  if (!ecmp)
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      nRoutes = 1;
+    }
+
+  // pick up one of the routes uniformly at random if random
+  // ECMP routing is enabled, or always select the first route
+  // consistently if random ECMP routing is disabled
+  uint32_t selectIndex = 0;
+  if (m_randomEcmpRouting)
+    {
+      selectIndex = m_rand->GetInteger (0, nRoutes - 1);
+    }
+
+  // find the position of the selected route in the route set
+  uint32_t i = 0;
+  for (; i < routeSet.routes.size (); i++)
+    {
+      if (oif == 0 || oif == m_ipv4->GetNetDevice (routeSet.routes[i]->GetInterface ()))
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          if (selectIndex == 0)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*k);
               break;
             }
+          selectIndex--;
         }
     }
-  if (allRoutes.size () > 0 ) // if route(s) is found
+  NS_ASSERT (i < routeSet.routes.size ());
+
+  if (routeSet.cachedRoutes[i] == 0)
     {
-      // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
-      uint32_t selectIndex;
-      if (m_randomEcmpRouting)
-        {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
-        }
-      else 
-        {
-          selectIndex = 0;
-        }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
+      Ipv4RoutingTableEntry* route = routeSet.routes[i];
       // create a Ipv4Route object from the selected routing table entry
-      rtentry = Create<Ipv4Route> ();
+      Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
       rtentry->SetDestination (route->GetDest ());
       /// \todo handle multi-address case
       rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
       rtentry->SetGateway (route->GetGateway ());
       uint32_t interfaceIdx = route->GetInterface ();
       rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-      return rtentry;
+      routeSet.cachedRoutes[i] = rtentry;
     }
-  else 
+  NS_LOG_LOGIC ("Selected route " << *routeSet.routes[i]);
+  return routeSet.cachedRoutes[i];
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION (this << dest << oif);
+  NS_LOG_LOGIC ("Looking for route for destination " << dest);
+  if (!m_forwardingTableValid)
+    {
+      BuildForwardingTable ();
+    }
+
+  Ptr<Ipv4Route> rtentry = 0;
+  uint8_t prefixLength = 33;
+  uint32_t index;
+  if (m_hostTable.Lookup (dest, prefixLength, index))
     {
-      return 0;
+      NS_LOG_LOGIC ("Found global host routes");
+      rtentry = SelectRoute (m_routeSets[index], oif, true);
     }
+  // if no host route is found, try the networks from the longest prefix
+  prefixLength = 33;
+  while (rtentry == 0 && m_networkTable.Lookup (dest, prefixLength, index))
+    {
+      NS_LOG_LOGIC ("Found global network routes, prefix length " << +prefixLength);
+      rtentry = SelectRoute (m_routeSets[index], oif, true);
+    }
+  // consider external if no host/network found: the first matching
+  // external route is selected, whatever the length of its prefix
+  for (auto k = m_ASexternalSets.begin (); rtentry == 0 && k != m_ASexternalSets.end (); k++)
+    {
+      RouteSet &routeSet = m_routeSets[*k];
+      Ipv4RoutingTableEntry *route = routeSet.routes.front ();
+      if (route->GetDestNetworkMask ().IsMatch (dest, route->GetDestNetwork ()))
+        {
+          NS_LOG_LOGIC ("Found external route " << *route);
+          rtentry = SelectRoute (routeSet, oif, false);
+        }
+    }
+  return rtentry;
 }
 
 uint32_t 
@@ -309,6 +372,7 @@ void
 Ipv4GlobalRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
+  InvalidateForwardingTable ();
   if (index < m_hostRoutes.size ())
     {
       uint32_t tmp = 0;
@@ -374,6 +438,7 @@ void
 Ipv4GlobalRouting::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  InvalidateForwardingTable ();
   for (HostRoutesI i = m_hostRoutes.begin (); 
        i != m_hostRoutes.end (); 
        i = m_hostRoutes.erase (i)) 
@@ -542,11 +607,10 @@ void
 Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  InvalidateForwardingTable ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -554,11 +618,10 @@ void
 Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  InvalidateForwardingTable ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -566,11 +629,10 @@ void
 Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << address);
+  InvalidateForwardingTable ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -578,11 +640,10 @@ void
 Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << address);
+  InvalidateForwardingTable ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -592,6 +653,7 @@ Ipv4GlobalRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_FUNCTION (this << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  InvalidateForwardingTable ();
 }
 
 
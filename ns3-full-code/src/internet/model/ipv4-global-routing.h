@@ -21,6 +21,7 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +29,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ipv4-lpm-table.h"
 
 namespace ns3 {
 
@@ -65,6 +67,15 @@ class Node;
  *
  * This class deals with Ipv4 unicast routes only.
  *
+ * Packets are not forwarded by walking the routing table: a forwarding
+ * table, which maps each destination to the set of its (equal cost)
+ * routes, is built on the first lookup following a change of the routing
+ * table, and the Ipv4Route of each route is created once and then reused.
+ * Host routes take precedence over network routes, which take precedence
+ * over external routes.  Among the network routes, the route to the
+ * longest matching prefix is selected; among the external routes, the
+ * first matching one in routing table order is selected.
+ *
  * \see Ipv4RoutingProtocol
  * \see GlobalRouteManager
  */
@@ -260,6 +271,16 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
+  /**
+   * \brief The routes to a destination (a host or a network), i.e., the
+   * candidates among which a route is selected when using ECMP
+   */
+  struct RouteSet
+  {
+    std::vector<Ipv4RoutingTableEntry *> routes; //!< the routes, in routing table order
+    std::vector<Ptr<Ipv4Route> > cachedRoutes;   //!< the Ipv4Route of each route, built on first use
+  };
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
@@ -268,10 +289,44 @@ private:
    */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Select a route of a route set.
+   *
+   * The routes which do not use the requested output interface (if any)
+   * are not considered.  Among the others, a route is picked uniformly at
+   * random if ECMP is allowed and random ECMP routing is enabled, the first
+   * one otherwise.
+   *
+   * \param routeSet the route set
+   * \param oif output interface if any (put 0 otherwise)
+   * \param ecmp whether a route can be picked among several candidates
+   * \return the Ipv4Route of the selected route, or 0 if no route matches
+   */
+  Ptr<Ipv4Route> SelectRoute (RouteSet &routeSet, Ptr<NetDevice> oif, bool ecmp);
+
+  /**
+   * \brief Build the forwarding table from the routing table.
+   */
+  void BuildForwardingTable (void);
+
+  /**
+   * \brief Discard the forwarding table, which is rebuilt on the next lookup.
+   *
+   * Must be called whenever the routing table or the interface addresses
+   * (used as the source of the cached Ipv4Route objects) change.
+   */
+  void InvalidateForwardingTable (void);
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  bool m_forwardingTableValid;            //!< True if the forwarding table reflects the routing table
+  std::vector<RouteSet> m_routeSets;      //!< Route sets referenced by the forwarding table
+  Ipv4LpmTable m_hostTable;               //!< Route set of each host
+  Ipv4LpmTable m_networkTable;            //!< Route set of each network
+  std::vector<uint32_t> m_ASexternalSets; //!< Route set of each external route, in routing table order
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ipv4-lpm-table.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4LpmTable");
+
+Ipv4LpmTable::Ipv4LpmTable ()
+  : m_nPrefixes (0)
+{
+}
+
+uint32_t
+Ipv4LpmTable::GetMask (uint8_t prefixLength)
+{
+  return prefixLength == 0 ? 0 : 0xffffffff << (32 - prefixLength);
+}
+
+bool
+Ipv4LpmTable::Insert (Ipv4Address network, uint8_t prefixLength, uint32_t value)
+{
+  NS_LOG_FUNCTION (this << network << +prefixLength << value);
+  NS_ASSERT (prefixLength <= 32);
+
+  auto level = m_levels.begin ();
+  while (level != m_levels.end () && level->length > prefixLength)
+    {
+      level++;
+    }
+  if (level == m_levels.end () || level->length != prefixLength)
+    {
+      Level newLevel;
+      newLevel.length = prefixLength;
+      newLevel.mask = GetMask (prefixLength);
+      level = m_levels.insert (level, newLevel);
+    }
+
+  if (!level->values.emplace (network.Get () & level->mask, value).second)
+    {
+      return false;
+    }
+  m_nPrefixes++;
+  return true;
+}
+
+bool
+Ipv4LpmTable::Get (Ipv4Address network, uint8_t prefixLength, uint32_t &value) const
+{
+  for (const auto &level : m_levels)
+    {
+      if (level.length == prefixLength)
+        {
+          auto it = level.values.find (network.Get () & level.mask);
+          if (it == level.values.end ())
+            {
+              return false;
+            }
+          value = it->second;
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+Ipv4LpmTable::Lookup (Ipv4Address address, uint8_t &prefixLength, uint32_t &value) const
+{
+  uint32_t addr = address.Get ();
+  for (const auto &level : m_levels)
+    {
+      if (level.length >= prefixLength)
+        {
+          continue;
+        }
+      auto it = level.values.find (addr & level.mask);
+      if (it != level.values.end ())
+        {
+          prefixLength = level.length;
+          value = it->second;
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+Ipv4LpmTable::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_levels.clear ();
+  m_nPrefixes = 0;
+}
+
+uint32_t
+Ipv4LpmTable::GetNPrefixes (void) const
+{
+  return m_nPrefixes;
+}
+
+} // namespace ns3
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_LPM_TABLE_H
+#define IPV4_LPM_TABLE_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief A longest prefix match table of IPv4 prefixes
+ *
+ * The table maps IPv4 prefixes to values (e.g., the index of a set of
+ * routes).  The prefixes are stored in one hash table per prefix length,
+ * and the lengths in use are kept sorted, from the longest to the shortest.
+ * A lookup probes the hash tables of the lengths in use, hence its cost
+ * depends on the number of distinct prefix lengths (a handful in the tables
+ * built by global routing), not on the number of prefixes, while the memory
+ * used is proportional to the number of prefixes.
+ *
+ * The prefixes matching an address can be enumerated from the longest to
+ * the shortest, by passing the length of the previous match as the bound
+ * of the next lookup.
+ */
+class Ipv4LpmTable
+{
+public:
+  Ipv4LpmTable ();
+
+  /**
+   * \brief Insert a prefix
+   * \param network the network address (the bits beyond the prefix length are ignored)
+   * \param prefixLength the length of the prefix, from 0 to 32
+   * \param value the value associated with the prefix
+   * \return false if the prefix was already in the table (the value is not changed)
+   */
+  bool Insert (Ipv4Address network, uint8_t prefixLength, uint32_t value);
+
+  /**
+   * \brief Get the value associated with a prefix
+   * \param network the network address (the bits beyond the prefix length are ignored)
+   * \param prefixLength the length of the prefix, from 0 to 32
+   * \param value the value associated with the prefix, if any
+   * \return true if the prefix is in the table
+   */
+  bool Get (Ipv4Address network, uint8_t prefixLength, uint32_t &value) const;
+
+  /**
+   * \brief Find the longest prefix matching an address
+   * \param address the address
+   * \param prefixLength on input, only the prefixes shorter than this length
+   *        are considered (33 for all of them); on output, the length of the
+   *        matching prefix
+   * \param value the value associated with the matching prefix
+   * \return true if a prefix matches
+   */
+  bool Lookup (Ipv4Address address, uint8_t &prefixLength, uint32_t &value) const;
+
+  /**
+   * \brief Remove all the prefixes
+   */
+  void Clear (void);
+
+  /**
+   * \return the number of prefixes in the table
+   */
+  uint32_t GetNPrefixes (void) const;
+
+private:
+  /**
+   * \brief The prefixes of a given length
+   */
+  struct Level
+  {
+    uint8_t length;                                 //!< the length of the prefixes
+    uint32_t mask;                                  //!< the mask of the prefixes
+    std::unordered_map<uint32_t, uint32_t> values;  //!< the value of each (masked) network
+  };
+
+  /**
+   * \param prefixLength the length of a prefix
+   * \return the mask of the prefixes of this length
+   */
+  static uint32_t GetMask (uint8_t prefixLength);
+
+  std::vector<Level> m_levels;  //!< the levels in use, from the longest prefixes
+  uint32_t m_nPrefixes;         //!< the number of prefixes
+};
+
+} // namespace ns3
+
+#endif /* IPV4_LPM_TABLE_H */
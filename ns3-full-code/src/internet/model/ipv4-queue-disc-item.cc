@@ -17,9 +17,8 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/hash.h"
 #include "ipv4-queue-disc-item.h"
-#include "ns3/tcp-header.h"
-#include "ns3/udp-header.h"
 
 namespace ns3 {
 
@@ -29,7 +28,11 @@ Ipv4QueueDiscItem::Ipv4QueueDiscItem (Ptr<Packet> p, const Address& addr,
                                       uint16_t protocol, const Ipv4Header & header)
   : QueueDiscItem (p, addr, protocol),
     m_header (header),
-    m_headerAdded (false)
+    m_headerAdded (false),
+    m_tupleSerialized (false),
+    m_hashValid (false),
+    m_perturbation (0),
+    m_hash (0)
 {
 }
 
@@ -111,59 +114,77 @@ Ipv4QueueDiscItem::GetUint8Value (QueueItem::Uint8Values field, uint8_t& value)
   return ret;
 }
 
-uint32_t
-Ipv4QueueDiscItem::Hash (uint32_t perturbation) const
+void
+Ipv4QueueDiscItem::SerializeTuple (void) const
 {
-  NS_LOG_FUNCTION (this << perturbation);
+  NS_LOG_FUNCTION (this);
 
   Ipv4Address src = m_header.GetSource ();
   Ipv4Address dest = m_header.GetDestination ();
   uint8_t prot = m_header.GetProtocol ();
   uint16_t fragOffset = m_header.GetFragmentOffset ();
 
-  TcpHeader tcpHdr;
-  UdpHeader udpHdr;
   uint16_t srcPort = 0;
   uint16_t destPort = 0;
 
-  if (prot == 6 && fragOffset == 0) // TCP
+  if ((prot == 6 || prot == 17) && fragOffset == 0) // TCP or UDP
     {
-      GetPacket ()->PeekHeader (tcpHdr);
-      srcPort = tcpHdr.GetSourcePort ();
-      destPort = tcpHdr.GetDestinationPort ();
-    }
-  else if (prot == 17 && fragOffset == 0) // UDP
-    {
-      GetPacket ()->PeekHeader (udpHdr);
-      srcPort = udpHdr.GetSourcePort ();
-      destPort = udpHdr.GetDestinationPort ();
+      // Both headers start with the source and destination ports, hence
+      // it is enough to read the first four bytes of the transport header
+      uint32_t offset = m_headerAdded ? m_header.GetSerializedSize () : 0;
+      uint8_t buf[64];
+      NS_ASSERT (offset + 4 <= sizeof (buf));
+      if (GetPacket ()->CopyData (buf, offset + 4) == offset + 4)
+        {
+          srcPort = (buf[offset] << 8) | buf[offset + 1];
+          destPort = (buf[offset + 2] << 8) | buf[offset + 3];
+        }
     }
   if (prot != 6 && prot != 17)
     {
       NS_LOG_WARN ("Unknown transport protocol, no port number included in hash computation");
     }
 
-  /* serialize the 5-tuple and the perturbation in buf */
-  uint8_t buf[17];
-  src.Serialize (buf);
-  dest.Serialize (buf + 4);
-  buf[8] = prot;
-  buf[9] = (srcPort >> 8) & 0xff;
-  buf[10] = srcPort & 0xff;
-  buf[11] = (destPort >> 8) & 0xff;
-  buf[12] = destPort & 0xff;
-  buf[13] = (perturbation >> 24) & 0xff;
-  buf[14] = (perturbation >> 16) & 0xff;
-  buf[15] = (perturbation >> 8) & 0xff;
-  buf[16] = perturbation & 0xff;
+  /* serialize the 5-tuple in m_tuple, the perturbation is appended later */
+  src.Serialize (m_tuple);
+  dest.Serialize (m_tuple + 4);
+  m_tuple[8] = prot;
+  m_tuple[9] = (srcPort >> 8) & 0xff;
+  m_tuple[10] = srcPort & 0xff;
+  m_tuple[11] = (destPort >> 8) & 0xff;
+  m_tuple[12] = destPort & 0xff;
+  m_tupleSerialized = true;
+}
+
+uint32_t
+Ipv4QueueDiscItem::Hash (uint32_t perturbation) const
+{
+  NS_LOG_FUNCTION (this << perturbation);
+
+  if (m_hashValid && m_perturbation == perturbation)
+    {
+      return m_hash;
+    }
+
+  if (!m_tupleSerialized)
+    {
+      SerializeTuple ();
+    }
+
+  m_tuple[13] = (perturbation >> 24) & 0xff;
+  m_tuple[14] = (perturbation >> 16) & 0xff;
+  m_tuple[15] = (perturbation >> 8) & 0xff;
+  m_tuple[16] = perturbation & 0xff;
 
   // Linux calculates jhash2 (jenkins hash), we calculate murmur3 because it is
   // already available in ns-3
-  uint32_t hash = Hash32 ((char*) buf, 17);
+  m_hash = Hash32 ((char*) m_tuple, 17);
+  m_perturbation = perturbation;
+  m_hashValid = true;
 
-  NS_LOG_DEBUG ("Hash value " << hash);
+  NS_LOG_DEBUG ("Hash value " << m_hash);
 
-  return hash;
+  return m_hash;
 }
 
 } // namespace ns3
@@ -95,14 +95,32 @@ public:
    * number and, if the transport protocol is either UDP or TCP, the source
    * and destination port
    *
+   * The 5-tuple is extracted from the packet only once per item, and the
+   * hash computed for the last perturbation value is cached, so that the
+   * queue discs and packet filters which hash the same item multiple times
+   * do not pay for it again.
+   *
    * \param perturbation hash perturbation value
    * \return the hash of the packet's 5-tuple
    */
   virtual uint32_t Hash (uint32_t perturbation) const;
 
 private:
+  /**
+   * \brief Serialize the 5-tuple of the packet in m_tuple.
+   *
+   * The port numbers are read directly from the first bytes of the
+   * transport header, without deserializing the whole header.
+   */
+  void SerializeTuple (void) const;
+
   Ipv4Header m_header;  //!< The IPv4 header.
   bool m_headerAdded;   //!< True if the header has already been added to the packet.
+  mutable uint8_t m_tuple[17];          //!< The serialized 5-tuple, followed by the perturbation
+  mutable bool m_tupleSerialized;       //!< True if m_tuple holds the 5-tuple
+  mutable bool m_hashValid;             //!< True if m_hash is the hash for m_perturbation
+  mutable uint32_t m_perturbation;      //!< The perturbation of the cached hash
+  mutable uint32_t m_hash;              //!< The cached hash
 };
 
 } // namespace ns3
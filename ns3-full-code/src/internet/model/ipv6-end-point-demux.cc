@@ -40,27 +40,91 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       Ipv6EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_connected.clear ();
+  m_wildcards.clear ();
+  m_ports.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+bool Ipv6EndPointDemux::IsConnected (Ipv6EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  return endPoint->m_localAddr != Ipv6Address::GetAny ()
+         && endPoint->m_peerAddr != Ipv6Address::GetAny ()
+         && endPoint->m_peerPort != 0;
+}
+
+void Ipv6EndPointDemux::Index (Ipv6EndPoint *endPoint)
+{
+  m_ports[endPoint->m_localPort]++;
+  if (IsConnected (endPoint))
     {
-      if ((*i)->GetLocalPort  () == port)
+      FourTuple tuple = {endPoint->m_localAddr, endPoint->m_peerAddr,
+                         endPoint->m_localPort, endPoint->m_peerPort};
+      m_connected.emplace (tuple, endPoint);
+    }
+  else
+    {
+      m_wildcards[endPoint->m_localPort].push_back (endPoint);
+    }
+}
+
+void Ipv6EndPointDemux::Unindex (Ipv6EndPoint *endPoint)
+{
+  auto port = m_ports.find (endPoint->m_localPort);
+  if (--port->second == 0)
+    {
+      m_ports.erase (port);
+    }
+  if (IsConnected (endPoint))
+    {
+      FourTuple tuple = {endPoint->m_localAddr, endPoint->m_peerAddr,
+                         endPoint->m_localPort, endPoint->m_peerPort};
+      auto range = m_connected.equal_range (tuple);
+      for (auto it = range.first; it != range.second; it++)
         {
-          return true;
+          if (it->second == endPoint)
+            {
+              m_connected.erase (it);
+              break;
+            }
         }
     }
-  return false;
+  else
+    {
+      auto wildcards = m_wildcards.find (endPoint->m_localPort);
+      wildcards->second.remove (endPoint);
+      if (wildcards->second.empty ())
+        {
+          m_wildcards.erase (wildcards);
+        }
+    }
+}
+
+Ipv6EndPoint* Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  endPoint->m_demux = this;
+  endPoint->m_position = m_endPoints.insert (m_endPoints.end (), endPoint);
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       if ((*i)->GetLocalPort () == port &&
@@ -82,10 +146,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (Ipv6Address::GetAny (), port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
@@ -97,10 +158,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, uint16_t port)
@@ -118,10 +176,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
       NS_LOG_WARN ("Duplicated endpoint.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
@@ -129,7 +184,30 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
+  endPoint->SetPeer (peerAddress, peerPort);
+
+  // the duplicates of a fully specified four-tuple are in the hash table,
+  // the others in the wildcard table
+  EndPoints candidates;
+  if (IsConnected (endPoint))
+    {
+      FourTuple tuple = {localAddress, peerAddress, localPort, peerPort};
+      auto range = m_connected.equal_range (tuple);
+      for (auto it = range.first; it != range.second; it++)
+        {
+          candidates.push_back (it->second);
+        }
+    }
+  else
+    {
+      auto wildcards = m_wildcards.find (localPort);
+      if (wildcards != m_wildcards.end ())
+        {
+          candidates = wildcards->second;
+        }
+    }
+  for (EndPointsI i = candidates.begin (); i != candidates.end (); i++)
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -138,30 +216,25 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
           ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
         {
           NS_LOG_WARN ("Duplicated endpoint.");
+          delete endPoint;
           return 0;
         }
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
-  endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (endPoint->m_demux != this)
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
     }
+  Unindex (endPoint);
+  m_endPoints.erase (endPoint->m_position);
+  endPoint->m_demux = 0;
+  delete endPoint;
 }
 
 /*
@@ -181,7 +254,38 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+
+  // An exact match on all 4 takes precedence over all the other matches:
+  // look for it in the hash table of the fully specified endpoints first,
+  // then among the endpoints of the port which are not fully specified
+  EndPoints candidates;
+  if (saddr != Ipv6Address::GetAny () && sport != 0)
+    {
+      FourTuple tuple = {daddr, saddr, dport, sport};
+      auto range = m_connected.equal_range (tuple);
+      for (auto it = range.first; it != range.second; it++)
+        {
+          Ipv6EndPoint* endP = it->second;
+          if (endP->IsRxEnabled ()
+              && (!endP->GetBoundNetDevice ()
+                  || (incomingInterface && endP->GetBoundNetDevice () == incomingInterface->GetDevice ())))
+            {
+              retval4.push_back (endP);
+            }
+        }
+      if (!retval4.empty ())
+        {
+          NS_ABORT_MSG_IF (retval4.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
+          return retval4;
+        }
+    }
+  auto wildcards = m_wildcards.find (dport);
+  if (wildcards != m_wildcards.end ())
+    {
+      candidates = wildcards->second;
+    }
+
+  for (EndPointsI i = candidates.begin (); i != candidates.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
 
@@ -290,6 +394,17 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+  if (dst != Ipv6Address::GetAny () && src != Ipv6Address::GetAny () && sport != 0)
+    {
+      FourTuple tuple = {dst, src, dport, sport};
+      auto it = m_connected.find (tuple);
+      if (it != m_connected.end ())
+        {
+          /* this is an exact match. */
+          return it->second;
+        }
+    }
+
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +35,16 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The endpoints whose four-tuple is fully specified (e.g., the endpoints of
+ * the established TCP connections) are indexed by a hash table, so that the
+ * packets of a connection are demultiplexed without scanning the list of
+ * the endpoints, and the other endpoints (e.g., those of the listening
+ * sockets) by local port in a wildcard table, which Lookup searches when
+ * there is no exact match.  The number of endpoints using each local port
+ * is counted, so that allocating an ephemeral port does not scan the list
+ * either.  The endpoints notify the demux when their local address, their
+ * local port or their peer changes.
  */
 class Ipv6EndPointDemux
 {
@@ -153,6 +164,73 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief The four-tuple of an endpoint
+   */
+  struct FourTuple
+  {
+    Ipv6Address localAddress;  //!< the local address
+    Ipv6Address peerAddress;   //!< the peer address
+    uint16_t localPort;        //!< the local port
+    uint16_t peerPort;         //!< the peer port
+
+    /**
+     * \param other the four-tuple to compare
+     * \return true if the four-tuples are equal
+     */
+    bool operator == (const FourTuple &other) const
+    {
+      return localAddress == other.localAddress && peerAddress == other.peerAddress
+             && localPort == other.localPort && peerPort == other.peerPort;
+    }
+  };
+
+  /**
+   * \brief Hash function of the four-tuples
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \param tuple the four-tuple
+     * \return the hash of the four-tuple
+     */
+    std::size_t operator () (const FourTuple &tuple) const
+    {
+      Ipv6AddressHash hash;
+      std::size_t h = hash (tuple.localAddress) * 31 + hash (tuple.peerAddress);
+      return h ^ ((static_cast<std::size_t> (tuple.localPort) << 16 | tuple.peerPort) * 0x9e3779b97f4a7c15ULL);
+    }
+  };
+
+  /**
+   * \brief Add an endpoint to the demux
+   * \param endPoint the endpoint
+   * \return the endpoint
+   */
+  Ipv6EndPoint *Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Count the local port of an endpoint and add the endpoint to the
+   * hash table if its four-tuple is fully specified, to the wildcard table
+   * otherwise
+   * \param endPoint the endpoint
+   */
+  void Index (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the hash table or the wildcard table
+   * \param endPoint the endpoint
+   */
+  void Unindex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \param endPoint the endpoint
+   * \return true if the four-tuple of the endpoint is fully specified
+   */
+  static bool IsConnected (Ipv6EndPoint *endPoint);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -178,6 +256,21 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points whose four-tuple is fully specified.
+   */
+  std::unordered_multimap<FourTuple, Ipv6EndPoint *, FourTupleHash> m_connected;
+
+  /**
+   * \brief The other end points, by local port.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_wildcards;
+
+  /**
+   * \brief The number of end points using each local port.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_ports;
 };
 
 } /* namespace ns3 */
@@ -17,9 +17,8 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/hash.h"
 #include "ipv6-queue-disc-item.h"
-#include "ns3/tcp-header.h"
-#include "ns3/udp-header.h"
 
 namespace ns3 {
 
@@ -29,7 +28,11 @@ Ipv6QueueDiscItem::Ipv6QueueDiscItem (Ptr<Packet> p, const Address& addr,
                                       uint16_t protocol, const Ipv6Header & header)
   : QueueDiscItem (p, addr, protocol),
     m_header (header),
-    m_headerAdded (false)
+    m_headerAdded (false),
+    m_tupleSerialized (false),
+    m_hashValid (false),
+    m_perturbation (0),
+    m_hash (0)
 {
 }
 
@@ -110,58 +113,75 @@ Ipv6QueueDiscItem::GetUint8Value (QueueItem::Uint8Values field, uint8_t& value)
   return ret;
 }
 
-uint32_t
-Ipv6QueueDiscItem::Hash (uint32_t perturbation) const
+void
+Ipv6QueueDiscItem::SerializeTuple (void) const
 {
-  NS_LOG_FUNCTION (this << perturbation);
+  NS_LOG_FUNCTION (this);
 
   Ipv6Address src = m_header.GetSource ();
   Ipv6Address dest = m_header.GetDestination ();
   uint8_t prot = m_header.GetNextHeader ();
 
-  TcpHeader tcpHdr;
-  UdpHeader udpHdr;
   uint16_t srcPort = 0;
   uint16_t destPort = 0;
 
-  if (prot == 6) // TCP
+  if (prot == 6 || prot == 17) // TCP or UDP
     {
-      GetPacket ()->PeekHeader (tcpHdr);
-      srcPort = tcpHdr.GetSourcePort ();
-      destPort = tcpHdr.GetDestinationPort ();
-    }
-  else if (prot == 17) // UDP
-    {
-      GetPacket ()->PeekHeader (udpHdr);
-      srcPort = udpHdr.GetSourcePort ();
-      destPort = udpHdr.GetDestinationPort ();
+      // Both headers start with the source and destination ports
+      uint32_t offset = m_headerAdded ? m_header.GetSerializedSize () : 0;
+      uint8_t buf[44];
+      NS_ASSERT (offset + 4 <= sizeof (buf));
+      if (GetPacket ()->CopyData (buf, offset + 4) == offset + 4)
+        {
+          srcPort = (buf[offset] << 8) | buf[offset + 1];
+          destPort = (buf[offset + 2] << 8) | buf[offset + 3];
+        }
     }
   if (prot != 6 && prot != 17)
     {
       NS_LOG_WARN ("Unknown transport protocol, no port number included in hash computation");
     }
 
-  /* serialize the 5-tuple and the perturbation in buf */
-  uint8_t buf[41];
-  src.Serialize (buf);
-  dest.Serialize (buf + 16);
-  buf[32] = prot;
-  buf[33] = (srcPort >> 8) & 0xff;
-  buf[34] = srcPort & 0xff;
-  buf[35] = (destPort >> 8) & 0xff;
-  buf[36] = destPort & 0xff;
-  buf[37] = (perturbation >> 24) & 0xff;
-  buf[38] = (perturbation >> 16) & 0xff;
-  buf[39] = (perturbation >> 8) & 0xff;
-  buf[40] = perturbation & 0xff;
+  /* serialize the 5-tuple in m_tuple, the perturbation is appended later */
+  src.Serialize (m_tuple);
+  dest.Serialize (m_tuple + 16);
+  m_tuple[32] = prot;
+  m_tuple[33] = (srcPort >> 8) & 0xff;
+  m_tuple[34] = srcPort & 0xff;
+  m_tuple[35] = (destPort >> 8) & 0xff;
+  m_tuple[36] = destPort & 0xff;
+  m_tupleSerialized = true;
+}
+
+uint32_t
+Ipv6QueueDiscItem::Hash (uint32_t perturbation) const
+{
+  NS_LOG_FUNCTION (this << perturbation);
+
+  if (m_hashValid && m_perturbation == perturbation)
+    {
+      return m_hash;
+    }
+
+  if (!m_tupleSerialized)
+    {
+      SerializeTuple ();
+    }
+
+  m_tuple[37] = (perturbation >> 24) & 0xff;
+  m_tuple[38] = (perturbation >> 16) & 0xff;
+  m_tuple[39] = (perturbation >> 8) & 0xff;
+  m_tuple[40] = perturbation & 0xff;
 
   // Linux calculates jhash2 (jenkins hash), we calculate murmur3 because it is
   // already available in ns-3
-  uint32_t hash = Hash32 ((char*) buf, 41);
+  m_hash = Hash32 ((char*) m_tuple, 41);
+  m_perturbation = perturbation;
+  m_hashValid = true;
 
-  NS_LOG_DEBUG ("Found Ipv6 packet; hash of the five tuple " << hash);
+  NS_LOG_DEBUG ("Found Ipv6 packet; hash of the five tuple " << m_hash);
 
-  return hash;
+  return m_hash;
 }
 
 } // namespace ns3
@@ -95,14 +95,27 @@ public:
    * number and, if the transport protocol is either UDP or TCP, the source
    * and destination port
    *
+   * As for Ipv4QueueDiscItem, the 5-tuple is extracted only once per item
+   * and the hash for the last perturbation value is cached.
+   *
    * \param perturbation hash perturbation value
    * \return the hash of the packet's 5-tuple
    */
   virtual uint32_t Hash (uint32_t perturbation) const;
 
 private:
+  /**
+   * \brief Serialize the 5-tuple of the packet in m_tuple.
+   */
+  void SerializeTuple (void) const;
+
   Ipv6Header m_header;  //!< The IPv6 header.
   bool m_headerAdded;   //!< True if the header has already been added to the packet.
+  mutable uint8_t m_tuple[41];          //!< The serialized 5-tuple, followed by the perturbation
+  mutable bool m_tupleSerialized;       //!< True if m_tuple holds the 5-tuple
+  mutable bool m_hashValid;             //!< True if m_hash is the hash for m_perturbation
+  mutable uint32_t m_perturbation;      //!< The perturbation of the cached hash
+  mutable uint32_t m_hash;              //!< The cached hash
 };
 
 } // namespace ns3
@@ -92,12 +92,20 @@ TcpL4Protocol::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TcpL4Protocol::m_sockets),
                    MakeObjectVectorChecker<TcpSocketBase> ())
+    .AddAttribute ("SocketTemplates",
+                   "Create the sockets as copies of a template socket of the same types, "
+                   "constructed on the first request, instead of constructing each socket; "
+                   "the attribute defaults of the sockets are then read only once.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpL4Protocol::m_useSocketTemplates),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 TcpL4Protocol::TcpL4Protocol ()
-  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ())
+  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ()),
+    m_useSocketTemplates (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -162,6 +170,7 @@ TcpL4Protocol::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_sockets.clear ();
+  m_socketTemplates.clear ();
 
   if (m_endPoints != 0)
     {
@@ -191,6 +200,29 @@ Ptr<Socket>
 TcpL4Protocol::CreateSocket (TypeId congestionTypeId, TypeId recoveryTypeId)
 {
   NS_LOG_FUNCTION (this << congestionTypeId.GetName ());
+  if (m_useSocketTemplates)
+    {
+      Ptr<TcpSocketBase> &socketTemplate =
+        m_socketTemplates[std::make_tuple (congestionTypeId, recoveryTypeId, m_rttTypeId)];
+      if (socketTemplate == 0)
+        {
+          socketTemplate = CreateSocketBase (congestionTypeId, recoveryTypeId);
+        }
+      // a closed socket is copied the way a listening socket is forked
+      Ptr<TcpSocketBase> socket = CopyObject<TcpSocketBase> (socketTemplate);
+      m_sockets.push_back (socket);
+      return socket;
+    }
+
+  Ptr<TcpSocketBase> socket = CreateSocketBase (congestionTypeId, recoveryTypeId);
+  m_sockets.push_back (socket);
+  return socket;
+}
+
+Ptr<TcpSocketBase>
+TcpL4Protocol::CreateSocketBase (TypeId congestionTypeId, TypeId recoveryTypeId)
+{
+  NS_LOG_FUNCTION (this << congestionTypeId.GetName () << recoveryTypeId.GetName ());
   ObjectFactory rttFactory;
   ObjectFactory congestionAlgorithmFactory;
   ObjectFactory recoveryAlgorithmFactory;
@@ -209,7 +241,6 @@ TcpL4Protocol::CreateSocket (TypeId congestionTypeId, TypeId recoveryTypeId)
   socket->SetCongestionControlAlgorithm (algo);
   socket->SetRecoveryAlgorithm (recovery);
 
-  m_sockets.push_back (socket);
   return socket;
 }
 
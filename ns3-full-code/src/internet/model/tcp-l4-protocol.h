@@ -22,6 +22,8 @@
 #define TCP_L4_PROTOCOL_H
 
 #include <stdint.h>
+#include <map>
+#include <tuple>
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
@@ -72,6 +74,15 @@ class NetDevice;
  * and SHOULD checksum packets its receives from the socket layer going down
  * the stack, but currently checksumming is disabled.
  *
+ * With the SocketTemplates attribute, CreateSocket creates the sockets as
+ * copies of a template socket of the same congestion control, recovery and
+ * RTT estimator types, constructed on the first request, the way a listening
+ * socket forks the sockets of its connections.  Copying a socket is cheaper
+ * than constructing it and its components and initializing their
+ * attributes, which matters when a simulation opens many short
+ * connections; however the attribute defaults (see Config::SetDefault) are
+ * then read only when the template is created.
+ *
  * \see CreateSocket
  * \see NotifyNewAggregate
  * \see SendPacket
@@ -325,9 +336,21 @@ private:
   TypeId m_congestionTypeId;       //!< The socket TypeId
   TypeId m_recoveryTypeId;         //!< The recovery TypeId
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
+  bool m_useSocketTemplates;       //!< Create the sockets by copying a template
+  /// The template sockets, by congestion control, recovery and RTT estimator TypeIds
+  std::map<std::tuple<TypeId, TypeId, TypeId>, Ptr<TcpSocketBase> > m_socketTemplates;
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
 
+  /**
+   * \brief Construct a TCP socket and its components
+   *
+   * \param congestionTypeId the congestion control algorithm TypeId
+   * \param recoveryTypeId the recovery algorithm TypeId
+   * \return the socket
+   */
+  Ptr<TcpSocketBase> CreateSocketBase (TypeId congestionTypeId, TypeId recoveryTypeId);
+
   /**
    * \brief Send a packet via TCP (IPv4)
    *
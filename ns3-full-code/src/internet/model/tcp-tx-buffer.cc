@@ -58,7 +58,8 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_lostFrontier (n), m_rxtFrontier (n)
 {
   m_rWndCallback = MakeNullCallback<uint32_t> ();
 }
@@ -174,6 +175,8 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostFrontier = seq;
+  m_rxtFrontier = seq;
 }
 
 bool
@@ -296,7 +299,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  m_sentIndex[item->m_startSeq] = m_sentList.insert (m_sentList.end (), item);
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -310,36 +313,33 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  auto index = m_sentIndex.find (seq);
+  if (index != m_sentIndex.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      auto it = index->second;
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked and have the same value for m_lost ... there is the possibility to merge
+          if ((! (*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
             {
-              // Next is not sacked and have the same value for m_lost ... there is the possibility to merge
-              if ((! (*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
@@ -349,8 +349,14 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
     {
       m_retrans += item->m_packet->GetSize ();
       item->m_retrans = true;
+      if (item->m_lost)
+        {
+          m_lostRetrans += item->m_packet->GetSize ();
+        }
     }
 
+  AdvanceRxtFrontier ();
+
   return item;
 }
 
@@ -376,6 +382,25 @@ TcpTxBuffer::FindHighestSacked () const
   return ret;
 }
 
+TcpTxBuffer::PacketList::iterator
+TcpTxBuffer::FindSentItem (const SequenceNumber32 &seq) const
+{
+  NS_ASSERT (!m_sentIndex.empty ());
+  auto index = m_sentIndex.upper_bound (seq);
+  NS_ASSERT (index != m_sentIndex.begin ());
+  return (--index)->second;
+}
+
+TcpTxBuffer::PacketList::const_iterator
+TcpTxBuffer::LowerBoundSentItem (const SequenceNumber32 &seq) const
+{
+  auto index = m_sentIndex.lower_bound (seq);
+  if (index == m_sentIndex.end ())
+    {
+      return m_sentList.end ();
+    }
+  return index->second;
+}
 
 void
 TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
@@ -400,7 +425,7 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
 TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
-                                bool *listEdited) const
+                                bool *listEdited)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -436,12 +461,20 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   TcpTxItem *outItem = nullptr;
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+  bool isSentList = (&list == &m_sentList);
+
+  if (isSentList && !m_sentIndex.empty () && seq >= listStartFrom)
+    {
+      // Jump to the item containing seq, the walk would arrive there anyway
+      it = FindSentItem (seq);
+      beginOfCurrentPacket = (*it)->m_startSeq;
+    }
 
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (!isSentList || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -471,7 +504,12 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              auto firstPartIt = list.insert (it, firstPart);
+              if (isSentList)
+                {
+                  m_sentIndex[firstPart->m_startSeq] = firstPartIt;
+                  m_sentIndex[currentItem->m_startSeq] = it;
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -518,6 +556,10 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                   TcpTxItem *previous = *(--it);
 
                   list.erase (it);
+                  if (isSentList)
+                    {
+                      m_sentIndex.erase (currentItem->m_startSeq);
+                    }
 
                   MergeItems (previous, currentItem);
                   delete currentItem;
@@ -537,7 +579,12 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               SplitItems (firstPart, currentItem, numBytes);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              auto firstPartIt = list.insert (it, firstPart);
+              if (isSentList)
+                {
+                  m_sentIndex[firstPart->m_startSeq] = firstPartIt;
+                  m_sentIndex[currentItem->m_startSeq] = it;
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -567,6 +614,10 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
 
           MergeItems (currentItem, next);
           list.erase (it);
+          if (isSentList)
+            {
+              m_sentIndex.erase (next->m_startSeq);
+            }
 
           delete next;
 
@@ -580,6 +631,7 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
     }
 
   NS_FATAL_ERROR ("This point is not reachable");
+  return nullptr; // silence compiler warning
 }
 
 void
@@ -599,18 +651,20 @@ TcpTxBuffer::MergeItems (TcpTxItem *t1, TcpTxItem *t2) const
   // be updated in MarkTransmittedSegment.
   if (t1->m_retrans != t2->m_retrans)
     {
-      if (t1->m_retrans)
+      TcpTxBuffer *self = const_cast<TcpTxBuffer*> (this);
+      TcpTxItem *retransItem = t1->m_retrans ? t1 : t2;
+      NS_ASSERT (retransItem->m_retrans);
+      self->m_retrans -= retransItem->m_packet->GetSize ();
+      if (retransItem->m_lost)
         {
-          TcpTxBuffer *self = const_cast<TcpTxBuffer*> (this);
-          self->m_retrans -= t1->m_packet->GetSize ();
-          t1->m_retrans = false;
+          self->m_lostRetrans -= retransItem->m_packet->GetSize ();
         }
-      else
+      retransItem->m_retrans = false;
+
+      // The merged item is not retransmitted anymore
+      if (self->m_rxtFrontier > t1->m_startSeq)
         {
-          NS_ASSERT (t2->m_retrans);
-          TcpTxBuffer *self = const_cast<TcpTxBuffer*> (this);
-          self->m_retrans -= t2->m_packet->GetSize ();
-          t2->m_retrans = false;
+          self->m_rxtFrontier = t1->m_startSeq;
         }
     }
 
@@ -644,22 +698,26 @@ TcpTxBuffer::RemoveFromCounts (TcpTxItem *item, uint32_t size)
                      " bytes from " << m_lostOut);
       m_lostOut -= size;
     }
+  if (item->m_lost && item->m_retrans)
+    {
+      NS_ASSERT (m_lostRetrans >= size);
+      m_lostRetrans -= size;
+    }
 }
 
 bool
 TcpTxBuffer::IsRetransmittedDataAcked (const SequenceNumber32& ack) const
 {
   NS_LOG_FUNCTION (this);
-  for (const auto &it : m_sentList)
-     {
-       TcpTxItem *item = it;
-       Ptr<Packet> p = item->m_packet;
-       if (item->m_startSeq + p->GetSize () == ack && !item->m_sacked && item->m_retrans)
-         {
-           return true;
-         }
-     }
-  return false;
+  // The only candidate is the item which ends just before ack
+  auto it = LowerBoundSentItem (ack);
+  if (it == m_sentList.begin ())
+    {
+      return false;
+    }
+  TcpTxItem *item = *(--it);
+  Ptr<Packet> p = item->m_packet;
+  return item->m_startSeq + p->GetSize () == ack && !item->m_sacked && item->m_retrans;
 }
 
 void
@@ -707,6 +765,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
 
           RemoveFromCounts (item, pktSize);
 
+          m_sentIndex.erase (item->m_startSeq);
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
                        " retrans: " << m_retrans << " sacked: " << m_sackedOut <<
@@ -726,7 +785,9 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
           NS_LOG_INFO (*item);
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
+          m_sentIndex.erase (item->m_startSeq);
           item->m_startSeq += offset;
+          m_sentIndex[item->m_startSeq] = i;
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -756,6 +817,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
           // when adding Reno dupacks in the count.
           head->m_sacked = false;
           m_sackedOut -= head->m_packet->GetSize ();
+          m_rxtFrontier = m_firstByteSeq;
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
           MarkHeadAsLost ();
@@ -771,6 +833,18 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
       m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
     }
 
+  // Do not let the frontier fall behind SND.UNA, where the sequence numbers
+  // can wrap around
+  if (m_lostFrontier < m_firstByteSeq)
+    {
+      m_lostFrontier = m_firstByteSeq;
+    }
+  if (m_rxtFrontier < m_firstByteSeq)
+    {
+      m_rxtFrontier = m_firstByteSeq;
+      AdvanceRxtFrontier ();
+    }
+
   NS_LOG_DEBUG ("Discarded up to " << seq << " lost: " << m_lostOut <<
                 " retrans: " << m_retrans << " sacked: " << m_sackedOut);
   NS_LOG_LOGIC ("Buffer status after discarding data " << *this);
@@ -790,15 +864,20 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return bytesSacked;
         }
 
+      // Only the items starting inside the block can be sacked
+      PacketList::const_iterator item_it = LowerBoundSentItem ((*option_it).first);
+      if (item_it == m_sentList.end ())
+        {
+          continue;
+        }
+      SequenceNumber32 beginOfCurrentPacket = (*item_it)->m_startSeq;
+
       while (item_it != m_sentList.end ())
         {
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
@@ -824,6 +903,10 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
                     {
                       (*item_it)->m_lost = false;
                       m_lostOut -= (*item_it)->m_packet->GetSize ();
+                      if ((*item_it)->m_retrans)
+                        {
+                          m_lostRetrans -= (*item_it)->m_packet->GetSize ();
+                        }
                     }
 
                   (*item_it)->m_sacked = true;
@@ -865,6 +948,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
     {
       NS_ASSERT_MSG (m_highestSack.first != m_sentList.end(), "Buffer status: " << *this);
       UpdateLostCount ();
+      AdvanceRxtFrontier ();
     }
 
   NS_ASSERT ((*(m_sentList.begin ()))->m_sacked == false);
@@ -880,7 +964,6 @@ TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
   uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
   if (m_highestSack.first == m_sentList.end ())
     {
       NS_LOG_INFO ("Status before the update: " << *this <<
@@ -892,7 +975,8 @@ TcpTxBuffer::UpdateLostCount ()
                    ", will start from item " << *(*m_highestSack.first));
     }
 
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  auto it = m_highestSack.first;
+  for (; it != m_sentList.begin(); --it)
     {
       TcpTxItem *item = *it;
       if (item->m_sacked)
@@ -902,62 +986,92 @@ TcpTxBuffer::UpdateLostCount ()
 
       if (sacked >= m_dupAckThresh)
         {
+          break;
+        }
+    }
+
+  if (sacked >= m_dupAckThresh)
+    {
+      // Everything below this item is lost, unless sacked. Below the
+      // frontier, the previous updates have already marked it.
+      SequenceNumber32 frontier = (*it)->m_startSeq;
+      for (; it != m_sentList.begin () && (*it)->m_startSeq >= m_lostFrontier; --it)
+        {
+          TcpTxItem *item = *it;
           if (!item->m_sacked && !item->m_lost)
             {
               item->m_lost = true;
               m_lostOut += item->m_packet->GetSize ();
+              if (item->m_retrans)
+                {
+                  m_lostRetrans += item->m_packet->GetSize ();
+                }
             }
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
-    }
+      if (m_lostFrontier < frontier)
+        {
+          m_lostFrontier = frontier;
+        }
 
-  if (sacked >= m_dupAckThresh)
-    {
       TcpTxItem *item = *m_sentList.begin ();
       if (!item->m_lost)
         {
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
+          if (item->m_retrans)
+            {
+              m_lostRetrans += item->m_packet->GetSize ();
+            }
         }
     }
   NS_LOG_INFO ("Status after the update: " << *this);
   ConsistencyCheck ();
 }
 
+void
+TcpTxBuffer::AdvanceRxtFrontier ()
+{
+  NS_LOG_FUNCTION (this);
+  auto it = LowerBoundSentItem (m_rxtFrontier);
+  while (it != m_sentList.end () && ((*it)->m_sacked || (*it)->m_retrans))
+    {
+      ++it;
+    }
+
+  if (it == m_sentList.end ())
+    {
+      m_rxtFrontier = m_firstByteSeq + m_sentSize;
+    }
+  else
+    {
+      m_rxtFrontier = (*it)->m_startSeq;
+    }
+}
+
 bool
 TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Start from the first item that begins at, or after, seq
+  for (auto it = LowerBoundSentItem (seq); it != m_sentList.end (); ++it)
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
+      if ((*it)->m_lost == true)
         {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
+          NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+          return true;
         }
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      if ((*it)->m_sacked == true)
+        {
+          NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+          return false;
+        }
     }
 
   return false;
@@ -985,9 +1099,18 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, SequenceNumber32 *seqHigh, bool isR
   TcpTxItem *item;
   SequenceNumber32 seqPerRule3;
   bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  uint32_t lostSeen = 0;
+  NS_ASSERT (m_lostOut >= m_lostRetrans);
+  uint32_t lostToRetransmit = m_lostOut - m_lostRetrans;
+
+  // The items below the rule (3) frontier are sacked or retransmitted, and
+  // none of the rules can pick them. Once all the lost bytes not yet
+  // retransmitted have been walked, rule (1) cannot match anymore, and the
+  // walk can stop as soon as rule (3) is not waiting for a candidate.
+  for (it = LowerBoundSentItem (m_rxtFrontier);
+       it != m_sentList.end ()
+       && (lostSeen < lostToRetransmit || (isRecovery && !isSeqPerRule3Valid));
+       ++it)
     {
       item = *it;
 
@@ -996,21 +1119,24 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, SequenceNumber32 *seqHigh, bool isR
         {
           if (item->m_lost)
             {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
+              NS_LOG_INFO("IsLost, returning" << item->m_startSeq);
+              *seq = item->m_startSeq;
               *seqHigh = *seq + m_segmentSize;
               return true;
             }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
+          else if (!isSeqPerRule3Valid && isRecovery)
             {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
+              NS_LOG_INFO ("Saving for rule 3 the seq " << item->m_startSeq);
               isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
+              seqPerRule3 = item->m_startSeq;
             }
         }
 
       // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      if (item->m_lost && !item->m_retrans)
+        {
+          lostSeen += item->m_packet->GetSize ();
+        }
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1224,6 +1350,9 @@ TcpTxBuffer::ResetRenoSack ()
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostFrontier = m_firstByteSeq;
+  m_rxtFrontier = m_firstByteSeq;
+  AdvanceRxtFrontier ();
 }
 
 void
@@ -1248,9 +1377,13 @@ TcpTxBuffer::ResetSentList ()
       m_sentList.pop_back ();
     }
 
+  m_sentIndex.clear ();
+  m_lostFrontier = m_firstByteSeq;
+  m_rxtFrontier = m_firstByteSeq;
   m_sentSize = 0;
   m_lostOut = 0;
   m_retrans = 0;
+  m_lostRetrans = 0;
   m_sackedOut = 0;
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
 }
@@ -1264,10 +1397,23 @@ TcpTxBuffer::ResetLastSegmentSent ()
       TcpTxItem *item = m_sentList.back ();
 
       m_sentList.pop_back ();
+      m_sentIndex.erase (item->m_startSeq);
+      if (m_lostFrontier > item->m_startSeq)
+        {
+          m_lostFrontier = item->m_startSeq;
+        }
+      if (m_rxtFrontier > item->m_startSeq)
+        {
+          m_rxtFrontier = item->m_startSeq;
+        }
       m_sentSize -= item->m_packet->GetSize ();
       if (item->m_retrans)
         {
           m_retrans -= item->m_packet->GetSize ();
+          if (item->m_lost)
+            {
+              m_lostRetrans -= item->m_packet->GetSize ();
+            }
         }
       m_appList.insert (m_appList.begin (), item);
     }
@@ -1279,6 +1425,9 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
 {
   NS_LOG_FUNCTION (this);
   m_retrans = 0;
+  m_lostRetrans = 0;
+  // The head is not sacked, and nothing is retransmitted anymore
+  m_rxtFrontier = m_firstByteSeq;
 
   if (resetSack)
     {
@@ -1348,6 +1497,11 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
     {
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      if (m_sentList.front ()->m_lost)
+        {
+          m_lostRetrans -= m_sentList.front ()->m_packet->GetSize ();
+        }
+      m_rxtFrontier = m_firstByteSeq;
     }
   ConsistencyCheck ();
 }
@@ -1370,8 +1524,15 @@ TcpTxBuffer::MarkHeadAsLost ()
         {
           m_sentList.front ()->m_retrans = false;
           m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+          if (m_sentList.front ()->m_lost)
+            {
+              m_lostRetrans -= m_sentList.front ()->m_packet->GetSize ();
+            }
         }
 
+      // The head is neither sacked nor retransmitted anymore
+      m_rxtFrontier = m_firstByteSeq;
+
       if (! m_sentList.front()->m_lost)
         {
           m_sentList.front()->m_lost = true;
@@ -1412,6 +1573,7 @@ TcpTxBuffer::AddRenoSack (void)
       (*it)->m_sacked = true;
       m_sackedOut += (*it)->m_packet->GetSize ();
       m_highestSack = std::make_pair (it, (*it)->m_startSeq);
+      AdvanceRxtFrontier ();
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
     }
   else
@@ -1436,9 +1598,14 @@ TcpTxBuffer::ConsistencyCheck () const
   uint32_t sacked = 0;
   uint32_t lost = 0;
   uint32_t retrans = 0;
+  uint32_t lostRetrans = 0;
 
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
+      if ((*it)->m_lost && (*it)->m_retrans)
+        {
+          lostRetrans += (*it)->m_packet->GetSize ();
+        }
       if ((*it)->m_sacked)
         {
           sacked += (*it)->m_packet->GetSize ();
@@ -1459,6 +1626,23 @@ TcpTxBuffer::ConsistencyCheck () const
                  " stored lost: " << m_lostOut);
   NS_ASSERT_MSG (retrans == m_retrans, " Counted retrans: " << retrans <<
                  " stored retrans: " << m_retrans);
+  NS_ASSERT_MSG (lostRetrans == m_lostRetrans, " Counted lost retrans: " << lostRetrans <<
+                 " stored lost retrans: " << m_lostRetrans);
+
+  NS_ASSERT_MSG (m_sentIndex.size () == m_sentList.size (), "Index size: " <<
+                 m_sentIndex.size () << " list size: " << m_sentList.size ());
+  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+    {
+      auto index = m_sentIndex.find ((*it)->m_startSeq);
+      NS_ASSERT_MSG (index != m_sentIndex.end () && index->second == it,
+                     "Item " << *(*it) << " is not indexed");
+      NS_ASSERT_MSG (it == m_sentList.begin () || (*it)->m_startSeq >= m_lostFrontier
+                     || (*it)->m_sacked || (*it)->m_lost,
+                     "Item " << *(*it) << " below " << m_lostFrontier << " is neither sacked nor lost");
+      NS_ASSERT_MSG ((*it)->m_startSeq >= m_rxtFrontier
+                     || (*it)->m_sacked || (*it)->m_retrans,
+                     "Item " << *(*it) << " below " << m_rxtFrontier << " is neither sacked nor retransmitted");
+    }
 }
 
 std::ostream &
@@ -22,6 +22,8 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <map>
+
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -73,6 +75,15 @@ class Packet;
  * documentation) and maintaining the scoreboard is a matter of travelling the
  * list and set the SACK flag on the corresponding segment sent.
  *
+ * The items of the SentList are also indexed by their starting sequence
+ * number, so that a SACK block, a lost sequence or an ACK are located in the
+ * list without walking it from the head. The lost marking only visits the
+ * segments not examined by the previous update. NextSeg starts from the first
+ * segment which is neither sacked nor retransmitted (the rule (3) frontier),
+ * and stops as soon as the answer cannot change. Hence, the cost of
+ * processing an ACK does not depend on the number of segments in flight,
+ * also in recovery.
+ *
  * Item properties
  * ---------------
  *
@@ -312,6 +323,11 @@ public:
   /**
    * \brief Get the next sequence number to transmit, according to RFC 6675
    *
+   * The SentList is walked from m_rxtFrontier, since the items below it
+   * are either sacked or retransmitted and cannot be returned, until all the
+   * lost bytes not yet retransmitted have been seen and, in recovery, until
+   * a segment eligible for rule (3) has been found.
+   *
    * \param seq Next sequence number to transmit, based on the scoreboard information
    * \param seqHigh Maximum sequence number to transmit, based on SMSS and/or receiver window
    * \param isRecovery true if the socket congestion state is in recovery mode
@@ -427,12 +443,22 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. Since every segment below m_lostFrontier
+   * which is not sacked is already lost, the walk stops there instead of
+   * reaching the head of the list.
    *
    */
   void UpdateLostCount ();
 
+  /**
+   * \brief Move m_rxtFrontier past the sacked or retransmitted items
+   *
+   * It is called after an item has been sacked or retransmitted. The items
+   * are walked from the current frontier, so each of them is passed once
+   * until a reset moves the frontier back.
+   */
+  void AdvanceRxtFrontier ();
+
   /**
    * \brief Remove the size specified from the lostOut, retrans, sacked count
    *
@@ -561,7 +587,7 @@ private:
    */
   TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
-                                bool *listEdited = nullptr) const;
+                                bool *listEdited = nullptr);
 
   /**
    * \brief Merge two TcpTxItem
@@ -600,8 +626,23 @@ private:
   std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
   FindHighestSacked () const;
 
+  /**
+   * \brief Find the item of the SentList which contains a sequence
+   * \param seq Sequence, which should be inside the SentList
+   * \return an iterator to the item containing seq
+   */
+  PacketList::iterator FindSentItem (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Find the first item of the SentList starting at, or after, a sequence
+   * \param seq Sequence
+   * \return an iterator to the item, or the end of the SentList
+   */
+  PacketList::const_iterator LowerBoundSentItem (const SequenceNumber32 &seq) const;
+
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
+  std::map<SequenceNumber32, PacketList::iterator> m_sentIndex; //!< Items of the SentList, by starting sequence
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
   uint32_t m_size;       //!< Size of all data in this buffer
   uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
@@ -609,10 +650,13 @@ private:
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
+  SequenceNumber32 m_lostFrontier; //!< Items starting below it are either sacked or lost
+  SequenceNumber32 m_rxtFrontier;  //!< Items starting below it are either sacked or retransmitted
 
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
   uint32_t m_retrans   {0}; //!< Number of retransmitted bytes
+  uint32_t m_lostRetrans {0}; //!< Number of lost bytes which have been retransmitted
 
   uint32_t m_dupAckThresh {0}; //!< Duplicate Ack threshold from TcpSocketBase
   uint32_t m_segmentSize {0}; //!< Segment size from TcpSocketBase
@@ -0,0 +1,548 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-interface.h"
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * The endpoint which Ipv4EndPointDemux::Lookup returns, found by scanning
+ * all the endpoints like the demux did before it indexed them
+ *
+ * \param endPoints all the endpoints
+ * \param daddr destination address
+ * \param dport destination port
+ * \param saddr source address
+ * \param sport source port
+ * \param incomingInterface the incoming interface
+ * \return the most exact matches
+ */
+Ipv4EndPointDemux::EndPoints
+ReferenceLookup (Ipv4EndPointDemux::EndPoints endPoints,
+                 Ipv4Address daddr, uint16_t dport, Ipv4Address saddr, uint16_t sport,
+                 Ptr<Ipv4Interface> incomingInterface)
+{
+  Ipv4EndPointDemux::EndPoints retval[4];
+  for (Ipv4EndPoint *endP : endPoints)
+    {
+      if (!endP->IsRxEnabled () || endP->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      if (endP->GetBoundNetDevice () && endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+        {
+          continue;
+        }
+      bool localExact = endP->GetLocalAddress () == daddr;
+      bool localWildCard = endP->GetLocalAddress () == Ipv4Address::GetAny ();
+      if (!localExact && !localWildCard)
+        {
+          for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+            {
+              Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+              Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+              if (endP->GetLocalAddress () == addrNetpart
+                  && addrNetpart == daddr.CombineMask (addr.GetMask ()))
+                {
+                  localWildCard = true;
+                }
+            }
+          if (!localWildCard)
+            {
+              continue;
+            }
+        }
+      bool peerPortExact = endP->GetPeerPort () == sport;
+      bool peerPortWildCard = endP->GetPeerPort () == 0;
+      bool peerAddressExact = endP->GetPeerAddress () == saddr;
+      bool peerAddressWildCard = endP->GetPeerAddress () == Ipv4Address::GetAny ();
+      if (!(peerPortExact || peerPortWildCard) || !(peerAddressExact || peerAddressWildCard))
+        {
+          continue;
+        }
+      if (localExact && peerAddressExact && peerPortExact)
+        {
+          retval[3].push_back (endP);
+        }
+      if (localWildCard && peerAddressExact && peerPortExact)
+        {
+          retval[2].push_back (endP);
+        }
+      if (localExact && peerAddressWildCard && peerPortWildCard)
+        {
+          retval[1].push_back (endP);
+        }
+      if (localWildCard && peerAddressWildCard && peerPortWildCard)
+        {
+          retval[0].push_back (endP);
+        }
+    }
+  for (int i = 3; i > 0; i--)
+    {
+      if (!retval[i].empty ())
+        {
+          return retval[i];
+        }
+    }
+  return retval[0];
+}
+
+/**
+ * The endpoint which Ipv6EndPointDemux::Lookup returns, found by scanning
+ * all the endpoints like the demux did before it indexed them
+ *
+ * \param endPoints all the endpoints
+ * \param daddr destination address
+ * \param dport destination port
+ * \param saddr source address
+ * \param sport source port
+ * \return the most exact matches
+ */
+Ipv6EndPointDemux::EndPoints
+ReferenceLookup (Ipv6EndPointDemux::EndPoints endPoints,
+                 Ipv6Address daddr, uint16_t dport, Ipv6Address saddr, uint16_t sport)
+{
+  Ipv6EndPointDemux::EndPoints retval[4];
+  for (Ipv6EndPoint *endP : endPoints)
+    {
+      if (!endP->IsRxEnabled () || endP->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      bool localWildCard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
+      bool localExact = endP->GetLocalAddress () == daddr;
+      if (!localExact && !localWildCard)
+        {
+          continue;
+        }
+      bool peerPortExact = endP->GetPeerPort () == sport;
+      bool peerPortWildCard = endP->GetPeerPort () == 0;
+      bool peerAddressExact = endP->GetPeerAddress () == saddr;
+      bool peerAddressWildCard = endP->GetPeerAddress () == Ipv6Address::GetAny ();
+      if (!(peerPortExact || peerPortWildCard) || !(peerAddressExact || peerAddressWildCard))
+        {
+          continue;
+        }
+      if (localWildCard && peerPortWildCard && peerAddressWildCard)
+        {
+          retval[0].push_back (endP);
+        }
+      if (localExact && peerPortWildCard && peerAddressWildCard)
+        {
+          retval[1].push_back (endP);
+        }
+      if (localWildCard && peerPortExact && peerAddressExact)
+        {
+          retval[2].push_back (endP);
+        }
+      if (localExact && peerPortExact && peerAddressExact)
+        {
+          retval[3].push_back (endP);
+        }
+    }
+  for (int i = 3; i > 0; i--)
+    {
+      if (!retval[i].empty ())
+        {
+          return retval[i];
+        }
+    }
+  return retval[0];
+}
+
+} // unnamed namespace
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the binding semantics of Ipv4EndPointDemux: duplicate
+ * bindings, the precedence of the matches, and the endpoints whose peer
+ * is set or which are removed after their allocation.
+ */
+class Ipv4EndPointDemuxBindTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxBindTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxBindTestCase::Ipv4EndPointDemuxBindTestCase ()
+  : TestCase ("Check the binding semantics of Ipv4EndPointDemux")
+{
+}
+
+void
+Ipv4EndPointDemuxBindTestCase::DoRun (void)
+{
+  Ipv4EndPointDemux demux;
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("255.255.255.0")));
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+  Ipv4Address other ("10.0.0.3");
+
+  Ipv4EndPoint *any = demux.Allocate (0, Ipv4Address::GetAny (), 80);
+  NS_TEST_ASSERT_MSG_NE (any, 0, "Binding to a free port should succeed");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, Ipv4Address::GetAny (), 80), 0, "Duplicated binding");
+  Ipv4EndPoint *specific = demux.Allocate (0, local, 80);
+  NS_TEST_ASSERT_MSG_NE (specific, 0, "Binding to another address should succeed");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, local, 80), 0, "Duplicated binding");
+  Ipv4EndPoint *connected = demux.Allocate (0, local, 80, peer, 1000);
+  NS_TEST_ASSERT_MSG_NE (connected, 0, "The endpoint of a connection should be allocated");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, local, 80, peer, 1000), 0, "Duplicated connection");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), true, "The port is used");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (81), false, "The port is not used");
+
+  // the most exact match wins
+  Ipv4EndPointDemux::EndPoints found = demux.Lookup (local, 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "One endpoint should match");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), connected, "The connection should match");
+  found = demux.Lookup (local, 80, peer, 1001, interface);
+  NS_TEST_ASSERT_MSG_EQ ((found.size () == 1 && found.front () == specific), true,
+                         "The endpoint bound to the address should match");
+  found = demux.Lookup (Ipv4Address ("10.0.0.255"), 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ ((found.size () == 1 && found.front () == any), true,
+                         "The endpoint bound to any address should match");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 1000), connected, "The connection should match");
+
+  // a disabled endpoint does not receive packets
+  connected->SetRxEnabled (false);
+  found = demux.Lookup (local, 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ ((found.size () == 1 && found.front () == specific), true,
+                         "A disabled endpoint should not match");
+  connected->SetRxEnabled (true);
+
+  // an endpoint connected after its allocation (e.g., by a UDP socket)
+  Ipv4EndPoint *udp = demux.Allocate (local);
+  uint16_t port = udp->GetLocalPort ();
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), true, "The ephemeral port is used");
+  NS_TEST_ASSERT_MSG_NE (demux.Allocate (local)->GetLocalPort (), port, "The ephemeral port should not be reused");
+  udp->SetPeer (peer, 53);
+  found = demux.Lookup (local, port, peer, 53, interface);
+  NS_TEST_ASSERT_MSG_EQ ((found.size () == 1 && found.front () == udp), true,
+                         "The connected endpoint should match");
+  found = demux.Lookup (local, port, other, 53, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.empty (), true, "The connected endpoint should not match another peer");
+  udp->SetPeer (Ipv4Address::GetAny (), 0);
+  found = demux.Lookup (local, port, other, 53, interface);
+  NS_TEST_ASSERT_MSG_EQ ((found.size () == 1 && found.front () == udp), true,
+                         "The disconnected endpoint should match any peer");
+
+  // a subnet-directed endpoint
+  Ipv4EndPoint *subnet = demux.Allocate (0, Ipv4Address ("10.0.0.0"), 90, peer, 1000);
+  found = demux.Lookup (Ipv4Address ("10.0.0.255"), 90, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ ((found.size () == 1 && found.front () == subnet), true,
+                         "The endpoint bound to the network should match a broadcast packet");
+
+  // removing the endpoints
+  demux.DeAllocate (connected);
+  found = demux.Lookup (local, 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ ((found.size () == 1 && found.front () == specific), true,
+                         "The removed connection should not match");
+  NS_TEST_ASSERT_MSG_NE (demux.Allocate (0, local, 80, peer, 1000), 0,
+                         "The connection should be allocated again");
+  demux.DeAllocate (subnet);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (90), false, "The port is no longer used");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetAllEndPoints ().size (), 5, "Wrong number of endpoints");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that Ipv4EndPointDemux and Ipv6EndPointDemux find the same
+ * endpoints as a scan of all the endpoints, after random sequences of
+ * allocations, removals and changes of the endpoints.
+ */
+class EndPointDemuxRandomTestCase : public TestCase
+{
+public:
+  EndPointDemuxRandomTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Run the IPv4 operations
+  void RunIpv4 (void);
+  /// Run the IPv6 operations
+  void RunIpv6 (void);
+
+  Ptr<UniformRandomVariable> m_uv;  //!< random variable
+};
+
+EndPointDemuxRandomTestCase::EndPointDemuxRandomTestCase ()
+  : TestCase ("Check that the demuxes find the same endpoints as a scan")
+{
+}
+
+void
+EndPointDemuxRandomTestCase::RunIpv4 (void)
+{
+  Ipv4EndPointDemux demux;
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("255.255.255.0")));
+  interface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.0.1.1"), Ipv4Mask ("255.255.255.0")));
+  std::vector<Ipv4Address> locals {Ipv4Address::GetAny (), Ipv4Address ("10.0.0.1"),
+                                   Ipv4Address ("10.0.1.1"), Ipv4Address ("10.0.0.0")};
+  std::vector<Ipv4Address> destinations {Ipv4Address ("10.0.0.1"), Ipv4Address ("10.0.1.1"),
+                                         Ipv4Address ("10.0.0.255"), Ipv4Address ("10.0.2.1")};
+  std::vector<Ipv4Address> peers {Ipv4Address::GetAny (), Ipv4Address ("10.0.0.2"),
+                                  Ipv4Address ("10.0.0.3")};
+  std::vector<uint16_t> ports {80, 81, 49153};
+  std::vector<uint16_t> peerPorts {0, 1000, 1001};
+
+  uint32_t lookups = 0;
+  for (uint32_t step = 0; step < 3000; step++)
+    {
+      Ipv4EndPointDemux::EndPoints all = demux.GetAllEndPoints ();
+      Ipv4EndPoint *endPoint = 0;
+      if (!all.empty ())
+        {
+          auto it = all.begin ();
+          std::advance (it, m_uv->GetInteger (0, all.size () - 1));
+          endPoint = *it;
+        }
+      Ipv4Address local = locals[m_uv->GetInteger (0, locals.size () - 1)];
+      Ipv4Address peer = peers[m_uv->GetInteger (0, peers.size () - 1)];
+      uint16_t port = ports[m_uv->GetInteger (0, ports.size () - 1)];
+      uint16_t peerPort = peerPorts[m_uv->GetInteger (0, peerPorts.size () - 1)];
+      switch (m_uv->GetInteger (0, 7))
+        {
+        case 0:
+          demux.Allocate (0, local, port);
+          break;
+        case 1:
+        case 2:
+          demux.Allocate (0, local, port, peer, peerPort);
+          break;
+        case 3:
+          demux.Allocate (local);
+          break;
+        case 4:
+          if (endPoint)
+            {
+              endPoint->SetPeer (peer, peerPort);
+            }
+          break;
+        case 5:
+          if (endPoint)
+            {
+              endPoint->SetLocalAddress (local);
+            }
+          break;
+        case 6:
+          if (endPoint)
+            {
+              endPoint->SetRxEnabled (!endPoint->IsRxEnabled ());
+            }
+          break;
+        default:
+          if (endPoint)
+            {
+              demux.DeAllocate (endPoint);
+            }
+        }
+
+      all = demux.GetAllEndPoints ();
+      for (uint32_t i = 0; i < 10; i++)
+        {
+          Ipv4Address daddr = destinations[m_uv->GetInteger (0, destinations.size () - 1)];
+          Ipv4Address saddr = peers[m_uv->GetInteger (1, peers.size () - 1)];
+          uint16_t dport = ports[m_uv->GetInteger (0, ports.size () - 1)];
+          uint16_t sport = peerPorts[m_uv->GetInteger (1, peerPorts.size () - 1)];
+          Ipv4EndPointDemux::EndPoints expected = ReferenceLookup (all, daddr, dport, saddr, sport, interface);
+          // the demux aborts if several endpoints match
+          if (expected.size () <= 1)
+            {
+              Ipv4EndPointDemux::EndPoints found = demux.Lookup (daddr, dport, saddr, sport, interface);
+              NS_TEST_ASSERT_MSG_EQ ((found == expected), true,
+                                     "Lookup (" << daddr << ":" << dport << " from " << saddr << ":" << sport
+                                     << ") differs from a scan at step " << step);
+              lookups++;
+            }
+
+          // endpoints sharing the same four-tuple are ambiguous, the scan
+          // returned the first one
+          Ipv4EndPoint *simple = 0;
+          uint32_t exact = 0;
+          for (Ipv4EndPoint *endP : all)
+            {
+              if (endP->GetLocalPort () == dport && endP->GetLocalAddress () == daddr
+                  && endP->GetPeerPort () == sport && endP->GetPeerAddress () == saddr)
+                {
+                  simple = endP;
+                  exact++;
+                }
+            }
+          if (exact == 1)
+            {
+              NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (daddr, dport, saddr, sport), simple,
+                                     "SimpleLookup should find the exact match");
+            }
+
+          bool used = false;
+          for (Ipv4EndPoint *endP : all)
+            {
+              used = used || endP->GetLocalPort () == dport;
+            }
+          NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (dport), used, "LookupPortLocal differs from a scan");
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (lookups, 10000, "Too few lookups checked");
+}
+
+void
+EndPointDemuxRandomTestCase::RunIpv6 (void)
+{
+  Ipv6EndPointDemux demux;
+  std::vector<Ipv6Address> locals {Ipv6Address::GetAny (), Ipv6Address ("2001:db8::1"),
+                                   Ipv6Address ("2001:db8::2")};
+  std::vector<Ipv6Address> peers {Ipv6Address::GetAny (), Ipv6Address ("2001:db8::10"),
+                                  Ipv6Address ("2001:db8::11")};
+  std::vector<uint16_t> ports {80, 81, 49153};
+  std::vector<uint16_t> peerPorts {0, 1000, 1001};
+
+  uint32_t lookups = 0;
+  for (uint32_t step = 0; step < 3000; step++)
+    {
+      Ipv6EndPointDemux::EndPoints all = demux.GetEndPoints ();
+      Ipv6EndPoint *endPoint = 0;
+      if (!all.empty ())
+        {
+          auto it = all.begin ();
+          std::advance (it, m_uv->GetInteger (0, all.size () - 1));
+          endPoint = *it;
+        }
+      Ipv6Address local = locals[m_uv->GetInteger (0, locals.size () - 1)];
+      Ipv6Address peer = peers[m_uv->GetInteger (0, peers.size () - 1)];
+      uint16_t port = ports[m_uv->GetInteger (0, ports.size () - 1)];
+      uint16_t peerPort = peerPorts[m_uv->GetInteger (0, peerPorts.size () - 1)];
+      switch (m_uv->GetInteger (0, 8))
+        {
+        case 0:
+          demux.Allocate (0, local, port);
+          break;
+        case 1:
+        case 2:
+          demux.Allocate (0, local, port, peer, peerPort);
+          break;
+        case 3:
+          demux.Allocate (local);
+          break;
+        case 4:
+          if (endPoint)
+            {
+              endPoint->SetPeer (peer, peerPort);
+            }
+          break;
+        case 5:
+          if (endPoint)
+            {
+              endPoint->SetLocalAddress (local);
+            }
+          break;
+        case 6:
+          if (endPoint)
+            {
+              endPoint->SetLocalPort (port);
+            }
+          break;
+        case 7:
+          if (endPoint)
+            {
+              endPoint->SetRxEnabled (!endPoint->IsRxEnabled ());
+            }
+          break;
+        default:
+          if (endPoint)
+            {
+              demux.DeAllocate (endPoint);
+            }
+        }
+
+      all = demux.GetEndPoints ();
+      for (uint32_t i = 0; i < 10; i++)
+        {
+          Ipv6Address daddr = locals[m_uv->GetInteger (1, locals.size () - 1)];
+          Ipv6Address saddr = peers[m_uv->GetInteger (1, peers.size () - 1)];
+          uint16_t dport = ports[m_uv->GetInteger (0, ports.size () - 1)];
+          uint16_t sport = peerPorts[m_uv->GetInteger (1, peerPorts.size () - 1)];
+          Ipv6EndPointDemux::EndPoints expected = ReferenceLookup (all, daddr, dport, saddr, sport);
+          // the demux aborts if several endpoints match
+          if (expected.size () <= 1)
+            {
+              Ipv6EndPointDemux::EndPoints found = demux.Lookup (daddr, dport, saddr, sport, 0);
+              NS_TEST_ASSERT_MSG_EQ ((found == expected), true,
+                                     "Lookup (" << daddr << ":" << dport << " from " << saddr << ":" << sport
+                                     << ") differs from a scan at step " << step);
+              lookups++;
+            }
+
+          bool used = false;
+          for (Ipv6EndPoint *endP : all)
+            {
+              used = used || endP->GetLocalPort () == dport;
+            }
+          NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (dport), used, "LookupPortLocal differs from a scan");
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (lookups, 10000, "Too few lookups checked");
+}
+
+void
+EndPointDemuxRandomTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  m_uv = CreateObject<UniformRandomVariable> ();
+  RunIpv4 ();
+  RunIpv6 ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux and Ipv6EndPointDemux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite ()
+  : TestSuite ("end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxBindTestCase (), TestCase::QUICK);
+  AddTestCase (new EndPointDemuxRandomTestCase (), TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
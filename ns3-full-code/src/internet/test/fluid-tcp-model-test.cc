@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/queue-disc.h"
+#include "ns3/fluid-tcp-model.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the equilibrium of the fluid TCP model behind a RED queue disc.
+ *
+ * A FluidTcpModel with 20 flows is installed on a 10 Mbps link whose root
+ * queue disc is RED. Once the transient is over, the link must be fully used,
+ * the queue must settle between the thresholds of RED, and the average window
+ * and the fraction of packets dropped (or marked) must satisfy the
+ * equilibrium of the window equation, W^2 p = 2.
+ */
+class FluidTcpModelTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param ecn whether the packets are ECN capable and RED marks them
+   */
+  FluidTcpModelTestCase (bool ecn);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Sample the state of the model and of the queue disc.
+   * \param fluid the model
+   * \param qdisc the queue disc
+   */
+  void Sample (Ptr<FluidTcpModel> fluid, Ptr<QueueDisc> qdisc);
+
+  bool m_ecn;                     //!< whether the packets are ECN capable
+  uint32_t m_samples;             //!< number of samples
+  double m_window;                //!< sum of the sampled windows
+  uint64_t m_txPackets;           //!< packets sent at the first sample
+  uint64_t m_congestedPackets;    //!< packets dropped or marked at the first sample
+  double m_queue;                 //!< sum of the sampled queue sizes
+};
+
+FluidTcpModelTestCase::FluidTcpModelTestCase (bool ecn)
+  : TestCase (std::string ("Check the equilibrium of the fluid TCP model with RED")
+              + (ecn ? " (ECN)" : "")),
+    m_ecn (ecn),
+    m_samples (0),
+    m_window (0),
+    m_txPackets (0),
+    m_congestedPackets (0),
+    m_queue (0)
+{
+}
+
+void
+FluidTcpModelTestCase::Sample (Ptr<FluidTcpModel> fluid, Ptr<QueueDisc> qdisc)
+{
+  if (m_samples++ == 0)
+    {
+      m_txPackets = fluid->GetTxPackets ();
+      m_congestedPackets = fluid->GetDroppedPackets () + fluid->GetMarkedPackets ();
+    }
+  m_window += fluid->GetWindow ();
+  m_queue += qdisc->GetNPackets ();
+  Simulator::Schedule (MilliSeconds (10), &FluidTcpModelTestCase::Sample, this, fluid, qdisc);
+}
+
+void
+FluidTcpModelTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simple;
+  simple.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simple.SetChannelAttribute ("Delay", StringValue ("20ms"));
+  simple.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("1p"));
+  NetDeviceContainer devices = simple.Install (nodes);
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::RedQueueDisc",
+                        "MaxSize", StringValue ("200p"),
+                        "MeanPktSize", UintegerValue (1000),
+                        "MinTh", DoubleValue (20),
+                        "MaxTh", DoubleValue (60),
+                        "LInterm", DoubleValue (10),
+                        "LinkBandwidth", StringValue ("10Mbps"),
+                        "LinkDelay", StringValue ("20ms"),
+                        "UseEcn", BooleanValue (m_ecn));
+  QueueDiscContainer qdiscs = tch.Install (devices.Get (0));
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (devices);
+
+  Ptr<FluidTcpModel> fluid = CreateObjectWithAttributes<FluidTcpModel> (
+    "Flows", UintegerValue (20),
+    "PropagationDelay", StringValue ("48ms"),
+    "PacketSize", UintegerValue (1000),
+    "UseEcn", BooleanValue (m_ecn));
+  fluid->AssignStreams (1);
+  fluid->Install (devices.Get (0));
+
+  // skip the transient of the flows
+  Simulator::Schedule (Seconds (5), &FluidTcpModelTestCase::Sample, this, fluid, qdiscs.Get (0));
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+
+  double window = m_window / m_samples;
+  double prob = static_cast<double> (fluid->GetDroppedPackets () + fluid->GetMarkedPackets ()
+                                     - m_congestedPackets)
+    / (fluid->GetTxPackets () - m_txPackets);
+  double queue = m_queue / m_samples;
+  double throughput = (fluid->GetTxPackets () - fluid->GetDroppedPackets ()) * 1000 * 8 / 20.0;
+
+  NS_TEST_EXPECT_MSG_GT (throughput, 0.9e7, "The link is not fully used");
+  NS_TEST_EXPECT_MSG_GT (queue, 20, "The queue is below the minimum threshold of RED");
+  NS_TEST_EXPECT_MSG_LT (queue, 60, "The queue is above the maximum threshold of RED");
+  NS_TEST_EXPECT_MSG_EQ_TOL (window * window * prob, 2, 0.5, "The flows are not at the equilibrium");
+  if (m_ecn)
+    {
+      NS_TEST_EXPECT_MSG_GT (fluid->GetMarkedPackets (), 0, "No packet was marked");
+      NS_TEST_EXPECT_MSG_LT (fluid->GetDroppedPackets (), fluid->GetMarkedPackets () / 10,
+                             "The packets should be marked rather than dropped");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_GT (fluid->GetDroppedPackets (), 0, "No packet was dropped");
+      NS_TEST_EXPECT_MSG_EQ (fluid->GetMarkedPackets (), 0, "No packet should be marked");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Fluid TCP model TestSuite
+ */
+class FluidTcpModelTestSuite : public TestSuite
+{
+public:
+  FluidTcpModelTestSuite ()
+    : TestSuite ("fluid-tcp-model", UNIT)
+  {
+    AddTestCase (new FluidTcpModelTestCase (false), TestCase::QUICK);
+    AddTestCase (new FluidTcpModelTestCase (true), TestCase::QUICK);
+  }
+};
+
+static FluidTcpModelTestSuite g_fluidTcpModelTestSuite; //!< Static variable for test initialization
@@ -26,7 +26,9 @@
 #include "ns3/global-route-manager-impl.h"
 #include "ns3/candidate-queue.h"
 #include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
 #include <cstdlib> // for rand()
+#include <vector>
 
 using namespace ns3;
 
@@ -226,6 +228,58 @@ GlobalRouteManagerImplTestCase::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Candidate Queue Test
+ */
+class CandidateQueueTestCase : public TestCase
+{
+public:
+  CandidateQueueTestCase ();
+  virtual void DoRun (void);
+};
+
+CandidateQueueTestCase::CandidateQueueTestCase ()
+  : TestCase ("CandidateQueueTestCase")
+{
+}
+void
+CandidateQueueTestCase::DoRun (void)
+{
+  CandidateQueue candidate;
+  std::vector<SPFVertex*> vertices;
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+
+  for (int i = 0; i < 100; ++i)
+    {
+      SPFVertex *v = new SPFVertex;
+      v->SetDistanceFromRoot (rand->GetInteger (1000, 1099));
+      candidate.Push (v);
+      vertices.push_back (v);
+    }
+
+  // decrease the distance of some vertices, as SPFNext () does
+  for (int i = 0; i < 100; i += 7)
+    {
+      vertices[i]->SetDistanceFromRoot (rand->GetInteger (0, 999));
+      candidate.Update (vertices[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (candidate.Size (), 100, "Update () changed the size of the queue");
+
+  uint32_t distance = 0;
+  while (!candidate.Empty ())
+    {
+      SPFVertex *v = candidate.Pop ();
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (v->GetDistanceFromRoot (), distance, "The vertices are not popped in order of distance");
+      distance = v->GetDistanceFromRoot ();
+      delete v;
+    }
+}
+
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -243,6 +297,7 @@ GlobalRouteManagerImplTestSuite::GlobalRouteManagerImplTestSuite ()
   : TestSuite ("global-route-manager-impl", UNIT)
 {
   AddTestCase (new GlobalRouteManagerImplTestCase (), TestCase::QUICK);
+  AddTestCase (new CandidateQueueTestCase (), TestCase::QUICK);
 }
 
 static GlobalRouteManagerImplTestSuite g_globalRoutingManagerImplTestSuite; //!< Static variable for test initialization
@@ -14,6 +14,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <sstream>
 #include <vector>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
@@ -41,6 +42,7 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
+#include "ns3/global-route-manager.h"
 #include "ns3/bridge-helper.h"
 
 using namespace ns3;
@@ -1244,6 +1246,331 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting forwarding table test
+ *
+ * Checks the precedence of host, network and external routes, the longest
+ * prefix match among network routes, the first match among external
+ * routes, the output interface filter, the reuse
+ * of the Ipv4Route objects and the update of the forwarding table when a
+ * route is removed.
+ */
+class Ipv4GlobalRoutingForwardingTableTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingForwardingTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Look up a route.
+   * \param routing The global routing protocol.
+   * \param dest The destination address.
+   * \param oif The output interface, if any.
+   * \return The route found, if any.
+   */
+  Ptr<Ipv4Route> Lookup (Ptr<Ipv4GlobalRouting> routing, std::string dest, Ptr<NetDevice> oif = 0);
+};
+
+Ipv4GlobalRoutingForwardingTableTestCase::Ipv4GlobalRoutingForwardingTableTestCase ()
+  : TestCase ("Global routing forwarding table")
+{
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRoutingForwardingTableTestCase::Lookup (Ptr<Ipv4GlobalRouting> routing, std::string dest, Ptr<NetDevice> oif)
+{
+  Ipv4Header header;
+  header.SetDestination (Ipv4Address (dest.c_str ()));
+  Socket::SocketErrno sockerr;
+  return routing->RouteOutput (Create<Packet> (), header, oif, sockerr);
+}
+
+void
+Ipv4GlobalRoutingForwardingTableTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (node);
+
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  Ptr<SimpleNetDevice> devices[2];
+  uint32_t interfaces[2];
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      devices[i] = CreateObject<SimpleNetDevice> ();
+      devices[i]->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (devices[i]);
+      interfaces[i] = ipv4->AddInterface (devices[i]);
+      ipv4->AddAddress (interfaces[i], Ipv4InterfaceAddress (Ipv4Address (i == 0 ? "10.0.0.1" : "10.0.0.5"),
+                                                             Ipv4Mask ("/30")));
+      ipv4->SetUp (interfaces[i]);
+    }
+  Ptr<Ipv4GlobalRouting> routing = ipv4->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+  NS_TEST_ASSERT_MSG_NE (routing, 0, "Error-- no Ipv4GlobalRouting object");
+
+  Ipv4Address gw0 ("10.0.0.2");
+  Ipv4Address gw1 ("10.0.0.6");
+  routing->AddHostRouteTo (Ipv4Address ("10.1.2.3"), gw0, interfaces[0]);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("/8"), gw0, interfaces[0]);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), gw1, interfaces[1]);
+  routing->AddASExternalRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("/0"), gw1, interfaces[1]);
+
+  Ptr<Ipv4Route> route = Lookup (routing, "10.1.2.3");
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No route to host");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), gw0, "The host route is not preferred");
+  NS_TEST_EXPECT_MSG_EQ (route->GetSource (), Ipv4Address ("10.0.0.1"), "Wrong source address");
+
+  route = Lookup (routing, "10.1.9.9");
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No route to network");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), gw1, "The longest prefix is not preferred");
+  NS_TEST_EXPECT_MSG_EQ (route->GetOutputDevice (), devices[1], "Wrong output device");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "10.1.9.9"), route, "The route is not reused");
+
+  route = Lookup (routing, "10.1.9.9", devices[0]);
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No route on the requested interface");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), gw0, "The output interface is not honored");
+
+  route = Lookup (routing, "10.2.0.1");
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No route to network");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), gw0, "Wrong network route");
+
+  route = Lookup (routing, "192.168.0.1");
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No external route");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), gw1, "Wrong external route");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "192.168.0.1", devices[0]), 0, "Unexpected external route");
+
+  // unlike the network routes, the first matching external route is
+  // selected, even if a later one has a longer prefix
+  routing->AddASExternalRouteTo (Ipv4Address ("192.168.0.0"), Ipv4Mask ("/16"), gw0, interfaces[0]);
+  route = Lookup (routing, "192.168.0.1");
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No external route");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), gw1, "The first external route is not preferred");
+  route = Lookup (routing, "192.168.0.1", devices[0]);
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No external route on the requested interface");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), gw0, "The output interface is not honored");
+
+  // the routing table holds the host route first, then the network routes
+  routing->RemoveRoute (2);
+  route = Lookup (routing, "10.1.9.9");
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No route to network");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), gw0, "The removed route is still used");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting SPF calculation test
+ *
+ * Two islands: a square n0-n1-n2-n3 with a stub n4 attached to n0, and a
+ * triangle n5-n6-n7.  Checks that the routing tables do not depend on the
+ * number of threads computing the routes, and that, when the link n1-n2
+ * goes down, RecomputeRoutingTables reinstalls the routes of the nodes of
+ * the square but leaves the routes of the other nodes alone.
+ */
+class Ipv4GlobalRoutingSpfTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingSpfTestCase ();
+  virtual ~Ipv4GlobalRoutingSpfTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * \brief Connect two nodes with a point-to-point link
+   * \param a the first node
+   * \param b the second node
+   * \param network the network address of the link
+   */
+  void AddLink (uint32_t a, uint32_t b, const char *network);
+  /**
+   * \brief Get the global routing protocol of a node
+   * \param node the index of the node
+   * \returns the global routing protocol
+   */
+  Ptr<Ipv4GlobalRouting> GetRouting (uint32_t node);
+  /**
+   * \brief Print the routing table of a node
+   * \param node the index of the node
+   * \returns the routes of the node, one per line
+   */
+  std::string GetRoutes (uint32_t node);
+  /**
+   * \brief Get the routing table entries of a node
+   * \param node the index of the node
+   * \returns the routing table entries of the node
+   */
+  std::vector<Ipv4RoutingTableEntry *> GetEntries (uint32_t node);
+
+  NodeContainer m_nodes; //!< Nodes used in the test.
+  std::vector<std::pair<Ptr<Ipv4>, uint32_t> > m_interfaces; //!< Interfaces of the link n1-n2.
+};
+
+Ipv4GlobalRoutingSpfTestCase::Ipv4GlobalRoutingSpfTestCase ()
+  : TestCase ("Global routing SPF threads and recomputation")
+{
+}
+
+Ipv4GlobalRoutingSpfTestCase::~Ipv4GlobalRoutingSpfTestCase ()
+{
+}
+
+void
+Ipv4GlobalRoutingSpfTestCase::AddLink (uint32_t a, uint32_t b, const char *network)
+{
+  Ptr<SimpleChannel> channel = CreateObject <SimpleChannel> ();
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  NetDeviceContainer net = simpleHelper.Install (NodeContainer (m_nodes.Get (a), m_nodes.Get (b)), channel);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase (network, "255.255.255.252");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (net);
+  if (a == 1 && b == 2)
+    {
+      m_interfaces.push_back (interfaces.Get (0));
+      m_interfaces.push_back (interfaces.Get (1));
+    }
+}
+
+void
+Ipv4GlobalRoutingSpfTestCase::DoSetup (void)
+{
+  m_nodes.Create (8);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  AddLink (0, 1, "10.1.1.0");
+  AddLink (1, 2, "10.1.2.0");
+  AddLink (2, 3, "10.1.3.0");
+  AddLink (3, 0, "10.1.4.0");
+  AddLink (0, 4, "10.1.5.0");
+  AddLink (5, 6, "10.2.1.0");
+  AddLink (6, 7, "10.2.2.0");
+  AddLink (7, 5, "10.2.3.0");
+}
+
+void
+Ipv4GlobalRoutingSpfTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (1));
+  Simulator::Destroy ();
+}
+
+Ptr<Ipv4GlobalRouting>
+Ipv4GlobalRoutingSpfTestCase::GetRouting (uint32_t node)
+{
+  Ptr<Ipv4L3Protocol> ip = m_nodes.Get (node)->GetObject<Ipv4L3Protocol> ();
+  return ip->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+}
+
+std::string
+Ipv4GlobalRoutingSpfTestCase::GetRoutes (uint32_t node)
+{
+  std::ostringstream oss;
+  Ptr<Ipv4GlobalRouting> routing = GetRouting (node);
+  for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+    {
+      oss << *routing->GetRoute (i) << std::endl;
+    }
+  return oss.str ();
+}
+
+std::vector<Ipv4RoutingTableEntry *>
+Ipv4GlobalRoutingSpfTestCase::GetEntries (uint32_t node)
+{
+  std::vector<Ipv4RoutingTableEntry *> entries;
+  Ptr<Ipv4GlobalRouting> routing = GetRouting (node);
+  for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+    {
+      entries.push_back (routing->GetRoute (i));
+    }
+  return entries;
+}
+
+void
+Ipv4GlobalRoutingSpfTestCase::DoRun (void)
+{
+  uint32_t nNodes = m_nodes.GetN ();
+
+  // the tables computed by one thread and by several threads are the same
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (1));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::vector<std::string> serial;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      serial.push_back (GetRoutes (i));
+      NS_TEST_ASSERT_MSG_GT (GetRouting (i)->GetNRoutes (), 0, "Node " << i << " has no route");
+    }
+
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (4));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (GetRoutes (i), serial[i], "The routes of node " << i << " depend on the number of threads");
+    }
+
+  // take the link n1-n2 down
+  std::vector<std::string> before;
+  std::vector<std::vector<Ipv4RoutingTableEntry *> > entries;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      before.push_back (GetRoutes (i));
+      entries.push_back (GetEntries (i));
+    }
+  for (const auto &interface : m_interfaces)
+    {
+      interface.first->SetDown (interface.second);
+    }
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+
+  // the nodes of the square are reinstalled, the stub and the triangle are not
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_NE (GetRoutes (i), before[i], "The routes of node " << i << " should change");
+    }
+  for (uint32_t i = 4; i < nNodes; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (GetRoutes (i), before[i], "The routes of node " << i << " should not change");
+      NS_TEST_EXPECT_MSG_EQ ((GetEntries (i) == entries[i]), true,
+                             "The routes of node " << i << " should not be reinstalled");
+    }
+
+  // n1 is left with a single interface: it becomes a stub of n0
+  Ptr<Ipv4GlobalRouting> routing1 = GetRouting (1);
+  NS_TEST_ASSERT_MSG_EQ (routing1->GetNRoutes (), 1, "n1 should only have a default route");
+  NS_TEST_EXPECT_MSG_EQ (routing1->GetRoute (0)->GetDest (), Ipv4Address ("0.0.0.0"), "Wrong destination");
+  NS_TEST_EXPECT_MSG_EQ (routing1->GetRoute (0)->GetGateway (), Ipv4Address ("10.1.1.1"), "Wrong gateway");
+
+  // the same tables as a full computation
+  std::vector<std::string> recomputed;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      recomputed.push_back (GetRoutes (i));
+    }
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (GetRoutes (i), recomputed[i], "The recomputed routes of node " << i << " are stale");
+    }
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1594,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingForwardingTableTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingSpfTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
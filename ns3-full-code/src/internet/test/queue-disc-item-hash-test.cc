@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/hash.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/ipv6-queue-disc-item.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-option-winscale.h"
+#include "ns3/udp-header.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the 5-tuple hash of the IPv4 and IPv6 queue disc items.
+ *
+ * The hash is compared against a reference computed by deserializing the
+ * whole transport header, for several perturbation values and repeated
+ * calls (which are served by the per-item cache).
+ */
+class QueueDiscItemHashTestCase : public TestCase
+{
+public:
+  QueueDiscItemHashTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Compute the reference hash of an IPv4 5-tuple.
+   * \param hdr the IPv4 header
+   * \param srcPort the source port
+   * \param dstPort the destination port
+   * \param perturbation the hash perturbation
+   * \return the hash
+   */
+  uint32_t Ipv4Reference (const Ipv4Header &hdr, uint16_t srcPort, uint16_t dstPort,
+                          uint32_t perturbation);
+  /**
+   * Compute the reference hash of an IPv6 5-tuple.
+   * \param hdr the IPv6 header
+   * \param srcPort the source port
+   * \param dstPort the destination port
+   * \param perturbation the hash perturbation
+   * \return the hash
+   */
+  uint32_t Ipv6Reference (const Ipv6Header &hdr, uint16_t srcPort, uint16_t dstPort,
+                          uint32_t perturbation);
+};
+
+QueueDiscItemHashTestCase::QueueDiscItemHashTestCase ()
+  : TestCase ("Check the cached 5-tuple hash of IPv4 and IPv6 queue disc items")
+{
+}
+
+uint32_t
+QueueDiscItemHashTestCase::Ipv4Reference (const Ipv4Header &hdr, uint16_t srcPort,
+                                          uint16_t dstPort, uint32_t perturbation)
+{
+  uint8_t buf[17];
+  hdr.GetSource ().Serialize (buf);
+  hdr.GetDestination ().Serialize (buf + 4);
+  buf[8] = hdr.GetProtocol ();
+  buf[9] = (srcPort >> 8) & 0xff;
+  buf[10] = srcPort & 0xff;
+  buf[11] = (dstPort >> 8) & 0xff;
+  buf[12] = dstPort & 0xff;
+  buf[13] = (perturbation >> 24) & 0xff;
+  buf[14] = (perturbation >> 16) & 0xff;
+  buf[15] = (perturbation >> 8) & 0xff;
+  buf[16] = perturbation & 0xff;
+  return Hash32 ((char*) buf, 17);
+}
+
+uint32_t
+QueueDiscItemHashTestCase::Ipv6Reference (const Ipv6Header &hdr, uint16_t srcPort,
+                                          uint16_t dstPort, uint32_t perturbation)
+{
+  uint8_t buf[41];
+  hdr.GetSource ().Serialize (buf);
+  hdr.GetDestination ().Serialize (buf + 16);
+  buf[32] = hdr.GetNextHeader ();
+  buf[33] = (srcPort >> 8) & 0xff;
+  buf[34] = srcPort & 0xff;
+  buf[35] = (dstPort >> 8) & 0xff;
+  buf[36] = dstPort & 0xff;
+  buf[37] = (perturbation >> 24) & 0xff;
+  buf[38] = (perturbation >> 16) & 0xff;
+  buf[39] = (perturbation >> 8) & 0xff;
+  buf[40] = perturbation & 0xff;
+  return Hash32 ((char*) buf, 41);
+}
+
+void
+QueueDiscItemHashTestCase::DoRun (void)
+{
+  uint32_t perturbations[] = {0, 1, 0xdeadbeef, 1};
+
+  // TCP over IPv4, with options making the header longer than 20 bytes
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader tcpHdr;
+  tcpHdr.SetSourcePort (49153);
+  tcpHdr.SetDestinationPort (80);
+  tcpHdr.AppendOption (CreateObject<TcpOptionWinScale> ());
+  p->AddHeader (tcpHdr);
+  Ipv4Header ipv4Hdr;
+  ipv4Hdr.SetSource (Ipv4Address ("10.0.0.1"));
+  ipv4Hdr.SetDestination (Ipv4Address ("10.0.1.2"));
+  ipv4Hdr.SetProtocol (6);
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, Address (), 0, ipv4Hdr);
+  for (uint32_t perturbation : perturbations)
+    {
+      NS_TEST_EXPECT_MSG_EQ (item->Hash (perturbation),
+                             Ipv4Reference (ipv4Hdr, 49153, 80, perturbation),
+                             "Wrong hash of a TCP/IPv4 packet");
+    }
+  // The ports must be found even after the header has been added
+  item->AddHeader ();
+  NS_TEST_EXPECT_MSG_EQ (item->Hash (7), Ipv4Reference (ipv4Hdr, 49153, 80, 7),
+                         "Wrong hash of a TCP/IPv4 packet after adding the header");
+
+  // UDP over IPv4
+  p = Create<Packet> (100);
+  UdpHeader udpHdr;
+  udpHdr.SetSourcePort (5000);
+  udpHdr.SetDestinationPort (9);
+  p->AddHeader (udpHdr);
+  ipv4Hdr.SetProtocol (17);
+  item = Create<Ipv4QueueDiscItem> (p, Address (), 0, ipv4Hdr);
+  for (uint32_t perturbation : perturbations)
+    {
+      NS_TEST_EXPECT_MSG_EQ (item->Hash (perturbation),
+                             Ipv4Reference (ipv4Hdr, 5000, 9, perturbation),
+                             "Wrong hash of a UDP/IPv4 packet");
+    }
+
+  // Non-first fragments and other protocols do not include the ports
+  p = Create<Packet> (100);
+  p->AddHeader (udpHdr);
+  ipv4Hdr.SetFragmentOffset (8);
+  item = Create<Ipv4QueueDiscItem> (p, Address (), 0, ipv4Hdr);
+  NS_TEST_EXPECT_MSG_EQ (item->Hash (3), Ipv4Reference (ipv4Hdr, 0, 0, 3),
+                         "Ports included for a non-first fragment");
+  ipv4Hdr.SetFragmentOffset (0);
+  ipv4Hdr.SetProtocol (1);
+  item = Create<Ipv4QueueDiscItem> (Create<Packet> (2), Address (), 0, ipv4Hdr);
+  NS_TEST_EXPECT_MSG_EQ (item->Hash (3), Ipv4Reference (ipv4Hdr, 0, 0, 3),
+                         "Ports included for an ICMP packet");
+
+  // TCP over IPv6
+  p = Create<Packet> (100);
+  p->AddHeader (tcpHdr);
+  Ipv6Header ipv6Hdr;
+  ipv6Hdr.SetSource (Ipv6Address ("2001:db8::1"));
+  ipv6Hdr.SetDestination (Ipv6Address ("2001:db8::2"));
+  ipv6Hdr.SetNextHeader (6);
+  Ptr<Ipv6QueueDiscItem> item6 = Create<Ipv6QueueDiscItem> (p, Address (), 0, ipv6Hdr);
+  for (uint32_t perturbation : perturbations)
+    {
+      NS_TEST_EXPECT_MSG_EQ (item6->Hash (perturbation),
+                             Ipv6Reference (ipv6Hdr, 49153, 80, perturbation),
+                             "Wrong hash of a TCP/IPv6 packet");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Queue disc item hash TestSuite
+ */
+static class QueueDiscItemHashTestSuite : public TestSuite
+{
+public:
+  QueueDiscItemHashTestSuite ()
+    : TestSuite ("queue-disc-item-hash", UNIT)
+  {
+    AddTestCase (new QueueDiscItemHashTestCase (), TestCase::QUICK);
+  }
+} g_queueDiscItemHashTestSuite; ///< Static variable for test initialization
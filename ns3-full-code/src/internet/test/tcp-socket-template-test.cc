@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <map>
+
+#include "ns3/test.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the sockets created from the templates of TcpL4Protocol.
+ *
+ * With the SocketTemplates attribute, a single node creates a listening
+ * socket and several client sockets from the same template.  The segment
+ * size of the first client is changed before it connects: the other
+ * clients, and a socket created afterwards, must keep the default value.
+ * Every client then connects on the loopback, sends its data and closes;
+ * every connection must deliver all its bytes and close normally on both
+ * sides.
+ */
+class TcpSocketTemplateTest : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param desc Test description.
+   * \param ipVersion True to use IPv6.
+   */
+  TcpSocketTemplateTest (std::string desc, bool ipVersion);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Get the segment size of a socket.
+   * \param socket The socket.
+   * \returns The value of its SegmentSize attribute.
+   */
+  uint32_t GetSegmentSize (Ptr<Socket> socket);
+  /**
+   * \brief Handle an incoming connection.
+   * \param s The accepted socket.
+   * \param from The address of the client.
+   */
+  void HandleAccept (Ptr<Socket> s, const Address &from);
+  /**
+   * \brief Receive data on an accepted socket.
+   * \param socket The accepted socket.
+   */
+  void Recv (Ptr<Socket> socket);
+  /**
+   * \brief Close an accepted socket once the client has closed.
+   * \param socket The accepted socket.
+   */
+  void ServerClose (Ptr<Socket> socket);
+  /**
+   * \brief Send the data of a client.
+   * \param socket The client socket.
+   * \param available Unused.
+   */
+  void Send (Ptr<Socket> socket, uint32_t available);
+  /**
+   * \brief Count the normal closes of the client sockets.
+   * \param socket The client socket.
+   */
+  void ClientClose (Ptr<Socket> socket);
+
+  bool m_v6;                                    //!< True to use IPv6.
+  uint32_t m_totalBytes;                        //!< Bytes sent by each client.
+  std::map<Ptr<Socket>, uint32_t> m_sent;       //!< Bytes sent by each client.
+  std::map<Ptr<Socket>, uint32_t> m_received;   //!< Bytes received on each accepted socket.
+  uint32_t m_serverCloses;                      //!< Accepted sockets closed by the client.
+  uint32_t m_clientCloses;                      //!< Client sockets closed normally.
+};
+
+TcpSocketTemplateTest::TcpSocketTemplateTest (std::string desc, bool ipVersion)
+  : TestCase (desc),
+    m_v6 (ipVersion),
+    m_totalBytes (5000),
+    m_serverCloses (0),
+    m_clientCloses (0)
+{
+}
+
+uint32_t
+TcpSocketTemplateTest::GetSegmentSize (Ptr<Socket> socket)
+{
+  UintegerValue segmentSize;
+  socket->GetAttribute ("SegmentSize", segmentSize);
+  return segmentSize.Get ();
+}
+
+void
+TcpSocketTemplateTest::HandleAccept (Ptr<Socket> s, const Address &from)
+{
+  m_received[s] = 0;
+  s->SetRecvCallback (MakeCallback (&TcpSocketTemplateTest::Recv, this));
+  s->SetCloseCallbacks (MakeCallback (&TcpSocketTemplateTest::ServerClose, this),
+                        MakeNullCallback<void, Ptr<Socket> > ());
+}
+
+void
+TcpSocketTemplateTest::Recv (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      m_received[socket] += p->GetSize ();
+    }
+}
+
+void
+TcpSocketTemplateTest::ServerClose (Ptr<Socket> socket)
+{
+  m_serverCloses++;
+  socket->Close ();
+}
+
+void
+TcpSocketTemplateTest::Send (Ptr<Socket> socket, uint32_t available)
+{
+  while (m_sent[socket] < m_totalBytes && socket->GetTxAvailable () > 0)
+    {
+      uint32_t toSend = std::min (m_totalBytes - m_sent[socket], socket->GetTxAvailable ());
+      int sent = socket->Send (Create<Packet> (toSend));
+      NS_TEST_EXPECT_MSG_NE (sent, -1, "Error during send");
+      m_sent[socket] += sent;
+    }
+  if (m_sent[socket] == m_totalBytes)
+    {
+      socket->Close ();
+    }
+}
+
+void
+TcpSocketTemplateTest::ClientClose (Ptr<Socket> socket)
+{
+  m_clientCloses++;
+}
+
+void
+TcpSocketTemplateTest::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+
+  InternetStackHelper internet;
+  internet.Install (node);
+  node->GetObject<TcpL4Protocol> ()->SetAttribute ("SocketTemplates", BooleanValue (true));
+
+  TypeId tid = TcpSocketFactory::GetTypeId ();
+  Ptr<Socket> sink = Socket::CreateSocket (node, tid);
+  Address local = m_v6 ? Address (Inet6SocketAddress (Ipv6Address::GetAny (), 9))
+                       : Address (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  Address remote = m_v6 ? Address (Inet6SocketAddress (Ipv6Address::GetLoopback (), 9))
+                        : Address (InetSocketAddress (Ipv4Address::GetLoopback (), 9));
+  sink->Bind (local);
+  sink->Listen ();
+  sink->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                           MakeCallback (&TcpSocketTemplateTest::HandleAccept, this));
+
+  uint32_t nClients = 4;
+  std::vector<Ptr<Socket> > clients;
+  for (uint32_t i = 0; i < nClients; i++)
+    {
+      clients.push_back (Socket::CreateSocket (node, tid));
+    }
+  uint32_t defaultSegmentSize = GetSegmentSize (clients[0]);
+  clients[0]->SetAttribute ("SegmentSize", UintegerValue (2 * defaultSegmentSize));
+  Ptr<Socket> later = Socket::CreateSocket (node, tid);
+
+  NS_TEST_ASSERT_MSG_EQ (GetSegmentSize (clients[0]), 2 * defaultSegmentSize,
+                         "The attribute should be set on the socket");
+  for (uint32_t i = 1; i < nClients; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (GetSegmentSize (clients[i]), defaultSegmentSize,
+                             "The attribute should not leak into a sibling socket");
+    }
+  NS_TEST_ASSERT_MSG_EQ (GetSegmentSize (later), defaultSegmentSize,
+                         "The attribute should not leak into the template");
+  NS_TEST_ASSERT_MSG_EQ (GetSegmentSize (sink), defaultSegmentSize,
+                         "The attribute should not leak into the listening socket");
+  later->Close ();
+
+  for (Ptr<Socket> client : clients)
+    {
+      m_sent[client] = 0;
+      client->Bind ();
+      client->SetSendCallback (MakeCallback (&TcpSocketTemplateTest::Send, this));
+      client->SetCloseCallbacks (MakeCallback (&TcpSocketTemplateTest::ClientClose, this),
+                                 MakeNullCallback<void, Ptr<Socket> > ());
+      NS_TEST_ASSERT_MSG_EQ (client->Connect (remote), 0, "Connect should succeed");
+    }
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received.size (), nClients, "Every client should have been accepted");
+  for (auto it = m_received.begin (); it != m_received.end (); it++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (it->second, m_totalBytes, "A connection did not deliver all its data");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_serverCloses, nClients, "Every accepted socket should have been closed");
+  NS_TEST_EXPECT_MSG_EQ (m_clientCloses, nClients, "Every client socket should have been closed");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for the TCP socket templates.
+ */
+class TcpSocketTemplateTestSuite : public TestSuite
+{
+public:
+  TcpSocketTemplateTestSuite () : TestSuite ("tcp-socket-template", UNIT)
+  {
+    AddTestCase (new TcpSocketTemplateTest ("Socket templates IPv4", false), TestCase::QUICK);
+    AddTestCase (new TcpSocketTemplateTest ("Socket templates IPv6", true), TestCase::QUICK);
+  }
+};
+
+static TcpSocketTemplateTestSuite g_tcpSocketTemplateTestSuite; //!< Static variable for test initialization
+
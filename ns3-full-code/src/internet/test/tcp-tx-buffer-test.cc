@@ -53,6 +53,12 @@ private:
   /** \brief Test the logic of merging items in GetTransmittedSegment()
    * which is triggered by CopyFromSequence()*/
   void TestMergeItemsWhenGetTransmittedSegment ();
+  /** \brief Test the scoreboard of a large window, with many holes and
+   * sequence numbers wrapping around */
+  void TestLargeWindow ();
+  /** \brief Test NextSeg in a recovery of a large window, in which no
+   * segment is lost and rule (3) picks every segment in turn */
+  void TestRecoveryWithoutLoss ();
   /**
    * \brief Callback to provide a value of receiver window
    * \returns the receiver window size
@@ -101,6 +107,24 @@ TcpTxBufferTestCase::DoRun ()
   Simulator::Schedule (Seconds (0.0),
                          &TcpTxBufferTestCase::TestMergeItemsWhenGetTransmittedSegment, this);
 
+  /*
+   * Case for a large window:
+   *  -> one segment every ten is lost, and the others are sacked three
+   *     blocks at a time, as a receiver would report them
+   *  -> the holes are retransmitted in order, then cumulatively acked
+   */
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestLargeWindow, this);
+
+  /*
+   * Case for a recovery without losses:
+   *  -> fewer than DupAckThresh segments are sacked in a large window, and
+   *     rule (3) returns the segments which are neither sacked nor
+   *     retransmitted, one after the other
+   */
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestRecoveryWithoutLoss, this);
+
   Simulator::Run ();
   Simulator::Destroy ();
 }
@@ -390,6 +414,164 @@ TcpTxBufferTestCase::TestTransmittedBlock ()
 {
 }
 
+void
+TcpTxBufferTestCase::TestLargeWindow ()
+{
+  const uint32_t segmentSize = 1000;
+  const uint32_t segments = 1000;
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  txBuf->SetRWndCallback (MakeCallback (&TcpTxBufferTestCase::GetRWnd, this));
+  txBuf->SetMaxBufferSize (segments * segmentSize);
+  txBuf->SetSegmentSize (segmentSize);
+  txBuf->SetDupAckThresh (3);
+  // Start close to the end of the sequence space, to wrap around it
+  SequenceNumber32 head (std::numeric_limits<uint32_t>::max () - 100 * segmentSize);
+  txBuf->SetHeadSequence (head);
+  SequenceNumber32 ret;
+  SequenceNumber32 retHigh;
+
+  txBuf->Add (Create<Packet> (segments * segmentSize));
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      txBuf->CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  // The segments 0, 10, 20, ... are lost; each SACK option carries the most
+  // recent block and the two previous ones
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  for (uint32_t hole = 0; hole < segments; hole += 10)
+    {
+      sack->ClearSackList ();
+      for (uint32_t b = 0; b < 3 && b * 10 <= hole; ++b)
+        {
+          SequenceNumber32 begin = head + (segmentSize * (hole - b * 10 + 1));
+          sack->AddSackBlock (TcpOptionSack::SackBlock (begin, begin + segmentSize * 9));
+        }
+      txBuf->Update (sack->GetSackList ());
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), segments / 10 * 9 * segmentSize,
+                         "Sacked bytes different than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), segments / 10 * segmentSize,
+                         "Lost bytes different than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 0,
+                         "Bytes in flight different than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (head + (segmentSize * 500)), true,
+                         "A hole is not lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (head + (segmentSize * 501)), false,
+                         "A sacked segment is lost");
+
+  // Retransmit the holes, in order
+  for (uint32_t hole = 0; hole < segments; hole += 10)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, true), true,
+                             "No NextSeq with lost segments");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * hole),
+                             "Different NextSeq than expected while retransmitting");
+      txBuf->CopyFromSequence (segmentSize, ret);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetRetransmitsCount (), segments / 10 * segmentSize,
+                         "Retransmitted bytes different than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, true), false,
+                         "NextSeq returned with everything retransmitted");
+
+  // The first retransmission is acked, and the next hole is still lost
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsRetransmittedDataAcked (head + segmentSize), true,
+                         "Retransmitted segment not recognized");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsRetransmittedDataAcked (head + (segmentSize * 2)), false,
+                         "Sacked segment recognized as retransmitted");
+  txBuf->DiscardUpTo (head + (segmentSize * 10));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), (segments / 10 - 1) * segmentSize,
+                         "Lost bytes different than expected after a partial ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (head + (segmentSize * 10)), true,
+                         "The next hole is not lost after a partial ACK");
+
+  txBuf->DiscardUpTo (head + (segmentSize * segments));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 0, "Data inside the buffer");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), 0, "Lost bytes inside the buffer");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), 0, "Sacked bytes inside the buffer");
+}
+
+void
+TcpTxBufferTestCase::TestRecoveryWithoutLoss ()
+{
+  const uint32_t segmentSize = 1000;
+  const uint32_t segments = 2000;
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  txBuf->SetRWndCallback (MakeCallback (&TcpTxBufferTestCase::GetRWnd, this));
+  txBuf->SetMaxBufferSize (segments * segmentSize);
+  txBuf->SetSegmentSize (segmentSize);
+  txBuf->SetDupAckThresh (3);
+  SequenceNumber32 head (1);
+  txBuf->SetHeadSequence (head);
+  SequenceNumber32 ret;
+  SequenceNumber32 retHigh;
+
+  txBuf->Add (Create<Packet> (segments * segmentSize));
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      txBuf->CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  // Only the segments 1 and 2 are sacked: nothing is lost
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  sack->AddSackBlock (TcpOptionSack::SackBlock (head + segmentSize,
+                                                head + (segmentSize * 3)));
+  txBuf->Update (sack->GetSackList ());
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), 2 * segmentSize,
+                         "Sacked bytes different than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), 0,
+                         "Lost bytes different than expected");
+
+  // Outside recovery there is nothing to send
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, false), false,
+                         "NextSeq returned outside recovery without losses");
+
+  // In recovery, rule (3) returns the first segment neither sacked nor
+  // retransmitted, skipping the ones retransmitted by the previous rounds
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      if (i == 1 || i == 2)
+        {
+          continue;
+        }
+      NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, true), true,
+                             "No NextSeq for rule (3)");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * i),
+                             "Different NextSeq than expected for rule (3)");
+      NS_TEST_ASSERT_MSG_EQ (retHigh, ret + segmentSize,
+                             "Different NextSeq high than expected for rule (3)");
+      txBuf->CopyFromSequence (segmentSize, ret);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetRetransmitsCount (), (segments - 2) * segmentSize,
+                         "Retransmitted bytes different than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, true), false,
+                         "NextSeq returned with everything sacked or retransmitted");
+
+  // A new SACK does not make the retransmitted segments eligible again
+  sack->ClearSackList ();
+  sack->AddSackBlock (TcpOptionSack::SackBlock (head + (segmentSize * 5),
+                                                head + (segmentSize * 6)));
+  txBuf->Update (sack->GetSackList ());
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, true), false,
+                         "NextSeq returned a retransmitted segment");
+
+  // Once the head is marked as lost, its retransmission is reset and it is
+  // the next segment to send
+  txBuf->MarkHeadAsLost ();
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, true), true,
+                         "No NextSeq for the lost head");
+  NS_TEST_ASSERT_MSG_EQ (ret, head, "The lost head is not the next segment");
+  txBuf->CopyFromSequence (segmentSize, ret);
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, true), false,
+                         "NextSeq returned with everything sacked or retransmitted");
+
+  txBuf->DiscardUpTo (head + (segmentSize * segments));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 0, "Data inside the buffer");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetRetransmitsCount (), 0,
+                         "Retransmitted bytes inside the buffer");
+}
+
 void
 TcpTxBufferTestCase::DoTeardown ()
 {
@@ -18,9 +18,15 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "buffer.h"
+#include "packet-allocator.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHECKSUM_AVX2 1
+#include <immintrin.h>
+#endif
+
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
                 ", zero end="<<m_zeroAreaEnd<<", count="<<m_data->m_count<<", size="<<m_data->m_size<<   \
@@ -43,6 +49,127 @@ static struct Zeroes
   const uint32_t size;  //!< buffer size
 } g_zeroes; //!< Zero-filled buffer
 
+/**
+ * \ingroup packet
+ * \brief Sum the 16 bit words of a memory area, read in host byte order.
+ *
+ * A trailing odd byte is summed as if it were followed by a zero byte.
+ * The 16 bit words are summed in pairs (as 32 bit values), which gives
+ * the same one's complement sum once folded.
+ *
+ * \param data the memory area
+ * \param size the size of the memory area (bytes), at most 65535
+ * \returns the (unfolded) sum
+ */
+uint64_t
+ChecksumAddScalar (const uint8_t *data, uint32_t size)
+{
+  uint64_t sum = 0;
+  while (size >= 8)
+    {
+      uint64_t words;
+      memcpy (&words, data, 8);
+      sum += (words & 0xffffffff) + (words >> 32);
+      data += 8;
+      size -= 8;
+    }
+  while (size >= 2)
+    {
+      uint16_t word;
+      memcpy (&word, data, 2);
+      sum += word;
+      data += 2;
+      size -= 2;
+    }
+  if (size == 1)
+    {
+      uint8_t last[2] = {data[0], 0};
+      uint16_t word;
+      memcpy (&word, last, 2);
+      sum += word;
+    }
+  return sum;
+}
+
+#ifdef CHECKSUM_AVX2
+
+/**
+ * \ingroup packet
+ * \brief AVX2 version of ChecksumAddScalar, which sums 32 bytes per step
+ * in four 64 bit lanes.
+ *
+ * \param data the memory area
+ * \param size the size of the memory area (bytes), at most 65535
+ * \returns the (unfolded) sum
+ */
+__attribute__ ((target ("avx2")))
+uint64_t
+ChecksumAddAvx2 (const uint8_t *data, uint32_t size)
+{
+  __m256i zero = _mm256_setzero_si256 ();
+  __m256i acc = zero;
+  while (size >= 32)
+    {
+      __m256i v = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (data));
+      acc = _mm256_add_epi64 (acc, _mm256_unpacklo_epi32 (v, zero));
+      acc = _mm256_add_epi64 (acc, _mm256_unpackhi_epi32 (v, zero));
+      data += 32;
+      size -= 32;
+    }
+  uint64_t lanes[4];
+  _mm256_storeu_si256 (reinterpret_cast<__m256i *> (lanes), acc);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + ChecksumAddScalar (data, size);
+}
+
+#endif /* CHECKSUM_AVX2 */
+
+/// Signature of the functions summing the 16 bit words of a memory area
+typedef uint64_t (*ChecksumAddFunction) (const uint8_t *data, uint32_t size);
+
+/**
+ * \ingroup packet
+ * \brief Select the fastest checksum function supported by the CPU.
+ * \returns the checksum function
+ */
+ChecksumAddFunction
+SelectChecksumAdd (void)
+{
+#ifdef CHECKSUM_AVX2
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    {
+      return &ChecksumAddAvx2;
+    }
+#endif
+  return &ChecksumAddScalar;
+}
+
+/**
+ * \ingroup packet
+ * \brief Compute the one's complement sum of a memory area, read as
+ * little endian 16 bit words as Buffer::Iterator::ReadU16 does.
+ *
+ * \param data the memory area
+ * \param size the size of the memory area (bytes), at most 65535
+ * \returns the 16 bit sum
+ */
+uint32_t
+ChecksumAdd (const uint8_t *data, uint32_t size)
+{
+  static ChecksumAddFunction checksumAdd = SelectChecksumAdd ();
+  uint64_t sum = (*checksumAdd) (data, size);
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  // The sum of the words read in host byte order is, byte by byte, the
+  // sum of the words read in any other byte order (RFC 1071).
+  uint16_t folded = static_cast<uint16_t> (sum);
+  uint8_t bytes[2];
+  memcpy (bytes, &folded, 2);
+  return bytes[0] | (bytes[1] << 8);
+}
+
 }
 
 namespace ns3 {
@@ -168,10 +295,11 @@ Buffer::Allocate (uint32_t reqSize)
       reqSize = 1;
     }
   NS_ASSERT (reqSize >= 1);
-  uint32_t size = reqSize - 1 + sizeof (struct Buffer::Data);
-  uint8_t *b = new uint8_t [size];
+  uint32_t size = PacketAllocator::GetCapacity (reqSize - 1 + sizeof (struct Buffer::Data));
+  uint8_t *b = PacketAllocator::Allocate (size);
   struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(b);
-  data->m_size = reqSize;
+  // use all the room actually available in the allocated block
+  data->m_size = size + 1 - sizeof (struct Buffer::Data);
   data->m_count = 1;
   return data;
 }
@@ -182,7 +310,7 @@ Buffer::Deallocate (struct Buffer::Data *data)
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
   uint8_t *buf = reinterpret_cast<uint8_t *> (data);
-  delete [] buf;
+  PacketAllocator::Deallocate (buf, data->m_size - 1 + sizeof (struct Buffer::Data));
 }
 
 Buffer::Buffer ()
@@ -1141,14 +1269,35 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
   /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
+  uint64_t sum = initialChecksum;
+
+  // The bytes before the zero area, the zero area itself (which does not
+  // contribute to the sum) and the bytes after it are processed
+  // separately.  A part starting at an odd offset has its bytes swapped
+  // in the 16 bit words, hence its sum is byte swapped.
+  uint32_t start = m_current;
+  uint32_t end = m_current + size;
+  if (start < m_zeroStart)
+    {
+      uint32_t partEnd = std::min (end, m_zeroStart);
+      sum += ChecksumAdd (&m_data[start], partEnd - start);
+    }
+  if (end > m_zeroEnd)
+    {
+      uint32_t partStart = std::max (start, m_zeroEnd);
+      uint32_t partSum = ChecksumAdd (&m_data[partStart - (m_zeroEnd - m_zeroStart)],
+                                      end - partStart);
+      if ((partStart - start) & 1)
+        {
+          partSum = ((partSum & 0xff) << 8) | (partSum >> 8);
+        }
+      sum += partSum;
+    }
+  m_current = end;
 
   while (sum >> 16)
     sum = (sum & 0xffff) + (sum >> 16);
@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "byte-tag-list.h"
+#include "packet-allocator.h"
 #include "ns3/log.h"
 #include <vector>
 #include <cstring>
@@ -67,7 +68,7 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList ()
        i != end (); i++)
     {
       uint8_t *buffer = (uint8_t *)(*i);
-      delete [] buffer;
+      PacketAllocator::Deallocate (buffer, (*i)->size + sizeof (struct ByteTagListData) - 4);
     }
 }
 #endif /* USE_FREE_LIST */
@@ -357,12 +358,13 @@ ByteTagList::Allocate (uint32_t size)
           return data;
         }
       uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
+      PacketAllocator::Deallocate (buffer, data->size + sizeof (struct ByteTagListData) - 4);
     }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
+  uint32_t bufferSize = PacketAllocator::GetCapacity (std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4);
+  uint8_t *buffer = PacketAllocator::Allocate (bufferSize);
   struct ByteTagListData *data = (struct ByteTagListData *)buffer;
   data->count = 1;
-  data->size = size;
+  data->size = bufferSize - sizeof (struct ByteTagListData) + 4;
   data->dirty = 0;
   return data;
 }
@@ -383,7 +385,7 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
-          delete [] buffer;
+          PacketAllocator::Deallocate (buffer, data->size + sizeof (struct ByteTagListData) - 4);
         }
       else
         {
@@ -398,10 +400,11 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  uint8_t *buffer = new uint8_t [size + sizeof (struct ByteTagListData) - 4];
+  uint32_t bufferSize = PacketAllocator::GetCapacity (size + sizeof (struct ByteTagListData) - 4);
+  uint8_t *buffer = PacketAllocator::Allocate (bufferSize);
   struct ByteTagListData *data = (struct ByteTagListData *)buffer;
   data->count = 1;
-  data->size = size;
+  data->size = bufferSize - sizeof (struct ByteTagListData) + 4;
   data->dirty = 0;
   return data;
 }
@@ -418,7 +421,7 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   if (data->count == 0)
     {
       uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
+      PacketAllocator::Deallocate (buffer, data->size + sizeof (struct ByteTagListData) - 4);
     }
 }
 
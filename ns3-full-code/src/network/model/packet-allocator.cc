@@ -0,0 +1,322 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-allocator.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+#define PACKET_ALLOCATOR_SLAB 1
+
+#if defined(__SANITIZE_ADDRESS__)
+#undef PACKET_ALLOCATOR_SLAB
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer)
+#undef PACKET_ALLOCATOR_SLAB
+#endif
+#endif
+
+namespace {
+
+#ifdef PACKET_ALLOCATOR_SLAB
+
+/// Granularity of the small size classes
+const uint32_t SMALL_STEP = 16;
+/// Largest size served by the small size classes
+const uint32_t SMALL_MAX = 256;
+/// Number of small size classes
+const uint32_t N_SMALL_CLASSES = SMALL_MAX / SMALL_STEP;
+/// Largest size served by the pool
+const uint32_t MAX_POOLED = 16384;
+/// Number of size classes (four per power of two above SMALL_MAX)
+const uint32_t N_CLASSES = N_SMALL_CLASSES + 6 * 4;
+/// Number of blocks of the first slab of a size class
+const uint32_t INITIAL_SLAB_BLOCKS = 8;
+/// Maximum size of a slab, in bytes
+const uint32_t MAX_SLAB_SIZE = 256 * 1024;
+
+/**
+ * \brief Get the base two logarithm of a value, rounded down
+ * \param value the value (must be positive)
+ * \returns the logarithm
+ */
+uint32_t
+Log2 (uint32_t value)
+{
+  uint32_t p = 0;
+  while (value >>= 1)
+    {
+      p++;
+    }
+  return p;
+}
+
+/**
+ * \brief Get the size class serving a request
+ * \param size the requested size (at most MAX_POOLED bytes)
+ * \returns the size class index
+ */
+uint32_t
+GetSizeClass (uint32_t size)
+{
+  if (size <= SMALL_MAX)
+    {
+      return size == 0 ? 0 : (size - 1) / SMALL_STEP;
+    }
+  uint32_t p = Log2 (size - 1);
+  return N_SMALL_CLASSES + (p - 8) * 4 + (size - 1 - (1u << p)) / (1u << (p - 2));
+}
+
+/**
+ * \brief Get the block size of a size class
+ * \param sizeClass the size class index
+ * \returns the block size, in bytes
+ */
+uint32_t
+GetClassSize (uint32_t sizeClass)
+{
+  if (sizeClass < N_SMALL_CLASSES)
+    {
+      return (sizeClass + 1) * SMALL_STEP;
+    }
+  uint32_t p = 8 + (sizeClass - N_SMALL_CLASSES) / 4;
+  uint32_t k = (sizeClass - N_SMALL_CLASSES) % 4;
+  return (1u << p) + (k + 1) * (1u << (p - 2));
+}
+
+/// A released block, linked in the free list of its size class
+struct FreeBlock
+{
+  FreeBlock *next; //!< next free block
+};
+
+/// Header of a slab, which links all the slabs together
+struct Slab
+{
+  Slab *next;      //!< next slab
+};
+
+/// Offset of the first block of a slab, preserving a 16 bytes alignment
+const uint32_t SLAB_HEADER_SIZE = (sizeof (Slab) + 15) / 16 * 16;
+
+/// The state of a size class
+struct SizeClass
+{
+  FreeBlock *freeList;  //!< the released blocks
+  uint8_t *cursor;      //!< next block to carve from the current slab
+  uint32_t remaining;   //!< number of blocks left in the current slab
+  uint32_t slabBlocks;  //!< number of blocks of the last slab
+};
+
+/*
+ * All the state below is zero-initialized before any constructor runs
+ * and has a trivial destructor, so the pool is usable even from the
+ * static destructors of other compilation units (e.g., the Buffer
+ * free list).
+ */
+SizeClass g_classes[N_CLASSES];                 //!< the size classes
+Slab *g_slabs;                                  //!< all the slabs
+ns3::PacketAllocator::Statistics g_stats;       //!< the statistics
+bool g_released;                                //!< slabs returned to the system
+
+/// Release the slabs at program exit, unless blocks are still in use
+struct LocalStaticDestructor
+{
+  ~LocalStaticDestructor ();
+} g_localStaticDestructor; //!< Local static destructor
+
+LocalStaticDestructor::~LocalStaticDestructor ()
+{
+  if (g_stats.inUse != 0)
+    {
+      return;
+    }
+  while (g_slabs != 0)
+    {
+      Slab *slab = g_slabs;
+      g_slabs = slab->next;
+      delete [] reinterpret_cast<uint8_t *> (slab);
+    }
+  for (uint32_t i = 0; i < N_CLASSES; i++)
+    {
+      g_classes[i] = SizeClass ();
+    }
+  g_released = true;
+}
+
+#endif /* PACKET_ALLOCATOR_SLAB */
+
+} // unnamed namespace
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketAllocator");
+
+double
+PacketAllocator::Statistics::GetHitRate (void) const
+{
+  return allocations == 0 ? 0 : static_cast<double> (hits) / allocations;
+}
+
+uint32_t
+PacketAllocator::GetCapacity (uint32_t size)
+{
+#ifdef PACKET_ALLOCATOR_SLAB
+  if (size <= MAX_POOLED)
+    {
+      return GetClassSize (GetSizeClass (size));
+    }
+#endif
+  return size;
+}
+
+#ifdef PACKET_ALLOCATOR_SLAB
+
+uint8_t *
+PacketAllocator::Allocate (uint32_t size)
+{
+  g_stats.allocations++;
+  if (size > MAX_POOLED || g_released)
+    {
+      g_stats.heapAllocations++;
+      return new uint8_t [GetCapacity (size)];
+    }
+
+  uint32_t sizeClass = GetSizeClass (size);
+  SizeClass &c = g_classes[sizeClass];
+  g_stats.inUse++;
+
+  if (c.freeList != 0)
+    {
+      g_stats.hits++;
+      FreeBlock *block = c.freeList;
+      c.freeList = block->next;
+      return reinterpret_cast<uint8_t *> (block);
+    }
+
+  uint32_t blockSize = GetClassSize (sizeClass);
+  if (c.remaining == 0)
+    {
+      // Every new slab of a class is twice as large as the previous one,
+      // up to MAX_SLAB_SIZE, so that busy classes quickly settle on
+      // large slabs while rarely used ones waste little memory.
+      uint32_t blocks = c.slabBlocks == 0 ? INITIAL_SLAB_BLOCKS : 2 * c.slabBlocks;
+      if (blocks * blockSize > MAX_SLAB_SIZE)
+        {
+          blocks = std::max<uint32_t> (MAX_SLAB_SIZE / blockSize, INITIAL_SLAB_BLOCKS);
+        }
+      uint32_t slabSize = SLAB_HEADER_SIZE + blocks * blockSize;
+      uint8_t *buffer = new uint8_t [slabSize];
+      Slab *slab = reinterpret_cast<Slab *> (buffer);
+      slab->next = g_slabs;
+      g_slabs = slab;
+      c.cursor = buffer + SLAB_HEADER_SIZE;
+      c.remaining = blocks;
+      c.slabBlocks = blocks;
+      g_stats.slabs++;
+      g_stats.reservedBytes += slabSize;
+      NS_LOG_LOGIC ("new slab of " << blocks << " blocks of " << blockSize << " bytes");
+    }
+
+  g_stats.slabAllocations++;
+  uint8_t *block = c.cursor;
+  c.cursor += blockSize;
+  c.remaining--;
+  return block;
+}
+
+void
+PacketAllocator::Deallocate (uint8_t *buffer, uint32_t size)
+{
+  if (buffer == 0)
+    {
+      return;
+    }
+  g_stats.deallocations++;
+  if (size > MAX_POOLED || g_released)
+    {
+      delete [] buffer;
+      return;
+    }
+
+  NS_ASSERT (g_stats.inUse > 0);
+  g_stats.inUse--;
+  SizeClass &c = g_classes[GetSizeClass (size)];
+  FreeBlock *block = reinterpret_cast<FreeBlock *> (buffer);
+  block->next = c.freeList;
+  c.freeList = block;
+}
+
+PacketAllocator::Statistics
+PacketAllocator::GetStatistics (void)
+{
+  return g_stats;
+}
+
+void
+PacketAllocator::ResetStatistics (void)
+{
+  uint64_t inUse = g_stats.inUse;
+  uint64_t slabs = g_stats.slabs;
+  uint64_t reservedBytes = g_stats.reservedBytes;
+  g_stats = Statistics ();
+  g_stats.inUse = inUse;
+  g_stats.slabs = slabs;
+  g_stats.reservedBytes = reservedBytes;
+}
+
+#else /* PACKET_ALLOCATOR_SLAB */
+
+uint8_t *
+PacketAllocator::Allocate (uint32_t size)
+{
+  return new uint8_t [size];
+}
+
+void
+PacketAllocator::Deallocate (uint8_t *buffer, uint32_t size)
+{
+  delete [] buffer;
+}
+
+PacketAllocator::Statistics
+PacketAllocator::GetStatistics (void)
+{
+  return Statistics ();
+}
+
+void
+PacketAllocator::ResetStatistics (void)
+{
+}
+
+#endif /* PACKET_ALLOCATOR_SLAB */
+
+void
+PacketAllocator::PrintStatistics (std::ostream &os)
+{
+  Statistics stats = GetStatistics ();
+  os << "allocations=" << stats.allocations
+     << " hits=" << stats.hits
+     << " slab=" << stats.slabAllocations
+     << " heap=" << stats.heapAllocations
+     << " hit-rate=" << stats.GetHitRate ()
+     << " in-use=" << stats.inUse
+     << " slabs=" << stats.slabs
+     << " reserved=" << stats.reservedBytes << "B";
+}
+
+} // namespace ns3
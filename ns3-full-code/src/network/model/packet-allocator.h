@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKET_ALLOCATOR_H
+#define PACKET_ALLOCATOR_H
+
+#include <stdint.h>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Slab allocator for the packet internal data structures.
+ *
+ * Buffer::Data, PacketMetadata::Data, the byte tag list data and the
+ * packet tag list nodes are allocated for (almost) every packet and
+ * header operation.  Rather than going to the heap each time, the
+ * storage is taken from size-segregated slabs: requests are rounded
+ * up to one of a set of size classes (16 byte steps up to 256 bytes,
+ * then four classes per power of two up to 16 KiB) and every class
+ * keeps an intrusive free list of released blocks.  The number of
+ * blocks carved in a new slab doubles every time a class runs out of
+ * free blocks, so the memory reserved by every class follows the
+ * packet sizes actually observed during the simulation.
+ *
+ * Requests larger than the biggest size class are served by the heap.
+ * The slabs are never returned to the system while some block is in
+ * use; they are released at program exit otherwise.
+ *
+ * The pool is bypassed when building with the address sanitizer, so
+ * that out-of-bounds accesses to packet data can still be detected.
+ */
+class PacketAllocator
+{
+public:
+  /**
+   * \brief Allocation statistics
+   */
+  struct Statistics
+  {
+    uint64_t allocations;     //!< Number of calls to Allocate
+    uint64_t hits;            //!< Allocations served from a free list
+    uint64_t slabAllocations; //!< Allocations carved from a slab
+    uint64_t heapAllocations; //!< Allocations served by the heap
+    uint64_t deallocations;   //!< Number of calls to Deallocate
+    uint64_t inUse;           //!< Number of pooled blocks in use
+    uint64_t slabs;           //!< Number of slabs allocated
+    uint64_t reservedBytes;   //!< Memory reserved by the slabs
+
+    /**
+     * \returns the fraction of allocations served from a free list
+     */
+    double GetHitRate (void) const;
+  };
+
+  /**
+   * \brief Allocate a block of memory.
+   *
+   * The returned block can hold GetCapacity (size) bytes and is
+   * aligned to 16 bytes.
+   *
+   * \param size the requested size, in bytes
+   * \returns a pointer to the block
+   */
+  static uint8_t *Allocate (uint32_t size);
+  /**
+   * \brief Release a block returned by Allocate.
+   * \param buffer the block
+   * \param size the size passed to Allocate, or the capacity of the block
+   */
+  static void Deallocate (uint8_t *buffer, uint32_t size);
+  /**
+   * \param size a requested size, in bytes
+   * \returns the number of bytes actually usable in the block returned
+   *          by Allocate for this request
+   */
+  static uint32_t GetCapacity (uint32_t size);
+
+  /**
+   * \returns the allocation statistics
+   */
+  static Statistics GetStatistics (void);
+  /**
+   * \brief Reset the counters of the allocation statistics.
+   *
+   * The number of blocks in use and the reserved memory are not reset.
+   */
+  static void ResetStatistics (void);
+  /**
+   * \brief Print the allocation statistics
+   * \param os the output stream
+   */
+  static void PrintStatistics (std::ostream &os);
+};
+
+} // namespace ns3
+
+#endif /* PACKET_ALLOCATOR_H */
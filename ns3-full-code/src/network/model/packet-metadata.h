@@ -74,6 +74,12 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * Unless Enable or EnableChecking is called, the metadata is not
+ * recorded at all: every packet then shares a single empty data
+ * buffer, so that creating, copying and destroying a packet does not
+ * allocate any metadata storage, and adding or removing headers and
+ * trailers returns immediately.
  */
 class PacketMetadata 
 {
@@ -160,6 +166,11 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \returns true if the packet metadata is recorded, false if the
+   *          packets are in the lightweight, metadata-less mode
+   */
+  static bool IsEnabled (void);
 
   /**
    * \brief Constructor
@@ -660,8 +671,20 @@ public:
    * \param data the buffer data storage
    */
   static void Deallocate (struct PacketMetadata::Data *data);
+  /**
+   * \brief Get a new reference to the empty data storage shared by
+   * all the packets when the metadata is disabled
+   * \returns a pointer to the shared buffer storage
+   */
+  inline static struct PacketMetadata::Data *GetEmptyData (void);
+  /**
+   * \brief Allocate the empty data storage shared by all the packets
+   * \returns a pointer to the shared buffer storage
+   */
+  static struct PacketMetadata::Data *CreateEmptyData (void);
 
   static DataFreeList m_freeList; //!< the metadata data storage
+  static struct Data *m_emptyData; //!< the shared empty data storage
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -691,14 +714,28 @@ public:
 
 namespace ns3 {
 
+PacketMetadata::Data *
+PacketMetadata::GetEmptyData (void)
+{
+  if (m_emptyData == 0)
+    {
+      m_emptyData = CreateEmptyData ();
+    }
+  m_emptyData->m_count++;
+  return m_emptyData;
+}
+
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (m_enable ? PacketMetadata::Create (10) : PacketMetadata::GetEmptyData ()),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
     m_packetUid (uid)
 {
-  memset (m_data->m_data, 0xff, 4);
+  if (m_enable)
+    {
+      memset (m_data->m_data, 0xff, 4);
+    }
   if (size > 0)
     {
       DoAddHeader (0, size);
@@ -22,6 +22,9 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include "ns3/crc32.h"
+
+#include <vector>
 
 using namespace ns3;
 
@@ -387,6 +390,135 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the Internet checksum and the CRC-32 against byte by byte
+ * implementations, on buffers with and without zero area and for any
+ * alignment of the data.
+ */
+class BufferChecksumTest : public TestCase {
+private:
+  /**
+   * Compute the checksum of a buffer area by reading it word by word.
+   * \param i iterator pointing to the first byte of the area
+   * \param size the size of the area
+   * \returns the checksum
+   */
+  uint16_t ReferenceChecksum (Buffer::Iterator i, uint16_t size);
+  /**
+   * Compute the CRC-32 of a memory area bit by bit.
+   * \param data the memory area
+   * \param size the size of the area
+   * \returns the CRC-32
+   */
+  uint32_t ReferenceCrc32 (const uint8_t *data, uint32_t size);
+public:
+  virtual void DoRun (void);
+  BufferChecksumTest ();
+};
+
+BufferChecksumTest::BufferChecksumTest ()
+  : TestCase ("Buffer checksum and CRC-32") {
+}
+
+uint16_t
+BufferChecksumTest::ReferenceChecksum (Buffer::Iterator i, uint16_t size)
+{
+  uint32_t sum = 0;
+  for (uint32_t j = 0; j < size / 2u; j++)
+    {
+      sum += i.ReadU16 ();
+    }
+  if (size & 1)
+    {
+      sum += i.ReadU8 ();
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+uint32_t
+BufferChecksumTest::ReferenceCrc32 (const uint8_t *data, uint32_t size)
+{
+  uint32_t crc = 0xffffffff;
+  for (uint32_t j = 0; j < size; j++)
+    {
+      crc ^= data[j];
+      for (uint32_t k = 0; k < 8; k++)
+        {
+          crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+        }
+    }
+  return ~crc;
+}
+
+void
+BufferChecksumTest::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  // zero area of various sizes between data written at both ends
+  uint32_t zeroSizes[] = {0, 1, 3, 64, 1000};
+  for (uint32_t zeroSize : zeroSizes)
+    {
+      for (uint32_t start = 0; start < 8; start++)
+        {
+          uint32_t headerSize = 37 + start;
+          uint32_t trailerSize = 131 + start;
+          Buffer buffer (zeroSize);
+          buffer.AddAtStart (headerSize);
+          buffer.AddAtEnd (trailerSize);
+          Buffer::Iterator i = buffer.Begin ();
+          for (uint32_t j = 0; j < headerSize; j++)
+            {
+              i.WriteU8 (rng->GetInteger (0, 255));
+            }
+          i.Next (zeroSize);
+          for (uint32_t j = 0; j < trailerSize; j++)
+            {
+              i.WriteU8 (rng->GetInteger (0, 255));
+            }
+
+          for (uint32_t size = 0; size + start <= buffer.GetSize (); size += 1 + size / 4)
+            {
+              Buffer::Iterator a = buffer.Begin ();
+              a.Next (start);
+              Buffer::Iterator b = a;
+              uint16_t checksum = a.CalculateIpChecksum (size);
+              NS_TEST_EXPECT_MSG_EQ (checksum, ReferenceChecksum (b, size),
+                                     "Wrong checksum (zero area " << zeroSize << ", start "
+                                     << start << ", size " << size << ")");
+              NS_TEST_EXPECT_MSG_EQ (a.GetDistanceFrom (buffer.Begin ()), start + size,
+                                     "The iterator must be moved after the checksummed area");
+            }
+        }
+    }
+
+  std::vector<uint8_t> data (1500);
+  for (uint32_t j = 0; j < data.size (); j++)
+    {
+      data[j] = rng->GetInteger (0, 255);
+    }
+  for (uint32_t start = 0; start < 16; start++)
+    {
+      for (uint32_t size = 0; size + start <= data.size (); size += 1 + size / 8)
+        {
+          NS_TEST_EXPECT_MSG_EQ (CRC32Calculate (&data[start], size),
+                                 ReferenceCrc32 (&data[start], size),
+                                 "Wrong CRC-32 (start " << start << ", size " << size << ")");
+        }
+    }
+  const char check[] = "123456789";
+  NS_TEST_EXPECT_MSG_EQ (CRC32Calculate (reinterpret_cast<const uint8_t *> (check), 9), 0xcbf43926,
+                         "Wrong CRC-32 check value");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -403,6 +535,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferChecksumTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/packet-allocator.h"
+#include "ns3/packet.h"
+#include "ns3/test.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the size classes and the block recycling of the PacketAllocator.
+ */
+class PacketAllocatorTest : public TestCase
+{
+public:
+  PacketAllocatorTest ();
+private:
+  virtual void DoRun (void);
+};
+
+PacketAllocatorTest::PacketAllocatorTest ()
+  : TestCase ("Check the packet slab allocator")
+{
+}
+
+void
+PacketAllocatorTest::DoRun (void)
+{
+  for (uint32_t size = 1; size <= 20000; size += 7)
+    {
+      uint32_t capacity = PacketAllocator::GetCapacity (size);
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (capacity, size, "Capacity too small for " << size);
+      NS_TEST_ASSERT_MSG_EQ (PacketAllocator::GetCapacity (capacity), capacity,
+                             "The capacity of a block must map onto the same size class");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (capacity, size + size / 4 + 16, "Too much waste for " << size);
+    }
+
+  PacketAllocator::ResetStatistics ();
+  std::vector<uint8_t *> blocks;
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      uint8_t *block = PacketAllocator::Allocate (600);
+      NS_TEST_ASSERT_MSG_EQ (reinterpret_cast<uintptr_t> (block) % 16, 0, "Block not aligned");
+      std::memset (block, i, PacketAllocator::GetCapacity (600));
+      blocks.push_back (block);
+    }
+  for (uint32_t i = 0; i < blocks.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (blocks[i][0], i, "Block overwritten");
+      PacketAllocator::Deallocate (blocks[i], 600);
+    }
+
+  // Blocks of the same size class must now be recycled (statistics are
+  // not collected when the pool is disabled)
+  PacketAllocator::Statistics before = PacketAllocator::GetStatistics ();
+  uint8_t *block = PacketAllocator::Allocate (PacketAllocator::GetCapacity (600));
+  PacketAllocator::Statistics after = PacketAllocator::GetStatistics ();
+  if (before.allocations != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (before.allocations, 100, "Wrong number of allocations");
+      NS_TEST_EXPECT_MSG_EQ (before.deallocations, 100, "Wrong number of deallocations");
+      NS_TEST_EXPECT_MSG_EQ (after.hits, before.hits + 1, "The block has not been recycled");
+      NS_TEST_EXPECT_MSG_EQ (after.slabs, before.slabs, "No new slab should have been needed");
+    }
+  PacketAllocator::Deallocate (block, 600);
+
+  // Oversized requests bypass the pool
+  block = PacketAllocator::Allocate (100000);
+  std::memset (block, 0, 100000);
+  PacketAllocator::Deallocate (block, 100000);
+
+  // Packet operations must keep working on recycled storage
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (500 + i);
+      Ptr<Packet> copy = p->Copy ();
+      copy->AddPaddingAtEnd (10);
+      NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 500 + i, "Wrong packet size");
+      NS_TEST_EXPECT_MSG_EQ (copy->GetSize (), 510 + i, "Wrong copy size");
+    }
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief PacketAllocator TestSuite
+ */
+class PacketAllocatorTestSuite : public TestSuite
+{
+public:
+  PacketAllocatorTestSuite ();
+};
+
+PacketAllocatorTestSuite::PacketAllocatorTestSuite ()
+  : TestSuite ("packet-allocator", UNIT)
+{
+  AddTestCase (new PacketAllocatorTest, TestCase::QUICK);
+}
+
+static PacketAllocatorTestSuite g_packetAllocatorTestSuite; //!< Static variable for test initialization
@@ -27,6 +27,11 @@
  */
 #include <stdint.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32_PCLMUL 1
+#include <immintrin.h>
+#endif
+
 namespace ns3 {
 
 /**
@@ -67,17 +72,177 @@ static uint32_t crc32table[256] = {
 0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D 
 };
 
+/**
+ * Tables of the slicing-by-8 algorithm: crc32slices[0] is crc32table and
+ * crc32slices[k][i] is the CRC of byte i followed by k zero bytes.
+ */
+static uint32_t crc32slices[8][256];
+
+/**
+ * Fill crc32slices.
+ * \returns true
+ */
+static bool
+CRC32InitSlices (void)
+{
+  for (uint32_t i = 0; i < 256; i++)
+    {
+      crc32slices[0][i] = crc32table[i];
+    }
+  for (uint32_t k = 1; k < 8; k++)
+    {
+      for (uint32_t i = 0; i < 256; i++)
+        {
+          uint32_t prev = crc32slices[k - 1][i];
+          crc32slices[k][i] = (prev >> 8) ^ crc32table[prev & 0xff];
+        }
+    }
+  return true;
+}
+
+/**
+ * Update a CRC-32 with the slicing-by-8 algorithm, which processes
+ * eight bytes per step with independent table lookups.
+ *
+ * \param crc the current (non inverted) CRC
+ * \param data the buffer
+ * \param length the length of the buffer (bytes)
+ * \returns the updated CRC
+ */
+static uint32_t
+CRC32UpdateSliced (uint32_t crc, const uint8_t *data, uint32_t length)
+{
+  static bool initialized = CRC32InitSlices ();
+  (void) initialized;
+
+  while (length >= 8)
+    {
+      uint32_t one = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t) data[3] << 24));
+      uint32_t two = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t) data[7] << 24);
+      crc = crc32slices[7][one & 0xff] ^ crc32slices[6][(one >> 8) & 0xff]
+        ^ crc32slices[5][(one >> 16) & 0xff] ^ crc32slices[4][one >> 24]
+        ^ crc32slices[3][two & 0xff] ^ crc32slices[2][(two >> 8) & 0xff]
+        ^ crc32slices[1][(two >> 16) & 0xff] ^ crc32slices[0][two >> 24];
+      data += 8;
+      length -= 8;
+    }
+  while (length--)
+    {
+      crc = (crc >> 8) ^ crc32table[(crc & 0xFF) ^ *data++];
+    }
+  return crc;
+}
+
+#ifdef CRC32_PCLMUL
+
+/**
+ * Update a CRC-32 with carry-less multiplications, folding 64 bytes per
+ * step (see "Fast CRC Computation for Generic Polynomials Using
+ * PCLMULQDQ Instruction", Intel, 2009).  The constants are the folding
+ * and Barrett reduction constants of the bit-reflected polynomial.
+ *
+ * \param crc the current (non inverted) CRC
+ * \param data the buffer
+ * \param length the length of the buffer (bytes), a multiple of 16 and
+ *        at least 64
+ * \returns the updated CRC
+ */
+__attribute__ ((target ("pclmul,sse2")))
+static uint32_t
+CRC32UpdatePclmul (uint32_t crc, const uint8_t *data, uint32_t length)
+{
+  const __m128i k1k2 = _mm_set_epi64x (0x01c6e41596, 0x0154442bd4);
+  const __m128i k3k4 = _mm_set_epi64x (0x00ccaa009e, 0x01751997d0);
+  const __m128i k5 = _mm_set_epi64x (0, 0x0163cd6124);
+  const __m128i poly = _mm_set_epi64x (0x01f7011641, 0x01db710641);
+  const __m128i mask32 = _mm_set_epi32 (0, 0, 0, -1);
+
+  __m128i x1 = _mm_loadu_si128 ((const __m128i *) (data + 0x00));
+  __m128i x2 = _mm_loadu_si128 ((const __m128i *) (data + 0x10));
+  __m128i x3 = _mm_loadu_si128 ((const __m128i *) (data + 0x20));
+  __m128i x4 = _mm_loadu_si128 ((const __m128i *) (data + 0x30));
+  x1 = _mm_xor_si128 (x1, _mm_cvtsi32_si128 (crc));
+  data += 64;
+  length -= 64;
+
+  // fold four 128 bit lanes by 512 bits at a time
+  while (length >= 64)
+    {
+      __m128i t1 = _mm_clmulepi64_si128 (x1, k1k2, 0x11);
+      __m128i t2 = _mm_clmulepi64_si128 (x2, k1k2, 0x11);
+      __m128i t3 = _mm_clmulepi64_si128 (x3, k1k2, 0x11);
+      __m128i t4 = _mm_clmulepi64_si128 (x4, k1k2, 0x11);
+      x1 = _mm_xor_si128 (_mm_clmulepi64_si128 (x1, k1k2, 0x00), t1);
+      x2 = _mm_xor_si128 (_mm_clmulepi64_si128 (x2, k1k2, 0x00), t2);
+      x3 = _mm_xor_si128 (_mm_clmulepi64_si128 (x3, k1k2, 0x00), t3);
+      x4 = _mm_xor_si128 (_mm_clmulepi64_si128 (x4, k1k2, 0x00), t4);
+      x1 = _mm_xor_si128 (x1, _mm_loadu_si128 ((const __m128i *) (data + 0x00)));
+      x2 = _mm_xor_si128 (x2, _mm_loadu_si128 ((const __m128i *) (data + 0x10)));
+      x3 = _mm_xor_si128 (x3, _mm_loadu_si128 ((const __m128i *) (data + 0x20)));
+      x4 = _mm_xor_si128 (x4, _mm_loadu_si128 ((const __m128i *) (data + 0x30)));
+      data += 64;
+      length -= 64;
+    }
+
+  // fold the four lanes into one, then the remaining 128 bit blocks
+  __m128i t = _mm_clmulepi64_si128 (x1, k3k4, 0x11);
+  x1 = _mm_xor_si128 (_mm_xor_si128 (_mm_clmulepi64_si128 (x1, k3k4, 0x00), t), x2);
+  t = _mm_clmulepi64_si128 (x1, k3k4, 0x11);
+  x1 = _mm_xor_si128 (_mm_xor_si128 (_mm_clmulepi64_si128 (x1, k3k4, 0x00), t), x3);
+  t = _mm_clmulepi64_si128 (x1, k3k4, 0x11);
+  x1 = _mm_xor_si128 (_mm_xor_si128 (_mm_clmulepi64_si128 (x1, k3k4, 0x00), t), x4);
+  while (length >= 16)
+    {
+      t = _mm_clmulepi64_si128 (x1, k3k4, 0x11);
+      x1 = _mm_xor_si128 (_mm_clmulepi64_si128 (x1, k3k4, 0x00), t);
+      x1 = _mm_xor_si128 (x1, _mm_loadu_si128 ((const __m128i *) data));
+      data += 16;
+      length -= 16;
+    }
+
+  // fold 128 bits into 64 bits, then 64 bits into 32 bits
+  t = _mm_clmulepi64_si128 (k3k4, x1, 0x01);
+  x1 = _mm_xor_si128 (_mm_srli_si128 (x1, 8), t);
+  t = _mm_clmulepi64_si128 (_mm_and_si128 (x1, mask32), k5, 0x00);
+  x1 = _mm_xor_si128 (_mm_srli_si128 (x1, 4), t);
+
+  // Barrett reduction
+  t = _mm_clmulepi64_si128 (_mm_and_si128 (x1, mask32), poly, 0x10);
+  t = _mm_clmulepi64_si128 (_mm_and_si128 (t, mask32), poly, 0x00);
+  x1 = _mm_xor_si128 (x1, t);
+  return _mm_cvtsi128_si32 (_mm_srli_si128 (x1, 4));
+}
+
+/**
+ * \returns true if the CPU supports the carry-less multiplication
+ */
+static bool
+CRC32HasPclmul (void)
+{
+  __builtin_cpu_init ();
+  return __builtin_cpu_supports ("pclmul");
+}
+
+#endif /* CRC32_PCLMUL */
+
 uint32_t
 CRC32Calculate (const uint8_t *data, int length)
 {
   uint32_t crc = 0xffffffff;
 
-  while (length--)
+#ifdef CRC32_PCLMUL
+  static bool pclmul = CRC32HasPclmul ();
+  if (pclmul && length >= 64)
     {
-      crc = (crc >> 8) ^ crc32table[(crc & 0xFF) ^ *data++];
+      uint32_t blocks = length & ~15;
+      crc = CRC32UpdatePclmul (crc, data, blocks);
+      data += blocks;
+      length -= blocks;
     }
+#endif
+
+  crc = CRC32UpdateSliced (crc, data, length);
   return ~crc;
 }
 
 } // namespace ns3
-
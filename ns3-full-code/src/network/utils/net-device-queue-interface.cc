@@ -43,6 +43,7 @@ NetDeviceQueue::GetTypeId (void)
 NetDeviceQueue::NetDeviceQueue ()
   : m_stoppedByDevice (false),
     m_stoppedByQueueLimits (false),
+    m_deviceNotifiesTxCompletion (false),
     NS_LOG_TEMPLATE_DEFINE ("NetDeviceQueueInterface")
 {
   NS_LOG_FUNCTION (this);
@@ -146,6 +147,13 @@ NetDeviceQueue::NotifyTransmittedBytes (uint32_t bytes)
     }
 }
 
+void
+NetDeviceQueue::SetDeviceNotifiesTxCompletion (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  m_deviceNotifiesTxCompletion = enable;
+}
+
 void
 NetDeviceQueue::ResetQueueLimits ()
 {
@@ -131,6 +131,20 @@ public:
    */
   virtual void NotifyTransmittedBytes (uint32_t bytes);
 
+  /**
+   * \brief Set whether the device reports the completion of its transmissions
+   * \param enable true if the device calls NotifyTransmittedBytes when it has
+   *        transmitted a packet
+   *
+   * By default, the bytes of a packet are reported as transmitted when the
+   * packet is dequeued from the device queue (see PacketDequeued), i.e., when
+   * the device starts transmitting it. A device which calls NotifyTransmittedBytes
+   * once the transmission is complete (like the Tx completion handler of a Linux
+   * driver calls netdev_tx_completed_queue) enables this, so that the packet being
+   * transmitted is still accounted as in flight by the queue limits.
+   */
+  void SetDeviceNotifiesTxCompletion (bool enable);
+
   /**
    * \brief Reset queue limits state
    */
@@ -206,6 +220,7 @@ public:
 private:
   bool m_stoppedByDevice;         //!< True if the queue has been stopped by the device
   bool m_stoppedByQueueLimits;    //!< True if the queue has been stopped by a queue limits object
+  bool m_deviceNotifiesTxCompletion; //!< True if the device reports the transmitted bytes
   Ptr<QueueLimits> m_queueLimits; //!< Queue limits object
   WakeCallback m_wakeCallback;    //!< Wake callback
   Ptr<NetDevice> m_device;        //!< the netdevice aggregated to the NetDeviceQueueInterface
@@ -364,8 +379,11 @@ NetDeviceQueue::PacketDequeued (QueueType* queue, Ptr<const typename QueueType::
 {
   NS_LOG_FUNCTION (this << queue << item);
 
-  // Inform BQL
-  NotifyTransmittedBytes (item->GetSize ());
+  // Inform BQL, unless the device does it when the transmission completes
+  if (!m_deviceNotifiesTxCompletion)
+    {
+      NotifyTransmittedBytes (item->GetSize ());
+    }
 
   NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
   // After dequeuing a packet, if there is room for another packet we
@@ -88,6 +88,14 @@ public:
   */
   virtual Ptr<IpRoutingProtocol> Create (Ptr<Node> node) const;
 
+  /**
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set.
+   *
+   * This method controls the attributes of ns3::NixVectorRouting
+   */
+  void Set (std::string name, const AttributeValue &value);
+
   /**
    * \brief prints the routing path for a source and destination at a particular time.
    * If the routing path does not exist, it prints that the path does not exist between
@@ -28,6 +28,7 @@
 
 #include "ns3/log.h"
 #include "ns3/abort.h"
+#include "ns3/boolean.h"
 #include "ns3/names.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/loopback-net-device.h"
@@ -50,6 +51,12 @@ typename NixVectorRouting<T>::IpAddressToNodeMap NixVectorRouting<T>::g_ipAddres
 template <typename T>
 typename NixVectorRouting<T>::NetDeviceToIpInterfaceMap NixVectorRouting<T>::g_netdeviceToIpInterfaceMap;
 
+template <typename T>
+std::vector<uint16_t> NixVectorRouting<T>::g_nextHopTable;
+
+template <typename T>
+uint32_t NixVectorRouting<T>::g_nextHopTableNodes = 0;
+
 template <typename T>
 TypeId 
 NixVectorRouting<T>::GetTypeId (void)
@@ -60,13 +67,20 @@ NixVectorRouting<T>::GetTypeId (void)
     .SetParent<T> ()
     .SetGroupName ("NixVectorRouting")
     .template AddConstructor<NixVectorRouting<T> > ()
+    .AddAttribute ("Compiled",
+                   "Route with a next-hop table computed once for all the pairs of nodes, "
+                   "instead of building a nix-vector per destination.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NixVectorRouting<T>::m_compiled),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 template <typename T>
 NixVectorRouting<T>::NixVectorRouting ()
-  : m_totalNeighbors (0)
+  : m_totalNeighbors (0),
+    m_compiled (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -121,6 +135,7 @@ NixVectorRouting<T>::DoDispose ()
 
   m_node = 0;
   m_ip = 0;
+  m_nextHops.clear ();
 
   T::DoDispose ();
 }
@@ -153,11 +168,17 @@ NixVectorRouting<T>::FlushGlobalNixRoutingCache (void) const
       rp->FlushNixCache ();
       rp->FlushIpRouteCache ();
       rp->m_totalNeighbors = 0;
+      rp->m_nextHops.clear ();
     }
 
   // IP address to node mapping is potentially invalid so clear it.
   // Will be repopulated in lazy evaluation when mapping is needed.
   g_ipAddressToNodeMap.clear ();
+  g_netdeviceToIpInterfaceMap.clear ();
+
+  // Likewise for the next-hop table
+  g_nextHopTable.clear ();
+  g_nextHopTableNodes = 0;
 }
 
 template <typename T>
@@ -713,6 +734,33 @@ NixVectorRouting<T>::RouteOutput (Ptr<Packet> p, const IpHeader &header, Ptr<Net
           return rtentry;
         }
     }
+  if (m_compiled)
+    {
+      uint16_t nextHop = GetNextHop (destAddress);
+      if (nextHop == NO_NEXT_HOP)
+        {
+          NS_LOG_ERROR ("No path to the dest: " << destAddress);
+          sockerr = Socket::ERROR_NOROUTETOHOST;
+          return 0;
+        }
+      const NextHop &entry = m_nextHops[nextHop];
+      // If another output device is requested, fall back on a nix-vector
+      // built through that device
+      Ptr<NetDevice> dev = m_ip->GetNetDevice (entry.interface);
+      if (!oif || oif == dev)
+        {
+          IpAddress sourceIPAddr = m_ip->SourceAddressSelection (entry.interface, destAddress);
+          rtentry = GetIpRouteInCache (destAddress);
+          if (!rtentry || rtentry->GetOutputDevice () != dev || rtentry->GetSource () != sourceIPAddr)
+            {
+              rtentry = CreateNextHopRoute (entry, sourceIPAddr, destAddress);
+              m_ipRouteCache[destAddress] = rtentry;
+            }
+          sockerr = Socket::ERROR_NOTERROR;
+          return rtentry;
+        }
+    }
+
   // Check the Nix cache
   bool foundInCache = false;
   nixVectorInCache = GetNixVectorInCache (destAddress, foundInCache);
@@ -888,45 +936,64 @@ NixVectorRouting<T>::RouteInput (Ptr<const Packet> p, const IpHeader &header, Pt
 
   Ptr<IpRoute> rtentry;
 
-  // Get the nix-vector from the packet
-  Ptr<NixVector> nixVector = p->GetNixVector ();
-
-  // If nixVector isn't in packet, something went wrong
-  NS_ASSERT (nixVector);
-
-  // Get the interface number that we go out of, by extracting
-  // from the nix-vector
-  if (m_totalNeighbors == 0)
+  if (m_compiled)
     {
-      m_totalNeighbors = FindTotalNeighbors (m_node);
+      uint16_t nextHop = GetNextHop (destAddress);
+      if (nextHop == NO_NEXT_HOP)
+        {
+          NS_LOG_LOGIC ("No path to the dest: " << destAddress);
+          return false;
+        }
+      const NextHop &entry = m_nextHops[nextHop];
+      rtentry = GetIpRouteInCache (destAddress);
+      if (!rtentry)
+        {
+          rtentry = CreateNextHopRoute (entry, m_ip->GetAddress (entry.interface, 0).GetAddress (), destAddress);
+          m_ipRouteCache.insert (typename IpRouteMap_t::value_type (destAddress, rtentry));
+        }
     }
-  uint32_t numberOfBits = nixVector->BitCount (m_totalNeighbors);
-  uint32_t nodeIndex = nixVector->ExtractNeighborIndex (numberOfBits);
-
-  rtentry = GetIpRouteInCache (destAddress);
-  // not in cache
-  if (!rtentry)
+  else
     {
-      NS_LOG_LOGIC ("IpRoute not in cache, build: ");
-      IpAddress gatewayIp;
-      uint32_t index = FindNetDeviceForNixIndex (m_node, nodeIndex, gatewayIp);
-      uint32_t interfaceIndex = (m_ip)->GetInterfaceForDevice (m_node->GetDevice (index));
-      IpInterfaceAddress ifAddr = m_ip->GetAddress (interfaceIndex, 0);
+      // Get the nix-vector from the packet
+      Ptr<NixVector> nixVector = p->GetNixVector ();
 
-      // start filling in the IpRoute info
-      rtentry = Create<IpRoute> ();
-      rtentry->SetSource (ifAddr.GetAddress ());
+      // If nixVector isn't in packet, something went wrong
+      NS_ASSERT (nixVector);
 
-      rtentry->SetGateway (gatewayIp);
-      rtentry->SetDestination (destAddress);
-      rtentry->SetOutputDevice (m_ip->GetNetDevice (interfaceIndex));
+      // Get the interface number that we go out of, by extracting
+      // from the nix-vector
+      if (m_totalNeighbors == 0)
+        {
+          m_totalNeighbors = FindTotalNeighbors (m_node);
+        }
+      uint32_t numberOfBits = nixVector->BitCount (m_totalNeighbors);
+      uint32_t nodeIndex = nixVector->ExtractNeighborIndex (numberOfBits);
 
-      // add rtentry to cache
-      m_ipRouteCache.insert (typename IpRouteMap_t::value_type (destAddress, rtentry));
-    }
+      rtentry = GetIpRouteInCache (destAddress);
+      // not in cache
+      if (!rtentry)
+        {
+          NS_LOG_LOGIC ("IpRoute not in cache, build: ");
+          IpAddress gatewayIp;
+          uint32_t index = FindNetDeviceForNixIndex (m_node, nodeIndex, gatewayIp);
+          uint32_t interfaceIndex = (m_ip)->GetInterfaceForDevice (m_node->GetDevice (index));
+          IpInterfaceAddress ifAddr = m_ip->GetAddress (interfaceIndex, 0);
+
+          // start filling in the IpRoute info
+          rtentry = Create<IpRoute> ();
+          rtentry->SetSource (ifAddr.GetAddress ());
 
-  NS_LOG_LOGIC ("At Node " << m_node->GetId () << ", Extracting " << numberOfBits <<
-                " bits from Nix-vector: " << nixVector << " : " << *nixVector);
+          rtentry->SetGateway (gatewayIp);
+          rtentry->SetDestination (destAddress);
+          rtentry->SetOutputDevice (m_ip->GetNetDevice (interfaceIndex));
+
+          // add rtentry to cache
+          m_ipRouteCache.insert (typename IpRouteMap_t::value_type (destAddress, rtentry));
+        }
+
+      NS_LOG_LOGIC ("At Node " << m_node->GetId () << ", Extracting " << numberOfBits <<
+                    " bits from Nix-vector: " << nixVector << " : " << *nixVector);
+    }
 
   // call the unicast callback
   // local deliver is handled by Ipv4StaticRoutingImpl
@@ -1008,6 +1075,41 @@ NixVectorRouting<T>::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::U
           *os << std::endl;
         }
     }
+  if (m_compiled)
+    {
+      if (g_nextHopTable.empty ())
+        {
+          BuildNextHopTable ();
+        }
+      *os << "NextHopTable:" << std::endl;
+      *os << std::setw (30) << "Destination";
+      *os << std::setw (30) << "Gateway";
+      *os << "OutputDevice" << std::endl;
+      const uint16_t *row = &g_nextHopTable[m_node->GetId () * g_nextHopTableNodes];
+      for (uint32_t dest = 0; dest < g_nextHopTableNodes; dest++)
+        {
+          if (row[dest] == NO_NEXT_HOP)
+            {
+              continue;
+            }
+          const NextHop &entry = m_nextHops[row[dest]];
+          std::ostringstream node, gw;
+          node << "Node " << dest;
+          *os << std::setw (30) << node.str ();
+          gw << entry.gateway;
+          *os << std::setw (30) << gw.str ();
+          Ptr<NetDevice> device = m_ip->GetNetDevice (entry.interface);
+          if (Names::FindName (device) != "")
+            {
+              *os << Names::FindName (device);
+            }
+          else
+            {
+              *os << device->GetIfIndex ();
+            }
+          *os << std::endl;
+        }
+    }
   *os << std::endl;
   // Restore the previous ostream state
   (*os).copyfmt (oldState);
@@ -1342,6 +1444,160 @@ NixVectorRouting<T>::PrintRoutingPath (Ptr<Node> source, IpAddress dest,
   (*os).copyfmt (oldState);
 }
 
+template <typename T>
+void
+NixVectorRouting<T>::BuildNextHopTable (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  /// A neighbor of a node
+  struct Neighbor
+  {
+    uint32_t node;             //!< the neighbor node
+    int32_t interface;         //!< the interface towards the neighbor
+    Ptr<NetDevice> device;     //!< the device of the neighbor on the channel
+  };
+
+  uint32_t numberOfNodes = NodeList::GetNNodes ();
+
+  // Collect the neighbors of every node once, with the same
+  // checks and in the same order as BFS ()
+  std::vector< std::vector<Neighbor> > neighbors (numberOfNodes);
+  for (uint32_t id = 0; id < numberOfNodes; id++)
+    {
+      Ptr<Node> node = NodeList::GetNode (id);
+      Ptr<IpL3Protocol> ip = node->GetObject<IpL3Protocol> ();
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+          int32_t interfaceIndex = -1;
+          if (ip)
+            {
+              interfaceIndex = ip->GetInterfaceForDevice (localNetDevice);
+              if (interfaceIndex == -1 || !(ip->IsUp (interfaceIndex)))
+                {
+                  continue;
+                }
+            }
+          if (!(localNetDevice->IsLinkUp ()))
+            {
+              continue;
+            }
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+
+          NetDeviceContainer netDeviceContainer;
+          GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+          for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+            {
+              Ptr<IpInterface> remoteIpInterface = GetInterfaceByNetDevice (*iter);
+              if (remoteIpInterface == 0 || !(remoteIpInterface->IsUp ()))
+                {
+                  continue;
+                }
+              Neighbor neighbor;
+              neighbor.node = (*iter)->GetNode ()->GetId ();
+              neighbor.interface = interfaceIndex;
+              neighbor.device = *iter;
+              neighbors[id].push_back (neighbor);
+            }
+        }
+    }
+
+  g_nextHopTable.assign (numberOfNodes * numberOfNodes, NO_NEXT_HOP);
+  g_nextHopTableNodes = numberOfNodes;
+
+  // One BFS per node using compiled routing: the next hop of a node is
+  // the next hop of its parent, or itself for the neighbors of the source
+  std::vector<uint32_t> greyNodeList;
+  std::vector<bool> visited;
+  for (uint32_t source = 0; source < numberOfNodes; source++)
+    {
+      Ptr<NixVectorRouting<T> > rp = NodeList::GetNode (source)->GetObject<NixVectorRouting> ();
+      if (!rp || !rp->m_compiled)
+        {
+          continue;
+        }
+      NS_ABORT_MSG_IF (neighbors[source].size () >= NO_NEXT_HOP,
+                       "Too many neighbors for the next-hop table at node " << source);
+
+      rp->m_nextHops.clear ();
+      for (const Neighbor &neighbor : neighbors[source])
+        {
+          NextHop nextHop;
+          nextHop.interface = neighbor.interface;
+          nextHop.gateway = GetInterfaceByNetDevice (neighbor.device)->GetAddress (0).GetAddress ();
+          rp->m_nextHops.push_back (nextHop);
+        }
+
+      uint16_t *row = &g_nextHopTable[source * numberOfNodes];
+      visited.assign (numberOfNodes, false);
+      visited[source] = true;
+      greyNodeList.clear ();
+      for (uint16_t i = 0; i < neighbors[source].size (); i++)
+        {
+          uint32_t remoteNode = neighbors[source][i].node;
+          if (!visited[remoteNode])
+            {
+              visited[remoteNode] = true;
+              row[remoteNode] = i;
+              greyNodeList.push_back (remoteNode);
+            }
+        }
+      for (std::size_t head = 0; head < greyNodeList.size (); head++)
+        {
+          uint32_t currNode = greyNodeList[head];
+          for (const Neighbor &neighbor : neighbors[currNode])
+            {
+              if (!visited[neighbor.node])
+                {
+                  visited[neighbor.node] = true;
+                  row[neighbor.node] = row[currNode];
+                  greyNodeList.push_back (neighbor.node);
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+uint16_t
+NixVectorRouting<T>::GetNextHop (IpAddress dest) const
+{
+  NS_LOG_FUNCTION (this << dest);
+
+  CheckCacheStateAndFlush ();
+
+  if (g_nextHopTable.empty ())
+    {
+      BuildNextHopTable ();
+    }
+
+  Ptr<Node> destNode = GetNodeByIp (dest);
+  if (destNode == 0 || destNode->GetId () >= g_nextHopTableNodes)
+    {
+      return NO_NEXT_HOP;
+    }
+  return g_nextHopTable[m_node->GetId () * g_nextHopTableNodes + destNode->GetId ()];
+}
+
+template <typename T>
+Ptr<typename NixVectorRouting<T>::IpRoute>
+NixVectorRouting<T>::CreateNextHopRoute (const NextHop &nextHop, IpAddress source, IpAddress dest) const
+{
+  NS_LOG_FUNCTION (this << nextHop.interface << nextHop.gateway << source << dest);
+
+  Ptr<IpRoute> rtentry = Create<IpRoute> ();
+  rtentry->SetSource (source);
+  rtentry->SetGateway (nextHop.gateway);
+  rtentry->SetDestination (dest);
+  rtentry->SetOutputDevice (m_ip->GetNetDevice (nextHop.interface));
+  return rtentry;
+}
+
 template <typename T>
 void 
 NixVectorRouting<T>::CheckCacheStateAndFlush (void) const
@@ -44,6 +44,7 @@
 
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 namespace ns3 {
 
@@ -58,6 +59,16 @@ namespace ns3 {
  * \ingroup nix-vector-routing
  * Nix-vector routing protocol
  *
+ * When the Compiled attribute is set, the routes are not built from
+ * nix-vectors: a table of the next hop from every node to every other
+ * node (one uint16_t per pair of nodes) is computed once, with one BFS per
+ * node, when the first route is requested after a topology change.
+ * RouteOutput and RouteInput then find the destination node of the packet
+ * and read its next hop in the table, and the packets carry no nix-vector.
+ * This suits the large static topologies for which the per-destination
+ * BFS of nix-vector routing dominates the setup time; the table takes
+ * 2 * N^2 bytes for N nodes, and all the nodes should use the same mode.
+ *
  * \internal
  * Since this class is meant to be specialized only by Ipv4RoutingProtocol or 
  * Ipv6RoutingProtocol the implementation of this class doesn't need to be
@@ -437,6 +448,42 @@ private:
    */
   void CheckCacheStateAndFlush (void) const;
 
+  /**
+   * \brief A next hop of a node in the compiled next-hop table
+   */
+  struct NextHop
+  {
+    uint32_t interface;  //!< the output interface
+    IpAddress gateway;   //!< the address of the neighbor on the channel
+  };
+
+  /// The next-hop table entry of the destinations without a path
+  static constexpr uint16_t NO_NEXT_HOP = 0xffff;
+
+  /**
+   * Computes the next hop from every node using compiled nix-vector
+   * routing to every node, with the neighbors visited in the same order
+   * as BFS (), and fills the table of next hops of these nodes.
+   */
+  void BuildNextHopTable (void) const;
+
+  /**
+   * Looks up the next hop to a destination in the compiled next-hop table,
+   * building the table first if needed
+   * \param dest the destination address
+   * \returns the index of the next hop in m_nextHops, or NO_NEXT_HOP
+   */
+  uint16_t GetNextHop (IpAddress dest) const;
+
+  /**
+   * Creates the route to a destination through a next hop
+   * \param nextHop the next hop
+   * \param source the source address of the route
+   * \param dest the destination address of the route
+   * \returns the route
+   */
+  Ptr<IpRoute> CreateNextHopRoute (const NextHop &nextHop, IpAddress source, IpAddress dest) const;
+
   /**
    * Build map from IP Address to Node for faster lookup.
    */
@@ -460,6 +507,20 @@ private:
   /** Total neighbors used for nix-vector to determine number of bits */
   uint32_t m_totalNeighbors;
 
+  /** Whether the routes are read from the compiled next-hop table */
+  bool m_compiled;
+
+  /** Next hops of this node, indexed by the entries of the next-hop table */
+  std::vector<NextHop> m_nextHops;
+
+  /**
+   * Next-hop table: the entry of the source node s and destination node d
+   * (at index s * g_nextHopTableNodes + d) is the index of the next hop in
+   * the m_nextHops of s, or NO_NEXT_HOP.
+   */
+  static std::vector<uint16_t> g_nextHopTable;
+  static uint32_t g_nextHopTableNodes; //!< Number of nodes in the next-hop table
+
 
   /**
    * Mapping of IP address to ns-3 node.
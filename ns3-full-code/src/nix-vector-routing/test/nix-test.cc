@@ -23,6 +23,7 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/simulator.h"
 #include "ns3/socket.h"
+#include "ns3/boolean.h"
 
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
@@ -30,6 +31,7 @@
 #include "ns3/icmpv4-l4-protocol.h"
 #include "ns3/ipv6-address-helper.h"
 #include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-route.h"
 #include "ns3/icmpv6-l4-protocol.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/simple-net-device-helper.h"
@@ -362,6 +364,305 @@ NixVectorRoutingTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * The topology is the same as in NixVectorRoutingTest:
+ * \verbatim
+              __________
+             /          \
+    nSrc -- nA -- nB -- nC -- nDst
+   \endverbatim
+ *
+ * Following are the tests in this test case, with the Compiled attribute:
+ * - Test that the routes returned by nSrc (RouteOutput) and nA (RouteInput)
+ *   lead to nDst through the expected neighbor.
+ * - Test the routing from nSrc to nDst over IPv4 and IPv6.
+ * - Test if the path taken is the shortest path (nB forwards no packet).
+ * (Set down the interfaces of nA on nA-nC channel.)
+ * - Test the routing from nSrc to nDst again, through nB.
+ * (Set down the interfaces of nC on nB-nC channel.)
+ * - Test that routing is not possible from nSrc to nDst.
+ *
+ * \brief Compiled Nix-Vector Routing Test
+ */
+class NixVectorRoutingCompiledTest : public TestCase
+{
+  /**
+   * \brief Send data immediately after being called.
+   * \param socket The sending socket.
+   * \param to Destination address.
+   */
+  void DoSendData (Ptr<Socket> socket, Address to);
+
+  /**
+   * \brief Receive data.
+   * \param socket The receiving socket.
+   */
+  void ReceivePkt (Ptr<Socket> socket);
+
+  /**
+   * \brief Count the packets forwarded by nB.
+   * \param p The forwarded packet.
+   * \param ipv4 The IPv4 object of nB.
+   * \param interface The output interface.
+   */
+  void ForwardIpv4 (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  /**
+   * \brief Count the packets forwarded by nB.
+   * \param p The forwarded packet.
+   * \param ipv6 The IPv6 object of nB.
+   * \param interface The output interface.
+   */
+  void ForwardIpv6 (Ptr<const Packet> p, Ptr<Ipv6> ipv6, uint32_t interface);
+
+  /**
+   * \brief Record the route of a packet forwarded by RouteInput.
+   * \param route The route.
+   * \param p The packet.
+   * \param header The IPv4 header of the packet.
+   */
+  void UnicastForwardIpv4 (Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header);
+
+  /**
+   * \brief Record the route of a packet forwarded by RouteInput.
+   * \param idev The input device.
+   * \param route The route.
+   * \param p The packet.
+   * \param header The IPv6 header of the packet.
+   */
+  void UnicastForwardIpv6 (Ptr<const NetDevice> idev, Ptr<Ipv6Route> route, Ptr<const Packet> p, const Ipv6Header &header);
+
+  /**
+   * \brief Check the routes given by RouteOutput at the source and by
+   * RouteInput at the next router.
+   * \param srcDevice The output device of the source.
+   * \param routerInput The input device of the router.
+   * \param routerOutput The expected output device of the router.
+   * \param dst4 The IPv4 address of the destination.
+   * \param dst6 The IPv6 address of the destination.
+   */
+  void CheckRoutes (Ptr<NetDevice> srcDevice, Ptr<NetDevice> routerInput,
+                    Ptr<NetDevice> routerOutput, Ipv4Address dst4, Ipv6Address dst6);
+
+public:
+  virtual void DoRun (void);
+  NixVectorRoutingCompiledTest ();
+
+private:
+  std::vector<Time> m_receivedTimes; //!< Reception times
+  std::vector<Time> m_forwardedTimes; //!< Times of the packets forwarded by nB
+  Ptr<Ipv4Route> m_inputRouteIpv4; //!< The last IPv4 route given by RouteInput
+  Ptr<Ipv6Route> m_inputRouteIpv6; //!< The last IPv6 route given by RouteInput
+};
+
+NixVectorRoutingCompiledTest::NixVectorRoutingCompiledTest ()
+  : TestCase ("three router, two path test with a compiled next-hop table")
+{
+}
+
+void
+NixVectorRoutingCompiledTest::DoSendData (Ptr<Socket> socket, Address to)
+{
+  socket->SendTo (Create<Packet> (123), 0, to);
+}
+
+void
+NixVectorRoutingCompiledTest::ReceivePkt (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet = socket->Recv (std::numeric_limits<uint32_t>::max (), 0);
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), 123, "Wrong packet size");
+  m_receivedTimes.push_back (Simulator::Now ());
+}
+
+void
+NixVectorRoutingCompiledTest::ForwardIpv4 (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  m_forwardedTimes.push_back (Simulator::Now ());
+}
+
+void
+NixVectorRoutingCompiledTest::ForwardIpv6 (Ptr<const Packet> p, Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  m_forwardedTimes.push_back (Simulator::Now ());
+}
+
+void
+NixVectorRoutingCompiledTest::UnicastForwardIpv4 (Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  m_inputRouteIpv4 = route;
+}
+
+void
+NixVectorRoutingCompiledTest::UnicastForwardIpv6 (Ptr<const NetDevice> idev, Ptr<Ipv6Route> route, Ptr<const Packet> p, const Ipv6Header &header)
+{
+  m_inputRouteIpv6 = route;
+}
+
+void
+NixVectorRoutingCompiledTest::CheckRoutes (Ptr<NetDevice> srcDevice, Ptr<NetDevice> routerInput,
+                                           Ptr<NetDevice> routerOutput, Ipv4Address dst4, Ipv6Address dst6)
+{
+  // The routes name the destination, not the next hop, the second time too
+  // (when they are found in the route cache)
+  Ipv4Header header4;
+  header4.SetDestination (dst4);
+  Ipv6Header header6;
+  header6.SetDestination (dst6);
+  Ptr<Node> src = srcDevice->GetNode ();
+  Ptr<Node> router = routerInput->GetNode ();
+  Ptr<Ipv4RoutingProtocol> srcRouting4 = src->GetObject<Ipv4> ()->GetRoutingProtocol ();
+  Ptr<Ipv6RoutingProtocol> srcRouting6 = src->GetObject<Ipv6> ()->GetRoutingProtocol ();
+  Ptr<Ipv4RoutingProtocol> routerRouting4 = router->GetObject<Ipv4> ()->GetRoutingProtocol ();
+  Ptr<Ipv6RoutingProtocol> routerRouting6 = router->GetObject<Ipv6> ()->GetRoutingProtocol ();
+  Socket::SocketErrno sockerr;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<Ipv4Route> route4 = srcRouting4->RouteOutput (Create<Packet> (), header4, 0, sockerr);
+      NS_TEST_ASSERT_MSG_NE (route4, 0, "The source should have an IPv4 route to the destination");
+      NS_TEST_EXPECT_MSG_EQ (route4->GetDestination (), header4.GetDestination (), "Wrong IPv4 route destination");
+      NS_TEST_EXPECT_MSG_EQ (route4->GetOutputDevice (), srcDevice, "Wrong IPv4 route output device");
+      Ptr<Ipv6Route> route6 = srcRouting6->RouteOutput (Create<Packet> (), header6, 0, sockerr);
+      NS_TEST_ASSERT_MSG_NE (route6, 0, "The source should have an IPv6 route to the destination");
+      NS_TEST_EXPECT_MSG_EQ (route6->GetDestination (), header6.GetDestination (), "Wrong IPv6 route destination");
+      NS_TEST_EXPECT_MSG_EQ (route6->GetOutputDevice (), srcDevice, "Wrong IPv6 route output device");
+
+      m_inputRouteIpv4 = 0;
+      routerRouting4->RouteInput (Create<Packet> (), header4, routerInput,
+                             MakeCallback (&NixVectorRoutingCompiledTest::UnicastForwardIpv4, this),
+                             Ipv4RoutingProtocol::MulticastForwardCallback (),
+                             Ipv4RoutingProtocol::LocalDeliverCallback (),
+                             Ipv4RoutingProtocol::ErrorCallback ());
+      NS_TEST_ASSERT_MSG_NE (m_inputRouteIpv4, 0, "The router should forward IPv4 packets to the destination");
+      NS_TEST_EXPECT_MSG_EQ (m_inputRouteIpv4->GetDestination (), header4.GetDestination (), "Wrong IPv4 route destination");
+      NS_TEST_EXPECT_MSG_EQ (m_inputRouteIpv4->GetOutputDevice (), routerOutput, "Wrong IPv4 route output device");
+      m_inputRouteIpv6 = 0;
+      routerRouting6->RouteInput (Create<Packet> (), header6, routerInput,
+                             MakeCallback (&NixVectorRoutingCompiledTest::UnicastForwardIpv6, this),
+                             Ipv6RoutingProtocol::MulticastForwardCallback (),
+                             Ipv6RoutingProtocol::LocalDeliverCallback (),
+                             Ipv6RoutingProtocol::ErrorCallback ());
+      NS_TEST_ASSERT_MSG_NE (m_inputRouteIpv6, 0, "The router should forward IPv6 packets to the destination");
+      NS_TEST_EXPECT_MSG_EQ (m_inputRouteIpv6->GetDestination (), header6.GetDestination (), "Wrong IPv6 route destination");
+      NS_TEST_EXPECT_MSG_EQ (m_inputRouteIpv6->GetOutputDevice (), routerOutput, "Wrong IPv6 route output device");
+    }
+}
+
+void
+NixVectorRoutingCompiledTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+  Ptr<Node> nSrc = nodes.Get (0);
+  Ptr<Node> nA = nodes.Get (1);
+  Ptr<Node> nB = nodes.Get (2);
+  Ptr<Node> nC = nodes.Get (3);
+  Ptr<Node> nDst = nodes.Get (4);
+
+  Ipv4NixVectorHelper ipv4NixRouting;
+  ipv4NixRouting.Set ("Compiled", BooleanValue (true));
+  Ipv6NixVectorHelper ipv6NixRouting;
+  ipv6NixRouting.Set ("Compiled", BooleanValue (true));
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (ipv4NixRouting);
+  stack.SetRoutingHelper (ipv6NixRouting);
+  stack.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  NetDeviceContainer dSrcdA = devHelper.Install (NodeContainer (nSrc, nA));
+  NetDeviceContainer dAdB = devHelper.Install (NodeContainer (nA, nB));
+  NetDeviceContainer dBdC = devHelper.Install (NodeContainer (nB, nC));
+  NetDeviceContainer dCdDst = devHelper.Install (NodeContainer (nC, nDst));
+  NetDeviceContainer dAdC = devHelper.Install (NodeContainer (nA, nC));
+
+  Ipv4AddressHelper ipv4Address;
+  ipv4Address.SetBase ("10.1.0.0", "255.255.255.0");
+  Ipv6AddressHelper ipv6Address;
+  ipv6Address.SetBase (Ipv6Address ("2001:0::"), Ipv6Prefix (64));
+  Ipv4InterfaceContainer iCiDstv4;
+  Ipv6InterfaceContainer iCiDstv6;
+  for (NetDeviceContainer devices : {dSrcdA, dAdB, dBdC, dCdDst, dAdC})
+    {
+      Ipv4InterfaceContainer iv4 = ipv4Address.Assign (devices);
+      Ipv6InterfaceContainer iv6 = ipv6Address.Assign (devices);
+      ipv4Address.NewNetwork ();
+      ipv6Address.NewNetwork ();
+      if (devices.Get (1)->GetNode () == nDst)
+        {
+          iCiDstv4 = iv4;
+          iCiDstv6 = iv6;
+        }
+    }
+
+  Ptr<SocketFactory> rxSocketFactory = nDst->GetObject<UdpSocketFactory> ();
+  Ptr<Socket> rxSocketv4 = rxSocketFactory->CreateSocket ();
+  Ptr<Socket> rxSocketv6 = rxSocketFactory->CreateSocket ();
+  NS_TEST_EXPECT_MSG_EQ (rxSocketv4->Bind (InetSocketAddress (iCiDstv4.GetAddress (1), 1234)), 0, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rxSocketv6->Bind (Inet6SocketAddress (iCiDstv6.GetAddress (1, 1), 1234)), 0, "trivial");
+  rxSocketv4->SetRecvCallback (MakeCallback (&NixVectorRoutingCompiledTest::ReceivePkt, this));
+  rxSocketv6->SetRecvCallback (MakeCallback (&NixVectorRoutingCompiledTest::ReceivePkt, this));
+
+  nB->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Tx", MakeCallback (&NixVectorRoutingCompiledTest::ForwardIpv4, this));
+  nB->GetObject<Ipv6L3Protocol> ()->TraceConnectWithoutContext ("Tx", MakeCallback (&NixVectorRoutingCompiledTest::ForwardIpv6, this));
+
+  Ptr<Socket> txSocket = nSrc->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  Address toV4 = InetSocketAddress (iCiDstv4.GetAddress (1), 1234);
+  Address toV6 = Inet6SocketAddress (iCiDstv6.GetAddress (1, 1), 1234);
+  Simulator::Schedule (Seconds (1), &NixVectorRoutingCompiledTest::CheckRoutes, this,
+                       dSrcdA.Get (0), dSrcdA.Get (1), dAdC.Get (0),
+                       iCiDstv4.GetAddress (1), iCiDstv6.GetAddress (1, 1));
+  for (double t : {2.0, 8.0, 11.0})
+    {
+      Simulator::ScheduleWithContext (nSrc->GetId (), Seconds (t),
+                                      &NixVectorRoutingCompiledTest::DoSendData, this, txSocket, toV4);
+      Simulator::ScheduleWithContext (nSrc->GetId (), Seconds (t),
+                                      &NixVectorRoutingCompiledTest::DoSendData, this, txSocket, toV6);
+    }
+
+  // Set the nA interfaces on nA - nC channel down.
+  Ptr<Ipv4> ipv4 = nA->GetObject<Ipv4> ();
+  Simulator::Schedule (Seconds (5), &Ipv4::SetDown, ipv4, ipv4->GetInterfaceForDevice (dAdC.Get (0)));
+  Ptr<Ipv6> ipv6 = nA->GetObject<Ipv6> ();
+  Simulator::Schedule (Seconds (5), &Ipv6::SetDown, ipv6, ipv6->GetInterfaceForDevice (dAdC.Get (0)));
+
+  // Set the nC interfaces on nB - nC channel down.
+  ipv4 = nC->GetObject<Ipv4> ();
+  Simulator::Schedule (Seconds (10), &Ipv4::SetDown, ipv4, ipv4->GetInterfaceForDevice (dBdC.Get (1)));
+  ipv6 = nC->GetObject<Ipv6> ();
+  Simulator::Schedule (Seconds (10), &Ipv6::SetDown, ipv6, ipv6->GetInterfaceForDevice (dBdC.Get (1)));
+
+  Simulator::Stop (Seconds (66));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_receivedTimes.size (), 4, "Two packets should have been received before and after the first change");
+  NS_TEST_EXPECT_MSG_LT (m_receivedTimes[1], Seconds (5), "IPv4 and IPv6 packets should have been received on the shortest path");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (m_receivedTimes[2], Seconds (8), "IPv4 and IPv6 packets should have been received on the new path");
+  NS_TEST_EXPECT_MSG_LT (m_receivedTimes[3], Seconds (10), "IPv4 and IPv6 packets should have been received on the new path");
+
+  // nB only forwards the packets sent after the nA - nC channel went down
+  // (plus, in IPv6, its own neighbor discovery packets)
+  uint32_t forwardedBefore = 0;
+  uint32_t forwardedAfter = 0;
+  for (Time t : m_forwardedTimes)
+    {
+      if (t >= Seconds (2) && t < Seconds (5))
+        {
+          forwardedBefore++;
+        }
+      else if (t >= Seconds (8) && t < Seconds (10))
+        {
+          forwardedAfter++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (forwardedBefore, 0, "The shortest path should not go through nB");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (forwardedAfter, 2, "The new path should go through nB");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup nix-vector-routing-test
  * \ingroup tests
@@ -374,6 +675,7 @@ public:
   NixVectorRoutingTestSuite () : TestSuite ("nix-vector-routing", UNIT)
   {
     AddTestCase (new NixVectorRoutingTest (), TestCase::QUICK);
+    AddTestCase (new NixVectorRoutingCompiledTest (), TestCase::QUICK);
   }
 };
 
@@ -253,9 +253,11 @@ PointToPointHelper::Install (Ptr<Node> a, Ptr<Node> b)
       Ptr<NetDeviceQueueInterface> ndqiA = CreateObject<NetDeviceQueueInterface> ();
       ndqiA->GetTxQueue (0)->ConnectQueueTraces (queueA);
       devA->AggregateObject (ndqiA);
+      devA->SetNetDeviceQueue (ndqiA->GetTxQueue (0));
       Ptr<NetDeviceQueueInterface> ndqiB = CreateObject<NetDeviceQueueInterface> ();
       ndqiB->GetTxQueue (0)->ConnectQueueTraces (queueB);
       devB->AggregateObject (ndqiB);
+      devB->SetNetDeviceQueue (ndqiB->GetTxQueue (0));
     }
 
   Ptr<PointToPointChannel> channel = 0;
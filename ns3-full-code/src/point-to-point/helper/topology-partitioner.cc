@@ -0,0 +1,416 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "topology-partitioner.h"
+
+#include <algorithm>
+#include <set>
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/node-list.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/application.h"
+#include "ns3/data-rate.h"
+#include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-net-device.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TopologyPartitioner");
+
+TopologyPartitioner::TopologyPartitioner ()
+  : m_tolerance (0.25),
+    m_baseLoad (1e6),
+    m_nPartitions (0),
+    m_lookahead (Time::Max ()),
+    m_nCut (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TopologyPartitioner::SetBalanceTolerance (double tolerance)
+{
+  NS_LOG_FUNCTION (this << tolerance);
+  NS_ABORT_MSG_IF (tolerance < 0, "The balance tolerance cannot be negative");
+  m_tolerance = tolerance;
+}
+
+void
+TopologyPartitioner::SetBaseNodeLoad (double load)
+{
+  NS_LOG_FUNCTION (this << load);
+  m_baseLoad = load;
+}
+
+void
+TopologyPartitioner::Partition (uint32_t nPartitions)
+{
+  NS_LOG_FUNCTION (this << nPartitions);
+  Partition (NodeContainer::GetGlobal (), nPartitions);
+}
+
+uint32_t
+TopologyPartitioner::Find (std::vector<uint32_t> &parent, uint32_t i)
+{
+  while (parent[i] != i)
+    {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+  return i;
+}
+
+void
+TopologyPartitioner::Partition (NodeContainer nodes, uint32_t nPartitions)
+{
+  NS_LOG_FUNCTION (this << nPartitions);
+  NS_ABORT_MSG_IF (nPartitions == 0, "At least one partition is required");
+
+  m_nodes = nodes;
+  m_nPartitions = nPartitions;
+  m_weights.assign (nodes.GetN (), m_baseLoad);
+  m_parent.resize (nodes.GetN ());
+  m_links.clear ();
+
+  uint32_t maxId = 0;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      maxId = std::max (maxId, nodes.Get (i)->GetId ());
+      m_parent[i] = i;
+    }
+
+  // Map node ids onto indices in the container
+  const uint32_t invalid = nodes.GetN ();
+  std::vector<uint32_t> index (maxId + 1, invalid);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      index[nodes.Get (i)->GetId ()] = i;
+    }
+
+  std::set<uint32_t> visited;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Node> node = nodes.Get (i);
+
+      for (uint32_t j = 0; j < node->GetNApplications (); j++)
+        {
+          DataRateValue rate;
+          if (node->GetApplication (j)->GetAttributeFailSafe ("DataRate", rate))
+            {
+              m_weights[i] += rate.Get ().GetBitRate ();
+            }
+        }
+
+      for (uint32_t j = 0; j < node->GetNDevices (); j++)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          DataRateValue rate;
+          if (device->GetAttributeFailSafe ("DataRate", rate))
+            {
+              m_weights[i] += rate.Get ().GetBitRate ();
+            }
+
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0 || !visited.insert (channel->GetId ()).second)
+            {
+              continue;
+            }
+
+          std::vector<uint32_t> ends;
+          for (std::size_t k = 0; k < channel->GetNDevices (); k++)
+            {
+              uint32_t id = channel->GetDevice (k)->GetNode ()->GetId ();
+              if (id <= maxId && index[id] != invalid)
+                {
+                  ends.push_back (index[id]);
+                }
+            }
+
+          // Only point-to-point channels (including the remote ones of the
+          // distributed simulators) can connect nodes on different LPs
+          if (DynamicCast<PointToPointChannel> (channel) && ends.size () == 2)
+            {
+              TimeValue delay;
+              channel->GetAttribute ("Delay", delay);
+              m_links.push_back ({ends[0], ends[1], delay.Get ()});
+              continue;
+            }
+
+          // This channel cannot be split across LPs
+          for (uint32_t k = 1; k < ends.size (); k++)
+            {
+              m_parent[Find (m_parent, ends[k])] = Find (m_parent, ends[0]);
+            }
+        }
+    }
+
+  // Try the candidate thresholds from the largest delay downwards and
+  // keep the first one that satisfies the balance constraint.
+  std::vector<Time> thresholds;
+  for (const auto &link : m_links)
+    {
+      thresholds.push_back (link.delay);
+    }
+  std::sort (thresholds.begin (), thresholds.end (), std::greater<Time> ());
+  thresholds.erase (std::unique (thresholds.begin (), thresholds.end ()), thresholds.end ());
+  if (thresholds.empty ())
+    {
+      thresholds.push_back (Time::Max ());
+    }
+
+  std::vector<uint32_t> best;
+  double bestImbalance = 0;
+  for (const auto &threshold : thresholds)
+    {
+      std::vector<uint32_t> assignment;
+      std::vector<double> loads;
+      Assign (threshold, assignment, loads);
+
+      double total = 0;
+      double max = 0;
+      for (double load : loads)
+        {
+          total += load;
+          max = std::max (max, load);
+        }
+      double imbalance = total > 0 ? max * nPartitions / total : 1;
+      NS_LOG_DEBUG ("Threshold " << threshold.As (Time::MS) << " imbalance " << imbalance);
+
+      if (best.empty () || imbalance < bestImbalance)
+        {
+          best = assignment;
+          bestImbalance = imbalance;
+          m_loads = loads;
+        }
+      if (imbalance <= 1 + m_tolerance)
+        {
+          break;
+        }
+    }
+
+  m_mapping.assign (maxId + 1, 0);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      m_mapping[nodes.Get (i)->GetId ()] = best[i];
+    }
+
+  m_lookahead = Time::Max ();
+  m_nCut = 0;
+  for (const auto &link : m_links)
+    {
+      if (best[link.a] != best[link.b])
+        {
+          m_lookahead = std::min (m_lookahead, link.delay);
+          m_nCut++;
+        }
+    }
+
+  NS_LOG_INFO ("Partitioned " << nodes.GetN () << " nodes on " << nPartitions
+               << " LPs, imbalance " << bestImbalance << ", " << m_nCut
+               << " cut links, lookahead " << m_lookahead.As (Time::MS));
+}
+
+void
+TopologyPartitioner::Assign (Time threshold, std::vector<uint32_t> &assignment,
+                             std::vector<double> &loads) const
+{
+  NS_LOG_FUNCTION (this << threshold);
+
+  std::vector<uint32_t> parent = m_parent;
+  for (const auto &link : m_links)
+    {
+      if (link.delay < threshold)
+        {
+          parent[Find (parent, link.b)] = Find (parent, link.a);
+        }
+    }
+
+  std::vector<double> clusterWeight (parent.size (), 0);
+  double total = 0;
+  for (uint32_t i = 0; i < parent.size (); i++)
+    {
+      clusterWeight[Find (parent, i)] += m_weights[i];
+      total += m_weights[i];
+    }
+
+  std::vector<uint32_t> clusters;
+  std::vector<std::vector<uint32_t> > adjacent (parent.size ());
+  for (uint32_t i = 0; i < parent.size (); i++)
+    {
+      if (parent[i] == i)
+        {
+          clusters.push_back (i);
+        }
+    }
+  for (const auto &link : m_links)
+    {
+      uint32_t a = Find (parent, link.a);
+      uint32_t b = Find (parent, link.b);
+      if (a != b)
+        {
+          adjacent[a].push_back (b);
+          adjacent[b].push_back (a);
+        }
+    }
+
+  // Largest clusters first
+  std::stable_sort (clusters.begin (), clusters.end (),
+                    [&clusterWeight] (uint32_t a, uint32_t b)
+                    { return clusterWeight[a] > clusterWeight[b]; });
+
+  const uint32_t unassigned = m_nPartitions;
+  std::vector<uint32_t> rank (parent.size (), unassigned);
+  loads.assign (m_nPartitions, 0);
+  double target = total / m_nPartitions * (1 + m_tolerance);
+
+  for (uint32_t c : clusters)
+    {
+      // Prefer the LP holding most of the neighbours of this cluster, as
+      // long as the cluster fits; otherwise use the least loaded LP.
+      std::vector<uint32_t> affinity (m_nPartitions, 0);
+      for (uint32_t n : adjacent[c])
+        {
+          if (rank[n] != unassigned)
+            {
+              affinity[rank[n]]++;
+            }
+        }
+
+      uint32_t chosen = 0;
+      bool fits = false;
+      for (uint32_t r = 0; r < m_nPartitions; r++)
+        {
+          bool rFits = loads[r] + clusterWeight[c] <= target;
+          if (rFits && (!fits || affinity[r] > affinity[chosen]
+                        || (affinity[r] == affinity[chosen] && loads[r] < loads[chosen])))
+            {
+              chosen = r;
+              fits = true;
+            }
+          else if (!fits && loads[r] < loads[chosen])
+            {
+              chosen = r;
+            }
+        }
+
+      rank[c] = chosen;
+      loads[chosen] += clusterWeight[c];
+    }
+
+  assignment.resize (parent.size ());
+  for (uint32_t i = 0; i < parent.size (); i++)
+    {
+      assignment[i] = rank[Find (parent, i)];
+    }
+}
+
+uint32_t
+TopologyPartitioner::GetSystemId (uint32_t nodeId) const
+{
+  NS_ABORT_MSG_IF (nodeId >= m_mapping.size (), "Node " << nodeId << " has not been partitioned");
+  return m_mapping[nodeId];
+}
+
+NodeContainer
+TopologyPartitioner::GetPartition (uint32_t partition) const
+{
+  NS_ABORT_MSG_IF (partition >= m_nPartitions, "Invalid partition " << partition);
+  NodeContainer nodes;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      if (m_mapping[m_nodes.Get (i)->GetId ()] == partition)
+        {
+          nodes.Add (m_nodes.Get (i));
+        }
+    }
+  return nodes;
+}
+
+uint32_t
+TopologyPartitioner::GetNPartitions (void) const
+{
+  return m_nPartitions;
+}
+
+double
+TopologyPartitioner::GetLoad (uint32_t partition) const
+{
+  NS_ABORT_MSG_IF (partition >= m_nPartitions, "Invalid partition " << partition);
+  return m_loads[partition];
+}
+
+double
+TopologyPartitioner::GetImbalance (void) const
+{
+  double total = 0;
+  double max = 0;
+  for (double load : m_loads)
+    {
+      total += load;
+      max = std::max (max, load);
+    }
+  return total > 0 ? max * m_nPartitions / total : 1;
+}
+
+Time
+TopologyPartitioner::GetLookahead (void) const
+{
+  return m_lookahead;
+}
+
+uint32_t
+TopologyPartitioner::GetNCutLinks (void) const
+{
+  return m_nCut;
+}
+
+const std::vector<uint32_t> &
+TopologyPartitioner::GetMapping (void) const
+{
+  return m_mapping;
+}
+
+void
+TopologyPartitioner::Write (std::ostream &os) const
+{
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      uint32_t id = m_nodes.Get (i)->GetId ();
+      os << id << " " << m_mapping[id] << std::endl;
+    }
+}
+
+std::vector<uint32_t>
+TopologyPartitioner::Read (std::istream &is)
+{
+  std::vector<uint32_t> mapping;
+  uint32_t id;
+  uint32_t systemId;
+  while (is >> id >> systemId)
+    {
+      if (id >= mapping.size ())
+        {
+          mapping.resize (id + 1, 0);
+        }
+      mapping[id] = systemId;
+    }
+  return mapping;
+}
+
+} // namespace ns3
@@ -0,0 +1,201 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_TOPOLOGY_PARTITIONER_H
+#define NS3_TOPOLOGY_PARTITIONER_H
+
+#include <iostream>
+#include <vector>
+
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ *
+ * \brief Compute a node-to-rank mapping for a parallel simulation.
+ *
+ * The partitioner inspects an already built topology and assigns every
+ * node to one of a given number of logical processes (LPs).  Each node
+ * is weighted by its expected event load, estimated from the
+ * "DataRate" attribute of its net devices and of its applications.
+ * Links are only cut where they can be cut: the distributed simulators
+ * only support point-to-point links across LP boundaries, hence only
+ * PointToPointChannel links are candidates for a cut.  Nodes sharing
+ * any other channel, even one connecting two devices only, are always
+ * kept on the same LP.
+ *
+ * Since the lookahead of the conservative synchronization algorithms
+ * is the smallest delay of the links crossing LP boundaries, the
+ * partitioner looks for the largest delay threshold such that cutting
+ * only links whose delay is at least that threshold still yields a
+ * load balance within the configured tolerance.  All the links below
+ * the threshold are contracted and the resulting clusters are assigned
+ * to the LPs with a longest-processing-time-first greedy heuristic.
+ *
+ * The mapping can be used both by the MPI based simulators (as the
+ * system id to pass to the Node constructor, see Write () and Read ())
+ * and by an in-process threaded scheduler (see GetPartition ()).
+ *
+ * Typical usage is to build the topology once on a single process,
+ * compute the partition and store it, then read the mapping back
+ * when the nodes are created in the distributed run.
+ */
+class TopologyPartitioner
+{
+public:
+  TopologyPartitioner ();
+
+  /**
+   * \brief Set the maximum tolerated load imbalance.
+   *
+   * A partition is accepted if the load of the most loaded LP does not
+   * exceed (1 + tolerance) times the average load.
+   *
+   * \param tolerance the imbalance tolerance (default 0.25)
+   */
+  void SetBalanceTolerance (double tolerance);
+
+  /**
+   * \brief Set the per-node load added to the traffic-based estimate.
+   *
+   * This accounts for the fixed cost of nodes without any rate
+   * information (e.g., routers with devices lacking a DataRate).
+   *
+   * \param load the base load, in bit/s (default 1 Mb/s)
+   */
+  void SetBaseNodeLoad (double load);
+
+  /**
+   * \brief Partition all the nodes in the NodeList.
+   * \param nPartitions the number of LPs
+   */
+  void Partition (uint32_t nPartitions);
+
+  /**
+   * \brief Partition the given nodes.
+   *
+   * Links towards nodes that are not in the container are ignored.
+   *
+   * \param nodes the nodes to partition
+   * \param nPartitions the number of LPs
+   */
+  void Partition (NodeContainer nodes, uint32_t nPartitions);
+
+  /**
+   * \param nodeId the id of the node
+   * \returns the system id (rank) assigned to the node
+   */
+  uint32_t GetSystemId (uint32_t nodeId) const;
+
+  /**
+   * \param partition the LP index
+   * \returns the nodes assigned to the given LP
+   */
+  NodeContainer GetPartition (uint32_t partition) const;
+
+  /**
+   * \returns the number of LPs of the last partition computed
+   */
+  uint32_t GetNPartitions (void) const;
+
+  /**
+   * \param partition the LP index
+   * \returns the estimated load of the given LP, in bit/s
+   */
+  double GetLoad (uint32_t partition) const;
+
+  /**
+   * \returns the ratio between the load of the most loaded LP and the
+   *          average load
+   */
+  double GetImbalance (void) const;
+
+  /**
+   * \returns the smallest delay among the links crossing LP boundaries,
+   *          or Time::Max () if no link is cut
+   */
+  Time GetLookahead (void) const;
+
+  /**
+   * \returns the number of links crossing LP boundaries
+   */
+  uint32_t GetNCutLinks (void) const;
+
+  /**
+   * \returns the system id of every node, indexed by node id
+   */
+  const std::vector<uint32_t> & GetMapping (void) const;
+
+  /**
+   * \brief Write the mapping, one "nodeId systemId" pair per line.
+   * \param os the output stream
+   */
+  void Write (std::ostream &os) const;
+
+  /**
+   * \brief Read a mapping previously stored by Write ().
+   * \param is the input stream
+   * \returns the system id of every node, indexed by node id
+   */
+  static std::vector<uint32_t> Read (std::istream &is);
+
+private:
+  /// A link that may be cut
+  struct Link
+  {
+    uint32_t a;   //!< index of the first endpoint
+    uint32_t b;   //!< index of the second endpoint
+    Time delay;   //!< link delay
+  };
+
+  /**
+   * \brief Find the representative of a cluster (with path halving).
+   * \param parent the union-find forest
+   * \param i the element
+   * \returns the cluster representative
+   */
+  static uint32_t Find (std::vector<uint32_t> &parent, uint32_t i);
+
+  /**
+   * \brief Assign clusters to LPs, contracting links below a threshold.
+   * \param threshold links with a smaller delay are never cut
+   * \param assignment the LP of every node (output)
+   * \param loads the load of every LP (output)
+   */
+  void Assign (Time threshold, std::vector<uint32_t> &assignment,
+               std::vector<double> &loads) const;
+
+  double m_tolerance;                   //!< imbalance tolerance
+  double m_baseLoad;                    //!< base load of a node
+  uint32_t m_nPartitions;               //!< number of LPs
+
+  NodeContainer m_nodes;                //!< the nodes being partitioned
+  std::vector<double> m_weights;        //!< load of every node
+  std::vector<uint32_t> m_parent;       //!< nodes that can never be split
+  std::vector<Link> m_links;            //!< the links that may be cut
+
+  std::vector<uint32_t> m_mapping;      //!< system id indexed by node id
+  std::vector<double> m_loads;          //!< load of every LP
+  Time m_lookahead;                     //!< resulting lookahead
+  uint32_t m_nCut;                      //!< number of cut links
+};
+
+} // namespace ns3
+
+#endif /* NS3_TOPOLOGY_PARTITIONER_H */
@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/net-device-queue-interface.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -215,6 +216,7 @@ PointToPointNetDevice::DoDispose ()
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
   m_queue = 0;
+  m_txQueue = 0;
   NetDevice::DoDispose ();
 }
 
@@ -279,6 +281,10 @@ PointToPointNetDevice::TransmitComplete (void)
   NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
 
   m_phyTxEndTrace (m_currentPkt);
+  if (m_txQueue)
+    {
+      m_txQueue->NotifyTransmittedBytes (m_currentPkt->GetSize ());
+    }
   m_currentPkt = 0;
 
   Ptr<Packet> p = m_queue->Dequeue ();
@@ -321,6 +327,14 @@ PointToPointNetDevice::SetQueue (Ptr<Queue<Packet> > q)
   m_queue = q;
 }
 
+void
+PointToPointNetDevice::SetNetDeviceQueue (Ptr<NetDeviceQueue> queue)
+{
+  NS_LOG_FUNCTION (this << queue);
+  m_txQueue = queue;
+  m_txQueue->SetDeviceNotifiesTxCompletion (true);
+}
+
 void
 PointToPointNetDevice::SetReceiveErrorModel (Ptr<ErrorModel> em)
 {
@@ -36,6 +36,7 @@ namespace ns3 {
 template <typename Item> class Queue;
 class PointToPointChannel;
 class ErrorModel;
+class NetDeviceQueue;
 
 /**
  * \defgroup point-to-point Point-To-Point Network Device
@@ -127,6 +128,19 @@ public:
    */
   Ptr<Queue<Packet> > GetQueue (void) const;
 
+  /**
+   * Set the transmission queue (of the NetDeviceQueueInterface aggregated to
+   * this device) to which the PointToPointNetDevice reports the bytes it
+   * has transmitted.
+   *
+   * The bytes of a packet are reported when its transmission is complete,
+   * instead of when the packet is dequeued from the device queue, so that
+   * Byte Queue Limits account for the packet on the wire.
+   *
+   * \param queue the device transmission queue
+   */
+  void SetNetDeviceQueue (Ptr<NetDeviceQueue> queue);
+
   /**
    * Attach a receive ErrorModel to the PointToPointNetDevice.
    *
@@ -321,6 +335,11 @@ private:
    */
   Ptr<Queue<Packet> > m_queue;
 
+  /**
+   * The device transmission queue to which the transmitted bytes are reported
+   */
+  Ptr<NetDeviceQueue> m_txQueue;
+
   /**
    * Error model for receive packet events
    */
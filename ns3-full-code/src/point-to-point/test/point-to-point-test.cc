@@ -24,8 +24,10 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-limits.h"
 
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -130,6 +132,130 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Queue limits which record the bytes queued and completed
+ */
+class RecordingQueueLimits : public QueueLimits
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual void Reset ()
+  {
+  }
+  virtual void Completed (uint32_t count)
+  {
+    m_completed.push_back (std::make_pair (Simulator::Now (), count));
+  }
+  virtual int32_t Available () const
+  {
+    return 0;
+  }
+  virtual void Queued (uint32_t count)
+  {
+    m_queued.push_back (std::make_pair (Simulator::Now (), count));
+  }
+
+  std::vector<std::pair<Time, uint32_t> > m_queued;    //!< the time and size of the bytes queued
+  std::vector<std::pair<Time, uint32_t> > m_completed; //!< the time and size of the bytes completed
+};
+
+TypeId
+RecordingQueueLimits::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RecordingQueueLimits")
+    .SetParent<QueueLimits> ()
+    .SetGroupName ("PointToPoint")
+  ;
+  return tid;
+}
+
+/**
+ * \brief Test the Byte Queue Limits support of PointToPointNetDevice
+ *
+ * It sends a burst of packets through a device whose transmission queue has
+ * queue limits, and checks that the bytes of each packet are reported as
+ * transmitted when its transmission completes.
+ */
+class PointToPointBqlTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointBqlTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+};
+
+PointToPointBqlTest::PointToPointBqlTest ()
+  : TestCase ("PointToPoint Byte Queue Limits")
+{
+}
+
+void
+PointToPointBqlTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  Ptr<Queue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  devA->SetQueue (queue);
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
+  ndqi->GetTxQueue (0)->ConnectQueueTraces (queue);
+  devA->AggregateObject (ndqi);
+  devA->SetNetDeviceQueue (ndqi->GetTxQueue (0));
+  Ptr<RecordingQueueLimits> limits = CreateObject<RecordingQueueLimits> ();
+  ndqi->GetTxQueue (0)->SetQueueLimits (limits);
+
+  DataRate rate ("1Mbps");
+  Time gap = MicroSeconds (10);
+  devA->SetDataRate (rate);
+  devA->SetInterframeGap (gap);
+
+  uint32_t n = 3;
+  uint32_t size = 998;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Simulator::Schedule (Seconds (1), &PointToPointNetDevice::Send, devA,
+                           Create<Packet> (size), devA->GetBroadcast (), 0x800);
+    }
+  Simulator::Run ();
+
+  // the size of the packets includes the PPP header
+  NS_TEST_ASSERT_MSG_EQ (limits->m_queued.size (), n, "Every packet should be queued");
+  NS_TEST_ASSERT_MSG_EQ (limits->m_completed.size (), n, "Every packet should be completed");
+  Time txTime = rate.CalculateBytesTxTime (size + 2) + gap;
+  for (uint32_t i = 0; i < limits->m_completed.size () && i < limits->m_queued.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (limits->m_queued[i].first, Seconds (1), "The packets are queued at once");
+      NS_TEST_EXPECT_MSG_EQ (limits->m_queued[i].second, size + 2, "Wrong number of bytes queued");
+      NS_TEST_EXPECT_MSG_EQ (limits->m_completed[i].first, Seconds (1) + txTime * (i + 1),
+                             "The bytes should be completed at the end of the transmission");
+      NS_TEST_EXPECT_MSG_EQ (limits->m_completed[i].second, size + 2, "Wrong number of bytes completed");
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -146,6 +272,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBqlTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
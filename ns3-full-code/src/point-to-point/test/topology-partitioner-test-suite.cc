@@ -0,0 +1,278 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/topology-partitioner.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/node.h"
+#include "ns3/data-rate.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <set>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \brief Get the links crossing LP boundaries.
+ * \param partitioner the partitioner
+ * \param nodes the partitioned nodes
+ * \return the channels connecting nodes assigned to different LPs
+ */
+static std::set<Ptr<Channel> >
+GetCutChannels (const TopologyPartitioner &partitioner, NodeContainer nodes)
+{
+  std::set<Ptr<Channel> > cut;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      for (uint32_t j = 0; j < nodes.Get (i)->GetNDevices (); j++)
+        {
+          Ptr<Channel> channel = nodes.Get (i)->GetDevice (j)->GetChannel ();
+          for (std::size_t k = 0; channel && k < channel->GetNDevices (); k++)
+            {
+              if (partitioner.GetSystemId (channel->GetDevice (k)->GetNode ()->GetId ())
+                  != partitioner.GetSystemId (nodes.Get (i)->GetId ()))
+                {
+                  cut.insert (channel);
+                }
+            }
+        }
+    }
+  return cut;
+}
+
+/**
+ * \brief Get the ids of some nodes.
+ * \param nodes the nodes
+ * \return the ids of the nodes
+ */
+static std::set<uint32_t>
+GetNodeIds (NodeContainer nodes)
+{
+  std::set<uint32_t> ids;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      ids.insert (nodes.Get (i)->GetId ());
+    }
+  return ids;
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \ingroup tests
+ *
+ * \brief Check the partition of a point-to-point dumbbell.
+ *
+ * Four leaves on each side are connected to a router with 1 ms links,
+ * and the two routers are connected by a 20 ms bottleneck.  With two
+ * partitions the bottleneck must be the only cut link.
+ */
+class TopologyPartitionerDumbbellTestCase : public TestCase
+{
+public:
+  TopologyPartitionerDumbbellTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Connect two nodes with a point-to-point link.
+   * \param a the first node
+   * \param b the second node
+   * \param delay the link delay
+   * \param rate the link data rate
+   * \return the channel of the link
+   */
+  Ptr<Channel> Link (Ptr<Node> a, Ptr<Node> b, std::string delay, std::string rate);
+};
+
+TopologyPartitionerDumbbellTestCase::TopologyPartitionerDumbbellTestCase ()
+  : TestCase ("Partition of a dumbbell topology")
+{
+}
+
+Ptr<Channel>
+TopologyPartitionerDumbbellTestCase::Link (Ptr<Node> a, Ptr<Node> b, std::string delay, std::string rate)
+{
+  PointToPointHelper p2p;
+  p2p.SetChannelAttribute ("Delay", StringValue (delay));
+  p2p.SetDeviceAttribute ("DataRate", StringValue (rate));
+  return p2p.Install (a, b).Get (0)->GetChannel ();
+}
+
+void
+TopologyPartitionerDumbbellTestCase::DoRun (void)
+{
+  NodeContainer routers;
+  routers.Create (2);
+  NodeContainer left;
+  left.Create (4);
+  NodeContainer right;
+  right.Create (4);
+
+  std::set<Ptr<Channel> > links;
+  Ptr<Channel> bottleneck = Link (routers.Get (0), routers.Get (1), "20ms", "10Mbps");
+  links.insert (bottleneck);
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      links.insert (Link (left.Get (i), routers.Get (0), "1ms", "100Mbps"));
+      links.insert (Link (right.Get (i), routers.Get (1), "1ms", "100Mbps"));
+    }
+
+  NodeContainer all (routers, left, right);
+  TopologyPartitioner partitioner;
+  partitioner.Partition (all, 2);
+
+  std::set<Ptr<Channel> > cut = GetCutChannels (partitioner, all);
+  NS_TEST_EXPECT_MSG_EQ (cut.size (), 1, "Only the bottleneck should be cut");
+  NS_TEST_EXPECT_MSG_EQ ((cut == std::set<Ptr<Channel> > {bottleneck}), true, "Only the bottleneck should be cut");
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetNCutLinks (), 1, "Only the bottleneck should be cut");
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetLookahead (), MilliSeconds (20),
+                         "The lookahead should be the bottleneck delay");
+  uint32_t leftId = partitioner.GetSystemId (routers.Get (0)->GetId ());
+  uint32_t rightId = partitioner.GetSystemId (routers.Get (1)->GetId ());
+  NS_TEST_ASSERT_MSG_NE (leftId, rightId, "The routers should be on different ranks");
+  NS_TEST_EXPECT_MSG_EQ ((GetNodeIds (partitioner.GetPartition (leftId))
+                          == GetNodeIds (NodeContainer (routers.Get (0), left))),
+                         true, "Rank " << leftId << " should hold the left router and leaves");
+  NS_TEST_EXPECT_MSG_EQ ((GetNodeIds (partitioner.GetPartition (rightId))
+                          == GetNodeIds (NodeContainer (routers.Get (1), right))),
+                         true, "Rank " << rightId << " should hold the right router and leaves");
+  NS_TEST_EXPECT_MSG_EQ_TOL (partitioner.GetImbalance (), 1, 1e-9, "The halves should be balanced");
+
+  // The mapping must survive a round trip through its text format
+  std::stringstream ss;
+  partitioner.Write (ss);
+  std::vector<uint32_t> mapping = TopologyPartitioner::Read (ss);
+  NS_TEST_EXPECT_MSG_EQ ((mapping == partitioner.GetMapping ()), true, "Mapping not read back correctly");
+
+  // Asking for more partitions than the bottleneck allows forces cutting
+  // the access links, reducing the lookahead.  The routers (411 Mb/s each)
+  // are on their own, and the leaves (101 Mb/s each) are spread over the
+  // other two ranks.
+  partitioner.Partition (all, 4);
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetLookahead (), MilliSeconds (1),
+                         "Access links should have been cut");
+  std::vector<uint32_t> sizes = {1, 1, 4, 4};
+  for (uint32_t i = 0; i < sizes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (partitioner.GetPartition (i).GetN (), sizes[i],
+                             "Wrong number of nodes on rank " << i);
+    }
+  NS_TEST_EXPECT_MSG_NE (partitioner.GetSystemId (routers.Get (0)->GetId ()),
+                         partitioner.GetSystemId (routers.Get (1)->GetId ()),
+                         "The routers should be on different ranks");
+  cut = GetCutChannels (partitioner, all);
+  NS_TEST_EXPECT_MSG_EQ ((cut == links), true, "Every link should be cut");
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetNCutLinks (), links.size (), "Every link should be cut");
+  NS_TEST_EXPECT_MSG_EQ_TOL (partitioner.GetImbalance (), 411.0 * 4 / 1630, 1e-9,
+                             "Unexpected imbalance");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \ingroup tests
+ *
+ * \brief Check that only point-to-point links are cut.
+ *
+ * Node 0 is connected to node 1 with a 5 ms point-to-point link, node 1
+ * to node 2 with a 50 ms channel connecting two devices only, and nodes
+ * 2, 3 and 4 share a 50 ms channel.  The point-to-point link must be the
+ * only cut link, even if the other channels have a larger delay.
+ */
+class TopologyPartitionerChannelTypeTestCase : public TestCase
+{
+public:
+  TopologyPartitionerChannelTypeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Connect some nodes with a simple channel.
+   * \param nodes the nodes
+   */
+  void Connect (NodeContainer nodes);
+};
+
+TopologyPartitionerChannelTypeTestCase::TopologyPartitionerChannelTypeTestCase ()
+  : TestCase ("Only point-to-point links are cut")
+{
+}
+
+void
+TopologyPartitionerChannelTypeTestCase::Connect (NodeContainer nodes)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (50)));
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetChannel (channel);
+      nodes.Get (i)->AddDevice (device);
+    }
+}
+
+void
+TopologyPartitionerChannelTypeTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+
+  PointToPointHelper p2p;
+  p2p.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  Ptr<Channel> link = p2p.Install (nodes.Get (0), nodes.Get (1)).Get (0)->GetChannel ();
+  Connect (NodeContainer (nodes.Get (1), nodes.Get (2)));
+  Connect (NodeContainer (nodes.Get (2), nodes.Get (3), nodes.Get (4)));
+
+  TopologyPartitioner partitioner;
+  partitioner.Partition (nodes, 2);
+
+  std::set<Ptr<Channel> > cut = GetCutChannels (partitioner, nodes);
+  NS_TEST_EXPECT_MSG_EQ ((cut == std::set<Ptr<Channel> > {link}), true,
+                         "Only the point-to-point link should be cut");
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetNCutLinks (), 1, "Only the point-to-point link should be cut");
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetLookahead (), MilliSeconds (5),
+                         "The lookahead should be the point-to-point delay");
+  NS_TEST_EXPECT_MSG_EQ ((GetNodeIds (partitioner.GetPartition (0))
+                          == GetNodeIds (NodeContainer (nodes.Get (1), nodes.Get (2), nodes.Get (3), nodes.Get (4)))),
+                         true, "Rank 0 should hold the nodes sharing the simple channels");
+  NS_TEST_EXPECT_MSG_EQ ((GetNodeIds (partitioner.GetPartition (1))
+                          == GetNodeIds (NodeContainer (nodes.Get (0)))),
+                         true, "Rank 1 should hold node 0 only");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \ingroup tests
+ *
+ * \brief Topology partitioner test suite
+ */
+static class TopologyPartitionerTestSuite : public TestSuite
+{
+public:
+  TopologyPartitionerTestSuite ()
+    : TestSuite ("topology-partitioner", UNIT)
+  {
+    AddTestCase (new TopologyPartitionerDumbbellTestCase (), TestCase::QUICK);
+    AddTestCase (new TopologyPartitionerChannelTypeTestCase (), TestCase::QUICK);
+  }
+} g_topologyPartitionerTestSuite; ///< the test suite
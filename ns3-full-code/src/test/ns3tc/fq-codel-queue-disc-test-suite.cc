@@ -34,6 +34,9 @@
 #include "ns3/udp-header.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+
+#include <vector>
 
 using namespace ns3;
 
@@ -951,6 +954,123 @@ FqCoDelQueueDiscSetLinearProbing::DoRun (void)
 }
 
 
+/*
+ * This class tests that set associative hashing does not reorder the packets
+ * of a flow when there are more flows than queues in a set. The queue disc
+ * has a single set of 8 queues, possibly followed by an overflow area, and
+ * the packets of 20 flows (each flow has its own hash) are enqueued in turn,
+ * while packets are dequeued from time to time, so that queues become
+ * inactive and are assigned to other flows. The flows which find the set
+ * full take a queue of the overflow area, if any is free, and otherwise
+ * share the first queue of the set. In both cases, they must keep their
+ * queue until it becomes inactive, so that each flow dequeues its packets
+ * in the order they were enqueued.
+ */
+class FqCoDelQueueDiscSetOverflowOrder : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param overflowFlows the number of queues of the overflow area
+   */
+  FqCoDelQueueDiscSetOverflowOrder (uint32_t overflowFlows);
+  virtual ~FqCoDelQueueDiscSetOverflowOrder ();
+private:
+  virtual void DoRun (void);
+  void AddPacket (Ptr<FqCoDelQueueDisc> queue, uint32_t flow, uint16_t seq);
+  void Dequeue (Ptr<FqCoDelQueueDisc> queue);
+
+  uint32_t m_overflowFlows;        //!< the number of queues of the overflow area
+  std::vector<int32_t> m_lastSeq;  //!< the sequence number of the last packet dequeued, by flow
+  uint32_t m_dequeued;             //!< the number of packets dequeued
+};
+
+FqCoDelQueueDiscSetOverflowOrder::FqCoDelQueueDiscSetOverflowOrder (uint32_t overflowFlows)
+  : TestCase ("Test the order of the packets of the flows colliding in a set with "
+              + std::to_string (overflowFlows) + " overflow queues"),
+    m_overflowFlows (overflowFlows),
+    m_dequeued (0)
+{
+}
+
+FqCoDelQueueDiscSetOverflowOrder::~FqCoDelQueueDiscSetOverflowOrder ()
+{
+}
+
+void
+FqCoDelQueueDiscSetOverflowOrder::AddPacket (Ptr<FqCoDelQueueDisc> queue, uint32_t flow, uint16_t seq)
+{
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (100);
+  hdr.SetSource (Ipv4Address (0x0a000001 + flow));
+  hdr.SetDestination (Ipv4Address ("10.10.1.2"));
+  hdr.SetProtocol (7);
+  hdr.SetIdentification (seq);
+  Ptr<Packet> p = Create<Packet> (100);
+  Address dest;
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, dest, 0, hdr);
+  // the flows fall in the same set, and differ by their full hash
+  hash = flow * 8;
+  queue->Enqueue (item);
+}
+
+void
+FqCoDelQueueDiscSetOverflowOrder::Dequeue (Ptr<FqCoDelQueueDisc> queue)
+{
+  Ptr<Ipv4QueueDiscItem> item = DynamicCast<Ipv4QueueDiscItem> (queue->Dequeue ());
+  NS_TEST_ASSERT_MSG_NE (item, 0, "A packet should have been dequeued");
+  uint32_t flow = item->GetHeader ().GetSource ().Get () - 0x0a000001;
+  int32_t seq = item->GetHeader ().GetIdentification ();
+  NS_TEST_ASSERT_MSG_GT (seq, m_lastSeq[flow], "The packets of flow " << flow << " have been reordered");
+  m_lastSeq[flow] = seq;
+  m_dequeued++;
+}
+
+void
+FqCoDelQueueDiscSetOverflowOrder::DoRun (void)
+{
+  Ptr<FqCoDelQueueDisc> queueDisc = CreateObjectWithAttributes<FqCoDelQueueDisc> ("EnableSetAssociativeHash", BooleanValue (true),
+                                                                                   "Flows", UintegerValue (8),
+                                                                                   "OverflowFlows", UintegerValue (m_overflowFlows));
+  queueDisc->SetQuantum (250);
+  queueDisc->Initialize ();
+
+  Ptr<Ipv4TestPacketFilter> filter = CreateObject<Ipv4TestPacketFilter> ();
+  queueDisc->AddPacketFilter (filter);
+
+  uint32_t nFlows = 20;
+  uint16_t nRounds = 30;
+  m_lastSeq.assign (nFlows, -1);
+  uint32_t enqueued = 0;
+  for (uint16_t seq = 0; seq < nRounds; seq++)
+    {
+      for (uint32_t flow = 0; flow < nFlows; flow++)
+        {
+          // the flows do not all send in every round
+          if ((flow + seq) % 3 == 0)
+            {
+              continue;
+            }
+          AddPacket (queueDisc, flow, seq);
+          enqueued++;
+          if (enqueued % 3 == 0)
+            {
+              Dequeue (queueDisc);
+              Dequeue (queueDisc);
+            }
+        }
+    }
+  while (queueDisc->QueueDisc::GetNPackets () > 0)
+    {
+      Dequeue (queueDisc);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_dequeued, enqueued, "All the packets should have been dequeued");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), 8 + m_overflowFlows,
+                         "The colliding flows should have used all the queues of the overflow area");
+  Simulator::Destroy ();
+}
+
+
 /**
  * This class tests L4S mode
  * Any future classifier options (e.g. SetAssociativeHash) should be disabled to prevent a hash collision on this test case.
@@ -1122,6 +1242,8 @@ FqCoDelQueueDiscTestSuite::FqCoDelQueueDiscTestSuite ()
   AddTestCase (new FqCoDelQueueDiscUDPFlowsSeparation, TestCase::QUICK);
   AddTestCase (new FqCoDelQueueDiscECNMarking, TestCase::QUICK);
   AddTestCase (new FqCoDelQueueDiscSetLinearProbing, TestCase::QUICK);
+  AddTestCase (new FqCoDelQueueDiscSetOverflowOrder (0), TestCase::QUICK);
+  AddTestCase (new FqCoDelQueueDiscSetOverflowOrder (4), TestCase::QUICK);
   AddTestCase (new FqCoDelQueueDiscL4sMode, TestCase::QUICK);
 }
 
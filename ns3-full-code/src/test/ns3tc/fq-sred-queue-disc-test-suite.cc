@@ -0,0 +1,390 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/fq-sred-queue-disc.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-packet-filter.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-queue-disc-item.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+
+using namespace ns3;
+
+/**
+ * Simple test packet filter unable to classify any packet
+ */
+class Ipv4FqSredTestPacketFilter : public Ipv4PacketFilter
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  Ipv4FqSredTestPacketFilter ();
+  virtual ~Ipv4FqSredTestPacketFilter ();
+
+private:
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
+  virtual bool CheckProtocol (Ptr<QueueDiscItem> item) const;
+};
+
+TypeId
+Ipv4FqSredTestPacketFilter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4FqSredTestPacketFilter")
+    .SetParent<Ipv4PacketFilter> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv4FqSredTestPacketFilter> ()
+  ;
+  return tid;
+}
+
+Ipv4FqSredTestPacketFilter::Ipv4FqSredTestPacketFilter ()
+{}
+
+Ipv4FqSredTestPacketFilter::~Ipv4FqSredTestPacketFilter ()
+{}
+
+int32_t
+Ipv4FqSredTestPacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  return PacketFilter::PF_NO_MATCH;
+}
+
+bool
+Ipv4FqSredTestPacketFilter::CheckProtocol (Ptr<QueueDiscItem> item) const
+{
+  return true;
+}
+
+/**
+ * Enqueue a packet of 100 bytes
+ * \param queue the queue disc
+ * \param hdr the IPv4 header identifying the flow
+ */
+static void
+AddFqSredPacket (Ptr<FqSredQueueDisc> queue, Ipv4Header hdr)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  Address dest;
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, dest, 0, hdr);
+  queue->Enqueue (item);
+}
+
+/**
+ * This class tests packets for which there is no suitable filter
+ */
+class FqSredQueueDiscNoSuitableFilter : public TestCase
+{
+public:
+  FqSredQueueDiscNoSuitableFilter ();
+  virtual ~FqSredQueueDiscNoSuitableFilter ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FqSredQueueDiscNoSuitableFilter::FqSredQueueDiscNoSuitableFilter ()
+  : TestCase ("Test packets that are not classified by any filter")
+{}
+
+FqSredQueueDiscNoSuitableFilter::~FqSredQueueDiscNoSuitableFilter ()
+{}
+
+void
+FqSredQueueDiscNoSuitableFilter::DoRun (void)
+{
+  // Packets that cannot be classified by the available filters should be dropped
+  Ptr<FqSredQueueDisc> queueDisc = CreateObjectWithAttributes<FqSredQueueDisc> ("MaxSize", StringValue ("4p"));
+  queueDisc->AddPacketFilter (CreateObject<Ipv4FqSredTestPacketFilter> ());
+  queueDisc->SetQuantum (1500);
+  queueDisc->Initialize ();
+
+  Ipv6Header ipv6Header;
+  Address dest;
+  Ptr<Ipv6QueueDiscItem> item = Create<Ipv6QueueDiscItem> (Create<Packet> (), dest, 0, ipv6Header);
+  queueDisc->Enqueue (item);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), 0, "no flow queue should have been created");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetStats ().GetNDroppedPackets (FqSredQueueDisc::UNCLASSIFIED_DROP), 1,
+                         "the packet should have been dropped");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests the IP flows separation and the packet limit
+ */
+class FqSredQueueDiscIPFlowsSeparationAndPacketLimit : public TestCase
+{
+public:
+  FqSredQueueDiscIPFlowsSeparationAndPacketLimit ();
+  virtual ~FqSredQueueDiscIPFlowsSeparationAndPacketLimit ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FqSredQueueDiscIPFlowsSeparationAndPacketLimit::FqSredQueueDiscIPFlowsSeparationAndPacketLimit ()
+  : TestCase ("Test IP flows separation and packet limit")
+{}
+
+FqSredQueueDiscIPFlowsSeparationAndPacketLimit::~FqSredQueueDiscIPFlowsSeparationAndPacketLimit ()
+{}
+
+void
+FqSredQueueDiscIPFlowsSeparationAndPacketLimit::DoRun (void)
+{
+  Ptr<FqSredQueueDisc> queueDisc = CreateObjectWithAttributes<FqSredQueueDisc> ("MaxSize", StringValue ("4p"));
+
+  queueDisc->SetQuantum (1500);
+  queueDisc->Initialize ();
+
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (100);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address ("10.10.1.2"));
+  hdr.SetProtocol (7);
+
+  // Add three packets from the first flow
+  AddFqSredPacket (queueDisc, hdr);
+  AddFqSredPacket (queueDisc, hdr);
+  AddFqSredPacket (queueDisc, hdr);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the flow queue");
+
+  // Add two packets from the second flow
+  hdr.SetDestination (Ipv4Address ("10.10.1.7"));
+  AddFqSredPacket (queueDisc, hdr);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the flow queue");
+  // Add the second packet that causes two packets to be dropped from the fat flow (max backlog = 300, threshold = 150)
+  AddFqSredPacket (queueDisc, hdr);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetStats ().GetNDroppedPackets (FqSredQueueDisc::OVERLIMIT_DROP), 2,
+                         "unexpected number of overlimit drops");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests the deficit round robin among the flows
+ */
+class FqSredQueueDiscDeficit : public TestCase
+{
+public:
+  FqSredQueueDiscDeficit ();
+  virtual ~FqSredQueueDiscDeficit ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FqSredQueueDiscDeficit::FqSredQueueDiscDeficit ()
+  : TestCase ("Test credits and flows status")
+{}
+
+FqSredQueueDiscDeficit::~FqSredQueueDiscDeficit ()
+{}
+
+void
+FqSredQueueDiscDeficit::DoRun (void)
+{
+  Ptr<FqSredQueueDisc> queueDisc = CreateObject<FqSredQueueDisc> ();
+
+  queueDisc->SetQuantum (90);
+  queueDisc->Initialize ();
+
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (100);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address ("10.10.1.2"));
+  hdr.SetProtocol (7);
+
+  // Add two packets from each of two flows
+  AddFqSredPacket (queueDisc, hdr);
+  AddFqSredPacket (queueDisc, hdr);
+  hdr.SetDestination (Ipv4Address ("10.10.1.10"));
+  AddFqSredPacket (queueDisc, hdr);
+  AddFqSredPacket (queueDisc, hdr);
+  Ptr<FqSredFlow> flow1 = StaticCast<FqSredFlow> (queueDisc->GetQueueDiscClass (0));
+  Ptr<FqSredFlow> flow2 = StaticCast<FqSredFlow> (queueDisc->GetQueueDiscClass (1));
+  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqSredFlow::NEW_FLOW, "the first flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqSredFlow::NEW_FLOW, "the second flow must be in the list of new queues");
+
+  // The flows are served in turn, as each packet (100+20 bytes) exceeds the quantum
+  queueDisc->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (flow1->GetQueueDisc ()->GetNPackets (), 1, "the first flow should have been served");
+  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), -30, "unexpected deficit for the first flow");
+  queueDisc->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (flow2->GetQueueDisc ()->GetNPackets (), 1, "the second flow should have been served");
+  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqSredFlow::OLD_FLOW, "the first flow must be in the list of old queues");
+  queueDisc->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (flow1->GetQueueDisc ()->GetNPackets (), 0, "the first flow should have been served");
+  queueDisc->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (flow2->GetQueueDisc ()->GetNPackets (), 0, "the second flow should have been served");
+
+  // Dequeuing from the empty queue disc makes both flows inactive
+  NS_TEST_ASSERT_MSG_EQ ((queueDisc->Dequeue () == 0), true, "the queue disc should be empty");
+  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqSredFlow::INACTIVE, "the first flow must be inactive");
+  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqSredFlow::INACTIVE, "the second flow must be inactive");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests that the drop probability depends on the occupancy of
+ * the flow queue of each packet
+ */
+class FqSredQueueDiscPerFlowZap : public TestCase
+{
+public:
+  FqSredQueueDiscPerFlowZap ();
+  virtual ~FqSredQueueDiscPerFlowZap ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FqSredQueueDiscPerFlowZap::FqSredQueueDiscPerFlowZap ()
+  : TestCase ("Test the SRED drops of each flow queue")
+{}
+
+FqSredQueueDiscPerFlowZap::~FqSredQueueDiscPerFlowZap ()
+{}
+
+void
+FqSredQueueDiscPerFlowZap::DoRun (void)
+{
+  // Do not scale the drop probability by the number of flows
+  Ptr<ActiveFlowEstimator> estimator = CreateObjectWithAttributes<ActiveFlowEstimator> ("ReferenceFlows",
+                                                                                        DoubleValue (1));
+  Ptr<FqSredQueueDisc> queueDisc = CreateObjectWithAttributes<FqSredQueueDisc> ("FlowLimit", UintegerValue (30),
+                                                                                "MaximumDropProbability", DoubleValue (1),
+                                                                                "ActiveFlowEstimator", PointerValue (estimator));
+  queueDisc->SetQuantum (1500);
+  queueDisc->AssignStreams (1);
+  queueDisc->Initialize ();
+
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (100);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address ("10.10.1.2"));
+  hdr.SetProtocol (7);
+
+  // The first flow queue reaches a third of the flow limit, where every
+  // packet is dropped
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      AddFqSredPacket (queueDisc, hdr);
+    }
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 10,
+                         "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetStats ().GetNDroppedPackets (FqSredQueueDisc::UNFORCED_DROP), 40,
+                         "unexpected number of unforced drops");
+
+  // The packets of a short flow are not dropped
+  hdr.SetDestination (Ipv4Address ("10.10.1.7"));
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      AddFqSredPacket (queueDisc, hdr);
+    }
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 4,
+                         "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetStats ().GetNDroppedPackets (FqSredQueueDisc::UNFORCED_DROP), 40,
+                         "unexpected number of unforced drops");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests that the flow queues share the zombie list
+ */
+class FqSredQueueDiscSharedZombieList : public TestCase
+{
+public:
+  FqSredQueueDiscSharedZombieList ();
+  virtual ~FqSredQueueDiscSharedZombieList ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FqSredQueueDiscSharedZombieList::FqSredQueueDiscSharedZombieList ()
+  : TestCase ("Test the estimate of the number of flows across the flow queues")
+{}
+
+FqSredQueueDiscSharedZombieList::~FqSredQueueDiscSharedZombieList ()
+{}
+
+void
+FqSredQueueDiscSharedZombieList::DoRun (void)
+{
+  Ptr<FqSredQueueDisc> queueDisc = CreateObject<FqSredQueueDisc> ();
+  queueDisc->SetQuantum (1500);
+  queueDisc->AssignStreams (1);
+  queueDisc->Initialize ();
+
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (100);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetProtocol (7);
+
+  // 20 flows share the link, and no flow queue builds up
+  uint32_t nFlows = 20;
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      hdr.SetDestination (Ipv4Address (0x0a0a0200 + i % nFlows));
+      AddFqSredPacket (queueDisc, hdr);
+      queueDisc->Dequeue ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetStats ().nTotalDroppedPackets, 0, "there should be no drops");
+  double flows = queueDisc->GetActiveFlowEstimator ()->GetActiveFlows ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (flows, nFlows, 0.25 * nFlows, "wrong estimate of the number of flows");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * FQ-SRED queue disc test suite
+ */
+class FqSredQueueDiscTestSuite : public TestSuite
+{
+public:
+  FqSredQueueDiscTestSuite ();
+};
+
+FqSredQueueDiscTestSuite::FqSredQueueDiscTestSuite ()
+  : TestSuite ("fq-sred-queue-disc", UNIT)
+{
+  AddTestCase (new FqSredQueueDiscNoSuitableFilter, TestCase::QUICK);
+  AddTestCase (new FqSredQueueDiscIPFlowsSeparationAndPacketLimit, TestCase::QUICK);
+  AddTestCase (new FqSredQueueDiscDeficit, TestCase::QUICK);
+  AddTestCase (new FqSredQueueDiscPerFlowZap, TestCase::QUICK);
+  AddTestCase (new FqSredQueueDiscSharedZombieList, TestCase::QUICK);
+}
+
+static FqSredQueueDiscTestSuite g_fqSredQueueDiscTestSuite; ///< the test suite
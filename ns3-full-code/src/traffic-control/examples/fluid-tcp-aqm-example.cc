@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** Network topology
+ *
+ *    s0 ----|                                   |---- d0
+ *    s1 ----|         bottleneck (AQM)          |---- d1
+ *    ...    r0 ------------------------------- r1     ...
+ *    sN-1 --|     rate, 20ms, QueueLimit=200p   |---- dN-1
+ *
+ * The senders and the receivers are attached with 100Mbps, 2ms links.
+ *
+ * This example evaluates an AQM (RED, PIE, Stabilized RED or ESRED) with a
+ * large number of background TCP flows, represented by a FluidTcpModel
+ * installed on the bottleneck, and a few TCP flows simulated packet by
+ * packet.  The fluid flows have the same round trip propagation delay as the
+ * packet flows.  The cost of the simulation depends on the rate of the
+ * bottleneck, not on the number of fluid flows, e.g.:
+ *
+ *   ./waf --run "fluid-tcp-aqm-example --aqm=StabilizedRed --fluidFlows=20000 --rate=1Gbps"
+ *
+ * Like the fluid model, which does not model the timeouts, the results are
+ * meaningful as long as the flows have a window of a few packets, that is as
+ * long as the bottleneck carries a few packets per round trip time per flow.
+ *
+ * Without packet flows (--packetFlows=0), only the fluid flows load the
+ * bottleneck.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("FluidTcpAqmExample");
+
+uint32_t checkTimes;
+double avgQueueDiscSize;
+double avgWindow;
+double avgDropProbability;
+
+void
+CheckQueueDiscSize (Ptr<QueueDisc> queue, Ptr<FluidTcpModel> fluid)
+{
+  avgQueueDiscSize += queue->GetCurrentSize ().GetValue ();
+  avgWindow += fluid->GetWindow ();
+  avgDropProbability += fluid->GetDropProbability ();
+  checkTimes++;
+
+  // check queue disc size every 1/100 of a second
+  Simulator::Schedule (Seconds (0.01), &CheckQueueDiscSize, queue, fluid);
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string aqm = "Red";
+  uint32_t packetFlows = 2;
+  uint32_t fluidFlows = 20;
+  std::string rate = "10Mbps";
+  bool ecn = false;
+  double stopTime = 30.0;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("aqm", "The AQM to use at the bottleneck: Red, Pie, StabilizedRed or ESRed", aqm);
+  cmd.AddValue ("packetFlows", "Number of TCP flows simulated packet by packet", packetFlows);
+  cmd.AddValue ("fluidFlows", "Number of TCP flows of the fluid model", fluidFlows);
+  cmd.AddValue ("rate", "The rate of the bottleneck", rate);
+  cmd.AddValue ("ecn", "<0/1> to mark instead of dropping (RED and PIE only)", ecn);
+  cmd.AddValue ("stopTime", "Simulation duration in seconds", stopTime);
+  cmd.Parse (argc, argv);
+
+  if (aqm != "Red" && aqm != "Pie" && aqm != "StabilizedRed" && aqm != "ESRed")
+    {
+      NS_FATAL_ERROR ("Unknown AQM " << aqm);
+    }
+
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpNewReno"));
+  // 42 = headers size
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1000 - 42));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (1));
+  Config::SetDefault ("ns3::TcpSocketBase::UseEcn", StringValue (ecn ? "On" : "Off"));
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (false));
+
+  Config::SetDefault ("ns3::RedQueueDisc::MaxSize", StringValue ("200p"));
+  Config::SetDefault ("ns3::RedQueueDisc::MeanPktSize", UintegerValue (1000));
+  Config::SetDefault ("ns3::RedQueueDisc::MinTh", DoubleValue (20));
+  Config::SetDefault ("ns3::RedQueueDisc::MaxTh", DoubleValue (60));
+  Config::SetDefault ("ns3::RedQueueDisc::LinkBandwidth", StringValue (rate));
+  Config::SetDefault ("ns3::RedQueueDisc::LinkDelay", StringValue ("20ms"));
+  Config::SetDefault ("ns3::RedQueueDisc::UseEcn", BooleanValue (ecn));
+  Config::SetDefault ("ns3::PieQueueDisc::MaxSize", StringValue ("200p"));
+  Config::SetDefault ("ns3::PieQueueDisc::MeanPktSize", UintegerValue (1000));
+  Config::SetDefault ("ns3::PieQueueDisc::UseEcn", BooleanValue (ecn));
+  Config::SetDefault ("ns3::StabilizedRedQueueDisc::MaxSize", StringValue ("200p"));
+  Config::SetDefault ("ns3::ESRedQueueDisc::MaxSize", StringValue ("200p"));
+
+  // The round trip propagation delay of the packet flows
+  Config::SetDefault ("ns3::FluidTcpModel::PropagationDelay", TimeValue (MilliSeconds (48)));
+  Config::SetDefault ("ns3::FluidTcpModel::PacketSize", UintegerValue (1000));
+  Config::SetDefault ("ns3::FluidTcpModel::UseEcn", BooleanValue (ecn));
+
+  NodeContainer routers;
+  routers.Create (2);
+  NodeContainer senders;
+  senders.Create (packetFlows);
+  NodeContainer receivers;
+  receivers.Create (packetFlows);
+
+  InternetStackHelper internet;
+  internet.InstallAll ();
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue (rate));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("20ms"));
+  bottleneck.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("1p"));
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.0");
+  NetDeviceContainer bottleneckDevices = bottleneck.Install (routers);
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::" + aqm + "QueueDisc");
+  QueueDiscContainer queueDiscs = tch.Install (bottleneckDevices.Get (0));
+  ipv4.Assign (bottleneckDevices);
+
+  Ptr<FluidTcpModel> fluid = CreateObjectWithAttributes<FluidTcpModel> ("Flows",
+                                                                        UintegerValue (fluidFlows));
+  fluid->Install (bottleneckDevices.Get (0));
+
+  Ipv4InterfaceContainer receiverInterfaces;
+  for (uint32_t i = 0; i < packetFlows; i++)
+    {
+      ipv4.NewNetwork ();
+      ipv4.Assign (access.Install (senders.Get (i), routers.Get (0)));
+      ipv4.NewNetwork ();
+      receiverInterfaces.Add (ipv4.Assign (access.Install (receivers.Get (i), routers.Get (1))).Get (0));
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint16_t port = 50000;
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sinkHelper.Install (receivers);
+  sinkApps.Start (Seconds (0));
+
+  Ptr<UniformRandomVariable> startTime = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < packetFlows; i++)
+    {
+      BulkSendHelper source ("ns3::TcpSocketFactory",
+                             InetSocketAddress (receiverInterfaces.GetAddress (i), port));
+      ApplicationContainer sourceApp = source.Install (senders.Get (i));
+      sourceApp.Start (Seconds (startTime->GetValue (0, 1)));
+      sourceApp.Stop (Seconds (stopTime));
+    }
+
+  // skip the transient of the flows
+  Simulator::Schedule (Seconds (5), &CheckQueueDiscSize, queueDiscs.Get (0), fluid);
+
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+
+  uint64_t rxBytes = 0;
+  for (uint32_t i = 0; i < sinkApps.GetN (); i++)
+    {
+      rxBytes += DynamicCast<PacketSink> (sinkApps.Get (i))->GetTotalRx ();
+    }
+
+  std::cout << "*** " << aqm << ", " << fluidFlows << " fluid flows, "
+            << packetFlows << " packet flows ***" << std::endl;
+  std::cout << "\t " << avgQueueDiscSize / checkTimes << " packets in queue on average" << std::endl;
+  std::cout << "\t " << avgWindow / checkTimes << " packets in the window of the fluid flows on average" << std::endl;
+  std::cout << "\t " << avgDropProbability / checkTimes << " drop (or mark) probability on average" << std::endl;
+  std::cout << "\t " << fluid->GetDroppedPackets () << " packets of the fluid flows dropped, "
+            << fluid->GetMarkedPackets () << " marked, out of " << fluid->GetTxPackets () << std::endl;
+  std::cout << "\t " << (fluid->GetTxPackets () - fluid->GetDroppedPackets ()) * 1000 * 8 / stopTime / 1e6
+            << " Mbps throughput of the fluid flows" << std::endl;
+  std::cout << "\t " << rxBytes * 8 / stopTime / 1e6 << " Mbps goodput of the packet flows" << std::endl;
+
+  Simulator::Destroy ();
+
+  return 0;
+}
@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** Network topology
+ *
+ *    s0 ----|                                   |---- d0
+ *    s1 ----|         bottleneck (AQM)          |---- d1
+ *    ...    r0 ------------------------------- r1     ...
+ *    sN-1 --|    10Mbps, 20ms, QueueLimit=200p  |---- dN-1
+ *
+ * The senders and the receivers are attached with 100Mbps, 2ms links.
+ *
+ * This example compares RED or PIE with and without an ActiveFlowEstimator
+ * for a given number of long-lived TCP flows.  When the estimator is
+ * attached (--nAware=1), the drop probability of the queue disc is scaled
+ * by the estimated number of active flows, as in Stabilized RED.  Run it
+ * for several values of --nFlows to see how the average queue size and the
+ * number of early drops change, e.g.:
+ *
+ *   ./waf --run "n-aware-aqm-example --aqm=Red --nFlows=5 --nAware=1"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("NAwareAqmExample");
+
+uint32_t checkTimes;
+double avgQueueDiscSize;
+
+void
+CheckQueueDiscSize (Ptr<QueueDisc> queue)
+{
+  avgQueueDiscSize += queue->GetCurrentSize ().GetValue ();
+  checkTimes++;
+
+  // check queue disc size every 1/100 of a second
+  Simulator::Schedule (Seconds (0.01), &CheckQueueDiscSize, queue);
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string aqm = "Red";
+  uint32_t nFlows = 10;
+  bool nAware = true;
+  uint32_t referenceFlows = 256;
+  double stopTime = 30.0;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("aqm", "The AQM to use at the bottleneck: Red or Pie", aqm);
+  cmd.AddValue ("nFlows", "Number of TCP flows", nFlows);
+  cmd.AddValue ("nAware", "<0/1> to scale the drop probability by the estimated number of flows", nAware);
+  cmd.AddValue ("referenceFlows", "Number of flows above which the drop probability is not scaled", referenceFlows);
+  cmd.AddValue ("stopTime", "Simulation duration in seconds", stopTime);
+  cmd.Parse (argc, argv);
+
+  if (aqm != "Red" && aqm != "Pie")
+    {
+      NS_FATAL_ERROR ("Unknown AQM " << aqm);
+    }
+
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpNewReno"));
+  // 42 = headers size
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1000 - 42));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (1));
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (false));
+
+  Config::SetDefault ("ns3::RedQueueDisc::MaxSize", StringValue ("200p"));
+  Config::SetDefault ("ns3::RedQueueDisc::MeanPktSize", UintegerValue (1000));
+  Config::SetDefault ("ns3::RedQueueDisc::MinTh", DoubleValue (20));
+  Config::SetDefault ("ns3::RedQueueDisc::MaxTh", DoubleValue (60));
+  Config::SetDefault ("ns3::RedQueueDisc::LinkBandwidth", StringValue ("10Mbps"));
+  Config::SetDefault ("ns3::RedQueueDisc::LinkDelay", StringValue ("20ms"));
+  Config::SetDefault ("ns3::PieQueueDisc::MaxSize", StringValue ("200p"));
+  Config::SetDefault ("ns3::PieQueueDisc::MeanPktSize", UintegerValue (1000));
+
+  NodeContainer routers;
+  routers.Create (2);
+  NodeContainer senders;
+  senders.Create (nFlows);
+  NodeContainer receivers;
+  receivers.Create (nFlows);
+
+  InternetStackHelper internet;
+  internet.InstallAll ();
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("20ms"));
+  bottleneck.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("1p"));
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.0");
+  NetDeviceContainer bottleneckDevices = bottleneck.Install (routers);
+
+  Ptr<ActiveFlowEstimator> estimator;
+  if (nAware)
+    {
+      estimator = CreateObjectWithAttributes<ActiveFlowEstimator> ("ReferenceFlows",
+                                                                   DoubleValue (referenceFlows));
+    }
+  TrafficControlHelper tch;
+  if (estimator)
+    {
+      tch.SetRootQueueDisc ("ns3::" + aqm + "QueueDisc", "ActiveFlowEstimator", PointerValue (estimator));
+    }
+  else
+    {
+      tch.SetRootQueueDisc ("ns3::" + aqm + "QueueDisc");
+    }
+  QueueDiscContainer queueDiscs = tch.Install (bottleneckDevices.Get (0));
+  ipv4.Assign (bottleneckDevices);
+
+  Ipv4InterfaceContainer receiverInterfaces;
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      ipv4.NewNetwork ();
+      ipv4.Assign (access.Install (senders.Get (i), routers.Get (0)));
+      ipv4.NewNetwork ();
+      receiverInterfaces.Add (ipv4.Assign (access.Install (receivers.Get (i), routers.Get (1))).Get (0));
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint16_t port = 50000;
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sinkHelper.Install (receivers);
+  sinkApps.Start (Seconds (0));
+
+  Ptr<UniformRandomVariable> startTime = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      BulkSendHelper source ("ns3::TcpSocketFactory",
+                             InetSocketAddress (receiverInterfaces.GetAddress (i), port));
+      ApplicationContainer sourceApp = source.Install (senders.Get (i));
+      sourceApp.Start (Seconds (startTime->GetValue (0, 1)));
+      sourceApp.Stop (Seconds (stopTime));
+    }
+
+  // skip the slow start of the flows
+  Simulator::Schedule (Seconds (5), &CheckQueueDiscSize, queueDiscs.Get (0));
+
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+
+  uint64_t rxBytes = 0;
+  for (uint32_t i = 0; i < sinkApps.GetN (); i++)
+    {
+      rxBytes += DynamicCast<PacketSink> (sinkApps.Get (i))->GetTotalRx ();
+    }
+
+  QueueDisc::Stats st = queueDiscs.Get (0)->GetStats ();
+  std::cout << "*** " << aqm << (nAware ? " with" : " without")
+            << " active flow estimation, " << nFlows << " flows ***" << std::endl;
+  std::cout << "\t " << avgQueueDiscSize / checkTimes << " packets in queue on average" << std::endl;
+  std::cout << "\t " << st.GetNDroppedPackets (QueueDisc::INTERNAL_QUEUE_DROP)
+            + st.GetNDroppedPackets (RedQueueDisc::FORCED_DROP)
+            << " drops due to queue limits" << std::endl;
+  std::cout << "\t " << st.GetNDroppedPackets (RedQueueDisc::UNFORCED_DROP)
+            << " drops due to prob mark" << std::endl;
+  std::cout << "\t " << rxBytes * 8 / stopTime / 1e6 << " Mbps aggregate goodput" << std::endl;
+  if (estimator)
+    {
+      std::cout << "\t " << estimator->GetActiveFlows () << " estimated active flows" << std::endl;
+    }
+
+  Simulator::Destroy ();
+
+  return 0;
+}
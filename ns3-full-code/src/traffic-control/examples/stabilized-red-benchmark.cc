@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the cost of the Enqueue and Dequeue operations of
+// StabilizedRedQueueDisc and ESRedQueueDisc, outside of any network stack.
+// Synthetic items of a number of flows (chosen uniformly at random) are
+// enqueued one at a time, and an item is dequeued whenever the queue holds
+// more than a given backlog, so that the queue stays in the region where
+// packets are zapped.  The program reports the average time per packet (one
+// Enqueue, and one Dequeue if the packet is accepted).
+//
+// The items are taken from a pool holding one more item than the queue disc
+// can hold, so that the cost of creating packets is not measured.
+//
+// Sample usage:
+//   ./ns3 run 'stabilized-red-benchmark --queueDiscType=ESRed --n=10000000'
+//
+// Use an optimized build to obtain meaningful figures.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/traffic-control-module.h"
+#include "ns3/system-wall-clock-ms.h"
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control
+ *
+ * A queue disc item whose hash is the identifier of its flow
+ */
+class BenchQueueDiscItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   * \param p the packet
+   */
+  BenchQueueDiscItem (Ptr<Packet> p)
+    : QueueDiscItem (p, Address (), 0),
+      m_flow (0)
+  {
+  }
+  virtual void AddHeader (void)
+  {
+  }
+  virtual bool Mark (void)
+  {
+    return false;
+  }
+  virtual uint32_t Hash (uint32_t perturbation) const
+  {
+    return m_flow;
+  }
+  /**
+   * \param flow the identifier of the flow
+   */
+  void SetFlow (uint32_t flow)
+  {
+    m_flow = flow;
+  }
+
+private:
+  uint32_t m_flow; ///< the identifier of the flow
+};
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t n = 10000000;
+  std::string queueDiscType = "StabilizedRed";
+  uint32_t mode = 1;
+  bool bytes = false;
+  uint32_t capacity = 1000;
+  double backlog = 0.4;
+  uint32_t nFlows = 1000;
+  uint32_t pktSize = 1000;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("n", "The number of packets", n);
+  cmd.AddValue ("queueDiscType", "The queue disc: StabilizedRed or ESRed", queueDiscType);
+  cmd.AddValue ("mode", "The StabilizedRedMode: 1 (simple) or 2 (full)", mode);
+  cmd.AddValue ("bytes", "Whether the queue size is expressed in bytes", bytes);
+  cmd.AddValue ("capacity", "The capacity of the queue, in packets", capacity);
+  cmd.AddValue ("backlog", "The fraction of the capacity kept in the queue", backlog);
+  cmd.AddValue ("flows", "The number of flows", nFlows);
+  cmd.AddValue ("pktSize", "The size of the packets", pktSize);
+  cmd.Parse (argc, argv);
+
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::" + queueDiscType + "QueueDisc");
+  factory.Set ("StabilizedRedMode", IntegerValue (mode));
+  if (bytes)
+    {
+      factory.Set ("MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::BYTES, capacity * pktSize)));
+    }
+  else
+    {
+      factory.Set ("MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, capacity)));
+    }
+  Ptr<QueueDisc> queue = factory.Create<QueueDisc> ();
+  queue->Initialize ();
+
+  std::vector<Ptr<BenchQueueDiscItem>> pool;
+  for (uint32_t i = 0; i <= capacity; i++)
+    {
+      pool.push_back (Create<BenchQueueDiscItem> (Create<Packet> (pktSize)));
+    }
+
+  // the flow of each packet is drawn beforehand
+  Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable> ();
+  uv->SetStream (2);
+  std::vector<uint32_t> flows (1 << 20);
+  for (auto &flow : flows)
+    {
+      flow = uv->GetInteger (0, nFlows - 1);
+    }
+
+  // the Time objects created before the simulation starts are recorded in
+  // case the time resolution changes: start the (empty) simulation so that
+  // the timestamps of the items do not pay for this bookkeeping
+  Simulator::Run ();
+
+  uint32_t target = backlog * capacity;
+  uint32_t next = 0;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // a pool item is reused once it has been dequeued: the queue holds
+      // at most capacity items, the most recently accepted ones
+      Ptr<BenchQueueDiscItem> item = pool[next];
+      item->SetFlow (flows[i & (flows.size () - 1)]);
+      if (queue->Enqueue (item))
+        {
+          next = (next + 1) % pool.size ();
+        }
+      if (queue->GetNPackets () > target)
+        {
+          queue->Dequeue ();
+        }
+    }
+  int64_t elapsed = clock.End ();
+
+  QueueDisc::Stats stats = queue->GetStats ();
+  std::cout << queueDiscType << " (mode " << mode << ", " << (bytes ? "bytes" : "packets")
+            << "): " << n << " packets in " << elapsed << " ms, "
+            << elapsed * 1e6 / n << " ns/packet" << std::endl;
+  std::cout << "Dropped: " << stats.nTotalDroppedPackets
+            << " (zapped: " << stats.GetNDroppedPackets ("Zap") << ")" << std::endl;
+
+  queue->Dispose ();
+  Simulator::Destroy ();
+  return 0;
+}
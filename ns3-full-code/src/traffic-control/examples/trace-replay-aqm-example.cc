@@ -0,0 +1,370 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** Network topology
+ *
+ *    s0 ----|                                   |---- d0
+ *    s1 ----|         bottleneck (AQM)          |---- d1
+ *    ...    r0 ------------------------------- r1     ...
+ *    sN-1 --|   10Mbps, 20ms, QueueLimit=200p   |---- dN-1
+ *
+ * The leaf nodes are attached with 100Mbps, 2ms links.
+ *
+ * This example drives an AQM (RED, Stabilized RED or ESRED) at the
+ * bottleneck of a dumbbell with the flows of a trace, replayed by a
+ * TraceReplayApplication from the left leaf nodes to the right leaf nodes.
+ * The trace is one of:
+ *
+ * \li a flow trace file (see FlowTraceFile), given with --trace;
+ * \li a pcap file, given with --pcap, whose IPv4 TCP and UDP packets are
+ *     grouped in flows by addresses, ports and protocol; a flow starts with
+ *     its first packet, its size is the payload of its packets and its gap
+ *     is the mean gap between its packets;
+ * \li otherwise, a synthetic trace of flows arriving as a Poisson process,
+ *     with Pareto-distributed sizes, loading the bottleneck at --load.
+ *
+ * The trace is written to (or, with --pcap, converted to) flows.bin unless
+ * --trace is given.  The application reads the trace as it is replayed and
+ * keeps state only for the active flows, so that the memory needed does
+ * not depend on the number of flows of the trace, e.g.:
+ *
+ *   ./waf --run "trace-replay-aqm-example --aqm=ESRed --flows=1000000 --stopTime=3000"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include <fstream>
+#include <map>
+#include <tuple>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TraceReplayAqmExample");
+
+uint64_t completedFlows;
+double totalFct;
+
+void
+FlowCompleted (uint32_t index, uint64_t size, Time fct)
+{
+  completedFlows++;
+  totalFct += fct.GetSeconds ();
+}
+
+/**
+ * Write a synthetic trace
+ * \param filename the name of the trace file
+ * \param flows the number of flows
+ * \param rate the rate of the bottleneck
+ * \param load the load of the bottleneck
+ * \param meanSize the mean size of the flows
+ * \param udpShare the share of UDP flows
+ */
+void
+WriteSyntheticTrace (std::string filename, uint32_t flows, DataRate rate, double load,
+                     uint32_t meanSize, double udpShare)
+{
+  Ptr<ExponentialRandomVariable> arrivals = CreateObject<ExponentialRandomVariable> ();
+  arrivals->SetAttribute ("Mean", DoubleValue (meanSize * 8.0 / (rate.GetBitRate () * load)));
+  Ptr<ParetoRandomVariable> sizes = CreateObject<ParetoRandomVariable> ();
+  sizes->SetAttribute ("Shape", DoubleValue (1.5));
+  sizes->SetAttribute ("Scale", DoubleValue (meanSize / 3.0));
+  Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable> ();
+
+  std::ofstream os (filename, std::ios::binary);
+  FlowTraceFile::WriteHeader (os);
+  Time start;
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      FlowTraceFile::Record record;
+      start += Seconds (arrivals->GetValue ());
+      record.start = start;
+      record.size = sizes->GetValue ();
+      record.source = uv->GetInteger (0, 65535);
+      record.destination = uv->GetInteger (0, 65535);
+      if (uv->GetValue () < udpShare)
+        {
+          // UDP flows at a tenth of the rate of the bottleneck
+          record.protocol = 17;
+          record.gap = rate.CalculateBytesTxTime (1000) * 10;
+        }
+      else
+        {
+          record.protocol = 6;
+          record.gap = Seconds (0);
+        }
+      FlowTraceFile::WriteRecord (os, record);
+    }
+}
+
+/**
+ * Convert the IPv4 TCP and UDP packets of a pcap file to a trace
+ * \param pcap the name of the pcap file
+ * \param filename the name of the trace file
+ */
+void
+ConvertPcap (std::string pcap, std::string filename)
+{
+  PcapFile in;
+  in.Open (pcap, std::ios::in);
+  NS_ABORT_MSG_IF (in.Fail (), "Cannot open " << pcap);
+  uint32_t linkHeader;
+  switch (in.GetDataLinkType ())
+    {
+    case PcapHelper::DLT_RAW:
+      linkHeader = 0;
+      break;
+    case PcapHelper::DLT_PPP:
+      linkHeader = 2;
+      break;
+    case PcapHelper::DLT_EN10MB:
+      linkHeader = 14;
+      break;
+    default:
+      NS_FATAL_ERROR ("Unsupported data link type " << in.GetDataLinkType () << " of " << pcap);
+    }
+
+  typedef std::tuple<Ipv4Address, Ipv4Address, uint16_t, uint16_t, uint8_t> FlowId;
+  struct PcapFlow
+  {
+    FlowTraceFile::Record record;
+    Time last;
+    uint32_t packets;
+  };
+  std::map<FlowId, uint32_t> ids;
+  std::vector<PcapFlow> flows;
+  std::map<Ipv4Address, uint16_t> hosts;
+
+  std::vector<uint8_t> data (PcapFile::SNAPLEN_DEFAULT);
+  Time first;
+  while (true)
+    {
+      uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+      in.Read (data.data (), data.size (), tsSec, tsUsec, inclLen, origLen, readLen);
+      if (in.Eof () || in.Fail ())
+        {
+          break;
+        }
+      if (readLen <= linkHeader)
+        {
+          continue;
+        }
+      Time now = Seconds (tsSec) + MicroSeconds (tsUsec);
+      if (flows.empty ())
+        {
+          first = now;
+        }
+      Ptr<Packet> p = Create<Packet> (data.data () + linkHeader, readLen - linkHeader);
+      Ipv4Header ip;
+      if (p->GetSize () < ip.GetSerializedSize () || p->RemoveHeader (ip) == 0
+          || (ip.GetProtocol () != 6 && ip.GetProtocol () != 17)
+          || !ip.IsLastFragment () || ip.GetFragmentOffset () != 0
+          || p->GetSize () < (ip.GetProtocol () == 6 ? 20 : 8))
+        {
+          // only the unfragmented TCP and UDP packets whose header was captured
+          continue;
+        }
+      uint16_t sport, dport;
+      uint32_t payload = ip.GetPayloadSize ();
+      if (ip.GetProtocol () == 6)
+        {
+          TcpHeader tcp;
+          p->RemoveHeader (tcp);
+          sport = tcp.GetSourcePort ();
+          dport = tcp.GetDestinationPort ();
+          payload -= std::min (payload, tcp.GetSerializedSize ());
+        }
+      else
+        {
+          UdpHeader udp;
+          p->RemoveHeader (udp);
+          sport = udp.GetSourcePort ();
+          dport = udp.GetDestinationPort ();
+          payload -= std::min (payload, udp.GetSerializedSize ());
+        }
+      if (payload == 0)
+        {
+          continue;
+        }
+
+      FlowId id (ip.GetSource (), ip.GetDestination (), sport, dport, ip.GetProtocol ());
+      auto it = ids.find (id);
+      if (it == ids.end ())
+        {
+          // the hosts are numbered in order of appearance
+          uint16_t source = hosts.emplace (ip.GetSource (), hosts.size ()).first->second;
+          uint16_t destination = hosts.emplace (ip.GetDestination (), hosts.size ()).first->second;
+          it = ids.emplace (id, flows.size ()).first;
+          PcapFlow flow;
+          flow.record.start = now - first;
+          flow.record.size = 0;
+          flow.record.source = source;
+          flow.record.destination = destination;
+          flow.record.protocol = ip.GetProtocol ();
+          flow.packets = 0;
+          flows.push_back (flow);
+        }
+      PcapFlow &flow = flows[it->second];
+      flow.record.size += payload;
+      flow.last = now - first;
+      flow.packets++;
+    }
+
+  // the flows are in order of their first packet
+  std::ofstream os (filename, std::ios::binary);
+  FlowTraceFile::WriteHeader (os);
+  for (auto &flow : flows)
+    {
+      flow.record.gap = flow.packets > 1 ? (flow.last - flow.record.start) / (flow.packets - 1) : Seconds (0);
+      FlowTraceFile::WriteRecord (os, flow.record);
+    }
+  std::cout << pcap << ": " << flows.size () << " flows between " << hosts.size () << " hosts" << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string aqm = "StabilizedRed";
+  std::string trace = "";
+  std::string pcap = "";
+  uint32_t nLeaf = 10;
+  uint32_t flows = 2000;
+  double load = 0.9;
+  uint32_t meanSize = 50000;
+  double udpShare = 0.1;
+  uint32_t maxActiveFlows = 0;
+  double stopTime = 100.0;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("aqm", "The AQM to use at the bottleneck: Red, StabilizedRed or ESRed", aqm);
+  cmd.AddValue ("trace", "The flow trace file to replay", trace);
+  cmd.AddValue ("pcap", "The pcap file to convert to a flow trace and replay", pcap);
+  cmd.AddValue ("nLeaf", "The number of leaf nodes on each side", nLeaf);
+  cmd.AddValue ("flows", "The number of flows of the synthetic trace", flows);
+  cmd.AddValue ("load", "The load of the bottleneck with the synthetic trace", load);
+  cmd.AddValue ("meanSize", "The mean size of the flows of the synthetic trace", meanSize);
+  cmd.AddValue ("udpShare", "The share of UDP flows of the synthetic trace", udpShare);
+  cmd.AddValue ("maxActiveFlows", "The maximum number of active flows (0 for no limit)", maxActiveFlows);
+  cmd.AddValue ("stopTime", "Simulation duration in seconds", stopTime);
+  cmd.Parse (argc, argv);
+
+  if (aqm != "Red" && aqm != "StabilizedRed" && aqm != "ESRed")
+    {
+      NS_FATAL_ERROR ("Unknown AQM " << aqm);
+    }
+
+  std::string rate = "10Mbps";
+  if (trace.empty ())
+    {
+      trace = "flows.bin";
+      if (pcap.empty ())
+        {
+          WriteSyntheticTrace (trace, flows, DataRate (rate), load, meanSize, udpShare);
+        }
+      else
+        {
+          ConvertPcap (pcap, trace);
+        }
+    }
+
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpNewReno"));
+  // 42 = headers size
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1000 - 42));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (1));
+  // many short connections: copy the sockets from a template
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketTemplates", BooleanValue (true));
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (false));
+
+  Config::SetDefault ("ns3::RedQueueDisc::MaxSize", StringValue ("200p"));
+  Config::SetDefault ("ns3::RedQueueDisc::MeanPktSize", UintegerValue (1000));
+  Config::SetDefault ("ns3::RedQueueDisc::MinTh", DoubleValue (20));
+  Config::SetDefault ("ns3::RedQueueDisc::MaxTh", DoubleValue (60));
+  Config::SetDefault ("ns3::RedQueueDisc::LinkBandwidth", StringValue (rate));
+  Config::SetDefault ("ns3::RedQueueDisc::LinkDelay", StringValue ("20ms"));
+  Config::SetDefault ("ns3::StabilizedRedQueueDisc::MaxSize", StringValue ("200p"));
+  Config::SetDefault ("ns3::ESRedQueueDisc::MaxSize", StringValue ("200p"));
+
+  NodeContainer routers;
+  routers.Create (2);
+  NodeContainer senders;
+  senders.Create (nLeaf);
+  NodeContainer receivers;
+  receivers.Create (nLeaf);
+
+  InternetStackHelper internet;
+  internet.InstallAll ();
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue (rate));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("20ms"));
+  bottleneck.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("1p"));
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.0");
+  NetDeviceContainer bottleneckDevices = bottleneck.Install (routers);
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::" + aqm + "QueueDisc");
+  QueueDiscContainer queueDiscs = tch.Install (bottleneckDevices.Get (0));
+  ipv4.Assign (bottleneckDevices);
+
+  std::vector<Address> receiverAddresses;
+  for (uint32_t i = 0; i < nLeaf; i++)
+    {
+      ipv4.NewNetwork ();
+      ipv4.Assign (access.Install (senders.Get (i), routers.Get (0)));
+      ipv4.NewNetwork ();
+      receiverAddresses.push_back (ipv4.Assign (access.Install (receivers.Get (i), routers.Get (1))).GetAddress (0));
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  TraceReplayHelper replay (trace);
+  replay.SetAttribute ("MaxActiveFlows", UintegerValue (maxActiveFlows));
+  ApplicationContainer apps = replay.Install (routers.Get (0), senders, receivers, receiverAddresses);
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (stopTime));
+  Ptr<TraceReplayApplication> app = DynamicCast<TraceReplayApplication> (apps.Get (0));
+  app->TraceConnectWithoutContext ("FlowCompleted", MakeCallback (&FlowCompleted));
+
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+
+  QueueDisc::Stats stats = queueDiscs.Get (0)->GetStats ();
+  std::cout << "*** " << aqm << ", " << trace << " ***" << std::endl;
+  std::cout << "\t " << app->GetStartedFlows () << " flows started, "
+            << app->GetSkippedFlows () << " skipped, "
+            << app->GetActiveFlows () << " still sending" << std::endl;
+  std::cout << "\t " << completedFlows << " TCP flows completed, "
+            << (completedFlows ? totalFct / completedFlows : 0) << " s completion time on average" << std::endl;
+  std::cout << "\t " << app->GetTotalRx () * 8 / stopTime / 1e6 << " Mbps goodput" << std::endl;
+  std::cout << "\t " << stats.nTotalDroppedPackets << " packets dropped at the bottleneck, out of "
+            << stats.nTotalReceivedPackets << std::endl;
+
+  Simulator::Destroy ();
+
+  return 0;
+}
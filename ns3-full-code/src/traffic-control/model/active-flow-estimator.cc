@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/queue-item.h"
+#include "active-flow-estimator.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ActiveFlowEstimator");
+
+NS_OBJECT_ENSURE_REGISTERED (ActiveFlowEstimator);
+
+TypeId
+ActiveFlowEstimator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ActiveFlowEstimator")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<ActiveFlowEstimator> ()
+    .AddAttribute ("ZombieListSize",
+                   "The number of recently seen flows kept in the zombie list",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&ActiveFlowEstimator::m_zombieListSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("OverwriteProbability",
+                   "The probability of overwriting the chosen zombie when a packet misses it",
+                   DoubleValue (0.25),
+                   MakeDoubleAccessor (&ActiveFlowEstimator::m_overwriteProbability),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("ReferenceFlows",
+                   "The number of active flows above which the drop probability is not scaled",
+                   DoubleValue (256),
+                   MakeDoubleAccessor (&ActiveFlowEstimator::m_referenceFlows),
+                   MakeDoubleChecker<double> (1))
+    .AddAttribute ("Perturbation",
+                   "The salt used as an additional input to the hash function used to identify flows",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ActiveFlowEstimator::m_perturbation),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("HitFrequency",
+                     "The hit frequency, whose inverse estimates the number of active flows",
+                     MakeTraceSourceAccessor (&ActiveFlowEstimator::m_hitFrequency),
+                     "ns3::TracedValueCallback::Double")
+  ;
+  return tid;
+}
+
+ActiveFlowEstimator::ActiveFlowEstimator ()
+  : m_hitFrequency (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = CreateObject<UniformRandomVariable> ();
+}
+
+ActiveFlowEstimator::~ActiveFlowEstimator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ActiveFlowEstimator::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = 0;
+  m_zombies.clear ();
+  Object::DoDispose ();
+}
+
+int64_t
+ActiveFlowEstimator::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uv->SetStream (stream);
+  return 1;
+}
+
+void
+ActiveFlowEstimator::Reset (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_zombies.clear ();
+  m_hitFrequency = 0;
+}
+
+bool
+ActiveFlowEstimator::Update (Ptr<const QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+  return Update (item->Hash (m_perturbation));
+}
+
+bool
+ActiveFlowEstimator::Update (uint32_t flowId)
+{
+  NS_LOG_FUNCTION (this << flowId);
+
+  // the zombie list is first filled with the flows of the arriving packets
+  if (m_zombies.size () < m_zombieListSize)
+    {
+      m_zombies.push_back ({flowId, 0});
+      return false;
+    }
+
+  uint32_t index = m_uv->GetInteger (0, m_zombies.size () - 1);
+  bool hit = (m_zombies[index].flowId == flowId);
+
+  if (hit)
+    {
+      m_zombies[index].count++;
+    }
+  else if (m_uv->GetValue () < m_overwriteProbability)
+    {
+      m_zombies[index].flowId = flowId;
+      m_zombies[index].count = 0;
+    }
+
+  double alpha = m_overwriteProbability / m_zombieListSize;
+  m_hitFrequency = (1 - alpha) * m_hitFrequency + alpha * (hit ? 1 : 0);
+
+  NS_LOG_LOGIC ("Hit " << hit << " frequency " << m_hitFrequency);
+  return hit;
+}
+
+double
+ActiveFlowEstimator::GetHitFrequency (void) const
+{
+  return m_hitFrequency;
+}
+
+double
+ActiveFlowEstimator::GetActiveFlows (void) const
+{
+  double maxFlows = m_zombieListSize;
+  if (m_hitFrequency * maxFlows <= 1)
+    {
+      return maxFlows;
+    }
+  return 1 / m_hitFrequency;
+}
+
+double
+ActiveFlowEstimator::GetDropProbabilityScale (void) const
+{
+  double ratio = GetActiveFlows () / m_referenceFlows;
+  return std::min (1.0, ratio * ratio);
+}
+
+} // namespace ns3
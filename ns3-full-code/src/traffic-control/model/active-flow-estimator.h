@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ACTIVE_FLOW_ESTIMATOR_H
+#define ACTIVE_FLOW_ESTIMATOR_H
+
+#include "ns3/object.h"
+#include "ns3/traced-value.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
+
+namespace ns3 {
+
+class QueueDiscItem;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Estimator of the number of active flows based on a zombie list
+ *
+ * This is the flow count estimator of Stabilized RED (T. J. Ott,
+ * T. V. Lakshman and L. H. Wong, "SRED: Stabilized RED", INFOCOM 1999),
+ * made available to any queue disc.  The estimator keeps a list of
+ * recently seen flows (the zombies).  Every arriving packet is compared
+ * with a randomly chosen zombie: a match is a hit, otherwise the zombie
+ * is replaced by the flow of the packet with the overwrite probability.
+ * The hit frequency P is an exponential average of the hits, with weight
+ * OverwriteProbability / ZombieListSize, and 1/P estimates the number of
+ * active flows.
+ *
+ * Queue discs use GetDropProbabilityScale to scale their drop probability
+ * by min (1, (N / ReferenceFlows)^2), the factor SRED applies to its
+ * own drop probability: since the throughput of a TCP flow is
+ * proportional to the inverse of the square root of its drop probability,
+ * this keeps the queue occupancy stable as the number of flows changes.
+ */
+class ActiveFlowEstimator : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief ActiveFlowEstimator constructor
+   */
+  ActiveFlowEstimator ();
+
+  virtual ~ActiveFlowEstimator ();
+
+  /**
+   * \brief Update the estimate with a packet arrival.
+   * \param item the arriving packet, whose flow is identified by its hash
+   * \return true if the packet hit a zombie of the same flow
+   */
+  bool Update (Ptr<const QueueDiscItem> item);
+  /**
+   * \brief Update the estimate with a packet arrival.
+   * \param flowId the identifier of the flow of the arriving packet
+   * \return true if the packet hit a zombie of the same flow
+   */
+  bool Update (uint32_t flowId);
+
+  /**
+   * \return the hit frequency P
+   */
+  double GetHitFrequency (void) const;
+  /**
+   * \brief Get the estimated number of active flows.
+   *
+   * The estimate 1/P is bounded by the size of the zombie list, which is
+   * also the value returned before any hit has been observed.
+   *
+   * \return the estimated number of active flows
+   */
+  double GetActiveFlows (void) const;
+  /**
+   * \return the factor min (1, (N / ReferenceFlows)^2) by which queue
+   *         discs scale their drop probability, N being the estimated
+   *         number of active flows
+   */
+  double GetDropProbabilityScale (void) const;
+
+  /**
+   * \brief Empty the zombie list and reset the hit frequency.
+   */
+  void Reset (void);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief An entry of the zombie list
+   */
+  struct Zombie
+  {
+    uint32_t flowId; //!< the flow identifier
+    uint32_t count;  //!< the number of hits since the zombie was last overwritten
+  };
+
+  std::vector<Zombie> m_zombies;        //!< The zombie list
+  uint32_t m_zombieListSize;            //!< Maximum number of zombies
+  double m_overwriteProbability;        //!< Probability of overwriting a zombie on a miss
+  double m_referenceFlows;              //!< Number of flows above which the drop probability is not scaled
+  uint32_t m_perturbation;              //!< Hash perturbation value
+  TracedValue<double> m_hitFrequency;   //!< The hit frequency P
+  Ptr<UniformRandomVariable> m_uv;      //!< Rng stream
+};
+
+} // namespace ns3
+
+#endif /* ACTIVE_FLOW_ESTIMATOR_H */
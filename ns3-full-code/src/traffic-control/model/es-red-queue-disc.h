@@ -31,34 +31,38 @@
 #include "ns3/data-rate.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/packet.h"
+#include "sred-shard-group.h"
 
-using namespace std;
-using namespace ns3;
+#define MAX_ZOMBIE_LIST_SIZE 1000
+
+namespace ns3 {
 
+/**
+ * \ingroup traffic-control
+ *
+ * \brief An entry of the ESRED zombie list
+ */
 struct EZombie
 {
-  int32_t flowID;         
-  int32_t count;
-  Time time;
+  uint32_t flowID;  //!< the hash of the flow
+  int32_t count;    //!< the number of hits
+  uint32_t time;    //!< the time of the last hit or write, in ticks of TickResolution
 
   EZombie()
   {
     flowID = 0;
     count = 0;
-    time = Seconds(0);
+    time = 0;
   }
 
-  EZombie(int32_t flowID, int32_t count)
+  EZombie(uint32_t flowID, int32_t count)
   {
     this->flowID = flowID;
     this->count = count;
+    time = 0;
   }
 };
 
-#define MAX_ZOMBIE_LIST_SIZE 1000
-
-namespace ns3 {
-
 class TraceContainer;
 
 /**
@@ -109,6 +113,22 @@ public:
   */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \brief Get the hit frequency of the zombie list
+   * \return the hit frequency
+   */
+  double GetHitFrequency (void) const;
+
+  /**
+   * \brief Set the hit frequency of the zombie list
+   *
+   * This is used by the SredShardGroup the queue disc belongs to, if any,
+   * to merge the hit frequencies of its shards.
+   *
+   * \param hitFrequency the hit frequency
+   */
+  void SetHitFrequency (double hitFrequency);
+
 protected:
   /**
    * \brief Dispose of the object
@@ -144,8 +164,47 @@ private:
   double calculateProbabilityStabilizedRed();
   double calculateProbabilityZapSimple(double probabilityStabilizedRed);
   double calculateProbabilityZap(double probabilityStabilizedRed,int32_t hit);
+
+  /**
+   * \brief Get the current time in ticks of TickResolution
+   *
+   * The tick counter wraps around after 2^32 ticks (about 119 hours with
+   * the default resolution of 100us), which only matters for zombies that
+   * are not hit nor overwritten for that long.
+   *
+   * \return the current time in ticks
+   */
+  uint32_t GetTicks (void) const;
+
+  /**
+   * \brief Compute the probability of overwriting a zombie
+   *
+   * In the TIMESTAMP mode (the original ESRED, and the default), the
+   * overwrite probability of a zombie is p_overwrite / (1 + t), where t is
+   * the time (in seconds) at which the zombie was last hit or written.  In
+   * the AGE mode, it is p_overwrite * (1 - 2^(-age / HalfLife)), where age
+   * is the time elapsed since the zombie was last hit or written: a zombie
+   * that was just refreshed is protected, and the protection halves every
+   * HalfLife.
+   *
+   * \param zombie the zombie
+   * \return the overwrite probability
+   */
+  double CalculateProbabilityOverwrite (const EZombie &zombie) const;
+
+public:
+  /**
+   * \brief Decay of the overwrite probability of the zombies
+   */
+  enum OverwriteDecay
+  {
+    TIMESTAMP,  //!< Divide by (1 + the absolute time the zombie was written)
+    AGE         //!< Decay with the time elapsed since the zombie was written
+  };
+
+private:
   
-  vector<EZombie> zombies;
+  std::vector<EZombie> zombies;
   double p_hitFreq;
   double p_overwrite; // 0.25 in paper
   double p_max; // 0.15 in paper
@@ -153,6 +212,16 @@ private:
 
   int32_t stabilizedRedMode; // 1 for simple, 2 for full
 
+
+  OverwriteDecay m_overwriteDecay;   //!< How the overwrite probability of a zombie decays
+  Time m_halfLife;                   //!< Half-life of the protection of a zombie in AGE mode
+  Time m_tickResolution;             //!< Resolution of the zombie timestamps
+  double m_halfLifeTicks;            //!< Half-life in ticks
+  uint32_t m_zombieListSize;         //!< Capacity of the zombie list
+  Ptr<SredShardGroup> m_shardGroup;  //!< The group of shards this zombie list belongs to, if any
+  uint32_t m_shard;                  //!< The identifier of this zombie list in the shard group
+  bool m_inShardGroup;               //!< Whether this zombie list has been added to the shard group
+
   Ptr<UniformRandomVariable> m_uv;
 };
 
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "flow-id-table.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowIdTable");
+
+FlowIdTable::FlowIdTable ()
+  : m_nSetBuckets (0),
+    m_ways (1),
+    m_collisions (0)
+{
+}
+
+void
+FlowIdTable::Configure (uint32_t buckets, uint32_t ways, uint32_t overflow)
+{
+  NS_LOG_FUNCTION (this << buckets << ways << overflow);
+  NS_ABORT_MSG_IF (buckets == 0 || ways == 0 || buckets % ways != 0,
+                   "The number of buckets must be a non-null multiple of the number of ways");
+
+  Bucket free = {0, false, false};
+  m_buckets.assign (buckets + overflow, free);
+  m_nOverflowed.assign (buckets / ways, 0);
+  // the free buckets of the overflow area, the lowest on top
+  m_freeOverflow.clear ();
+  m_freeOverflow.reserve (overflow);
+  for (uint32_t i = buckets + overflow; i > buckets; i--)
+    {
+      m_freeOverflow.push_back (i - 1);
+    }
+  m_nSetBuckets = buckets;
+  m_ways = ways;
+  m_collisions = 0;
+}
+
+uint32_t
+FlowIdTable::GetSet (uint32_t flowHash) const
+{
+  return (flowHash % m_nSetBuckets) / m_ways;
+}
+
+uint32_t
+FlowIdTable::Lookup (uint32_t flowHash)
+{
+  NS_LOG_FUNCTION (this << flowHash);
+  NS_ASSERT_MSG (!m_buckets.empty (), "The table has not been configured");
+
+  uint32_t set = GetSet (flowHash);
+  uint32_t first = set * m_ways;
+  uint32_t last = first + m_ways;
+  uint32_t none = m_buckets.size ();
+  uint32_t chosen = none;
+
+  for (uint32_t i = first; i < last; i++)
+    {
+      if (m_buckets[i].used && m_buckets[i].tag == flowHash)
+        {
+          return i;
+        }
+      if (!m_buckets[i].used && chosen == none)
+        {
+          // the first free bucket of the set
+          chosen = i;
+        }
+    }
+
+  if (m_nOverflowed[set] > 0)
+    {
+      for (uint32_t i = m_nSetBuckets; i < m_buckets.size (); i++)
+        {
+          if (m_buckets[i].used && m_buckets[i].tag == flowHash)
+            {
+              return i;
+            }
+        }
+    }
+
+  if (m_buckets[first].shared)
+    {
+      // the flow may be one of the flows sharing the first bucket, which
+      // keep it as long as it is held
+      return first;
+    }
+
+  if (chosen == none && !m_freeOverflow.empty ())
+    {
+      // all the buckets of the set are held by flows having packets queued
+      chosen = m_freeOverflow.back ();
+      m_freeOverflow.pop_back ();
+      m_nOverflowed[set]++;
+      NS_LOG_DEBUG ("Flow " << flowHash << " takes bucket " << chosen << " of the overflow area");
+    }
+
+  if (chosen == none)
+    {
+      // the overflow area is full too: share the first bucket of the set,
+      // so that the colliding flows do not take over the queues of other flows
+      NS_LOG_DEBUG ("Flow " << flowHash << " collides with flow " << m_buckets[first].tag
+                    << " in bucket " << first);
+      m_buckets[first].shared = true;
+      m_collisions++;
+      return first;
+    }
+
+  m_buckets[chosen].tag = flowHash;
+  m_buckets[chosen].used = true;
+  return chosen;
+}
+
+void
+FlowIdTable::Release (uint32_t bucket)
+{
+  NS_LOG_FUNCTION (this << bucket);
+  NS_ASSERT (bucket < m_buckets.size ());
+  if (bucket >= m_nSetBuckets && m_buckets[bucket].used)
+    {
+      m_nOverflowed[GetSet (m_buckets[bucket].tag)]--;
+      m_freeOverflow.push_back (bucket);
+    }
+  m_buckets[bucket].used = false;
+  m_buckets[bucket].shared = false;
+}
+
+uint32_t
+FlowIdTable::GetNBuckets (void) const
+{
+  return m_buckets.size ();
+}
+
+uint32_t
+FlowIdTable::GetNOverflowBuckets (void) const
+{
+  return m_buckets.size () - m_nSetBuckets;
+}
+
+uint32_t
+FlowIdTable::GetNWays (void) const
+{
+  return m_ways;
+}
+
+uint64_t
+FlowIdTable::GetNCollisions (void) const
+{
+  return m_collisions;
+}
+
+} // namespace ns3
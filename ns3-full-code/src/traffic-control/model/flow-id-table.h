@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_ID_TABLE_H
+#define FLOW_ID_TABLE_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A set associative table mapping flow hashes to flow identifiers
+ *
+ * The table has a number of buckets, grouped into sets of SetWays
+ * consecutive buckets, and optionally an overflow area of additional
+ * buckets shared by all the sets. The set of a flow is determined by its
+ * hash and the flow is assigned a bucket, whose index is the identifier of
+ * the flow. Each bucket is tagged with the full hash of the flow it holds,
+ * so that flows whose hashes fall in the same set are kept in distinct
+ * buckets as long as there is room for them:
+ *
+ * - a flow whose tag is found in its set or in the overflow area keeps its
+ *   bucket;
+ * - otherwise, the flow takes the first free bucket of its set;
+ * - otherwise, all the buckets of the set are held by flows which have
+ *   packets queued: the flow takes the first free bucket of the overflow
+ *   area, whose identifiers follow those of the sets;
+ * - otherwise, the overflow area is full too: the flow collides with the
+ *   flow of the first bucket of the set, and shares it until the bucket is
+ *   released.
+ *
+ * A bucket is never reassigned while it is held, so that the packets of a
+ * flow do not end up in several queues, which would reorder them. Since the
+ * table does not record which flows share the first bucket of a set, all
+ * the flows of the set which do not hold a bucket are assigned the shared
+ * bucket until it is released, even if another bucket becomes free in the
+ * meantime. Queue discs release the bucket of a flow when the flow has no
+ * more packets queued (Release), so that it can be reused by another flow.
+ * With a single way and no overflow area, the table is a direct mapped table
+ * (the identifier of a flow is its hash modulo the number of buckets).
+ *
+ * All the buckets are allocated by Configure, hence looking up a flow never
+ * allocates memory. The overflow area is only searched for the flows of the
+ * sets which have flows in it, so it is meant to be small compared to the
+ * number of buckets.
+ *
+ * This is the set associative hash of FqCoDel, shared by the FQ queue discs.
+ */
+class FlowIdTable
+{
+public:
+  FlowIdTable ();
+
+  /**
+   * \brief Allocate the buckets of the table and mark them as free
+   * \param buckets the number of buckets of the sets
+   * \param ways the number of buckets of a set, which must divide the number of buckets
+   * \param overflow the number of buckets of the overflow area
+   */
+  void Configure (uint32_t buckets, uint32_t ways, uint32_t overflow = 0);
+
+  /**
+   * \brief Get the identifier of the flow having the given hash, assigning it a bucket if needed
+   * \param flowHash the hash of the flow
+   * \return the index of the bucket of the flow
+   */
+  uint32_t Lookup (uint32_t flowHash);
+
+  /**
+   * \brief Mark a bucket as free, so that it can be assigned to another flow
+   * \param bucket the index of the bucket
+   */
+  void Release (uint32_t bucket);
+
+  /**
+   * \return the number of buckets, including the overflow area
+   */
+  uint32_t GetNBuckets (void) const;
+
+  /**
+   * \return the number of buckets of the overflow area
+   */
+  uint32_t GetNOverflowBuckets (void) const;
+
+  /**
+   * \return the number of buckets of a set
+   */
+  uint32_t GetNWays (void) const;
+
+  /**
+   * \return the number of times a flow found no free bucket, so that the first bucket of its set started being shared
+   */
+  uint64_t GetNCollisions (void) const;
+
+private:
+  /**
+   * \brief A bucket of the table
+   */
+  struct Bucket
+  {
+    uint32_t tag;      //!< the hash of the flow holding the bucket
+    bool used;         //!< whether a flow holds the bucket
+    bool shared;       //!< whether colliding flows share the bucket
+  };
+
+  /**
+   * \param flowHash the hash of a flow
+   * \return the index of the set of the flow
+   */
+  uint32_t GetSet (uint32_t flowHash) const;
+
+  std::vector<Bucket> m_buckets;        //!< the buckets of the sets, followed by the overflow area
+  std::vector<uint32_t> m_nOverflowed;  //!< the number of buckets of the overflow area held, by set
+  std::vector<uint32_t> m_freeOverflow; //!< the free buckets of the overflow area
+  uint32_t m_nSetBuckets;               //!< the number of buckets of the sets
+  uint32_t m_ways;                      //!< the number of buckets of a set
+  uint64_t m_collisions;                //!< the number of collisions
+};
+
+} // namespace ns3
+
+#endif /* FLOW_ID_TABLE_H */
@@ -169,6 +169,12 @@ TypeId FqCobaltQueueDisc::GetTypeId (void)
                    UintegerValue (8),
                    MakeUintegerAccessor (&FqCobaltQueueDisc::m_setWays),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("OverflowFlows",
+                   "The number of queues, in addition to Flows, assigned to the flows whose set "
+                   "of queues is full (used by set associative hash)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FqCobaltQueueDisc::m_overflowFlows),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("UseL4s",
                    "True to use L4S (only ECT1 packets are marked at CE threshold)",
                    BooleanValue (false),
@@ -210,6 +216,16 @@ FqCobaltQueueDisc::~FqCobaltQueueDisc ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+FqCobaltQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_newFlows.Clear ();
+  m_oldFlows.Clear ();
+  m_flowsByBucket.clear ();
+  QueueDisc::DoDispose ();
+}
+
 void
 FqCobaltQueueDisc::SetQuantum (uint32_t quantum)
 {
@@ -223,35 +239,6 @@ FqCobaltQueueDisc::GetQuantum (void) const
   return m_quantum;
 }
 
-uint32_t
-FqCobaltQueueDisc::SetAssociativeHash (uint32_t flowHash)
-{
-  NS_LOG_FUNCTION (this << flowHash);
-
-  uint32_t h = (flowHash % m_flows);
-  uint32_t innerHash = h % m_setWays;
-  uint32_t outerHash = h - innerHash;
-
-  for (uint32_t i = outerHash; i < outerHash + m_setWays; i++)
-    {
-      auto it = m_flowsIndices.find (i);
-
-      if (it == m_flowsIndices.end ()
-          || (m_tags.find (i) != m_tags.end () && m_tags[i] == flowHash)
-          || StaticCast<FqCobaltFlow> (GetQueueDiscClass (it->second))->GetStatus () == FqCobaltFlow::INACTIVE)
-        {
-          // this queue has not been created yet or is associated with this flow
-          // or is inactive, hence we can use it
-          m_tags[i] = flowHash;
-          return i;
-        }
-    }
-
-  // all the queues of the set are used. Use the first queue of the set
-  m_tags[outerHash] = flowHash;
-  return outerHash;
-}
-
 bool
 FqCobaltQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 {
@@ -281,18 +268,18 @@ FqCobaltQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
   if (m_enableSetAssociativeHash)
     {
-      h = SetAssociativeHash (flowHash);
+      h = m_flowTable.Lookup (flowHash);
     }
   else
     {
       h = flowHash % m_flows;
     }
 
-  Ptr<FqCobaltFlow> flow;
-  if (m_flowsIndices.find (h) == m_flowsIndices.end ())
+  FqCobaltFlow *flow = m_flowsByBucket[h];
+  if (flow == 0)
     {
       NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
-      flow = m_flowFactory.Create<FqCobaltFlow> ();
+      Ptr<FqCobaltFlow> newFlow = m_flowFactory.Create<FqCobaltFlow> ();
       Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc> ();
       // If Cobalt, Set values of CobaltQueueDisc to match this QueueDisc
       Ptr<CobaltQueueDisc> cobalt = qd->GetObject<CobaltQueueDisc> ();
@@ -304,27 +291,24 @@ FqCobaltQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
           cobalt->SetAttribute ("BlueThreshold", TimeValue (m_blueThreshold));
         }
       qd->Initialize ();
-      flow->SetQueueDisc (qd);
-      flow->SetIndex (h);
-      AddQueueDiscClass (flow);
+      newFlow->SetQueueDisc (qd);
+      newFlow->SetIndex (h);
+      AddQueueDiscClass (newFlow);
 
-      m_flowsIndices[h] = GetNQueueDiscClasses () - 1;
-    }
-  else
-    {
-      flow = StaticCast<FqCobaltFlow> (GetQueueDiscClass (m_flowsIndices[h]));
+      flow = PeekPointer (newFlow);
+      m_flowsByBucket[h] = flow;
     }
 
   if (flow->GetStatus () == FqCobaltFlow::INACTIVE)
     {
       flow->SetStatus (FqCobaltFlow::NEW_FLOW);
       flow->SetDeficit (m_quantum);
-      m_newFlows.push_back (flow);
+      m_newFlows.PushBack (flow);
     }
 
   flow->GetQueueDisc ()->Enqueue (item);
 
-  NS_LOG_DEBUG ("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+  NS_LOG_DEBUG ("Packet enqueued into flow " << h);
 
   if (GetCurrentSize () > GetMaxSize ())
     {
@@ -340,24 +324,23 @@ FqCobaltQueueDisc::DoDequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<FqCobaltFlow> flow;
+  FqCobaltFlow *flow = 0;
   Ptr<QueueDiscItem> item;
 
   do
     {
       bool found = false;
 
-      while (!found && !m_newFlows.empty ())
+      while (!found && !m_newFlows.IsEmpty ())
         {
-          flow = m_newFlows.front ();
+          flow = m_newFlows.Front ();
 
           if (flow->GetDeficit () <= 0)
             {
               NS_LOG_DEBUG ("Increase deficit for new flow index " << flow->GetIndex ());
               flow->IncreaseDeficit (m_quantum);
               flow->SetStatus (FqCobaltFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              m_newFlows.MoveFrontTo (m_oldFlows);
             }
           else
             {
@@ -366,16 +349,15 @@ FqCobaltQueueDisc::DoDequeue (void)
             }
         }
 
-      while (!found && !m_oldFlows.empty ())
+      while (!found && !m_oldFlows.IsEmpty ())
         {
-          flow = m_oldFlows.front ();
+          flow = m_oldFlows.Front ();
 
           if (flow->GetDeficit () <= 0)
             {
               NS_LOG_DEBUG ("Increase deficit for old flow index " << flow->GetIndex ());
               flow->IncreaseDeficit (m_quantum);
-              m_oldFlows.push_back (flow);
-              m_oldFlows.pop_front ();
+              m_oldFlows.MoveFrontTo (m_oldFlows);
             }
           else
             {
@@ -395,16 +377,20 @@ FqCobaltQueueDisc::DoDequeue (void)
       if (!item)
         {
           NS_LOG_DEBUG ("Could not get a packet from the selected flow queue");
-          if (!m_newFlows.empty ())
+          if (!m_newFlows.IsEmpty ())
             {
               flow->SetStatus (FqCobaltFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              m_newFlows.MoveFrontTo (m_oldFlows);
             }
           else
             {
               flow->SetStatus (FqCobaltFlow::INACTIVE);
-              m_oldFlows.pop_front ();
+              m_oldFlows.PopFront ();
+              if (m_enableSetAssociativeHash)
+                {
+                  // the bucket of the flow can be assigned to another flow
+                  m_flowTable.Release (flow->GetIndex ());
+                }
             }
         }
       else
@@ -479,6 +465,16 @@ FqCobaltQueueDisc::InitializeParams (void)
 {
   NS_LOG_FUNCTION (this);
 
+  // preallocate the flow queue pointers, so that looking up the flow queue
+  // of a packet takes constant time
+  uint32_t nQueues = m_flows;
+  if (m_enableSetAssociativeHash)
+    {
+      m_flowTable.Configure (m_flows, m_setWays, m_overflowFlows);
+      nQueues = m_flowTable.GetNBuckets ();
+    }
+  m_flowsByBucket.assign (nQueues, 0);
+
   m_flowFactory.SetTypeId ("ns3::FqCobaltFlow");
 
   m_queueDiscFactory.SetTypeId ("ns3::CobaltQueueDisc");
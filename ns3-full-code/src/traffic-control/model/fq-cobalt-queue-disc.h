@@ -30,8 +30,9 @@
 
 #include "ns3/queue-disc.h"
 #include "ns3/object-factory.h"
-#include <list>
-#include <map>
+#include "fq-flow-list.h"
+#include "flow-id-table.h"
+#include <vector>
 
 namespace ns3 {
 
@@ -41,7 +42,7 @@ namespace ns3 {
  * \brief A flow queue used by the FqCobalt queue disc
  */
 
-class FqCobaltFlow : public QueueDiscClass
+class FqCobaltFlow : public QueueDiscClass, public FqFlowListItem
 {
 public:
   /**
@@ -149,6 +150,12 @@ public:
   static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
   static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
 
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
 private:
   virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
   virtual Ptr<QueueDiscItem> DoDequeue (void);
@@ -161,20 +168,12 @@ private:
    */
   uint32_t FqCobaltDrop (void);
 
-  /**
-   * Compute the index of the queue for the flow having the given flowHash,
-   * according to the set associative hash approach.
-   *
-   * \param flowHash the hash of the flow 5-tuple
-   * \return the index of the queue for the given flow
-   */
-  uint32_t SetAssociativeHash (uint32_t flowHash);
-
   std::string m_interval;    //!< CoDel interval attribute
   std::string m_target;      //!< CoDel target attribute
   uint32_t m_quantum;        //!< Deficit assigned to flows at each round
   uint32_t m_flows;          //!< Number of flow queues
   uint32_t m_setWays;        //!< size of a set of queues (used by set associative hash)
+  uint32_t m_overflowFlows;  //!< number of queues of the overflow area (used by set associative hash)
   uint32_t m_dropBatchSize;  //!< Max number of packets dropped from the fat flow
   uint32_t m_perturbation;   //!< hash perturbation value
   bool m_useEcn;             //!< True if ECN is used (packets are marked instead of being dropped)
@@ -186,11 +185,11 @@ private:
   double m_Pdrop;            //!< Drop Probability
   Time m_blueThreshold;      //!< Threshold to enable blue enhancement
 
-  std::list<Ptr<FqCobaltFlow> > m_newFlows;    //!< The list of new flows
-  std::list<Ptr<FqCobaltFlow> > m_oldFlows;    //!< The list of old flows
+  FqFlowList<FqCobaltFlow> m_newFlows;    //!< The list of new flows
+  FqFlowList<FqCobaltFlow> m_oldFlows;    //!< The list of old flows
 
-  std::map<uint32_t, uint32_t> m_flowsIndices;    //!< Map with the index of class for each flow
-  std::map<uint32_t, uint32_t> m_tags;            //!< Tags used by set associative hash
+  std::vector<FqCobaltFlow*> m_flowsByBucket;  //!< The flow queue (if created) of each hash bucket
+  FlowIdTable m_flowTable;                 //!< Buckets of the flows, used by set associative hash
 
   ObjectFactory m_flowFactory;         //!< Factory to create a new flow
   ObjectFactory m_queueDiscFactory;    //!< Factory to create a new queue
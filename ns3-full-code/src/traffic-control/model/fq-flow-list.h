@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FQ_FLOW_LIST_H
+#define FQ_FLOW_LIST_H
+
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+template <typename T>
+class FqFlowList;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief The links of a flow queue in the list of new flows or old flows
+ *
+ * The flow queues of the FQ queue discs (FqCoDel, FqPie, FqCobalt and
+ * FqSred) inherit from this class, so that they can be moved from a list
+ * to another by just updating a few pointers, with no memory allocation.
+ * A flow queue can belong to at most one list at a time.
+ */
+class FqFlowListItem
+{
+public:
+  FqFlowListItem ()
+    : m_prev (0),
+      m_next (0),
+      m_linked (false)
+  {
+  }
+
+  /**
+   * \return true if this flow queue belongs to a list
+   */
+  bool IsLinked (void) const
+  {
+    return m_linked;
+  }
+
+private:
+  template <typename T>
+  friend class FqFlowList;
+
+  FqFlowListItem *m_prev;  //!< the previous flow queue in the list
+  FqFlowListItem *m_next;  //!< the next flow queue in the list
+  bool m_linked;           //!< whether the flow queue belongs to a list
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief An intrusive doubly-linked list of flow queues
+ *
+ * The list does not hold a reference to its flow queues, which are kept
+ * alive by the queue disc they are a class of.  The list must therefore be
+ * cleared before the classes of the queue disc are disposed of.
+ */
+template <typename T>
+class FqFlowList
+{
+public:
+  FqFlowList ()
+    : m_head (0),
+      m_tail (0)
+  {
+  }
+
+  /**
+   * \return true if the list is empty
+   */
+  bool IsEmpty (void) const
+  {
+    return m_head == 0;
+  }
+
+  /**
+   * \return the flow queue at the head of the list (0 if the list is empty)
+   */
+  T* Front (void) const
+  {
+    return static_cast<T*> (m_head);
+  }
+
+  /**
+   * \brief Append a flow queue to the list
+   * \param flow the flow queue, which must not belong to any list
+   */
+  void PushBack (T* flow)
+  {
+    FqFlowListItem *item = flow;
+    NS_ASSERT_MSG (!item->m_linked, "The flow queue already belongs to a list");
+    item->m_prev = m_tail;
+    item->m_next = 0;
+    item->m_linked = true;
+    if (m_tail)
+      {
+        m_tail->m_next = item;
+      }
+    else
+      {
+        m_head = item;
+      }
+    m_tail = item;
+  }
+
+  /**
+   * \brief Remove the flow queue at the head of the list
+   * \return the removed flow queue
+   */
+  T* PopFront (void)
+  {
+    NS_ASSERT_MSG (m_head, "The list is empty");
+    T* flow = static_cast<T*> (m_head);
+    Remove (flow);
+    return flow;
+  }
+
+  /**
+   * \brief Remove a flow queue from the list
+   * \param flow the flow queue, which must belong to this list
+   */
+  void Remove (T* flow)
+  {
+    FqFlowListItem *item = flow;
+    NS_ASSERT_MSG (item->m_linked, "The flow queue does not belong to a list");
+    if (item->m_prev)
+      {
+        item->m_prev->m_next = item->m_next;
+      }
+    else
+      {
+        m_head = item->m_next;
+      }
+    if (item->m_next)
+      {
+        item->m_next->m_prev = item->m_prev;
+      }
+    else
+      {
+        m_tail = item->m_prev;
+      }
+    item->m_prev = 0;
+    item->m_next = 0;
+    item->m_linked = false;
+  }
+
+  /**
+   * \brief Move the flow queue at the head of this list to the tail of another list
+   * \param other the destination list (possibly this list)
+   * \return the moved flow queue
+   */
+  T* MoveFrontTo (FqFlowList<T> &other)
+  {
+    T* flow = PopFront ();
+    other.PushBack (flow);
+    return flow;
+  }
+
+  /**
+   * \brief Unlink all the flow queues of the list
+   */
+  void Clear (void)
+  {
+    while (m_head)
+      {
+        PopFront ();
+      }
+  }
+
+private:
+  FqFlowListItem *m_head;  //!< the flow queue at the head of the list
+  FqFlowListItem *m_tail;  //!< the flow queue at the tail of the list
+};
+
+} // namespace ns3
+
+#endif /* FQ_FLOW_LIST_H */
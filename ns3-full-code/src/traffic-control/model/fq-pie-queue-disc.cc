@@ -224,6 +224,12 @@ TypeId FqPieQueueDisc::GetTypeId (void)
                    UintegerValue (8),
                    MakeUintegerAccessor (&FqPieQueueDisc::m_setWays),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("OverflowFlows",
+                   "The number of queues, in addition to Flows, assigned to the flows whose set "
+                   "of queues is full (used by set associative hash)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FqPieQueueDisc::m_overflowFlows),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -240,6 +246,16 @@ FqPieQueueDisc::~FqPieQueueDisc ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+FqPieQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_newFlows.Clear ();
+  m_oldFlows.Clear ();
+  m_flowsByBucket.clear ();
+  QueueDisc::DoDispose ();
+}
+
 void
 FqPieQueueDisc::SetQuantum (uint32_t quantum)
 {
@@ -253,35 +269,6 @@ FqPieQueueDisc::GetQuantum (void) const
   return m_quantum;
 }
 
-uint32_t
-FqPieQueueDisc::SetAssociativeHash (uint32_t flowHash)
-{
-  NS_LOG_FUNCTION (this << flowHash);
-
-  uint32_t h = (flowHash % m_flows);
-  uint32_t innerHash = h % m_setWays;
-  uint32_t outerHash = h - innerHash;
-
-  for (uint32_t i = outerHash; i < outerHash + m_setWays; i++)
-    {
-      auto it = m_flowsIndices.find (i);
-
-      if (it == m_flowsIndices.end ()
-          || (m_tags.find (i) != m_tags.end () && m_tags[i] == flowHash)
-          || StaticCast<FqPieFlow> (GetQueueDiscClass (it->second))->GetStatus () == FqPieFlow::INACTIVE)
-        {
-          // this queue has not been created yet or is associated with this flow
-          // or is inactive, hence we can use it
-          m_tags[i] = flowHash;
-          return i;
-        }
-    }
-
-  // all the queues of the set are used. Use the first queue of the set
-  m_tags[outerHash] = flowHash;
-  return outerHash;
-}
-
 bool
 FqPieQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 {
@@ -311,18 +298,18 @@ FqPieQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
   if (m_enableSetAssociativeHash)
     {
-      h = SetAssociativeHash (flowHash);
+      h = m_flowTable.Lookup (flowHash);
     }
   else
     {
       h = flowHash % m_flows;
     }
 
-  Ptr<FqPieFlow> flow;
-  if (m_flowsIndices.find (h) == m_flowsIndices.end ())
+  FqPieFlow *flow = m_flowsByBucket[h];
+  if (flow == 0)
     {
       NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
-      flow = m_flowFactory.Create<FqPieFlow> ();
+      Ptr<FqPieFlow> newFlow = m_flowFactory.Create<FqPieFlow> ();
       Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc> ();
       // If Pie, Set values of PieQueueDisc to match this QueueDisc
       Ptr<PieQueueDisc> pie = qd->GetObject<PieQueueDisc> ();
@@ -333,27 +320,24 @@ FqPieQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
           pie->SetAttribute ("UseL4s", BooleanValue (m_useL4s));
         }
       qd->Initialize ();
-      flow->SetQueueDisc (qd);
-      flow->SetIndex (h);
-      AddQueueDiscClass (flow);
+      newFlow->SetQueueDisc (qd);
+      newFlow->SetIndex (h);
+      AddQueueDiscClass (newFlow);
 
-      m_flowsIndices[h] = GetNQueueDiscClasses () - 1;
-    }
-  else
-    {
-      flow = StaticCast<FqPieFlow> (GetQueueDiscClass (m_flowsIndices[h]));
+      flow = PeekPointer (newFlow);
+      m_flowsByBucket[h] = flow;
     }
 
   if (flow->GetStatus () == FqPieFlow::INACTIVE)
     {
       flow->SetStatus (FqPieFlow::NEW_FLOW);
       flow->SetDeficit (m_quantum);
-      m_newFlows.push_back (flow);
+      m_newFlows.PushBack (flow);
     }
 
   flow->GetQueueDisc ()->Enqueue (item);
 
-  NS_LOG_DEBUG ("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+  NS_LOG_DEBUG ("Packet enqueued into flow " << h);
 
   if (GetCurrentSize () > GetMaxSize ())
     {
@@ -369,24 +353,23 @@ FqPieQueueDisc::DoDequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<FqPieFlow> flow;
+  FqPieFlow *flow = 0;
   Ptr<QueueDiscItem> item;
 
   do
     {
       bool found = false;
 
-      while (!found && !m_newFlows.empty ())
+      while (!found && !m_newFlows.IsEmpty ())
         {
-          flow = m_newFlows.front ();
+          flow = m_newFlows.Front ();
 
           if (flow->GetDeficit () <= 0)
             {
               NS_LOG_DEBUG ("Increase deficit for new flow index " << flow->GetIndex ());
               flow->IncreaseDeficit (m_quantum);
               flow->SetStatus (FqPieFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              m_newFlows.MoveFrontTo (m_oldFlows);
             }
           else
             {
@@ -395,16 +378,15 @@ FqPieQueueDisc::DoDequeue (void)
             }
         }
 
-      while (!found && !m_oldFlows.empty ())
+      while (!found && !m_oldFlows.IsEmpty ())
         {
-          flow = m_oldFlows.front ();
+          flow = m_oldFlows.Front ();
 
           if (flow->GetDeficit () <= 0)
             {
               NS_LOG_DEBUG ("Increase deficit for old flow index " << flow->GetIndex ());
               flow->IncreaseDeficit (m_quantum);
-              m_oldFlows.push_back (flow);
-              m_oldFlows.pop_front ();
+              m_oldFlows.MoveFrontTo (m_oldFlows);
             }
           else
             {
@@ -424,16 +406,20 @@ FqPieQueueDisc::DoDequeue (void)
       if (!item)
         {
           NS_LOG_DEBUG ("Could not get a packet from the selected flow queue");
-          if (!m_newFlows.empty ())
+          if (!m_newFlows.IsEmpty ())
             {
               flow->SetStatus (FqPieFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              m_newFlows.MoveFrontTo (m_oldFlows);
             }
           else
             {
               flow->SetStatus (FqPieFlow::INACTIVE);
-              m_oldFlows.pop_front ();
+              m_oldFlows.PopFront ();
+              if (m_enableSetAssociativeHash)
+                {
+                  // the bucket of the flow can be assigned to another flow
+                  m_flowTable.Release (flow->GetIndex ());
+                }
             }
         }
       else
@@ -508,6 +494,16 @@ FqPieQueueDisc::InitializeParams (void)
 {
   NS_LOG_FUNCTION (this);
 
+  // preallocate the flow queue pointers, so that looking up the flow queue
+  // of a packet takes constant time
+  uint32_t nQueues = m_flows;
+  if (m_enableSetAssociativeHash)
+    {
+      m_flowTable.Configure (m_flows, m_setWays, m_overflowFlows);
+      nQueues = m_flowTable.GetNBuckets ();
+    }
+  m_flowsByBucket.assign (nQueues, 0);
+
   m_flowFactory.SetTypeId ("ns3::FqPieFlow");
 
   m_queueDiscFactory.SetTypeId ("ns3::PieQueueDisc");
@@ -29,8 +29,9 @@
 
 #include "ns3/queue-disc.h"
 #include "ns3/object-factory.h"
-#include <list>
-#include <map>
+#include "fq-flow-list.h"
+#include "flow-id-table.h"
+#include <vector>
 
 namespace ns3 {
 
@@ -40,7 +41,7 @@ namespace ns3 {
  * \brief A flow queue used by the FqPie queue disc
  */
 
-class FqPieFlow : public QueueDiscClass
+class FqPieFlow : public QueueDiscClass, public FqFlowListItem
 {
 public:
   /**
@@ -148,6 +149,12 @@ public:
   static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
   static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
 
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
 private:
   virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
   virtual Ptr<QueueDiscItem> DoDequeue (void);
@@ -160,15 +167,6 @@ private:
    */
   uint32_t FqPieDrop (void);
 
-  /**
-   * Compute the index of the queue for the flow having the given flowHash,
-   * according to the set associative hash approach.
-   *
-   * \param flowHash the hash of the flow 5-tuple
-   * \return the index of the queue for the given flow
-   */
-  uint32_t SetAssociativeHash (uint32_t flowHash);
-
   // PIE queue disc parameter
   bool m_useEcn;             //!< True if ECN is used (packets are marked instead of being dropped)
   double m_markEcnTh;        //!< ECN marking threshold (default 10% as suggested in RFC 8033)
@@ -190,15 +188,16 @@ private:
   uint32_t m_quantum;        //!< Deficit assigned to flows at each round
   uint32_t m_flows;          //!< Number of flow queues
   uint32_t m_setWays;        //!< size of a set of queues (used by set associative hash)
+  uint32_t m_overflowFlows;  //!< number of queues of the overflow area (used by set associative hash)
   uint32_t m_dropBatchSize;  //!< Max number of packets dropped from the fat flow
   uint32_t m_perturbation;   //!< hash perturbation value
   bool m_enableSetAssociativeHash; //!< whether to enable set associative hash
 
-  std::list<Ptr<FqPieFlow> > m_newFlows;    //!< The list of new flows
-  std::list<Ptr<FqPieFlow> > m_oldFlows;    //!< The list of old flows
+  FqFlowList<FqPieFlow> m_newFlows;    //!< The list of new flows
+  FqFlowList<FqPieFlow> m_oldFlows;    //!< The list of old flows
 
-  std::map<uint32_t, uint32_t> m_flowsIndices;    //!< Map with the index of class for each flow
-  std::map<uint32_t, uint32_t> m_tags;            //!< Tags used by set associative hash
+  std::vector<FqPieFlow*> m_flowsByBucket;  //!< The flow queue (if created) of each hash bucket
+  FlowIdTable m_flowTable;                 //!< Buckets of the flows, used by set associative hash
 
   ObjectFactory m_flowFactory;         //!< Factory to create a new flow
   ObjectFactory m_queueDiscFactory;    //!< Factory to create a new queue
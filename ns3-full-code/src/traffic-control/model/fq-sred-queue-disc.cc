@@ -0,0 +1,501 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
+#include "ns3/queue.h"
+#include "fq-sred-queue-disc.h"
+#include "ns3/net-device-queue-interface.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FqSredQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (FqSredFlow);
+
+TypeId FqSredFlow::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FqSredFlow")
+    .SetParent<QueueDiscClass> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<FqSredFlow> ()
+  ;
+  return tid;
+}
+
+FqSredFlow::FqSredFlow ()
+  : m_deficit (0),
+    m_status (INACTIVE),
+    m_index (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FqSredFlow::~FqSredFlow ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FqSredFlow::SetDeficit (uint32_t deficit)
+{
+  NS_LOG_FUNCTION (this << deficit);
+  m_deficit = deficit;
+}
+
+int32_t
+FqSredFlow::GetDeficit (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_deficit;
+}
+
+void
+FqSredFlow::IncreaseDeficit (int32_t deficit)
+{
+  NS_LOG_FUNCTION (this << deficit);
+  m_deficit += deficit;
+}
+
+void
+FqSredFlow::SetStatus (FlowStatus status)
+{
+  NS_LOG_FUNCTION (this);
+  m_status = status;
+}
+
+FqSredFlow::FlowStatus
+FqSredFlow::GetStatus (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_status;
+}
+
+void
+FqSredFlow::SetIndex (uint32_t index)
+{
+  NS_LOG_FUNCTION (this);
+  m_index = index;
+}
+
+uint32_t
+FqSredFlow::GetIndex (void) const
+{
+  return m_index;
+}
+
+
+NS_OBJECT_ENSURE_REGISTERED (FqSredQueueDisc);
+
+TypeId FqSredQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FqSredQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<FqSredQueueDisc> ()
+    .AddAttribute ("UseEcn",
+                   "True to use ECN (packets are marked instead of being dropped)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FqSredQueueDisc::m_useEcn),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaximumDropProbability",
+                   "The maximum probability of dropping a packet",
+                   DoubleValue (0.15),
+                   MakeDoubleAccessor (&FqSredQueueDisc::m_maxProbability),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("FlowLimit",
+                   "The maximum number of packets accepted by a flow queue",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&FqSredQueueDisc::m_flowLimit),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("StabilizedRedMode",
+                   "1 for simple SRED, 2 for full SRED (drop probability increased on hits)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&FqSredQueueDisc::m_sredMode),
+                   MakeUintegerChecker<uint32_t> (1, 2))
+    .AddAttribute ("ActiveFlowEstimator",
+                   "The estimator of the number of active flows shared by the flow queues "
+                   "(a default one is created if not set)",
+                   PointerValue (),
+                   MakePointerAccessor (&FqSredQueueDisc::m_flowEstimator),
+                   MakePointerChecker<ActiveFlowEstimator> ())
+    .AddAttribute ("MaxSize",
+                   "The maximum number of packets accepted by this queue disc",
+                   QueueSizeValue (QueueSize ("10240p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("Flows",
+                   "The number of queues into which the incoming packets are classified",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&FqSredQueueDisc::m_flows),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("DropBatchSize",
+                   "The maximum number of packets dropped from the fat flow",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&FqSredQueueDisc::m_dropBatchSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Perturbation",
+                   "The salt used as an additional input to the hash function used to classify packets",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FqSredQueueDisc::m_perturbation),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+FqSredQueueDisc::FqSredQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
+    m_quantum (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = CreateObject<UniformRandomVariable> ();
+}
+
+FqSredQueueDisc::~FqSredQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FqSredQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = 0;
+  m_flowEstimator = 0;
+  m_newFlows.Clear ();
+  m_oldFlows.Clear ();
+  m_flowsByBucket.clear ();
+  QueueDisc::DoDispose ();
+}
+
+void
+FqSredQueueDisc::SetQuantum (uint32_t quantum)
+{
+  NS_LOG_FUNCTION (this << quantum);
+  m_quantum = quantum;
+}
+
+uint32_t
+FqSredQueueDisc::GetQuantum (void) const
+{
+  return m_quantum;
+}
+
+Ptr<ActiveFlowEstimator>
+FqSredQueueDisc::GetActiveFlowEstimator (void)
+{
+  if (!m_flowEstimator)
+    {
+      m_flowEstimator = CreateObject<ActiveFlowEstimator> ();
+    }
+  return m_flowEstimator;
+}
+
+int64_t
+FqSredQueueDisc::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uv->SetStream (stream);
+  return 1 + GetActiveFlowEstimator ()->AssignStreams (stream + 1);
+}
+
+double
+FqSredQueueDisc::CalculateProbabilityZap (uint32_t qSize, bool hit) const
+{
+  NS_LOG_FUNCTION (this << qSize << hit);
+
+  // p_sred, from the occupancy of the flow queue
+  double p;
+  if (3 * qSize >= m_flowLimit)
+    {
+      p = m_maxProbability;
+    }
+  else if (6 * qSize >= m_flowLimit)
+    {
+      p = m_maxProbability / 4;
+    }
+  else
+    {
+      return 0;
+    }
+
+  p *= m_flowEstimator->GetDropProbabilityScale ();
+
+  double hitFrequency = m_flowEstimator->GetHitFrequency ();
+  if (m_sredMode == 2 && hit && hitFrequency > 0)
+    {
+      p *= 1 + 1 / hitFrequency;
+    }
+  return p;
+}
+
+bool
+FqSredQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  uint32_t flowHash, h;
+
+  if (GetNPacketFilters () == 0)
+    {
+      flowHash = item->Hash (m_perturbation);
+    }
+  else
+    {
+      int32_t ret = Classify (item);
+
+      if (ret != PacketFilter::PF_NO_MATCH)
+        {
+          flowHash = static_cast<uint32_t> (ret);
+        }
+      else
+        {
+          NS_LOG_ERROR ("No filter has been able to classify this packet, drop it.");
+          DropBeforeEnqueue (item, UNCLASSIFIED_DROP);
+          return false;
+        }
+    }
+
+  h = flowHash % m_flows;
+
+  // all the flow queues update the same zombie list
+  bool hit = m_flowEstimator->Update (flowHash);
+
+  FqSredFlow *flow = m_flowsByBucket[h];
+  if (flow == 0)
+    {
+      NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
+      Ptr<FqSredFlow> newFlow = m_flowFactory.Create<FqSredFlow> ();
+      Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc> ();
+      qd->Initialize ();
+      newFlow->SetQueueDisc (qd);
+      newFlow->SetIndex (h);
+      AddQueueDiscClass (newFlow);
+
+      flow = PeekPointer (newFlow);
+      m_flowsByBucket[h] = flow;
+    }
+
+  double p = CalculateProbabilityZap (flow->GetQueueDisc ()->GetNPackets (), hit);
+  if (p > 0 && m_uv->GetValue () < p
+      && (!m_useEcn || !Mark (item, UNFORCED_MARK)))
+    {
+      NS_LOG_DEBUG ("Zap packet of flow " << h << " with probability " << p);
+      DropBeforeEnqueue (item, UNFORCED_DROP);
+      return false;
+    }
+
+  if (flow->GetStatus () == FqSredFlow::INACTIVE)
+    {
+      flow->SetStatus (FqSredFlow::NEW_FLOW);
+      flow->SetDeficit (m_quantum);
+      m_newFlows.PushBack (flow);
+    }
+
+  flow->GetQueueDisc ()->Enqueue (item);
+
+  NS_LOG_DEBUG ("Packet enqueued into flow " << h);
+
+  if (GetCurrentSize () > GetMaxSize ())
+    {
+      NS_LOG_DEBUG ("Overload; enter FqSredDrop ()");
+      FqSredDrop ();
+    }
+
+  return true;
+}
+
+Ptr<QueueDiscItem>
+FqSredQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  FqSredFlow *flow = 0;
+  Ptr<QueueDiscItem> item;
+
+  do
+    {
+      bool found = false;
+
+      while (!found && !m_newFlows.IsEmpty ())
+        {
+          flow = m_newFlows.Front ();
+
+          if (flow->GetDeficit () <= 0)
+            {
+              NS_LOG_DEBUG ("Increase deficit for new flow index " << flow->GetIndex ());
+              flow->IncreaseDeficit (m_quantum);
+              flow->SetStatus (FqSredFlow::OLD_FLOW);
+              m_newFlows.MoveFrontTo (m_oldFlows);
+            }
+          else
+            {
+              NS_LOG_DEBUG ("Found a new flow " << flow->GetIndex () << " with positive deficit");
+              found = true;
+            }
+        }
+
+      while (!found && !m_oldFlows.IsEmpty ())
+        {
+          flow = m_oldFlows.Front ();
+
+          if (flow->GetDeficit () <= 0)
+            {
+              NS_LOG_DEBUG ("Increase deficit for old flow index " << flow->GetIndex ());
+              flow->IncreaseDeficit (m_quantum);
+              m_oldFlows.MoveFrontTo (m_oldFlows);
+            }
+          else
+            {
+              NS_LOG_DEBUG ("Found an old flow " << flow->GetIndex () << " with positive deficit");
+              found = true;
+            }
+        }
+
+      if (!found)
+        {
+          NS_LOG_DEBUG ("No flow found to dequeue a packet");
+          return 0;
+        }
+
+      item = flow->GetQueueDisc ()->Dequeue ();
+
+      if (!item)
+        {
+          NS_LOG_DEBUG ("Could not get a packet from the selected flow queue");
+          if (!m_newFlows.IsEmpty ())
+            {
+              flow->SetStatus (FqSredFlow::OLD_FLOW);
+              m_newFlows.MoveFrontTo (m_oldFlows);
+            }
+          else
+            {
+              flow->SetStatus (FqSredFlow::INACTIVE);
+              m_oldFlows.PopFront ();
+            }
+        }
+      else
+        {
+          NS_LOG_DEBUG ("Dequeued packet " << item->GetPacket ());
+        }
+    }
+  while (item == 0);
+
+  flow->IncreaseDeficit (item->GetSize () * -1);
+
+  return item;
+}
+
+bool
+FqSredQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("FqSredQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("FqSredQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  // we are at initialization time. If the user has not set a quantum value,
+  // set the quantum to the MTU of the device (if any)
+  if (!m_quantum)
+    {
+      Ptr<NetDeviceQueueInterface> ndqi = GetNetDeviceQueueInterface ();
+      Ptr<NetDevice> dev;
+      // if the NetDeviceQueueInterface object is aggregated to a
+      // NetDevice, get the MTU of such NetDevice
+      if (ndqi && (dev = ndqi->GetObject<NetDevice> ()))
+        {
+          m_quantum = dev->GetMtu ();
+          NS_LOG_DEBUG ("Setting the quantum to the MTU of the device: " << m_quantum);
+        }
+
+      if (!m_quantum)
+        {
+          NS_LOG_ERROR ("The quantum parameter cannot be null");
+          return false;
+        }
+    }
+
+  return true;
+}
+
+void
+FqSredQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // preallocate the flow queue pointers, so that looking up the flow queue
+  // of a packet takes constant time
+  m_flowsByBucket.assign (m_flows, 0);
+
+  m_flowFactory.SetTypeId ("ns3::FqSredFlow");
+
+  m_queueDiscFactory.SetTypeId ("ns3::FifoQueueDisc");
+  m_queueDiscFactory.Set ("MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, m_flowLimit)));
+
+  GetActiveFlowEstimator ();
+}
+
+uint32_t
+FqSredQueueDisc::FqSredDrop (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t maxBacklog = 0, index = 0;
+  Ptr<QueueDisc> qd;
+
+  /* Queue is full! Find the fat flow and drop packet(s) from it */
+  for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
+    {
+      qd = GetQueueDiscClass (i)->GetQueueDisc ();
+      uint32_t bytes = qd->GetNBytes ();
+      if (bytes > maxBacklog)
+        {
+          maxBacklog = bytes;
+          index = i;
+        }
+    }
+
+  /* Our goal is to drop half of this fat flow backlog */
+  uint32_t len = 0, count = 0, threshold = maxBacklog >> 1;
+  qd = GetQueueDiscClass (index)->GetQueueDisc ();
+  Ptr<QueueDiscItem> item;
+
+  do
+    {
+      NS_LOG_DEBUG ("Drop packet (overflow); count: " << count << " len: " << len << " threshold: " << threshold);
+      item = qd->GetInternalQueue (0)->Dequeue ();
+      DropAfterDequeue (item, OVERLIMIT_DROP);
+      len += item->GetSize ();
+    }
+  while (++count < m_dropBatchSize && len < threshold);
+
+  return index;
+}
+
+} // namespace ns3
@@ -0,0 +1,225 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FQ_SRED_QUEUE_DISC
+#define FQ_SRED_QUEUE_DISC
+
+#include "ns3/queue-disc.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include "active-flow-estimator.h"
+#include "fq-flow-list.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A flow queue used by the FqSred queue disc
+ */
+
+class FqSredFlow : public QueueDiscClass, public FqFlowListItem
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief FqSredFlow constructor
+   */
+  FqSredFlow ();
+
+  virtual ~FqSredFlow ();
+
+  /**
+   * \enum FlowStatus
+   * \brief Used to determine the status of this flow queue
+   */
+  enum FlowStatus
+  {
+    INACTIVE,
+    NEW_FLOW,
+    OLD_FLOW
+  };
+
+  /**
+   * \brief Set the deficit for this flow
+   * \param deficit the deficit for this flow
+   */
+  void SetDeficit (uint32_t deficit);
+  /**
+   * \brief Get the deficit for this flow
+   * \return the deficit for this flow
+   */
+  int32_t GetDeficit (void) const;
+  /**
+   * \brief Increase the deficit for this flow
+   * \param deficit the amount by which the deficit is to be increased
+   */
+  void IncreaseDeficit (int32_t deficit);
+  /**
+   * \brief Set the status for this flow
+   * \param status the status for this flow
+   */
+  void SetStatus (FlowStatus status);
+  /**
+   * \brief Get the status of this flow
+   * \return the status of this flow
+   */
+  FlowStatus GetStatus (void) const;
+  /**
+   * \brief Set the index for this flow
+   * \param index the index for this flow
+   */
+  void SetIndex (uint32_t index);
+  /**
+   * \brief Get the index of this flow
+   * \return the index of this flow
+   */
+  uint32_t GetIndex (void) const;
+
+private:
+  int32_t m_deficit;    //!< the deficit for this flow
+  FlowStatus m_status;  //!< the status of this flow
+  uint32_t m_index;     //!< the index for this flow
+};
+
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A flow queueing packet queue disc with Stabilized RED drops
+ *
+ * Packets are classified into flow queues which are served by the same
+ * deficit round robin scheduler as FqCoDel and FqPie.  The drop decision
+ * follows Stabilized RED: the drop probability p_sred of a packet depends
+ * on the occupancy of its flow queue relative to FlowLimit (p_max above a
+ * third of it, p_max/4 above a sixth), and it is scaled by the number of
+ * active flows estimated by an ActiveFlowEstimator.  The estimator is
+ * shared by all the flow queues, so that the hit frequency reflects the
+ * load of the whole link.  In the full mode, the probability is further
+ * multiplied by (1 + hit / P), which penalizes the flows hitting the
+ * zombie list.
+ */
+
+class FqSredQueueDisc : public QueueDisc
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief FqSredQueueDisc constructor
+   */
+  FqSredQueueDisc ();
+
+  virtual ~FqSredQueueDisc ();
+
+  /**
+   * \brief Set the quantum value.
+   *
+   * \param quantum The number of bytes each queue gets to dequeue on each round of the scheduling algorithm
+   */
+  void SetQuantum (uint32_t quantum);
+
+  /**
+   * \brief Get the quantum value.
+   *
+   * \returns The number of bytes each queue gets to dequeue on each round of the scheduling algorithm
+   */
+  uint32_t GetQuantum (void) const;
+
+  /**
+   * \brief Get the estimator of the number of active flows shared by the flow queues.
+   *
+   * \returns the active flow estimator
+   */
+  Ptr<ActiveFlowEstimator> GetActiveFlowEstimator (void);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  // Reasons for dropping packets
+  static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
+  static constexpr const char* UNFORCED_DROP = "Unforced drop";          //!< Drops by the SRED zap probability
+  static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
+  // Reasons for marking packets
+  static constexpr const char* UNFORCED_MARK = "Unforced mark";          //!< Marks by the SRED zap probability
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief Compute the probability of dropping a packet of a flow queue
+   * \param qSize the number of packets in the flow queue
+   * \param hit whether the packet hit the zombie list
+   * \return the drop probability
+   */
+  double CalculateProbabilityZap (uint32_t qSize, bool hit) const;
+
+  /**
+   * \brief Drop a packet from the head of the queue with the largest current byte count
+   * \return the index of the queue with the largest current byte count
+   */
+  uint32_t FqSredDrop (void);
+
+  bool m_useEcn;             //!< True if ECN is used (packets are marked instead of being dropped)
+  double m_maxProbability;   //!< Maximum drop probability p_max
+  uint32_t m_flowLimit;      //!< Capacity of a flow queue, in packets
+  uint32_t m_sredMode;       //!< 1 for simple SRED, 2 for full SRED
+
+  // Fq parameters
+  uint32_t m_quantum;        //!< Deficit assigned to flows at each round
+  uint32_t m_flows;          //!< Number of flow queues
+  uint32_t m_dropBatchSize;  //!< Max number of packets dropped from the fat flow
+  uint32_t m_perturbation;   //!< hash perturbation value
+
+  FqFlowList<FqSredFlow> m_newFlows;    //!< The list of new flows
+  FqFlowList<FqSredFlow> m_oldFlows;    //!< The list of old flows
+
+  std::vector<FqSredFlow*> m_flowsByBucket;  //!< The flow queue (if created) of each hash bucket
+
+  Ptr<ActiveFlowEstimator> m_flowEstimator;  //!< The zombie list shared by the flow queues
+  Ptr<UniformRandomVariable> m_uv;           //!< Rng stream
+
+  ObjectFactory m_flowFactory;         //!< Factory to create a new flow
+  ObjectFactory m_queueDiscFactory;    //!< Factory to create a new queue
+};
+
+} // namespace ns3
+
+#endif /* FQ_SRED_QUEUE_DISC */
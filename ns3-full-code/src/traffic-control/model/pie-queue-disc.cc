@@ -31,6 +31,7 @@
 #include "ns3/double.h"
 #include "ns3/simulator.h"
 #include "ns3/abort.h"
+#include "ns3/pointer.h"
 #include "pie-queue-disc.h"
 #include "ns3/drop-tail-queue.h"
 
@@ -132,6 +133,11 @@ TypeId PieQueueDisc::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PieQueueDisc::m_useL4s),
                    MakeBooleanChecker ())
+    .AddAttribute ("ActiveFlowEstimator",
+                   "If set, the drop probability is scaled by the estimated number of active flows",
+                   PointerValue (),
+                   MakePointerAccessor (&PieQueueDisc::m_flowEstimator),
+                   MakePointerChecker<ActiveFlowEstimator> ())
   ;
 
   return tid;
@@ -155,6 +161,7 @@ PieQueueDisc::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_uv = 0;
+  m_flowEstimator = 0;
   m_rtrsEvent.Cancel ();
   QueueDisc::DoDispose ();
 }
@@ -170,6 +177,10 @@ PieQueueDisc::AssignStreams (int64_t stream)
 {
   NS_LOG_FUNCTION (this << stream);
   m_uv->SetStream (stream);
+  if (m_flowEstimator)
+    {
+      return 1 + m_flowEstimator->AssignStreams (stream + 1);
+    }
   return 1;
 }
 
@@ -178,6 +189,11 @@ PieQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
 
+  if (m_flowEstimator)
+    {
+      m_flowEstimator->Update (item);
+    }
+
   QueueSize nQueued = GetCurrentSize ();
   // If L4S is enabled, then check if the packet is ECT1, and if it is then set isEct true
   bool isEct1 = false;
@@ -291,6 +307,11 @@ bool PieQueueDisc::DropEarly (Ptr<QueueDiscItem> item, uint32_t qSize)
       p = p * packetSize / m_meanPktSize;
     }
 
+  if (m_flowEstimator)
+    {
+      p *= m_flowEstimator->GetDropProbabilityScale ();
+    }
+
   // Safeguard PIE to be work conserving (Section 4.1 of RFC 8033)
   if ((m_qDelayOld.GetSeconds () < (0.5 * m_qDelayRef.GetSeconds ())) && (m_dropProb < 0.2))
     {
@@ -35,6 +35,7 @@
 #include "ns3/timer.h"
 #include "ns3/event-id.h"
 #include "ns3/random-variable-stream.h"
+#include "active-flow-estimator.h"
 
 #define BURST_RESET_TIMEOUT 1.5
 
@@ -87,7 +88,8 @@ public:
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
-   * have been assigned.
+   * have been assigned.  The stream of the ActiveFlowEstimator, if any, is
+   * assigned as well.
    *
    * \param stream first stream index to use
    * \return the number of stream indices assigned by this model
@@ -168,6 +170,7 @@ private:
   Ptr<UniformRandomVariable> m_uv;              //!< Rng stream
   double m_accuProb;                            //!< Accumulated drop probability
   bool m_active;                                //!< Indicates whether PIE is in active state or not
+  Ptr<ActiveFlowEstimator> m_flowEstimator;     //!< Estimator of the number of active flows (optional)
 };
 
 };   // namespace ns3
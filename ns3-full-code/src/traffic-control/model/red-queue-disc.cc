@@ -62,6 +62,7 @@
 #include "ns3/double.h"
 #include "ns3/simulator.h"
 #include "ns3/abort.h"
+#include "ns3/pointer.h"
 #include "red-queue-disc.h"
 #include "ns3/drop-tail-queue.h"
 
@@ -218,6 +219,11 @@ TypeId RedQueueDisc::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&RedQueueDisc::m_useHardDrop),
                    MakeBooleanChecker ())
+    .AddAttribute ("ActiveFlowEstimator",
+                   "If set, the early drop probability is scaled by the estimated number of active flows",
+                   PointerValue (),
+                   MakePointerAccessor (&RedQueueDisc::m_flowEstimator),
+                   MakePointerChecker<ActiveFlowEstimator> ())
   ;
 
   return tid;
@@ -240,6 +246,7 @@ RedQueueDisc::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_uv = 0;
+  m_flowEstimator = 0;
   QueueDisc::DoDispose ();
 }
 
@@ -333,6 +340,10 @@ RedQueueDisc::AssignStreams (int64_t stream)
 {
   NS_LOG_FUNCTION (this << stream);
   m_uv->SetStream (stream);
+  if (m_flowEstimator)
+    {
+      return 1 + m_flowEstimator->AssignStreams (stream + 1);
+    }
   return 1;
 }
 
@@ -341,6 +352,11 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
 
+  if (m_flowEstimator)
+    {
+      m_flowEstimator->Update (item);
+    }
+
   uint32_t nQueued = GetInternalQueue (0)->GetCurrentSize ().GetValue ();
 
   // simulate number of packets arrival during idle period
@@ -654,6 +670,11 @@ RedQueueDisc::DropEarly (Ptr<QueueDiscItem> item, uint32_t qSize)
   NS_LOG_FUNCTION (this << item << qSize);
 
   double prob1 = CalculatePNew ();
+  if (m_flowEstimator)
+    {
+      // With few active flows, each of them reacts strongly to a drop
+      prob1 *= m_flowEstimator->GetDropProbabilityScale ();
+    }
   m_vProb = ModifyP (prob1, item->GetSize ());
 
   // Drop probability is computed, pick random number and act
@@ -66,6 +66,7 @@
 #include "ns3/boolean.h"
 #include "ns3/data-rate.h"
 #include "ns3/random-variable-stream.h"
+#include "active-flow-estimator.h"
 
 namespace ns3 {
 
@@ -187,6 +188,8 @@ public:
   * used by this model.  Return the number of streams (possibly zero) that
   * have been assigned.
   *
+  * The stream of the ActiveFlowEstimator, if any, is assigned as well.
+  *
   * \param stream first stream index to use
   * \return the number of stream indices assigned by this model
   */
@@ -312,6 +315,7 @@ private:
   Time m_idleTime;          //!< Start of current idle period
 
   Ptr<UniformRandomVariable> m_uv;  //!< rng stream
+  Ptr<ActiveFlowEstimator> m_flowEstimator; //!< Estimator of the number of active flows (optional)
 };
 
 }; // namespace ns3
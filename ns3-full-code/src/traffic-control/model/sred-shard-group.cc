@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "sred-shard-group.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SredShardGroup");
+
+NS_OBJECT_ENSURE_REGISTERED (SredShardGroup);
+
+TypeId
+SredShardGroup::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SredShardGroup")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<SredShardGroup> ()
+    .AddAttribute ("MergeInterval",
+                   "The interval between two merges of the hit frequencies of the shards "
+                   "(zero to disable the merge)",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&SredShardGroup::m_mergeInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MergeWeight",
+                   "The weight of the average hit frequency when merging the hit frequency of a shard",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&SredShardGroup::m_mergeWeight),
+                   MakeDoubleChecker<double> (0, 1))
+  ;
+  return tid;
+}
+
+SredShardGroup::SredShardGroup ()
+  : m_nShards (0),
+    m_activeFlows (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SredShardGroup::~SredShardGroup ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SredShardGroup::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_mergeEvent.Cancel ();
+  m_shards.clear ();
+  m_nShards = 0;
+  Object::DoDispose ();
+}
+
+uint32_t
+SredShardGroup::AddShard (Callback<double> getHitFrequency, Callback<void, double> setHitFrequency)
+{
+  NS_LOG_FUNCTION (this);
+  Shard shard = {getHitFrequency, setHitFrequency, true};
+  m_shards.push_back (shard);
+  m_nShards++;
+
+  if (m_nShards == 1 && m_mergeInterval.IsStrictlyPositive ())
+    {
+      m_mergeEvent = Simulator::Schedule (m_mergeInterval, &SredShardGroup::PeriodicMerge, this);
+    }
+  return m_shards.size () - 1;
+}
+
+void
+SredShardGroup::RemoveShard (uint32_t shard)
+{
+  NS_LOG_FUNCTION (this << shard);
+  // the shards are disposed of when they are destroyed, which may happen
+  // after the group has been disposed of
+  if (shard >= m_shards.size ())
+    {
+      return;
+    }
+  NS_ASSERT (m_shards[shard].active);
+  m_shards[shard].active = false;
+  m_shards[shard].getHitFrequency = MakeNullCallback<double> ();
+  m_shards[shard].setHitFrequency = MakeNullCallback<void, double> ();
+
+  // the shards are removed when they are disposed of: stop merging once
+  // they are all gone
+  if (--m_nShards == 0)
+    {
+      m_mergeEvent.Cancel ();
+    }
+}
+
+uint32_t
+SredShardGroup::GetNShards (void) const
+{
+  return m_nShards;
+}
+
+double
+SredShardGroup::GetActiveFlows (void) const
+{
+  return m_activeFlows;
+}
+
+void
+SredShardGroup::Merge (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // shards with a null hit frequency have no estimate yet
+  double flows = 0;
+  uint32_t estimates = 0;
+  for (auto &shard : m_shards)
+    {
+      if (shard.active)
+        {
+          double hitFrequency = shard.getHitFrequency ();
+          if (hitFrequency > 0)
+            {
+              flows += 1 / hitFrequency;
+              estimates++;
+            }
+        }
+    }
+
+  m_activeFlows = flows;
+  if (estimates == 0)
+    {
+      return;
+    }
+
+  double average = estimates / flows;
+  NS_LOG_DEBUG ("Estimated flows " << flows << " over " << estimates << " shards");
+
+  for (auto &shard : m_shards)
+    {
+      if (shard.active)
+        {
+          double hitFrequency = shard.getHitFrequency ();
+          if (hitFrequency > 0)
+            {
+              shard.setHitFrequency ((1 - m_mergeWeight) * hitFrequency + m_mergeWeight * average);
+            }
+        }
+    }
+}
+
+void
+SredShardGroup::PeriodicMerge (void)
+{
+  NS_LOG_FUNCTION (this);
+  Merge ();
+  m_mergeEvent = Simulator::Schedule (m_mergeInterval, &SredShardGroup::PeriodicMerge, this);
+}
+
+} // namespace ns3
@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SRED_SHARD_GROUP_H
+#define SRED_SHARD_GROUP_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A group of Stabilized RED queue discs sharing their estimate of the number of flows
+ *
+ * When Stabilized RED (or ESRED) is installed as the child queue disc of
+ * each transmission queue of a multi-queue device (MqQueueDisc), every
+ * child keeps its own zombie list (a shard), sized by its ZombieListSize
+ * attribute, and its own random variable stream.  The children only see
+ * the flows of their transmission queue, hence a child receiving few
+ * packets may take long to estimate its number of flows.
+ *
+ * The children can be attached to the same SredShardGroup (through their
+ * ShardGroup attribute).  Every MergeInterval, the group sums up the
+ * number of flows 1/P estimated by each shard and moves the hit frequency
+ * P of each shard towards the hit frequency of a shard carrying the
+ * average number of flows, with weight MergeWeight.  The shards are not
+ * otherwise synchronized, and a null MergeInterval disables the merge.
+ */
+class SredShardGroup : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief SredShardGroup constructor
+   */
+  SredShardGroup ();
+
+  virtual ~SredShardGroup ();
+
+  /**
+   * \brief Add a shard to the group
+   * \param getHitFrequency callback returning the hit frequency of the shard
+   * \param setHitFrequency callback setting the hit frequency of the shard
+   * \return the identifier of the shard in the group
+   */
+  uint32_t AddShard (Callback<double> getHitFrequency, Callback<void, double> setHitFrequency);
+
+  /**
+   * \brief Remove a shard from the group
+   * \param shard the identifier returned by AddShard
+   */
+  void RemoveShard (uint32_t shard);
+
+  /**
+   * \return the number of shards in the group
+   */
+  uint32_t GetNShards (void) const;
+
+  /**
+   * \brief Get the number of flows estimated by all the shards at the last merge
+   * \return the sum of the number of flows estimated by the shards
+   */
+  double GetActiveFlows (void) const;
+
+  /**
+   * \brief Merge the hit frequencies of the shards
+   *
+   * This is called every MergeInterval, and can be called explicitly.
+   */
+  void Merge (void);
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief A shard of the group
+   */
+  struct Shard
+  {
+    Callback<double> getHitFrequency;        //!< returns the hit frequency of the shard
+    Callback<void, double> setHitFrequency;  //!< sets the hit frequency of the shard
+    bool active;                             //!< false if the shard has been removed
+  };
+
+  /**
+   * \brief Merge the hit frequencies and schedule the next merge
+   */
+  void PeriodicMerge (void);
+
+  std::vector<Shard> m_shards;   //!< the shards
+  uint32_t m_nShards;            //!< the number of active shards
+  Time m_mergeInterval;          //!< interval between two merges
+  double m_mergeWeight;          //!< weight of the average hit frequency in a merge
+  double m_activeFlows;          //!< number of flows estimated at the last merge
+  EventId m_mergeEvent;          //!< the next merge
+};
+
+} // namespace ns3
+
+#endif /* SRED_SHARD_GROUP_H */
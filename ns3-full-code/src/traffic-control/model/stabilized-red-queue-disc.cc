@@ -23,10 +23,14 @@
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/boolean.h"
 #include "ns3/simulator.h"
 #include "ns3/abort.h"
 #include "ns3/drop-tail-queue.h"
 #include "stabilized-red-queue-disc.h"
+#include <algorithm>
+#include <cmath>
 
 using namespace std;
 
@@ -59,12 +63,79 @@ StabilizedRedQueueDisc::GetTypeId (void)
                 MakeQueueSizeChecker ())
       .AddAttribute ("StabilizedRedMode", "Simple  or Full", IntegerValue (1),
                       MakeIntegerAccessor (&StabilizedRedQueueDisc::stabilizedRedMode),
-                      MakeIntegerChecker<int32_t> ());
+                      MakeIntegerChecker<int32_t> ())
+      .AddAttribute ("ZombieListSize",
+                     "The number of recently seen flows kept in the zombie list",
+                     UintegerValue (MAX_ZOMBIE_LIST_SIZE),
+                     MakeUintegerAccessor (&StabilizedRedQueueDisc::m_zombieListSize),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("ShardGroup",
+                     "The group of shards whose hit frequencies are merged (for a child of MqQueueDisc)",
+                     PointerValue (),
+                     MakePointerAccessor (&StabilizedRedQueueDisc::m_shardGroup),
+                     MakePointerChecker<SredShardGroup> ())
+      .AddAttribute ("AdaptMaxP",
+                     "True to adapt the maximum drop probability and the overwrite probability",
+                     BooleanValue (false),
+                     MakeBooleanAccessor (&StabilizedRedQueueDisc::m_isAdaptMaxP),
+                     MakeBooleanChecker ())
+      .AddAttribute ("QW",
+                     "Queue weight related to the exponential weighted moving average (EWMA)",
+                     DoubleValue (0.002),
+                     MakeDoubleAccessor (&StabilizedRedQueueDisc::m_qW),
+                     MakeDoubleChecker <double> (0, 1))
+      .AddAttribute ("MeanPktSize",
+                     "Average of packet size, used to age the average queue size while the queue is idle",
+                     UintegerValue (500),
+                     MakeUintegerAccessor (&StabilizedRedQueueDisc::m_meanPktSize),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("LinkBandwidth",
+                     "The link bandwidth, used to age the average queue size while the queue is idle",
+                     DataRateValue (DataRate ("1.5Mbps")),
+                     MakeDataRateAccessor (&StabilizedRedQueueDisc::m_linkBandwidth),
+                     MakeDataRateChecker ())
+      .AddAttribute ("Interval",
+                     "Time interval to update the maximum drop probability and the overwrite probability",
+                     TimeValue (Seconds (0.5)),
+                     MakeTimeAccessor (&StabilizedRedQueueDisc::m_interval),
+                     MakeTimeChecker ())
+      .AddAttribute ("Top",
+                     "Upper bound for the maximum drop probability in adaptive mode",
+                     DoubleValue (0.5),
+                     MakeDoubleAccessor (&StabilizedRedQueueDisc::m_top),
+                     MakeDoubleChecker <double> (0, 1))
+      .AddAttribute ("Bottom",
+                     "Lower bound for the maximum drop probability in adaptive mode",
+                     DoubleValue (0.01),
+                     MakeDoubleAccessor (&StabilizedRedQueueDisc::m_bottom),
+                     MakeDoubleChecker <double> (0, 1))
+      .AddAttribute ("OverwriteTop",
+                     "Upper bound for the overwrite probability in adaptive mode",
+                     DoubleValue (0.5),
+                     MakeDoubleAccessor (&StabilizedRedQueueDisc::m_overwriteTop),
+                     MakeDoubleChecker <double> (0, 1))
+      .AddAttribute ("OverwriteBottom",
+                     "Lower bound for the overwrite probability in adaptive mode",
+                     DoubleValue (0.05),
+                     MakeDoubleAccessor (&StabilizedRedQueueDisc::m_overwriteBottom),
+                     MakeDoubleChecker <double> (0, 1))
+      .AddAttribute ("Alpha",
+                     "Increment parameter for the probabilities in adaptive mode",
+                     DoubleValue (0.01),
+                     MakeDoubleAccessor (&StabilizedRedQueueDisc::m_alpha),
+                     MakeDoubleChecker <double> (0, 1))
+      .AddAttribute ("Beta",
+                     "Decrement parameter for the probabilities in adaptive mode",
+                     DoubleValue (0.9),
+                     MakeDoubleAccessor (&StabilizedRedQueueDisc::m_beta),
+                     MakeDoubleChecker <double> (0, 1));
   return tid;
 }
 
 StabilizedRedQueueDisc::StabilizedRedQueueDisc ()
-    : QueueDisc (QueueDiscSizePolicy::SINGLE_INTERNAL_QUEUE)
+    : QueueDisc (QueueDiscSizePolicy::SINGLE_INTERNAL_QUEUE),
+      m_shard (0),
+      m_inShardGroup (false)
 {
   NS_LOG_FUNCTION (this);
   m_uv = CreateObject<UniformRandomVariable> ();
@@ -80,6 +151,12 @@ StabilizedRedQueueDisc::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_uv = 0;
+  if (m_inShardGroup)
+    {
+      m_shardGroup->RemoveShard (m_shard);
+      m_inShardGroup = false;
+    }
+  m_shardGroup = 0;
   QueueDisc::DoDispose ();
 }
 
@@ -91,6 +168,19 @@ StabilizedRedQueueDisc::AssignStreams (int64_t stream)
   return 1;
 }
 
+double
+StabilizedRedQueueDisc::GetHitFrequency (void) const
+{
+  return p_hitFreq;
+}
+
+void
+StabilizedRedQueueDisc::SetHitFrequency (double hitFrequency)
+{
+  NS_LOG_FUNCTION (this << hitFrequency);
+  p_hitFreq = hitFrequency;
+}
+
 void
 StabilizedRedQueueDisc::InitializeParams (void)
 {
@@ -98,15 +188,89 @@ StabilizedRedQueueDisc::InitializeParams (void)
   NS_LOG_INFO ("Initializing Stabilized RED params.");
   zombies = vector<Zombie> ();
   p_hitFreq = 0;
-  alpha = p_overwrite / MAX_ZOMBIE_LIST_SIZE;
+  alpha = p_overwrite / m_zombieListSize;
+  m_qAvg = 0;
+  m_lastSet = Seconds (0);
+  m_ptc = m_linkBandwidth.GetBitRate () / (8.0 * m_meanPktSize);
+  m_idle = true;
+  m_idleTime = NanoSeconds (0);
+
+  if (m_shardGroup && !m_inShardGroup)
+    {
+      m_shard = m_shardGroup->AddShard (MakeCallback (&StabilizedRedQueueDisc::GetHitFrequency, this),
+                                        MakeCallback (&StabilizedRedQueueDisc::SetHitFrequency, this));
+      m_inShardGroup = true;
+    }
+}
+
+// Update p_max and p_overwrite to keep the average queue length within the target range.
+void
+StabilizedRedQueueDisc::UpdateMaxP (double newAve)
+{
+  NS_LOG_FUNCTION (this << newAve);
+
+  Time now = Simulator::Now ();
+  double capacity = GetInternalQueue (0)->GetMaxSize ().GetValue ();
+  double minTh = capacity / 6.0;
+  double maxTh = capacity / 3.0;
+  double part = 0.4 * (maxTh - minTh);
+  // AIMD rule to keep target Q~1/2(minTh + maxTh)
+  if (newAve < minTh + part)
+    {
+      // we should increase the average queue size, so decrease the probabilities
+      if (p_max > m_bottom)
+        {
+          p_max = std::max (p_max * m_beta, m_bottom);
+        }
+      if (p_overwrite > m_overwriteBottom)
+        {
+          p_overwrite = std::max (p_overwrite * m_beta, m_overwriteBottom);
+        }
+      m_lastSet = now;
+    }
+  else if (newAve > maxTh - part)
+    {
+      // we should decrease the average queue size, so increase the probabilities
+      if (m_top > p_max)
+        {
+          p_max = std::min (p_max + std::min (m_alpha, 0.25 * p_max), m_top);
+        }
+      if (m_overwriteTop > p_overwrite)
+        {
+          p_overwrite = std::min (p_overwrite + std::min (m_alpha, 0.25 * p_overwrite), m_overwriteTop);
+        }
+      m_lastSet = now;
+    }
+  // the weight of the hit frequency follows the overwrite probability
+  alpha = p_overwrite / m_zombieListSize;
+  NS_LOG_DEBUG ("p_max " << p_max << " p_overwrite " << p_overwrite);
+}
+
+// Compute the average queue size
+double
+StabilizedRedQueueDisc::Estimator (uint32_t nQueued, uint32_t m, double qAvg, double qW)
+{
+  NS_LOG_FUNCTION (this << nQueued << m << qAvg << qW);
+
+  double newAve = qAvg * std::pow (1.0 - qW, m);
+  newAve += qW * nQueued;
+
+  Time now = Simulator::Now ();
+  if (m_isAdaptMaxP && now > m_lastSet + m_interval)
+    {
+      UpdateMaxP (newAve);
+    }
+
+  return newAve;
 }
 
 // calculate p_sred
 double
 StabilizedRedQueueDisc::calculateProbabilityStabilizedRed()
 {
+    // the queue size and the capacity are both expressed in packets or in bytes
     uint32_t bufferCapacity = GetInternalQueue (0)->GetMaxSize ().GetValue ();
-    uint32_t q = GetInternalQueue (0)->GetNBytes ();
+    uint32_t q = GetInternalQueue (0)->GetCurrentSize ().GetValue ();
 
     double bufferCapacity_3 = (double) bufferCapacity / 3.0;
     double bufferCapacity_6 = (double) bufferCapacity / 6.0;
@@ -189,21 +353,29 @@ StabilizedRedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       }
   }
 
-  int32_t flowID = flowHash;
+  // the zombie list stores and compares the full 32-bit flow hash
+  uint32_t flowID = flowHash;
 
   uint32_t nQueued = GetInternalQueue (0)->GetCurrentSize ().GetValue ();
-  uint32_t capacity = GetInternalQueue (0)->GetMaxSize ().GetValue ();
 
-  if (flowID == -1)
+  if (m_isAdaptMaxP)
     {
-      DropBeforeEnqueue (item, "InvalidFlowID");
+      // simulate the number of packets the link could have sent while the
+      // queue was idle, so that the average decays as in RED
+      uint32_t m = 0;
+      if (m_idle)
+        {
+          m = uint32_t (m_ptc * (Simulator::Now () - m_idleTime).GetSeconds ());
+        }
+      m_qAvg = Estimator (nQueued, m + 1, m_qAvg, m_qW);
     }
+  m_idle = false;
 
   int32_t curZombieSize = zombies.size ();
   // cout<<"curZombieSize: "<<curZombieSize<<endl;
   // cout<<"nQueued: "<<nQueued<<" , Capacity "<<capacity<< ", Percent : "<< nQueued*100.0/capacity<<endl;
 
-  if (curZombieSize < MAX_ZOMBIE_LIST_SIZE) // still has space in zombie list
+  if (static_cast<uint32_t> (curZombieSize) < m_zombieListSize) // still has space in zombie list
     {
       Zombie zombie;
       zombie.flowID = flowID;
@@ -211,7 +383,7 @@ StabilizedRedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       zombies.push_back (zombie);
 
       // if adding packet size doesn't exceed capacity of queue, then enqueue
-        if (nQueued + item->GetSize () <= capacity)
+        if (GetInternalQueue (0)->GetCurrentSize () + item <= GetInternalQueue (0)->GetMaxSize ())
         {
             NS_LOG_DEBUG ("Enqueueing " << item->GetPacket ()->GetUid () << " to queue " << (uint32_t) flowID);
             return GetInternalQueue (0)->Enqueue (item);
@@ -274,7 +446,7 @@ StabilizedRedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       }
     else
       {
-        if(nQueued < capacity)
+        if (GetInternalQueue (0)->GetCurrentSize () + item <= GetInternalQueue (0)->GetMaxSize ())
         {
             return GetInternalQueue (0)->Enqueue (item);
         }
@@ -295,10 +467,14 @@ StabilizedRedQueueDisc::DoDequeue (void)
   if (GetInternalQueue (0)->IsEmpty ())
     {
       NS_LOG_LOGIC ("Queue empty");
+      m_idle = true;
+      m_idleTime = Simulator::Now ();
+
       return 0;
     }
   else
     {
+      m_idle = false;
       Ptr<QueueDiscItem> item = GetInternalQueue (0)->Dequeue ();
 
       NS_LOG_LOGIC ("Popped " << item);
@@ -358,6 +534,13 @@ StabilizedRedQueueDisc::CheckConfig (void)
       NS_LOG_ERROR ("StabilizedRedQueueDisc needs 1 internal queue");
       return false;
     }
+
+  if (m_isAdaptMaxP && (m_bottom > m_top || m_overwriteBottom > m_overwriteTop))
+    {
+      NS_LOG_ERROR ("The lower bounds of the probabilities cannot exceed their upper bounds");
+      return false;
+    }
+
   return true;
 }
 
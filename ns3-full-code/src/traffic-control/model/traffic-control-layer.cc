@@ -61,7 +61,8 @@ TrafficControlLayer::GetInstanceTypeId (void) const
 }
 
 TrafficControlLayer::TrafficControlLayer ()
-  : Object ()
+  : Object (),
+    m_devicesByIndexValid (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -78,6 +79,8 @@ TrafficControlLayer::DoDispose (void)
   m_node = 0;
   m_handlers.clear ();
   m_netDevices.clear ();
+  m_devicesByIndex.clear ();
+  m_devicesByIndexValid = false;
   Object::DoDispose ();
 }
 
@@ -113,6 +116,7 @@ TrafficControlLayer::RegisterProtocolHandler (Node::ProtocolHandler handler,
   entry.promiscuous = false;
 
   m_handlers.push_back (entry);
+  m_devicesByIndexValid = false;
 
   NS_LOG_DEBUG ("Handler for NetDevice: " << device << " registered for protocol " <<
                 protocolType << ".");
@@ -126,6 +130,7 @@ TrafficControlLayer::ScanDevices (void)
   NS_ASSERT_MSG (m_node, "Cannot run ScanDevices without an aggregated node");
 
   NS_LOG_DEBUG ("Scanning devices on node " << m_node->GetId ());
+  m_devicesByIndexValid = false;
   for (uint32_t i = 0; i < m_node->GetNDevices (); i++)
     {
       NS_LOG_DEBUG ("Scanning devices on node " << m_node->GetId ());
@@ -210,6 +215,7 @@ TrafficControlLayer::SetRootQueueDiscOnDevice (Ptr<NetDevice> device, Ptr<QueueD
   NS_LOG_FUNCTION (this << device << qDisc);
 
   std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (device);
+  m_devicesByIndexValid = false;
 
   if (ndi == m_netDevices.end ())
     {
@@ -256,6 +262,7 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device)
 
   NS_ASSERT_MSG (ndi != m_netDevices.end () && ndi->second.m_rootQueueDisc != 0,
                  "No root queue disc installed on device " << device);
+  m_devicesByIndexValid = false;
 
   // remove the root queue disc
   ndi->second.m_rootQueueDisc = 0;
@@ -312,6 +319,59 @@ TrafficControlLayer::GetNDevices (void) const
   return m_node->GetNDevices ();
 }
 
+void
+TrafficControlLayer::UpdateDeviceIndex (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_devicesByIndex.clear ();
+  m_devicesByIndexValid = true;
+  if (m_node == 0)
+    {
+      return;
+    }
+
+  m_devicesByIndex.resize (m_node->GetNDevices ());
+  for (uint32_t i = 0; i < m_devicesByIndex.size (); i++)
+    {
+      Ptr<NetDevice> dev = m_node->GetDevice (i);
+      DeviceIndexEntry &entry = m_devicesByIndex[i];
+      entry.m_device = PeekPointer (dev);
+
+      // entries of a std::map are not moved by insertions and removals of
+      // other entries, and the table is invalidated when this one is removed
+      std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (dev);
+      entry.m_info = (ndi != m_netDevices.end () ? &ndi->second : nullptr);
+
+      for (uint32_t h = 0; h < m_handlers.size (); h++)
+        {
+          if (m_handlers[h].device == 0 || m_handlers[h].device == dev)
+            {
+              entry.m_handlers.push_back (h);
+            }
+        }
+    }
+}
+
+TrafficControlLayer::DeviceIndexEntry *
+TrafficControlLayer::GetDeviceIndexEntry (const Ptr<NetDevice> &device)
+{
+  uint32_t index = device->GetIfIndex ();
+
+  // devices added to the node after the table was built have larger indices
+  if (!m_devicesByIndexValid
+      || (index >= m_devicesByIndex.size () && m_node != 0 && index < m_node->GetNDevices ()))
+    {
+      UpdateDeviceIndex ();
+    }
+
+  if (index < m_devicesByIndex.size () && m_devicesByIndex[index].m_device == PeekPointer (device))
+    {
+      return &m_devicesByIndex[index];
+    }
+  return nullptr;
+}
+
 
 void
 TrafficControlLayer::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
@@ -322,23 +382,44 @@ TrafficControlLayer::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
 
   bool found = false;
 
-  for (ProtocolHandlerList::iterator i = m_handlers.begin ();
-       i != m_handlers.end (); i++)
+  DeviceIndexEntry *entry = GetDeviceIndexEntry (device);
+  if (entry != nullptr)
     {
-      if (i->device == 0
-          || (i->device != 0 && i->device == device))
+      // only the handlers for this device (or for all devices) are checked
+      for (uint32_t h : entry->m_handlers)
         {
-          if (i->protocol == 0
-              || i->protocol == protocol)
+          const ProtocolHandlerEntry &handler = m_handlers[h];
+          if (handler.protocol == 0
+              || handler.protocol == protocol)
             {
               NS_LOG_DEBUG ("Found handler for packet " << p << ", protocol " <<
                             protocol << " and NetDevice " << device <<
                             ". Send packet up");
-              i->handler (device, p, protocol, from, to, packetType);
+              handler.handler (device, p, protocol, from, to, packetType);
               found = true;
             }
         }
     }
+  else
+    {
+      for (ProtocolHandlerList::iterator i = m_handlers.begin ();
+           i != m_handlers.end (); i++)
+        {
+          if (i->device == 0
+              || (i->device != 0 && i->device == device))
+            {
+              if (i->protocol == 0
+                  || i->protocol == protocol)
+                {
+                  NS_LOG_DEBUG ("Found handler for packet " << p << ", protocol " <<
+                                protocol << " and NetDevice " << device <<
+                                ". Send packet up");
+                  i->handler (device, p, protocol, from, to, packetType);
+                  found = true;
+                }
+            }
+        }
+    }
 
   NS_ABORT_MSG_IF (!found, "Handler for protocol " << p << " and device " << device <<
                            " not found. It isn't forwarded up; it dies here.");
@@ -352,13 +433,24 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
   NS_LOG_DEBUG ("Send packet to device " << device << " protocol number " <<
                 item->GetProtocol ());
 
-  Ptr<NetDeviceQueueInterface> devQueueIface;
-  std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (device);
+  NetDeviceInfo *ndi = nullptr;
+  DeviceIndexEntry *entry = GetDeviceIndexEntry (device);
 
-  if (ndi != m_netDevices.end ())
+  if (entry != nullptr)
     {
-      devQueueIface = ndi->second.m_ndqi;
+      ndi = entry->m_info;
     }
+  else
+    {
+      // the device does not belong to the node, or not yet
+      std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator it = m_netDevices.find (device);
+      if (it != m_netDevices.end ())
+        {
+          ndi = &it->second;
+        }
+    }
+
+  Ptr<NetDeviceQueueInterface> devQueueIface = (ndi != nullptr ? ndi->m_ndqi : nullptr);
 
   // determine the transmission queue of the device where the packet will be enqueued
   std::size_t txq = 0;
@@ -375,7 +467,7 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
 
   NS_ASSERT (!devQueueIface || txq < devQueueIface->GetNTxQueues ());
 
-  if (ndi == m_netDevices.end () || ndi->second.m_rootQueueDisc == 0)
+  if (ndi == nullptr || ndi->m_rootQueueDisc == 0)
     {
       // The device has no attached queue disc, thus add the header to the packet and
       // send it directly to the device if the selected queue is not stopped
@@ -401,7 +493,7 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
       // selected for the packet and try to dequeue packets from such queue disc
       item->SetTxQueueIndex (txq);
 
-      Ptr<QueueDisc> qDisc = ndi->second.m_queueDiscsToWake[txq];
+      Ptr<QueueDisc> qDisc = ndi->m_queueDiscsToWake[txq];
       NS_ASSERT (qDisc);
       qDisc->Enqueue (item);
       qDisc->Run ();
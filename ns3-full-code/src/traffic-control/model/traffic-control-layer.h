@@ -231,6 +231,30 @@ private:
   /// Typedef for protocol handlers container
   typedef std::vector<struct ProtocolHandlerEntry> ProtocolHandlerList;
 
+  /**
+   * \brief Information to dispatch packets to or from the device having a
+   *        given interface index, without searching m_netDevices and m_handlers
+   */
+  struct DeviceIndexEntry
+  {
+    NetDevice *m_device;              //!< the device having this interface index
+    NetDeviceInfo *m_info;            //!< the device entry in m_netDevices, if any
+    std::vector<uint32_t> m_handlers; //!< the indices of the handlers for the device in m_handlers
+  };
+
+  /**
+   * \brief Rebuild the table of the devices indexed by interface index
+   */
+  void UpdateDeviceIndex (void);
+
+  /**
+   * \brief Get the entry of the table of the devices indexed by interface
+   *        index for the given device
+   * \param device the device
+   * \return the entry, or a null pointer if the device is not (yet) in the table
+   */
+  DeviceIndexEntry * GetDeviceIndexEntry (const Ptr<NetDevice> &device);
+
   /**
    * \brief Required by the object map accessor
    * \return the number of devices in the m_netDevices map
@@ -248,6 +272,9 @@ private:
   /// Map storing the required information for each device with a queue disc installed
   std::map<Ptr<NetDevice>, NetDeviceInfo> m_netDevices;
   ProtocolHandlerList m_handlers;  //!< List of upper-layer handlers
+  /// Devices of the node indexed by interface index, built from m_netDevices and m_handlers
+  std::vector<DeviceIndexEntry> m_devicesByIndex;
+  bool m_devicesByIndexValid;      //!< True if m_devicesByIndex is up to date
 
   /**
    * The trace source fired when the Traffic Control layer drops a packet because
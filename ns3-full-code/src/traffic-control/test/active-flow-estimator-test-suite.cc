@@ -0,0 +1,259 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/active-flow-estimator.h"
+#include "ns3/red-queue-disc.h"
+#include "ns3/pie-queue-disc.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Active Flow Estimator Test Item, whose hash is the flow identifier
+ */
+class ActiveFlowEstimatorTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param p packet
+   * \param addr address
+   * \param flowId the flow identifier
+   */
+  ActiveFlowEstimatorTestItem (Ptr<Packet> p, const Address & addr, uint32_t flowId);
+  virtual ~ActiveFlowEstimatorTestItem ();
+
+  // Delete copy constructor and assignment operator to avoid misuse
+  ActiveFlowEstimatorTestItem (const ActiveFlowEstimatorTestItem &) = delete;
+  ActiveFlowEstimatorTestItem & operator = (const ActiveFlowEstimatorTestItem &) = delete;
+
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  virtual uint32_t Hash (uint32_t perturbation) const;
+
+private:
+  ActiveFlowEstimatorTestItem ();
+
+  uint32_t m_flowId; ///< the flow identifier
+};
+
+ActiveFlowEstimatorTestItem::ActiveFlowEstimatorTestItem (Ptr<Packet> p, const Address & addr, uint32_t flowId)
+  : QueueDiscItem (p, addr, 0),
+    m_flowId (flowId)
+{
+}
+
+ActiveFlowEstimatorTestItem::~ActiveFlowEstimatorTestItem ()
+{
+}
+
+void
+ActiveFlowEstimatorTestItem::AddHeader (void)
+{
+}
+
+bool
+ActiveFlowEstimatorTestItem::Mark (void)
+{
+  return false;
+}
+
+uint32_t
+ActiveFlowEstimatorTestItem::Hash (uint32_t perturbation) const
+{
+  return m_flowId;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the number of flows estimated by the ActiveFlowEstimator
+ */
+class ActiveFlowEstimatorAccuracyTestCase : public TestCase
+{
+public:
+  ActiveFlowEstimatorAccuracyTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Feed the estimator with packets of flows sending at the same rate
+   * \param nFlows the number of flows
+   * \return the inverse of the hit frequency averaged over the last packets
+   */
+  double EstimateFlows (uint32_t nFlows);
+};
+
+ActiveFlowEstimatorAccuracyTestCase::ActiveFlowEstimatorAccuracyTestCase ()
+  : TestCase ("Check the accuracy of the active flow estimator")
+{
+}
+
+double
+ActiveFlowEstimatorAccuracyTestCase::EstimateFlows (uint32_t nFlows)
+{
+  Ptr<ActiveFlowEstimator> estimator = CreateObject<ActiveFlowEstimator> ();
+  estimator->AssignStreams (1);
+
+  // let the hit frequency converge (its time constant is 4000 packets)
+  // before averaging it
+  double sum = 0;
+  uint32_t samples = 0;
+  for (uint32_t i = 0; i < 200000; i++)
+    {
+      estimator->Update (i % nFlows);
+      if (i >= 100000)
+        {
+          sum += estimator->GetHitFrequency ();
+          samples++;
+        }
+    }
+  return samples / sum;
+}
+
+void
+ActiveFlowEstimatorAccuracyTestCase::DoRun (void)
+{
+  Ptr<ActiveFlowEstimator> estimator = CreateObject<ActiveFlowEstimator> ();
+  NS_TEST_EXPECT_MSG_EQ (estimator->GetActiveFlows (), 1000,
+                         "With no hits, the estimate is bounded by the zombie list size");
+  NS_TEST_EXPECT_MSG_EQ (estimator->GetDropProbabilityScale (), 1,
+                         "With many flows, the drop probability must not be scaled");
+
+  // a single flow hits the zombie list at every packet once it is full
+  for (uint32_t i = 0; i < 100000; i++)
+    {
+      estimator->Update (7);
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (estimator->GetActiveFlows (), 1, 0.01, "Wrong estimate for a single flow");
+  NS_TEST_EXPECT_MSG_EQ_TOL (estimator->GetDropProbabilityScale (), 1.0 / 65536, 1e-6,
+                             "Wrong drop probability scale for a single flow");
+  estimator->Reset ();
+  NS_TEST_EXPECT_MSG_EQ (estimator->GetHitFrequency (), 0, "The hit frequency has not been reset");
+
+  uint32_t flows[] = {10, 50, 100};
+  for (uint32_t nFlows : flows)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (EstimateFlows (nFlows), nFlows, 0.1 * nFlows,
+                                 "Wrong estimate for " << nFlows << " flows");
+    }
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that RED and PIE scale their drop probability by the
+ *        estimated number of active flows
+ */
+class NAwareQueueDiscTestCase : public TestCase
+{
+public:
+  NAwareQueueDiscTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue packets of two flows in a RED queue disc
+   * \param estimator the estimator to attach, if any
+   * \return the number of unforced drops
+   */
+  uint32_t RunRed (Ptr<ActiveFlowEstimator> estimator);
+};
+
+NAwareQueueDiscTestCase::NAwareQueueDiscTestCase ()
+  : TestCase ("Check the N-aware mode of RED and PIE")
+{
+}
+
+uint32_t
+NAwareQueueDiscTestCase::RunRed (Ptr<ActiveFlowEstimator> estimator)
+{
+  Ptr<RedQueueDisc> queue = CreateObject<RedQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MinTh", DoubleValue (70)), true,
+                         "Verify that we can actually set the attribute MinTh");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxTh", DoubleValue (150)), true,
+                         "Verify that we can actually set the attribute MaxTh");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxSize", QueueSizeValue (QueueSize ("300p"))),
+                         true, "Verify that we can actually set the attribute MaxSize");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QW", DoubleValue (0.020)), true,
+                         "Verify that we can actually set the attribute QW");
+  if (estimator)
+    {
+      NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("ActiveFlowEstimator", PointerValue (estimator)),
+                             true, "Verify that we can actually set the attribute ActiveFlowEstimator");
+    }
+  queue->Initialize ();
+  NS_TEST_EXPECT_MSG_EQ (queue->AssignStreams (1), (estimator ? 2 : 1),
+                         "The stream of the estimator must be assigned too");
+
+  Address dest;
+  for (uint32_t i = 0; i < 300; i++)
+    {
+      queue->Enqueue (Create<ActiveFlowEstimatorTestItem> (Create<Packet> (500), dest, i % 2));
+    }
+  return queue->GetStats ().GetNDroppedPackets (RedQueueDisc::UNFORCED_DROP);
+}
+
+void
+NAwareQueueDiscTestCase::DoRun (void)
+{
+  uint32_t drops = RunRed (0);
+  NS_TEST_EXPECT_MSG_GT (drops, 0, "There should be some unforced drops");
+
+  // a short zombie list lets the estimate converge within a few packets
+  Ptr<ActiveFlowEstimator> estimator = CreateObject<ActiveFlowEstimator> ();
+  estimator->SetAttribute ("ZombieListSize", UintegerValue (10));
+  estimator->SetAttribute ("ReferenceFlows", DoubleValue (16));
+  uint32_t nAwareDrops = RunRed (estimator);
+  NS_TEST_EXPECT_MSG_LT (nAwareDrops, drops,
+                         "With two flows, the N-aware mode should drop less packets");
+  NS_TEST_EXPECT_MSG_LT (estimator->GetActiveFlows (), 4, "Wrong estimate for two flows");
+
+  Ptr<PieQueueDisc> pie = CreateObject<PieQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (pie->SetAttributeFailSafe ("ActiveFlowEstimator",
+                                                    PointerValue (CreateObject<ActiveFlowEstimator> ())),
+                         true, "Verify that we can actually set the attribute ActiveFlowEstimator");
+  NS_TEST_EXPECT_MSG_EQ (pie->AssignStreams (1), 2, "The stream of the estimator must be assigned too");
+  pie->Dispose ();
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Active Flow Estimator Test Suite
+ */
+static class ActiveFlowEstimatorTestSuite : public TestSuite
+{
+public:
+  ActiveFlowEstimatorTestSuite ()
+    : TestSuite ("active-flow-estimator", UNIT)
+  {
+    AddTestCase (new ActiveFlowEstimatorAccuracyTestCase (), TestCase::QUICK);
+    AddTestCase (new NAwareQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_activeFlowEstimatorTestSuite; ///< the test suite
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/flow-id-table.h"
+
+#include <set>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that a direct mapped table maps the flow hashes modulo the number of buckets
+ */
+class FlowIdTableDirectMappedTestCase : public TestCase
+{
+public:
+  FlowIdTableDirectMappedTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FlowIdTableDirectMappedTestCase::FlowIdTableDirectMappedTestCase ()
+  : TestCase ("Check the direct mapped flow id table")
+{
+}
+
+void
+FlowIdTableDirectMappedTestCase::DoRun (void)
+{
+  FlowIdTable table;
+  table.Configure (16, 1);
+
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (3), 3, "Unexpected bucket for flow 3");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (35), 3, "Unexpected bucket for flow 35");
+  NS_TEST_EXPECT_MSG_EQ (table.GetNCollisions (), 1, "Flow 35 should collide with flow 3");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (3), 3, "Flow 3 should keep its bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (0xffffffff), 15, "Unexpected bucket for the largest hash");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the insertion, the tag checking and the collisions of a set associative table
+ */
+class FlowIdTableSetAssociativeTestCase : public TestCase
+{
+public:
+  FlowIdTableSetAssociativeTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FlowIdTableSetAssociativeTestCase::FlowIdTableSetAssociativeTestCase ()
+  : TestCase ("Check the set associative flow id table")
+{
+}
+
+void
+FlowIdTableSetAssociativeTestCase::DoRun (void)
+{
+  // 4 sets of 4 buckets
+  FlowIdTable table;
+  table.Configure (16, 4);
+
+  // flows 1, 17, 33 and 49 fall in the first set and get distinct buckets
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (1), 0, "Flow 1 should take the first free bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (17), 1, "Flow 17 should take the first free bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (33), 2, "Flow 33 should take the first free bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (49), 3, "Flow 49 should take the first free bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (17), 1, "Flow 17 should keep its bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (1), 0, "Flow 1 should keep its bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (6), 4, "Flow 6 falls in the second set");
+  NS_TEST_EXPECT_MSG_EQ (table.GetNCollisions (), 0, "No flows should have collided");
+
+  // the first set is full and there is no overflow area: flows 65 and 81
+  // share the first bucket with flow 1
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (65), 0, "Flow 65 should share the first bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (81), 0, "Flow 81 should share the first bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.GetNCollisions (), 1, "The first bucket should have started being shared once");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (1), 0, "Flow 1 should keep its bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (33), 2, "Flow 33 should keep its bucket");
+
+  // the flows without a bucket of their own share the first bucket while it
+  // is held, even if another bucket of the set is released
+  table.Release (3);
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (65), 0, "Flow 65 should keep the first bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (97), 0, "Flow 97 should share the first bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (49), 0, "Flow 49 should share the first bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (6), 4, "Flow 6 should keep its bucket in the second set");
+
+  // once the first bucket is released, the flows which shared it are new flows
+  table.Release (0);
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (81), 0, "Flow 81 should take the released bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (65), 3, "Flow 65 should take the released bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.GetNCollisions (), 1, "No further flows should have collided");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the flows colliding in a full set are kept apart by the overflow area
+ */
+class FlowIdTableOverflowTestCase : public TestCase
+{
+public:
+  FlowIdTableOverflowTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FlowIdTableOverflowTestCase::FlowIdTableOverflowTestCase ()
+  : TestCase ("Check the overflow area of the flow id table")
+{
+}
+
+void
+FlowIdTableOverflowTestCase::DoRun (void)
+{
+  // 4 sets of 4 buckets, followed by 3 overflow buckets
+  FlowIdTable table;
+  table.Configure (16, 4, 3);
+  NS_TEST_ASSERT_MSG_EQ (table.GetNBuckets (), 19, "Unexpected number of buckets");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNOverflowBuckets (), 3, "Unexpected number of overflow buckets");
+
+  // 9 flows fall in the first set: 4 take the buckets of the set, 3 the
+  // buckets of the overflow area and the last 2 share the first bucket
+  std::vector<uint32_t> buckets;
+  for (uint32_t flow = 1; flow <= 129; flow += 16)
+    {
+      buckets.push_back (table.Lookup (flow));
+    }
+  std::vector<uint32_t> expected = {0, 1, 2, 3, 16, 17, 18, 0, 0};
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (buckets[i], expected[i], "Unexpected bucket for flow " << 1 + 16 * i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (std::set<uint32_t> (buckets.begin (), buckets.end ()).size (), 7,
+                         "The flows should have been assigned 7 distinct buckets");
+  NS_TEST_EXPECT_MSG_EQ (table.GetNCollisions (), 1, "The first bucket should have started being shared once");
+
+  // every flow keeps its bucket, and the overflow area is shared with the other sets
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (table.Lookup (1 + 16 * i), expected[i], "Flow " << 1 + 16 * i << " should keep its bucket");
+    }
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (6), 4, "Flow 6 falls in the second set");
+
+  // a flow keeps its overflow bucket while it is held, even if a bucket of
+  // its set is released; the released overflow bucket is reused
+  table.Release (1);
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (81), 17, "Flow 81 should keep its overflow bucket");
+  table.Release (17);
+  table.Release (0);
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (81), 0, "Flow 81 should take the first free bucket of its set");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (113), 1, "Flow 113 should take the first free bucket of its set");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (145), 17, "Flow 145 should take the released overflow bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (161), 0, "Flow 161 should share the first bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.GetNCollisions (), 2, "The first bucket should have started being shared twice");
+
+  // the first bucket of the overflow area follows the last set
+  FlowIdTable small;
+  small.Configure (8, 4, 1);
+  for (uint32_t flow = 4; flow <= 28; flow += 8)
+    {
+      NS_TEST_EXPECT_MSG_EQ (small.Lookup (flow), 4 + flow / 8, "Flow " << flow << " should take a bucket of the last set");
+    }
+  NS_TEST_EXPECT_MSG_EQ (small.Lookup (36), 8, "Flow 36 should take the overflow bucket");
+  NS_TEST_EXPECT_MSG_EQ (small.Lookup (36), 8, "Flow 36 should keep the overflow bucket");
+  NS_TEST_EXPECT_MSG_EQ (small.Lookup (44), 4, "Flow 44 should share the first bucket of the last set");
+  NS_TEST_EXPECT_MSG_EQ (small.GetNCollisions (), 1, "Only flow 44 should have collided");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Flow Id Table Test Suite
+ */
+static class FlowIdTableTestSuite : public TestSuite
+{
+public:
+  FlowIdTableTestSuite ()
+    : TestSuite ("flow-id-table", UNIT)
+  {
+    AddTestCase (new FlowIdTableDirectMappedTestCase (), TestCase::QUICK);
+    AddTestCase (new FlowIdTableSetAssociativeTestCase (), TestCase::QUICK);
+    AddTestCase (new FlowIdTableOverflowTestCase (), TestCase::QUICK);
+  }
+} g_flowIdTableTestSuite; ///< the test suite
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/sred-shard-group.h"
+#include "ns3/double.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief A shard holding a hit frequency
+ */
+class SredShardGroupTestShard
+{
+public:
+  /**
+   * Constructor
+   * \param hitFrequency the initial hit frequency
+   */
+  SredShardGroupTestShard (double hitFrequency)
+    : m_hitFrequency (hitFrequency)
+  {
+  }
+  /**
+   * \return the hit frequency
+   */
+  double GetHitFrequency (void) const
+  {
+    return m_hitFrequency;
+  }
+  /**
+   * \param hitFrequency the hit frequency
+   */
+  void SetHitFrequency (double hitFrequency)
+  {
+    m_hitFrequency = hitFrequency;
+  }
+
+  double m_hitFrequency; ///< the hit frequency
+};
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the merge of the hit frequencies of the shards
+ */
+class SredShardGroupMergeTestCase : public TestCase
+{
+public:
+  SredShardGroupMergeTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Add a shard to a group
+   * \param group the group
+   * \param shard the shard
+   * \return the identifier of the shard in the group
+   */
+  uint32_t AddShard (Ptr<SredShardGroup> group, SredShardGroupTestShard *shard);
+};
+
+SredShardGroupMergeTestCase::SredShardGroupMergeTestCase ()
+  : TestCase ("Check the merge of the hit frequencies of the shards")
+{
+}
+
+uint32_t
+SredShardGroupMergeTestCase::AddShard (Ptr<SredShardGroup> group, SredShardGroupTestShard *shard)
+{
+  return group->AddShard (MakeCallback (&SredShardGroupTestShard::GetHitFrequency, shard),
+                          MakeCallback (&SredShardGroupTestShard::SetHitFrequency, shard));
+}
+
+void
+SredShardGroupMergeTestCase::DoRun (void)
+{
+  SredShardGroupTestShard a (0.1);
+  SredShardGroupTestShard b (0.5);
+  SredShardGroupTestShard c (0);
+
+  Ptr<SredShardGroup> group = CreateObject<SredShardGroup> ();
+  uint32_t ida = AddShard (group, &a);
+  uint32_t idb = AddShard (group, &b);
+  uint32_t idc = AddShard (group, &c);
+  NS_TEST_EXPECT_MSG_EQ (group->GetNShards (), 3, "Unexpected number of shards");
+
+  // 10 + 2 flows over the two shards having an estimate: 6 flows on average
+  group->Merge ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (group->GetActiveFlows (), 12, 1e-9, "Unexpected number of flows");
+  NS_TEST_EXPECT_MSG_EQ_TOL (a.m_hitFrequency, 0.5 * 0.1 + 0.5 / 6, 1e-9, "Unexpected hit frequency");
+  NS_TEST_EXPECT_MSG_EQ_TOL (b.m_hitFrequency, 0.5 * 0.5 + 0.5 / 6, 1e-9, "Unexpected hit frequency");
+  NS_TEST_EXPECT_MSG_EQ (c.m_hitFrequency, 0, "A shard with no estimate must not be merged");
+
+  group->RemoveShard (idb);
+  group->RemoveShard (idc);
+  group->Merge ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (group->GetActiveFlows (), 1 / a.m_hitFrequency, 1e-9,
+                             "Removed shards must not be merged");
+  group->RemoveShard (ida);
+  NS_TEST_EXPECT_MSG_EQ (group->GetNShards (), 0, "Unexpected number of shards");
+  group->Dispose ();
+
+  // periodic merges
+  a.m_hitFrequency = 0.1;
+  b.m_hitFrequency = 0.5;
+  group = CreateObjectWithAttributes<SredShardGroup> ("MergeInterval", TimeValue (Seconds (1)),
+                                                      "MergeWeight", DoubleValue (1));
+  ida = AddShard (group, &a);
+  idb = AddShard (group, &b);
+  Simulator::Stop (Seconds (1.5));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (a.m_hitFrequency, 1.0 / 6, 1e-9, "The shards should have been merged");
+  NS_TEST_EXPECT_MSG_EQ_TOL (b.m_hitFrequency, 1.0 / 6, 1e-9, "The shards should have been merged");
+  group->RemoveShard (ida);
+  group->RemoveShard (idb);
+  group->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Sred Shard Group Test Suite
+ */
+static class SredShardGroupTestSuite : public TestSuite
+{
+public:
+  SredShardGroupTestSuite ()
+    : TestSuite ("sred-shard-group", UNIT)
+  {
+    AddTestCase (new SredShardGroupMergeTestCase (), TestCase::QUICK);
+  }
+} g_sredShardGroupTestSuite; ///< the test suite
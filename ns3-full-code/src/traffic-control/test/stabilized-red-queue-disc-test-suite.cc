@@ -0,0 +1,888 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/stabilized-red-queue-disc.h"
+#include "ns3/es-red-queue-disc.h"
+#include "ns3/mq-queue-disc.h"
+#include "ns3/sred-shard-group.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/integer.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/simulator.h"
+#include <cmath>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Stabilized RED Queue Disc Test Item, whose hash is the identifier of its flow
+ */
+class StabilizedRedQueueDiscTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param addr the address
+   * \param flow the identifier of the flow
+   */
+  StabilizedRedQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint32_t flow);
+  virtual ~StabilizedRedQueueDiscTestItem ();
+
+  // Delete copy constructor and assignment operator to avoid misuse
+  StabilizedRedQueueDiscTestItem (const StabilizedRedQueueDiscTestItem &) = delete;
+  StabilizedRedQueueDiscTestItem & operator = (const StabilizedRedQueueDiscTestItem &) = delete;
+
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  virtual uint32_t Hash (uint32_t perturbation) const;
+
+private:
+  StabilizedRedQueueDiscTestItem ();
+
+  uint32_t m_flow; ///< the identifier of the flow
+};
+
+StabilizedRedQueueDiscTestItem::StabilizedRedQueueDiscTestItem (Ptr<Packet> p, const Address & addr,
+                                                                uint32_t flow)
+  : QueueDiscItem (p, addr, 0),
+    m_flow (flow)
+{
+}
+
+StabilizedRedQueueDiscTestItem::~StabilizedRedQueueDiscTestItem ()
+{
+}
+
+void
+StabilizedRedQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+StabilizedRedQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+uint32_t
+StabilizedRedQueueDiscTestItem::Hash (uint32_t perturbation) const
+{
+  return m_flow;
+}
+
+/**
+ * Enqueue packets of a flow
+ * \param queue the queue disc
+ * \param flow the identifier of the flow
+ * \param size the size of the packets
+ * \param nPkt the number of packets
+ * \return the number of packets accepted by the queue disc
+ */
+static uint32_t
+EnqueueFlow (Ptr<QueueDisc> queue, uint32_t flow, uint32_t size, uint32_t nPkt)
+{
+  Address dest;
+  uint32_t accepted = 0;
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      if (queue->Enqueue (Create<StabilizedRedQueueDiscTestItem> (Create<Packet> (size), dest, flow)))
+        {
+          accepted++;
+        }
+    }
+  return accepted;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the packets filling the zombie list are not dropped early
+ */
+template <typename QueueDiscType>
+class StabilizedRedZombieFillTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the name of the queue disc
+   */
+  StabilizedRedZombieFillTestCase (std::string name);
+private:
+  virtual void DoRun (void);
+};
+
+template <typename QueueDiscType>
+StabilizedRedZombieFillTestCase<QueueDiscType>::StabilizedRedZombieFillTestCase (std::string name)
+  : TestCase ("Check the zombie list fill of " + name)
+{
+}
+
+template <typename QueueDiscType>
+void
+StabilizedRedZombieFillTestCase<QueueDiscType>::DoRun (void)
+{
+  // the queue reaches a third of its capacity while the zombie list is filled:
+  // with the maximum drop probability, a full zombie list would zap every packet
+  Ptr<QueueDiscType> queue = CreateObjectWithAttributes<QueueDiscType> (
+      "MaxSize", QueueSizeValue (QueueSize ("30p")),
+      "ZombieListSize", UintegerValue (10),
+      "MaximumDropProbability", DoubleValue (1));
+  queue->AssignStreams (1);
+  queue->Initialize ();
+
+  // the size of the packets does not count in packet mode
+  for (uint32_t flow = 1; flow <= 10; flow++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (EnqueueFlow (queue, flow, 1000, 1), 1,
+                             "The packets filling the zombie list should be enqueued");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 10, "Unexpected number of packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetHitFrequency (), 0, "No zombie should have been compared yet");
+
+  NS_TEST_EXPECT_MSG_EQ (EnqueueFlow (queue, 11, 1000, 1), 0,
+                         "Once the zombie list is full, the packet should be zapped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNDroppedPackets ("Zap"), 1, "Unexpected number of zaps");
+  queue->Dispose ();
+
+  // the packets exceeding the capacity are dropped while filling the zombie list
+  queue = CreateObjectWithAttributes<QueueDiscType> (
+      "MaxSize", QueueSizeValue (QueueSize ("2500B")),
+      "ZombieListSize", UintegerValue (10));
+  queue->Initialize ();
+  NS_TEST_EXPECT_MSG_EQ (EnqueueFlow (queue, 1, 1000, 3), 2, "The third packet should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNDroppedPackets ("QUEUE_OVERFLOW"), 1,
+                         "Unexpected number of overflows");
+  queue->Dispose ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the update of the hit frequency
+ */
+template <typename QueueDiscType>
+class StabilizedRedHitAccountingTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the name of the queue disc
+   */
+  StabilizedRedHitAccountingTestCase (std::string name);
+private:
+  virtual void DoRun (void);
+};
+
+template <typename QueueDiscType>
+StabilizedRedHitAccountingTestCase<QueueDiscType>::StabilizedRedHitAccountingTestCase (std::string name)
+  : TestCase ("Check the hit accounting of " + name)
+{
+}
+
+template <typename QueueDiscType>
+void
+StabilizedRedHitAccountingTestCase<QueueDiscType>::DoRun (void)
+{
+  // alpha = OverwriteProbability / ZombieListSize = 0.1
+  Ptr<QueueDiscType> queue = CreateObjectWithAttributes<QueueDiscType> (
+      "MaxSize", QueueSizeValue (QueueSize ("1000p")),
+      "ZombieListSize", UintegerValue (5),
+      "OverwriteProbability", DoubleValue (0.5),
+      "MaximumDropProbability", DoubleValue (0));
+  queue->AssignStreams (1);
+  queue->Initialize ();
+
+  // all the zombies belong to flow 7, hence every comparison is a hit
+  EnqueueFlow (queue, 7, 100, 5);
+  NS_TEST_EXPECT_MSG_EQ (queue->GetHitFrequency (), 0, "No zombie should have been compared yet");
+  EnqueueFlow (queue, 7, 100, 20);
+  NS_TEST_EXPECT_MSG_EQ_TOL (queue->GetHitFrequency (), 1 - std::pow (0.9, 20), 1e-9,
+                             "Unexpected hit frequency after 20 hits");
+
+  // a packet of another flow misses
+  EnqueueFlow (queue, 8, 100, 1);
+  NS_TEST_EXPECT_MSG_EQ_TOL (queue->GetHitFrequency (), 0.9 * (1 - std::pow (0.9, 20)), 1e-9,
+                             "Unexpected hit frequency after a miss");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 26, "No packet should have been dropped");
+  queue->Dispose ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the zap probability in packet and byte mode
+ *
+ * A single flow keeps the hit frequency to 1, hence the zap probability is
+ * p_sred / 256 in the simple mode and p_sred / 128 in the full mode, where
+ * p_sred is MaximumDropProbability when the queue holds at least a third of
+ * its capacity, a quarter of it when the queue holds between a sixth and a
+ * third of its capacity, and zero below.
+ */
+template <typename QueueDiscType>
+class StabilizedRedZapTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the name of the queue disc
+   * \param mode the StabilizedRedMode (1 for simple, 2 for full)
+   * \param unit the unit of the queue size
+   */
+  StabilizedRedZapTestCase (std::string name, int32_t mode, QueueSizeUnit unit);
+private:
+  virtual void DoRun (void);
+  /**
+   * Count the packets zapped while the queue size is kept constant
+   * \param backlog the number of packets kept in the queue
+   * \param nPkt the number of packets enqueued
+   * \return the number of zapped packets
+   */
+  uint32_t RunZap (uint32_t backlog, uint32_t nPkt);
+
+  int32_t m_mode;         ///< the StabilizedRedMode
+  QueueSizeUnit m_unit;   ///< the unit of the queue size
+};
+
+template <typename QueueDiscType>
+StabilizedRedZapTestCase<QueueDiscType>::StabilizedRedZapTestCase (std::string name, int32_t mode,
+                                                                  QueueSizeUnit unit)
+  : TestCase ("Check the zap probability of " + name + " in "
+              + (mode == 1 ? "simple" : "full") + " mode with a queue size in "
+              + (unit == QueueSizeUnit::PACKETS ? "packets" : "bytes")),
+    m_mode (mode),
+    m_unit (unit)
+{
+}
+
+template <typename QueueDiscType>
+uint32_t
+StabilizedRedZapTestCase<QueueDiscType>::RunZap (uint32_t backlog, uint32_t nPkt)
+{
+  uint32_t pktSize = 100;
+  uint32_t capacity = 300;
+  if (m_unit == QueueSizeUnit::BYTES)
+    {
+      capacity *= pktSize;
+    }
+
+  // a single zombie, always hit, and a hit frequency reflecting the last
+  // comparison only
+  Ptr<QueueDiscType> queue = CreateObjectWithAttributes<QueueDiscType> (
+      "MaxSize", QueueSizeValue (QueueSize (m_unit, capacity)),
+      "ZombieListSize", UintegerValue (1),
+      "OverwriteProbability", DoubleValue (1),
+      "MaximumDropProbability", DoubleValue (0),
+      "StabilizedRedMode", IntegerValue (m_mode));
+  queue->AssignStreams (1);
+  queue->Initialize ();
+
+  EnqueueFlow (queue, 1, pktSize, backlog);
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), backlog, "No packet should have been dropped");
+  queue->SetAttribute ("MaximumDropProbability", DoubleValue (1));
+
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      if (EnqueueFlow (queue, 1, pktSize, 1))
+        {
+          queue->Dequeue ();
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetHitFrequency (), 1, "Every comparison should be a hit");
+
+  uint32_t zaps = queue->GetStats ().GetNDroppedPackets ("Zap");
+  queue->Dispose ();
+  return zaps;
+}
+
+template <typename QueueDiscType>
+void
+StabilizedRedZapTestCase<QueueDiscType>::DoRun (void)
+{
+  // the Time objects created before the simulation starts are recorded in
+  // case the time resolution changes: start the (empty) simulation so that
+  // the timestamps of the items do not pay for this bookkeeping
+  Simulator::Run ();
+
+  uint32_t nPkt = 50000;
+  double divisor = (m_mode == 1 ? 256 : 128);
+
+  // at least a third of the capacity
+  double expected = nPkt / divisor;
+  NS_TEST_EXPECT_MSG_EQ_TOL (RunZap (200, nPkt), expected, 0.25 * expected,
+                             "Unexpected number of zaps above a third of the capacity");
+
+  // between a sixth and a third of the capacity
+  expected = nPkt / divisor / 4;
+  NS_TEST_EXPECT_MSG_EQ_TOL (RunZap (75, nPkt), expected, 0.25 * expected,
+                             "Unexpected number of zaps between a sixth and a third of the capacity");
+
+  // below a sixth of the capacity
+  NS_TEST_EXPECT_MSG_EQ (RunZap (40, nPkt), 0,
+                         "No packet should be zapped below a sixth of the capacity");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the adaptive mode of Stabilized RED
+ *
+ * With a capacity of 60 packets, the target range of the average queue size
+ * is [10, 20]: the probabilities are increased above 16 packets and decreased
+ * below 14 packets, at most once per Interval.
+ */
+class StabilizedRedAdaptMaxPTestCase : public TestCase
+{
+public:
+  StabilizedRedAdaptMaxPTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the maximum drop probability and the overwrite probability
+   * \param queue the queue disc
+   * \param maxP the expected maximum drop probability
+   * \param overwrite the expected overwrite probability
+   * \param msg the message printed on failure
+   */
+  void CheckProbabilities (Ptr<StabilizedRedQueueDisc> queue, double maxP, double overwrite,
+                           std::string msg);
+  /**
+   * Enqueue packets of flow 1
+   * \param queue the queue disc
+   * \param nPkt the number of packets
+   */
+  void Enqueue (Ptr<StabilizedRedQueueDisc> queue, uint32_t nPkt);
+  /**
+   * Dequeue all the packets and try once more, which makes the queue idle
+   * \param queue the queue disc
+   */
+  void Drain (Ptr<StabilizedRedQueueDisc> queue);
+  /**
+   * Check the adjustment of the probabilities across the thresholds
+   */
+  void RunThresholds (void);
+  /**
+   * Check that the average queue size decays while the queue is idle
+   */
+  void RunIdle (void);
+};
+
+StabilizedRedAdaptMaxPTestCase::StabilizedRedAdaptMaxPTestCase ()
+  : TestCase ("Check the adaptive mode of SRED")
+{
+}
+
+void
+StabilizedRedAdaptMaxPTestCase::CheckProbabilities (Ptr<StabilizedRedQueueDisc> queue, double maxP,
+                                                    double overwrite, std::string msg)
+{
+  DoubleValue value;
+  queue->GetAttribute ("MaximumDropProbability", value);
+  NS_TEST_EXPECT_MSG_EQ_TOL (value.Get (), maxP, 1e-9, "Unexpected p_max " << msg);
+  queue->GetAttribute ("OverwriteProbability", value);
+  NS_TEST_EXPECT_MSG_EQ_TOL (value.Get (), overwrite, 1e-9, "Unexpected overwrite probability " << msg);
+}
+
+void
+StabilizedRedAdaptMaxPTestCase::Enqueue (Ptr<StabilizedRedQueueDisc> queue, uint32_t nPkt)
+{
+  EnqueueFlow (queue, 1, 100, nPkt);
+}
+
+void
+StabilizedRedAdaptMaxPTestCase::Drain (Ptr<StabilizedRedQueueDisc> queue)
+{
+  while (queue->Dequeue ())
+    {
+    }
+}
+
+void
+StabilizedRedAdaptMaxPTestCase::RunThresholds (void)
+{
+  // with QW = 1, the average queue size is the current queue size
+  Ptr<StabilizedRedQueueDisc> queue = CreateObjectWithAttributes<StabilizedRedQueueDisc> (
+      "MaxSize", QueueSizeValue (QueueSize ("60p")),
+      "MaximumDropProbability", DoubleValue (0.1),
+      "OverwriteProbability", DoubleValue (0.25),
+      "AdaptMaxP", BooleanValue (true),
+      "QW", DoubleValue (1),
+      "Interval", TimeValue (Seconds (0.5)),
+      "OverwriteTop", DoubleValue (0.265),
+      "OverwriteBottom", DoubleValue (0.25));
+  queue->AssignStreams (1);
+  queue->Initialize ();
+
+  // no update before the first Interval has elapsed
+  EnqueueFlow (queue, 1, 100, 20);
+  CheckProbabilities (queue, 0.1, 0.25, "before the first Interval");
+
+  // above the upper part of the range: additive increase, capped by OverwriteTop
+  Simulator::Schedule (Seconds (1), &StabilizedRedAdaptMaxPTestCase::Enqueue, this, queue, 1);
+  Simulator::Schedule (Seconds (1), &StabilizedRedAdaptMaxPTestCase::CheckProbabilities, this,
+                       queue, 0.11, 0.26, "after the first increase");
+  Simulator::Schedule (Seconds (1.2), &StabilizedRedAdaptMaxPTestCase::Enqueue, this, queue, 1);
+  Simulator::Schedule (Seconds (1.2), &StabilizedRedAdaptMaxPTestCase::CheckProbabilities, this,
+                       queue, 0.11, 0.26, "within the Interval");
+  Simulator::Schedule (Seconds (1.6), &StabilizedRedAdaptMaxPTestCase::Enqueue, this, queue, 1);
+  Simulator::Schedule (Seconds (1.6), &StabilizedRedAdaptMaxPTestCase::CheckProbabilities, this,
+                       queue, 0.12, 0.265, "after the second increase");
+
+  // below the lower part of the range: multiplicative decrease, bounded by OverwriteBottom
+  Simulator::Schedule (Seconds (1.7), &StabilizedRedAdaptMaxPTestCase::Drain, this, queue);
+  Simulator::Schedule (Seconds (2.2), &StabilizedRedAdaptMaxPTestCase::Enqueue, this, queue, 1);
+  Simulator::Schedule (Seconds (2.2), &StabilizedRedAdaptMaxPTestCase::CheckProbabilities, this,
+                       queue, 0.108, 0.25, "after the decrease");
+
+  // within the range: no change
+  Simulator::Schedule (Seconds (2.3), &StabilizedRedAdaptMaxPTestCase::Enqueue, this, queue, 14);
+  Simulator::Schedule (Seconds (3), &StabilizedRedAdaptMaxPTestCase::Enqueue, this, queue, 1);
+  Simulator::Schedule (Seconds (3), &StabilizedRedAdaptMaxPTestCase::CheckProbabilities, this,
+                       queue, 0.108, 0.25, "within the target range");
+
+  Simulator::Run ();
+  queue->Dispose ();
+  Simulator::Destroy ();
+}
+
+void
+StabilizedRedAdaptMaxPTestCase::RunIdle (void)
+{
+  // 1000 packets per second: the average is negligible after an idle second,
+  // whereas without the decay it would be about half of the previous backlog
+  Ptr<StabilizedRedQueueDisc> queue = CreateObjectWithAttributes<StabilizedRedQueueDisc> (
+      "MaxSize", QueueSizeValue (QueueSize ("60p")),
+      "MaximumDropProbability", DoubleValue (0.1),
+      "AdaptMaxP", BooleanValue (true),
+      "QW", DoubleValue (0.5),
+      "Interval", TimeValue (Seconds (0.5)),
+      "MeanPktSize", UintegerValue (500),
+      "LinkBandwidth", DataRateValue (DataRate ("4Mbps")));
+  queue->AssignStreams (1);
+  queue->Initialize ();
+
+  EnqueueFlow (queue, 1, 100, 40);
+  Drain (queue);
+  Simulator::Schedule (Seconds (1), &StabilizedRedAdaptMaxPTestCase::Enqueue, this, queue, 1);
+  Simulator::Schedule (Seconds (1), &StabilizedRedAdaptMaxPTestCase::CheckProbabilities, this,
+                       queue, 0.09, 0.225, "after an idle period");
+
+  Simulator::Run ();
+  queue->Dispose ();
+  Simulator::Destroy ();
+}
+
+void
+StabilizedRedAdaptMaxPTestCase::DoRun (void)
+{
+  RunThresholds ();
+  RunIdle ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the shards installed as the children of a MqQueueDisc
+ *
+ * The two children of a MqQueueDisc share a SredShardGroup.  The first child
+ * receives a single flow, hence its hit frequency tends to 1, while the
+ * second one receives ten flows.  Every MergeInterval, the group must
+ * estimate the flows of both children and, with a MergeWeight of 1, set the
+ * hit frequency of both children to the one of a child carrying the average
+ * number of flows.  The children leave the group when the MqQueueDisc
+ * releases them.
+ */
+template <typename QueueDiscType>
+class StabilizedRedMqShardTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the name of the queue disc
+   */
+  StabilizedRedMqShardTestCase (std::string name);
+private:
+  virtual void DoRun (void);
+};
+
+template <typename QueueDiscType>
+StabilizedRedMqShardTestCase<QueueDiscType>::StabilizedRedMqShardTestCase (std::string name)
+  : TestCase ("Check the shards of " + name + " under a MqQueueDisc")
+{
+}
+
+template <typename QueueDiscType>
+void
+StabilizedRedMqShardTestCase<QueueDiscType>::DoRun (void)
+{
+  Ptr<SredShardGroup> group = CreateObjectWithAttributes<SredShardGroup> ("MergeInterval", TimeValue (Seconds (1)),
+                                                                          "MergeWeight", DoubleValue (1));
+  Ptr<MqQueueDisc> mq = CreateObject<MqQueueDisc> ();
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<QueueDiscType> child = CreateObjectWithAttributes<QueueDiscType> (
+          "MaxSize", QueueSizeValue (QueueSize ("10000p")),
+          "ZombieListSize", UintegerValue (10),
+          "MaximumDropProbability", DoubleValue (0),
+          "ShardGroup", PointerValue (group));
+      child->AssignStreams (i + 1);
+      Ptr<QueueDiscClass> c = CreateObject<QueueDiscClass> ();
+      c->SetQueueDisc (child);
+      mq->AddQueueDiscClass (c);
+    }
+  mq->Initialize ();
+  NS_TEST_ASSERT_MSG_EQ (group->GetNShards (), 2, "Every child should be a shard of the group");
+
+  Ptr<QueueDiscType> single = DynamicCast<QueueDiscType> (mq->GetQueueDiscClass (0)->GetQueueDisc ());
+  Ptr<QueueDiscType> multi = DynamicCast<QueueDiscType> (mq->GetQueueDiscClass (1)->GetQueueDisc ());
+  EnqueueFlow (single, 1, 100, 1000);
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      EnqueueFlow (multi, i % 10, 100, 1);
+    }
+
+  double singleHitFrequency = single->GetHitFrequency ();
+  double multiHitFrequency = multi->GetHitFrequency ();
+  NS_TEST_ASSERT_MSG_GT (singleHitFrequency, 0.9, "A single flow should hit almost always");
+  NS_TEST_ASSERT_MSG_LT (multiHitFrequency, 0.5, "Ten flows should rarely hit");
+
+  // the first merge happens after one second
+  Simulator::Stop (Seconds (1.5));
+  Simulator::Run ();
+
+  double flows = 1 / singleHitFrequency + 1 / multiHitFrequency;
+  NS_TEST_EXPECT_MSG_EQ_TOL (group->GetActiveFlows (), flows, 1e-9,
+                             "The group should sum up the flows of the children");
+  NS_TEST_EXPECT_MSG_EQ_TOL (single->GetHitFrequency (), 2 / flows, 1e-9,
+                             "The hit frequency should be shared by the children");
+  NS_TEST_EXPECT_MSG_EQ_TOL (multi->GetHitFrequency (), 2 / flows, 1e-9,
+                             "The hit frequency should be shared by the children");
+
+  // the children are disposed of, and leave the group, when they are destroyed
+  single = 0;
+  multi = 0;
+  mq->Dispose ();
+  NS_TEST_EXPECT_MSG_EQ (group->GetNShards (), 0, "The children should have left the group");
+  group->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * Enqueue packets of 20 flows in a round robin fashion, one packet every
+ * millisecond, and dequeue a packet every other millisecond
+ * \param queue the queue disc
+ * \param start the time of the first packet
+ * \param nPkt the number of packets
+ */
+static void
+ScheduleTraffic (Ptr<QueueDisc> queue, Time start, uint32_t nPkt)
+{
+  Address dest;
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      Simulator::Schedule (start + MilliSeconds (i), &QueueDisc::Enqueue, queue,
+                           Create<StabilizedRedQueueDiscTestItem> (Create<Packet> (100), dest, i % 20 + 1));
+      if (i % 2)
+        {
+          Simulator::Schedule (start + MilliSeconds (i), &QueueDisc::Dequeue, queue);
+        }
+    }
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that ESRED behaves as SRED when the zombies are not protected
+ */
+class ESRedQueueDiscSredEquivalenceTestCase : public TestCase
+{
+public:
+  ESRedQueueDiscSredEquivalenceTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+ESRedQueueDiscSredEquivalenceTestCase::ESRedQueueDiscSredEquivalenceTestCase ()
+  : TestCase ("Check that ESRED with a null half-life behaves as SRED")
+{
+}
+
+void
+ESRedQueueDiscSredEquivalenceTestCase::DoRun (void)
+{
+  Ptr<StabilizedRedQueueDisc> sred = CreateObjectWithAttributes<StabilizedRedQueueDisc> (
+      "MaxSize", QueueSizeValue (QueueSize ("1000p")),
+      "ZombieListSize", UintegerValue (10));
+  Ptr<ESRedQueueDisc> esred = CreateObjectWithAttributes<ESRedQueueDisc> (
+      "MaxSize", QueueSizeValue (QueueSize ("1000p")),
+      "ZombieListSize", UintegerValue (10),
+      "OverwriteDecay", EnumValue (ESRedQueueDisc::AGE),
+      "HalfLife", TimeValue (Seconds (0)));
+  sred->AssignStreams (1);
+  esred->AssignStreams (1);
+  sred->Initialize ();
+  esred->Initialize ();
+
+  ScheduleTraffic (sred, Seconds (0), 1000);
+  ScheduleTraffic (esred, Seconds (0), 1000);
+  Simulator::Run ();
+
+  QueueDisc::Stats sredStats = sred->GetStats ();
+  QueueDisc::Stats esredStats = esred->GetStats ();
+  NS_TEST_EXPECT_MSG_GT (sredStats.GetNDroppedPackets ("Zap"), 0, "SRED should have zapped packets");
+  NS_TEST_EXPECT_MSG_EQ (esredStats.GetNDroppedPackets ("Zap"), sredStats.GetNDroppedPackets ("Zap"),
+                         "ESRED and SRED should zap the same packets");
+  NS_TEST_EXPECT_MSG_EQ (esredStats.nTotalEnqueuedPackets, sredStats.nTotalEnqueuedPackets,
+                         "ESRED and SRED should enqueue the same packets");
+  NS_TEST_EXPECT_MSG_EQ (esred->GetHitFrequency (), sred->GetHitFrequency (),
+                         "ESRED and SRED should estimate the same hit frequency");
+
+  sred->Dispose ();
+  esred->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the age based overwrite does not depend on the absolute time
+ */
+class ESRedQueueDiscTimeInvarianceTestCase : public TestCase
+{
+public:
+  ESRedQueueDiscTimeInvarianceTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+ESRedQueueDiscTimeInvarianceTestCase::ESRedQueueDiscTimeInvarianceTestCase ()
+  : TestCase ("Check that the age based overwrite does not depend on the absolute time")
+{
+}
+
+void
+ESRedQueueDiscTimeInvarianceTestCase::DoRun (void)
+{
+  Ptr<ESRedQueueDisc> early = CreateObjectWithAttributes<ESRedQueueDisc> (
+      "MaxSize", QueueSizeValue (QueueSize ("1000p")),
+      "ZombieListSize", UintegerValue (10),
+      "OverwriteDecay", EnumValue (ESRedQueueDisc::AGE),
+      "HalfLife", TimeValue (MilliSeconds (10)));
+  Ptr<ESRedQueueDisc> late = CreateObjectWithAttributes<ESRedQueueDisc> (
+      "MaxSize", QueueSizeValue (QueueSize ("1000p")),
+      "ZombieListSize", UintegerValue (10),
+      "OverwriteDecay", EnumValue (ESRedQueueDisc::AGE),
+      "HalfLife", TimeValue (MilliSeconds (10)));
+  early->AssignStreams (1);
+  late->AssignStreams (1);
+  early->Initialize ();
+  late->Initialize ();
+
+  // the same traffic, starting at 0 and after 1000s
+  ScheduleTraffic (early, Seconds (0), 1000);
+  ScheduleTraffic (late, Seconds (1000), 1000);
+  Simulator::Run ();
+
+  QueueDisc::Stats earlyStats = early->GetStats ();
+  QueueDisc::Stats lateStats = late->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (lateStats.GetNDroppedPackets ("Zap"), earlyStats.GetNDroppedPackets ("Zap"),
+                         "The same packets should be zapped at any time");
+  NS_TEST_EXPECT_MSG_EQ (late->GetHitFrequency (), early->GetHitFrequency (),
+                         "The same hit frequency should be estimated at any time");
+
+  early->Dispose ();
+  late->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that recently refreshed zombies are protected against overwrites
+ */
+class ESRedQueueDiscHalfLifeTestCase : public TestCase
+{
+public:
+  ESRedQueueDiscHalfLifeTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the hit frequency of the queue disc
+   * \param queue the queue disc
+   * \param expected the expected hit frequency
+   * \param msg the message in case of failure
+   */
+  void CheckHitFrequency (Ptr<ESRedQueueDisc> queue, double expected, std::string msg);
+  /**
+   * Enqueue packets of a flow
+   * \param queue the queue disc
+   * \param flow the identifier of the flow
+   * \param nPkt the number of packets
+   */
+  void Enqueue (Ptr<ESRedQueueDisc> queue, uint32_t flow, uint32_t nPkt);
+};
+
+ESRedQueueDiscHalfLifeTestCase::ESRedQueueDiscHalfLifeTestCase ()
+  : TestCase ("Check the protection of the zombies against overwrites")
+{
+}
+
+void
+ESRedQueueDiscHalfLifeTestCase::CheckHitFrequency (Ptr<ESRedQueueDisc> queue, double expected,
+                                                   std::string msg)
+{
+  NS_TEST_EXPECT_MSG_EQ (queue->GetHitFrequency (), expected, msg);
+}
+
+void
+ESRedQueueDiscHalfLifeTestCase::Enqueue (Ptr<ESRedQueueDisc> queue, uint32_t flow, uint32_t nPkt)
+{
+  EnqueueFlow (queue, flow, 100, nPkt);
+}
+
+void
+ESRedQueueDiscHalfLifeTestCase::DoRun (void)
+{
+  // a single zombie, always overwritten unless protected, and a hit
+  // frequency reflecting the last comparison only
+  Ptr<ESRedQueueDisc> queue = CreateObjectWithAttributes<ESRedQueueDisc> (
+      "MaxSize", QueueSizeValue (QueueSize ("1000p")),
+      "ZombieListSize", UintegerValue (1),
+      "OverwriteProbability", DoubleValue (1),
+      "OverwriteDecay", EnumValue (ESRedQueueDisc::AGE),
+      "HalfLife", TimeValue (Seconds (1)));
+  queue->AssignStreams (1);
+  queue->Initialize ();
+
+  // flow 1 fills the zombie list; flow 2 cannot overwrite the fresh zombie
+  Simulator::Schedule (Seconds (10), &ESRedQueueDiscHalfLifeTestCase::Enqueue, this, queue, 1, 1);
+  Simulator::Schedule (Seconds (10), &ESRedQueueDiscHalfLifeTestCase::Enqueue, this, queue, 2, 10);
+  Simulator::Schedule (Seconds (10), &ESRedQueueDiscHalfLifeTestCase::Enqueue, this, queue, 1, 1);
+  Simulator::Schedule (Seconds (10), &ESRedQueueDiscHalfLifeTestCase::CheckHitFrequency, this,
+                       queue, 1, "Flow 1 should still be the zombie");
+
+  // after 100 half-lives, the zombie is no longer protected
+  Simulator::Schedule (Seconds (110), &ESRedQueueDiscHalfLifeTestCase::Enqueue, this, queue, 2, 1);
+  Simulator::Schedule (Seconds (110), &ESRedQueueDiscHalfLifeTestCase::CheckHitFrequency, this,
+                       queue, 0, "Flow 2 should have missed");
+  Simulator::Schedule (Seconds (110), &ESRedQueueDiscHalfLifeTestCase::Enqueue, this, queue, 2, 1);
+  Simulator::Schedule (Seconds (110), &ESRedQueueDiscHalfLifeTestCase::CheckHitFrequency, this,
+                       queue, 1, "Flow 2 should have overwritten the zombie");
+  Simulator::Run ();
+
+  queue->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the original timestamp based overwrite is the default
+ */
+class ESRedQueueDiscDefaultDecayTestCase : public TestCase
+{
+public:
+  ESRedQueueDiscDefaultDecayTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+ESRedQueueDiscDefaultDecayTestCase::ESRedQueueDiscDefaultDecayTestCase ()
+  : TestCase ("Check that the timestamp based overwrite is the default")
+{
+}
+
+void
+ESRedQueueDiscDefaultDecayTestCase::DoRun (void)
+{
+  Ptr<ESRedQueueDisc> queue = CreateObjectWithAttributes<ESRedQueueDisc> (
+      "MaxSize", QueueSizeValue (QueueSize ("1000p")),
+      "ZombieListSize", UintegerValue (1),
+      "OverwriteProbability", DoubleValue (1));
+  EnumValue decay;
+  queue->GetAttribute ("OverwriteDecay", decay);
+  NS_TEST_EXPECT_MSG_EQ (decay.Get (), ESRedQueueDisc::TIMESTAMP, "Unexpected default decay");
+  queue->AssignStreams (1);
+  queue->Initialize ();
+
+  // a zombie written at time 0 is overwritten with probability
+  // p_overwrite / (1 + 0) = 1, even if it has just been written
+  EnqueueFlow (queue, 1, 100, 1);
+  EnqueueFlow (queue, 2, 100, 1);
+  NS_TEST_EXPECT_MSG_EQ (queue->GetHitFrequency (), 0, "Flow 2 should have missed");
+  EnqueueFlow (queue, 2, 100, 1);
+  NS_TEST_EXPECT_MSG_EQ (queue->GetHitFrequency (), 1, "Flow 2 should have overwritten the zombie");
+
+  queue->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Stabilized RED Queue Disc Test Suite
+ */
+static class StabilizedRedQueueDiscTestSuite : public TestSuite
+{
+public:
+  StabilizedRedQueueDiscTestSuite ()
+    : TestSuite ("stabilized-red-queue-disc", UNIT)
+  {
+    AddTestCase (new StabilizedRedZombieFillTestCase<StabilizedRedQueueDisc> ("SRED"), TestCase::QUICK);
+    AddTestCase (new StabilizedRedZombieFillTestCase<ESRedQueueDisc> ("ESRED"), TestCase::QUICK);
+    AddTestCase (new StabilizedRedHitAccountingTestCase<StabilizedRedQueueDisc> ("SRED"), TestCase::QUICK);
+    AddTestCase (new StabilizedRedHitAccountingTestCase<ESRedQueueDisc> ("ESRED"), TestCase::QUICK);
+    for (int32_t mode = 1; mode <= 2; mode++)
+      {
+        for (QueueSizeUnit unit : {QueueSizeUnit::PACKETS, QueueSizeUnit::BYTES})
+          {
+            AddTestCase (new StabilizedRedZapTestCase<StabilizedRedQueueDisc> ("SRED", mode, unit),
+                         TestCase::QUICK);
+            AddTestCase (new StabilizedRedZapTestCase<ESRedQueueDisc> ("ESRED", mode, unit),
+                         TestCase::QUICK);
+          }
+      }
+    AddTestCase (new StabilizedRedAdaptMaxPTestCase (), TestCase::QUICK);
+    AddTestCase (new StabilizedRedMqShardTestCase<StabilizedRedQueueDisc> ("SRED"), TestCase::QUICK);
+    AddTestCase (new StabilizedRedMqShardTestCase<ESRedQueueDisc> ("ESRED"), TestCase::QUICK);
+    AddTestCase (new ESRedQueueDiscSredEquivalenceTestCase (), TestCase::QUICK);
+    AddTestCase (new ESRedQueueDiscTimeInvarianceTestCase (), TestCase::QUICK);
+    AddTestCase (new ESRedQueueDiscHalfLifeTestCase (), TestCase::QUICK);
+    AddTestCase (new ESRedQueueDiscDefaultDecayTestCase (), TestCase::QUICK);
+  }
+} g_stabilizedRedQueueDiscTestSuite; ///< the test suite
@@ -26,6 +26,7 @@
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/packet-allocator.h"
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -328,6 +329,60 @@ benchByteTags (uint32_t n)
     }
 }
 
+static void
+benchTcpIpv4Ppp (uint32_t n)
+{
+  // Header sizes of a TCP segment with the timestamp option, carried
+  // over IPv4 and PPP through one router, as in a dumbbell topology
+  BenchHeader<32> tcp;
+  BenchHeader<20> ipv4;
+  BenchHeader<2> ppp;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // sender: the socket keeps a copy for retransmission
+      Ptr<Packet> data = Create<Packet> (536);
+      Ptr<Packet> segment = data->Copy ();
+      segment->AddHeader (tcp);
+      segment->AddHeader (ipv4);
+      segment->AddHeader (ppp);
+
+      // router: strip and rebuild the link and network headers
+      Ptr<Packet> forwarded = segment->Copy ();
+      forwarded->RemoveHeader (ppp);
+      forwarded->RemoveHeader (ipv4);
+      forwarded->AddHeader (ipv4);
+      forwarded->AddHeader (ppp);
+
+      // receiver: strip all the headers and send back an ACK
+      Ptr<Packet> received = forwarded->Copy ();
+      received->RemoveHeader (ppp);
+      received->RemoveHeader (ipv4);
+      received->RemoveHeader (tcp);
+      Ptr<Packet> ack = Create<Packet> ();
+      ack->AddHeader (tcp);
+      ack->AddHeader (ipv4);
+      ack->AddHeader (ppp);
+    }
+}
+
+static void
+benchCreateCopy (uint32_t n)
+{
+  BenchHeader<20> ipv4;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // packets which are created, queued as copies and dropped without
+      // ever being printed, as in most large simulations
+      Ptr<Packet> p = Create<Packet> (1000);
+      Ptr<Packet> copy = p->Copy ();
+      Ptr<Packet> fragment = copy->CreateFragment (0, 500);
+      Ptr<Packet> empty = Create<Packet> ();
+      empty->AddHeader (ipv4);
+    }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -370,6 +425,11 @@ int main (int argc, char *argv[])
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
   cmd.Parse (argc, argv);
 
+  if (enablePrinting)
+    {
+      Packet::EnablePrinting ();
+    }
+
   if (n == 0)
     {
       std::cerr << "Error-- number of packets must be specified " <<
@@ -378,6 +438,9 @@ int main (int argc, char *argv[])
     }
   std::cout << "Running bench-packets with n=" << n << std::endl;
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
+  std::cout << "Packet metadata: "
+            << (PacketMetadata::IsEnabled () ? "enabled" : "disabled (lightweight mode)")
+            << std::endl;
 
   runBench (&benchA, n, minIterations, "Copy packet, remove headers");
   runBench (&benchB, n, minIterations, "Just add headers");
@@ -385,6 +448,12 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchTcpIpv4Ppp, n, minIterations, "TCP+IPv4+PPP forwarding");
+  runBench (&benchCreateCopy, n, minIterations, "Create, copy and fragment packets");
+
+  std::cout << "Packet allocator: ";
+  PacketAllocator::PrintStatistics (std::cout);
+  std::cout << std::endl;
 
   return 0;
 }
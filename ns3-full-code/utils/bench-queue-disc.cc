@@ -0,0 +1,478 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks a queue disc without any network stack.  The
+// queue disc, built from its TypeId, is attached to a mock device exposing
+// a single transmission queue through a NetDeviceQueueInterface.  Packets
+// arrive at precomputed times according to a synthetic arrival process and
+// are enqueued as the TrafficControlLayer would do (Enqueue, then Run); the
+// mock device transmits them at the given rate, stopping its transmission
+// queue while busy and restarting the queue disc when done.
+//
+// The arrival processes are:
+//   poisson: Poisson arrivals, the flow of each packet being chosen uniformly
+//   onoff:   each flow alternates exponentially distributed on and off
+//            periods, sending at a constant rate while on
+//   zipf:    Poisson arrivals, the flow of each packet following a Zipf
+//            distribution (a few flows send most packets)
+//
+// The program reports the time per Enqueue and per dequeued packet (the
+// time spent in Run divided by the number of packets it dequeued), the drops
+// and the memory allocations per packet made by the queue disc.  The
+// creation of the packets and the scheduling of the events are not measured.
+//
+// The attributes of the queue disc can be set from the command line, e.g.:
+//   ./ns3 run 'bench-queue-disc --queueDisc=ns3::FqCoDelQueueDisc
+//              --arrivals=zipf --flows=10000 --ns3::FqCoDelQueueDisc::MaxSize=10240p'
+//
+// Use an optimized build to obtain meaningful figures.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/traffic-control-module.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+using namespace ns3;
+
+/// Number of memory allocations made by the program
+static uint64_t g_allocations = 0;
+
+/**
+ * Count the memory allocations
+ * \param size the size of the allocation
+ * \return the allocated memory
+ */
+void *
+operator new (std::size_t size)
+{
+  g_allocations++;
+  void *p = std::malloc (size ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+/**
+ * Release memory allocated by operator new
+ * \param p the memory
+ */
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+/**
+ * Release memory allocated by operator new
+ * \param p the memory
+ * \param size the size of the allocation
+ */
+void
+operator delete (void *p, std::size_t size) noexcept
+{
+  std::free (p);
+}
+
+/**
+ * A queue disc item carrying the identifier of its flow
+ */
+class BenchQueueDiscItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   * \param p the packet
+   * \param flow the identifier of the flow
+   */
+  BenchQueueDiscItem (Ptr<Packet> p, uint32_t flow)
+    : QueueDiscItem (p, Address (), 0),
+      m_flow (flow)
+  {
+  }
+  virtual void AddHeader (void)
+  {
+  }
+  virtual bool Mark (void)
+  {
+    return false;
+  }
+  virtual uint32_t Hash (uint32_t perturbation) const
+  {
+    // a cheap mix, so that the cost of hashing a 5-tuple is not measured
+    return (m_flow ^ perturbation) * 0x9E3779B1;
+  }
+
+private:
+  uint32_t m_flow; ///< the identifier of the flow
+};
+
+/**
+ * The synthetic arrivals
+ */
+struct Arrivals
+{
+  std::vector<int64_t> times;    //!< the arrival times, in nanoseconds
+  std::vector<uint32_t> flows;   //!< the flow of each packet
+};
+
+/**
+ * Generate Poisson arrivals
+ * \param n the number of packets
+ * \param rate the arrival rate, in packets per second
+ * \param cdf the cumulative distribution of the flows of the packets
+ * \param arrivals the arrivals
+ */
+static void
+GeneratePoisson (uint32_t n, double rate, const std::vector<double> &cdf, Arrivals &arrivals)
+{
+  Ptr<ExponentialRandomVariable> interval = CreateObject<ExponentialRandomVariable> ();
+  interval->SetAttribute ("Mean", DoubleValue (1e9 / rate));
+  Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable> ();
+
+  double t = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      t += interval->GetValue ();
+      arrivals.times.push_back (static_cast<int64_t> (t));
+      auto it = std::lower_bound (cdf.begin (), cdf.end (), uv->GetValue ());
+      arrivals.flows.push_back (std::min<std::size_t> (it - cdf.begin (), cdf.size () - 1));
+    }
+}
+
+/**
+ * Generate on/off arrivals
+ * \param n the number of packets
+ * \param rate the average arrival rate, in packets per second
+ * \param nFlows the number of flows
+ * \param onTime the average duration of the on periods
+ * \param offTime the average duration of the off periods
+ * \param arrivals the arrivals
+ */
+static void
+GenerateOnOff (uint32_t n, double rate, uint32_t nFlows, Time onTime, Time offTime, Arrivals &arrivals)
+{
+  Ptr<ExponentialRandomVariable> on = CreateObject<ExponentialRandomVariable> ();
+  on->SetAttribute ("Mean", DoubleValue (onTime.GetNanoSeconds ()));
+  Ptr<ExponentialRandomVariable> off = CreateObject<ExponentialRandomVariable> ();
+  off->SetAttribute ("Mean", DoubleValue (offTime.GetNanoSeconds ()));
+
+  // the rate of a flow while on, such that the average rate of all the flows is rate
+  double dutyCycle = onTime.GetSeconds () / (onTime + offTime).GetSeconds ();
+  double interval = 1e9 * nFlows * dutyCycle / rate;
+  uint32_t perFlow = (n + nFlows - 1) / nFlows;
+
+  std::vector<std::pair<int64_t, uint32_t>> packets;
+  packets.reserve (perFlow * nFlows);
+  for (uint32_t flow = 0; flow < nFlows; flow++)
+    {
+      double t = off->GetValue ();
+      double end = t + on->GetValue ();
+      for (uint32_t i = 0; i < perFlow; i++)
+        {
+          if (t >= end)
+            {
+              t = end + off->GetValue ();
+              end = t + on->GetValue ();
+            }
+          packets.push_back (std::make_pair (static_cast<int64_t> (t), flow));
+          t += interval;
+        }
+    }
+  std::sort (packets.begin (), packets.end ());
+  packets.resize (n);
+
+  for (auto &packet : packets)
+    {
+      arrivals.times.push_back (packet.first);
+      arrivals.flows.push_back (packet.second);
+    }
+}
+
+/**
+ * A device transmitting the packets dequeued by a queue disc, which measures
+ * the time spent in the queue disc
+ */
+class BenchDevice
+{
+public:
+  /**
+   * Constructor
+   * \param queueDisc the queue disc
+   * \param rate the transmission rate
+   * \param mtu the MTU of the device
+   * \param arrivals the arrivals
+   * \param pktSize the size of the packets
+   */
+  BenchDevice (Ptr<QueueDisc> queueDisc, DataRate rate, uint16_t mtu, const Arrivals &arrivals,
+               uint32_t pktSize);
+
+  /**
+   * Schedule the first arrival
+   */
+  void Start (void);
+
+  /**
+   * Print the results
+   */
+  void Report (void) const;
+
+private:
+  /**
+   * Enqueue a packet and run the queue disc
+   * \param i the index of the packet
+   */
+  void Arrival (uint32_t i);
+  /**
+   * Called by the queue disc to transmit a packet
+   * \param item the packet
+   */
+  void Send (Ptr<QueueDiscItem> item);
+  /**
+   * Run the queue disc and schedule the end of the transmission of the
+   * packet it dequeued, if any, or stop the simulation once all the packets
+   * have been transmitted
+   */
+  void Run (void);
+  /**
+   * Restart the transmission queue and run the queue disc
+   */
+  void TransmitComplete (void);
+
+  Ptr<QueueDisc> m_queueDisc;                //!< the queue disc
+  Ptr<NetDeviceQueueInterface> m_ndqi;       //!< the mock device queue interface
+  Ptr<NetDeviceQueue> m_txQueue;             //!< the transmission queue
+  DataRate m_rate;                           //!< the transmission rate
+  const Arrivals &m_arrivals;                //!< the arrivals
+  uint32_t m_pktSize;                        //!< the size of the packets
+  uint32_t m_transmitting;                   //!< the size of the packet being transmitted
+  bool m_running;                            //!< true while the device runs the queue disc
+  std::chrono::nanoseconds m_enqueueTime;    //!< time spent in Enqueue
+  std::chrono::nanoseconds m_dequeueTime;    //!< time spent in Run
+  uint64_t m_enqueueAllocations;             //!< allocations made by Enqueue
+  uint64_t m_dequeueAllocations;             //!< allocations made by Run
+  uint64_t m_nEnqueueCalls;                  //!< number of calls to Enqueue
+  uint64_t m_nDequeued;                      //!< number of packets dequeued
+};
+
+BenchDevice::BenchDevice (Ptr<QueueDisc> queueDisc, DataRate rate, uint16_t mtu,
+                          const Arrivals &arrivals, uint32_t pktSize)
+  : m_queueDisc (queueDisc),
+    m_rate (rate),
+    m_arrivals (arrivals),
+    m_pktSize (pktSize),
+    m_transmitting (0),
+    m_running (false),
+    m_enqueueTime (0),
+    m_dequeueTime (0),
+    m_enqueueAllocations (0),
+    m_dequeueAllocations (0),
+    m_nEnqueueCalls (0),
+    m_nDequeued (0)
+{
+  // a single transmission queue, as created by default.  The interface is
+  // aggregated to a device only because some queue discs (e.g., FqCoDel)
+  // take their quantum from the MTU of the device
+  m_ndqi = CreateObject<NetDeviceQueueInterface> ();
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetMtu (mtu);
+  device->AggregateObject (m_ndqi);
+  m_txQueue = m_ndqi->GetTxQueue (0);
+  m_queueDisc->SetNetDeviceQueueInterface (m_ndqi);
+  m_queueDisc->SetSendCallback ([this] (Ptr<QueueDiscItem> item) { Send (item); });
+  m_queueDisc->Initialize ();
+}
+
+void
+BenchDevice::Start (void)
+{
+  Simulator::Schedule (NanoSeconds (m_arrivals.times[0]), &BenchDevice::Arrival, this, 0);
+}
+
+void
+BenchDevice::Arrival (uint32_t i)
+{
+  Ptr<QueueDiscItem> item = Create<BenchQueueDiscItem> (Create<Packet> (m_pktSize),
+                                                        m_arrivals.flows[i]);
+
+  uint64_t allocations = g_allocations;
+  auto start = std::chrono::steady_clock::now ();
+  m_queueDisc->Enqueue (item);
+  m_enqueueTime += std::chrono::steady_clock::now () - start;
+  m_enqueueAllocations += g_allocations - allocations;
+  m_nEnqueueCalls++;
+  item = 0;
+
+  Run ();
+
+  if (i + 1 < m_arrivals.times.size ())
+    {
+      Simulator::Schedule (NanoSeconds (m_arrivals.times[i + 1]) - Simulator::Now (),
+                           &BenchDevice::Arrival, this, i + 1);
+    }
+}
+
+void
+BenchDevice::Send (Ptr<QueueDiscItem> item)
+{
+  // the device is busy until the packet is transmitted
+  m_transmitting = item->GetSize ();
+  m_txQueue->Stop ();
+  m_nDequeued++;
+
+  // some queue discs (e.g., TBF) run themselves when they can dequeue again
+  if (!m_running)
+    {
+      Simulator::Schedule (m_rate.CalculateBytesTxTime (m_transmitting),
+                           &BenchDevice::TransmitComplete, this);
+    }
+}
+
+void
+BenchDevice::Run (void)
+{
+  if (m_txQueue->IsStopped ())
+    {
+      return;
+    }
+
+  uint64_t allocations = g_allocations;
+  m_running = true;
+  auto start = std::chrono::steady_clock::now ();
+  m_queueDisc->Run ();
+  m_dequeueTime += std::chrono::steady_clock::now () - start;
+  m_running = false;
+  m_dequeueAllocations += g_allocations - allocations;
+
+  if (m_txQueue->IsStopped ())
+    {
+      Simulator::Schedule (m_rate.CalculateBytesTxTime (m_transmitting),
+                           &BenchDevice::TransmitComplete, this);
+    }
+  else if (m_nEnqueueCalls == m_arrivals.times.size ())
+    {
+      // the queue disc is empty and all the packets have arrived: stop here,
+      // as some queue discs (e.g., PIE) keep scheduling periodic events
+      Simulator::Stop ();
+    }
+}
+
+void
+BenchDevice::TransmitComplete (void)
+{
+  m_txQueue->Start ();
+  Run ();
+}
+
+void
+BenchDevice::Report (void) const
+{
+  QueueDisc::Stats stats = m_queueDisc->GetStats ();
+  std::cout << "Simulated time:    " << Simulator::Now ().As (Time::S) << std::endl
+            << "Enqueue:           " << (double) m_enqueueTime.count () / m_nEnqueueCalls
+            << " ns/op (" << m_nEnqueueCalls << " packets)" << std::endl
+            << "Dequeue:           " << (m_nDequeued ? (double) m_dequeueTime.count () / m_nDequeued : 0)
+            << " ns/op (" << m_nDequeued << " packets)" << std::endl
+            << "Dropped:           " << stats.nTotalDroppedPackets << " ("
+            << stats.nTotalDroppedPacketsBeforeEnqueue << " before enqueue, "
+            << stats.nTotalDroppedPacketsAfterDequeue << " after dequeue)" << std::endl
+            << "Allocations:       " << (double) m_enqueueAllocations / m_nEnqueueCalls
+            << " per enqueue, "
+            << (m_nDequeued ? (double) m_dequeueAllocations / m_nDequeued : 0)
+            << " per dequeued packet" << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string queueDisc = "ns3::FifoQueueDisc";
+  std::string process = "poisson";
+  uint32_t n = 1000000;
+  uint32_t nFlows = 100;
+  uint32_t pktSize = 1000;
+  uint16_t mtu = 1500;
+  DataRate linkRate ("100Mbps");
+  double load = 1.2;
+  double zipfAlpha = 1;
+  Time onTime = MilliSeconds (10);
+  Time offTime = MilliSeconds (40);
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark a queue disc without the network stack");
+  cmd.AddValue ("queueDisc", "The TypeId of the queue disc", queueDisc);
+  cmd.AddValue ("arrivals", "The arrival process: poisson, onoff or zipf", process);
+  cmd.AddValue ("n", "The number of packets", n);
+  cmd.AddValue ("flows", "The number of flows", nFlows);
+  cmd.AddValue ("pktSize", "The size of the packets", pktSize);
+  cmd.AddValue ("mtu", "The MTU of the device", mtu);
+  cmd.AddValue ("linkRate", "The transmission rate of the device", linkRate);
+  cmd.AddValue ("load", "The average arrival rate, relative to the transmission rate", load);
+  cmd.AddValue ("zipfAlpha", "The exponent of the Zipf distribution of the flows", zipfAlpha);
+  cmd.AddValue ("onTime", "The average duration of the on periods", onTime);
+  cmd.AddValue ("offTime", "The average duration of the off periods", offTime);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (n == 0 || nFlows == 0, "The number of packets and of flows must not be null");
+  double rate = load * linkRate.GetBitRate () / (pktSize * 8.0);
+
+  Arrivals arrivals;
+  arrivals.times.reserve (n);
+  arrivals.flows.reserve (n);
+  if (process == "onoff")
+    {
+      GenerateOnOff (n, rate, nFlows, onTime, offTime, arrivals);
+    }
+  else
+    {
+      // the flows are equally likely with Poisson arrivals
+      double alpha = (process == "zipf" ? zipfAlpha : 0);
+      NS_ABORT_MSG_IF (process != "zipf" && process != "poisson",
+                       "Unknown arrival process " << process);
+      std::vector<double> cdf (nFlows);
+      double sum = 0;
+      for (uint32_t i = 0; i < nFlows; i++)
+        {
+          sum += 1 / std::pow (i + 1, alpha);
+          cdf[i] = sum;
+        }
+      for (auto &p : cdf)
+        {
+          p /= sum;
+        }
+      GeneratePoisson (n, rate, cdf, arrivals);
+    }
+
+  ObjectFactory factory;
+  factory.SetTypeId (queueDisc);
+  BenchDevice device (factory.Create<QueueDisc> (), linkRate, mtu, arrivals, pktSize);
+
+  std::cout << "Running bench-queue-disc with " << queueDisc << ", " << process << " arrivals, "
+            << n << " packets of " << nFlows << " flows" << std::endl;
+
+  device.Start ();
+  Simulator::Run ();
+  device.Report ();
+  Simulator::Destroy ();
+
+  return 0;
+}
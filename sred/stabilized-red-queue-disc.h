@@ -31,32 +31,23 @@
 #include "ns3/data-rate.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/packet.h"
+#include "sred-shard-group.h"
 
-using namespace std;
+#define MAX_ZOMBIE_LIST_SIZE 1000
+
+namespace ns3 {
 
+/**
+ * \ingroup traffic-control
+ *
+ * \brief An entry of the SRED zombie list
+ */
 struct Zombie
 {
-  int32_t flowID;         
-  int32_t count;
-  // Time time;
-
-  // Zombie(int32_t flowID, int32_t count)
-  // {
-  //   this->flowID = flowID;
-  //   this->count = count;
-  // }
-
-  // set time
-  // void SetTime(Time time)
-  // {
-  //   this->time = time;
-  // }
+  uint32_t flowID;  //!< the hash of the flow
+  int32_t count;    //!< the number of hits
 };
 
-#define MAX_ZOMBIE_LIST_SIZE 1000
-
-namespace ns3 {
-
 class TraceContainer;
 
 /**
@@ -107,6 +98,22 @@ public:
   */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \brief Get the hit frequency of the zombie list
+   * \return the hit frequency
+   */
+  double GetHitFrequency (void) const;
+
+  /**
+   * \brief Set the hit frequency of the zombie list
+   *
+   * This is used by the SredShardGroup the queue disc belongs to, if any,
+   * to merge the hit frequencies of its shards.
+   *
+   * \param hitFrequency the hit frequency
+   */
+  void SetHitFrequency (double hitFrequency);
+
 protected:
   /**
    * \brief Dispose of the object
@@ -137,13 +144,26 @@ private:
    * \returns new average queue size
    */
   double Estimator (uint32_t nQueued, uint32_t m, double qAvg, double qW);
+  /**
+   * \brief Update p_max and the overwrite probability to keep the average
+   *        queue size within the target range
+   *
+   * The target range is [B/6, B/3], the thresholds of the drop probability
+   * p_sred, where B is the capacity of the queue.  As in the AdaptMaxP mode
+   * of RedQueueDisc, the probabilities are increased additively when the
+   * average queue size is in the upper part of the range and decreased
+   * multiplicatively when it is in the lower part.
+   *
+   * \param newAve new average queue size
+   */
+  void UpdateMaxP (double newAve);
 
   
   double calculateProbabilityStabilizedRed();
   double calculateProbabilityZapSimple(double probabilityStabilizedRed);
   double calculateProbabilityZap(double probabilityStabilizedRed,int32_t hit);
   
-  vector<Zombie> zombies;
+  std::vector<Zombie> zombies;
   double p_hitFreq;
   double p_overwrite; // 0.25 in paper
   double p_max; // 0.15 in paper
@@ -151,6 +171,30 @@ private:
 
   int32_t stabilizedRedMode; // 1 for simple, 2 for full
 
+
+  uint32_t m_zombieListSize;         //!< Capacity of the zombie list
+  Ptr<SredShardGroup> m_shardGroup;  //!< The group of shards this zombie list belongs to, if any
+  uint32_t m_shard;                  //!< The identifier of this zombie list in the shard group
+  bool m_inShardGroup;               //!< Whether this zombie list has been added to the shard group
+
+  // Adaptive SRED parameters
+  bool m_isAdaptMaxP;        //!< True to adapt p_max and the overwrite probability
+  double m_qW;               //!< Queue weight given to cur queue size sample
+  double m_qAvg;             //!< Average queue length
+  uint32_t m_meanPktSize;    //!< Average packet size
+  DataRate m_linkBandwidth;  //!< Link bandwidth
+  double m_ptc;              //!< Packet time constant in packets/second
+  bool m_idle;               //!< True if the queue is idle
+  Time m_idleTime;           //!< Start of the current idle period
+  Time m_interval;           //!< Time interval to update p_max and the overwrite probability
+  Time m_lastSet;            //!< Last time p_max and the overwrite probability were updated
+  double m_top;              //!< Upper bound for p_max
+  double m_bottom;           //!< Lower bound for p_max
+  double m_overwriteTop;     //!< Upper bound for the overwrite probability
+  double m_overwriteBottom;  //!< Lower bound for the overwrite probability
+  double m_alpha;            //!< Increment parameter for p_max and the overwrite probability
+  double m_beta;             //!< Decrement parameter for p_max and the overwrite probability
+
   Ptr<UniformRandomVariable> m_uv;
 };
 